@@ -41,6 +41,9 @@ typedef enum {
     UCX_PERF_CMD_TAG,
     UCX_PERF_CMD_TAG_SYNC,
     UCX_PERF_CMD_STREAM,
+    UCX_PERF_CMD_AM_BATCH,
+    UCX_PERF_CMD_EP_CREATE,
+    UCX_PERF_CMD_TAG_MT,
     UCX_PERF_CMD_LAST
 } ucx_perf_cmd_t;
 
@@ -56,6 +59,7 @@ typedef enum {
 typedef enum {
     UCP_PERF_DATATYPE_CONTIG,
     UCP_PERF_DATATYPE_IOV,
+    UCP_PERF_DATATYPE_STRIDED,
 } ucp_perf_datatype_t;
 
 
@@ -83,7 +87,9 @@ enum ucx_perf_test_flags {
     UCX_PERF_TEST_FLAG_TAG_WILDCARD     = UCS_BIT(4), /* For tag tests, use wildcard mask */
     UCX_PERF_TEST_FLAG_TAG_UNEXP_PROBE  = UCS_BIT(5), /* For tag tests, use probe to get unexpected receive */
     UCX_PERF_TEST_FLAG_VERBOSE          = UCS_BIT(7), /* Print error messages */
-    UCX_PERF_TEST_FLAG_STREAM_RECV_DATA = UCS_BIT(8)  /* For stream tests, use recv data API */
+    UCX_PERF_TEST_FLAG_STREAM_RECV_DATA = UCS_BIT(8), /* For stream tests, use recv data API */
+    UCX_PERF_TEST_FLAG_PRINT_LANES      = UCS_BIT(9)  /* For UCP tests, print endpoint lanes and
+                                                         per-lane bytes at the end of the test */
 };
 
 
@@ -188,6 +194,10 @@ typedef struct ucx_perf_params {
         unsigned               nonblocking_mode; /* TBD */
         ucp_perf_datatype_t    send_datatype;
         ucp_perf_datatype_t    recv_datatype;
+        size_t                 mixed_size;   /* Size of background messages, 0 - none */
+        unsigned               mixed_period; /* Iterations between background messages */
+        unsigned               am_batch_size; /* Active messages per batch */
+        unsigned               compute_time; /* Usec of computation after each send */
     } ucp;
 
 } ucx_perf_params_t;
@@ -275,6 +275,7 @@ static void ucx_perf_test_init(ucx_perf_context_t *perf,
 {
     perf->params            = *params;
     perf->offset            = 0;
+    perf->thread_index      = 0;
     perf->allocator         = ucx_perf_mem_type_allocators[params->mem_type];
 
     ucx_perf_test_prepare_new_run(perf, params);
@@ -355,6 +356,32 @@ static ucs_status_t ucx_perf_test_check_params(ucx_perf_params_t *params)
         return UCS_ERR_INVALID_PARAM;
     }
 
+    if ((params->ucp.mixed_size != 0) &&
+        ((params->api != UCX_PERF_API_UCP) ||
+         ((params->command != UCX_PERF_CMD_TAG) &&
+          (params->command != UCX_PERF_CMD_TAG_SYNC)) ||
+         (params->test_type != UCX_PERF_TEST_TYPE_PINGPONG) ||
+         (params->mem_type != UCS_MEMORY_TYPE_HOST) ||
+         (params->flags & UCX_PERF_TEST_FLAG_TAG_WILDCARD))) {
+        if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
+            ucs_error("Mixed-size mode is supported only by UCP tag latency "
+                      "tests on host memory, without wild-card tag");
+        }
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    if (((params->ucp.send_datatype == UCP_PERF_DATATYPE_STRIDED) ||
+         (params->ucp.recv_datatype == UCP_PERF_DATATYPE_STRIDED))) {
+        for (it = 1; it < params->msg_size_cnt; ++it) {
+            if (params->msg_size_list[it] != params->msg_size_list[0]) {
+                if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
+                    ucs_error("Strided datatype requires equal block sizes");
+                }
+                return UCS_ERR_INVALID_PARAM;
+            }
+        }
+    }
+
     /* check if particular message size fit into stride size */
     if (params->iov_stride) {
         for (it = 0; it < params->msg_size_cnt; ++it) {
@@ -833,6 +860,7 @@ static ucs_status_t ucp_perf_test_fill_params(ucx_perf_params_t *params,
         break;
     case UCX_PERF_CMD_TAG:
     case UCX_PERF_CMD_TAG_SYNC:
+    case UCX_PERF_CMD_TAG_MT:
         ucp_params->features    |= UCP_FEATURE_TAG;
         ucp_params->field_mask  |= UCP_PARAM_FIELD_REQUEST_SIZE;
         ucp_params->request_size = sizeof(ucp_perf_request_t);
@@ -842,6 +870,23 @@ static ucs_status_t ucp_perf_test_fill_params(ucx_perf_params_t *params,
         ucp_params->field_mask  |= UCP_PARAM_FIELD_REQUEST_SIZE;
         ucp_params->request_size = sizeof(ucp_perf_request_t);
         break;
+    case UCX_PERF_CMD_AM_BATCH:
+        if (params->ucp.am_batch_size < 1) {
+            if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
+                ucs_error("Active message batch size should be at least 1");
+            }
+            return UCS_ERR_INVALID_PARAM;
+        }
+
+        ucp_params->features    |= UCP_FEATURE_AM;
+        ucp_params->field_mask  |= UCP_PARAM_FIELD_REQUEST_SIZE;
+        ucp_params->request_size = sizeof(ucp_perf_request_t);
+        break;
+    case UCX_PERF_CMD_EP_CREATE:
+        ucp_params->features    |= UCP_FEATURE_TAG;
+        ucp_params->field_mask  |= UCP_PARAM_FIELD_REQUEST_SIZE;
+        ucp_params->request_size = sizeof(ucp_perf_request_t);
+        break;
     default:
         if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
             ucs_error("Invalid test command");
@@ -875,6 +920,31 @@ static ucs_status_t ucp_perf_test_alloc_iov_mem(ucp_perf_datatype_t datatype,
     return UCS_OK;
 }
 
+static ucs_status_t
+ucp_perf_test_create_strided_dt(ucx_perf_params_t *params,
+                                ucp_perf_datatype_t datatype,
+                                ucp_datatype_t *dt_p)
+{
+    ucp_dt_strided_dim_t dim;
+    ucs_status_t status;
+
+    *dt_p = ucp_dt_make_contig(1);
+    if (UCP_PERF_DATATYPE_STRIDED != datatype) {
+        return UCS_OK;
+    }
+
+    dim.count  = params->msg_size_cnt;
+    dim.stride = params->iov_stride ? params->iov_stride :
+                 params->msg_size_list[0];
+    status     = ucp_dt_create_strided(params->msg_size_list[0], &dim, 1, dt_p);
+    if (status != UCS_OK) {
+        ucs_error("Failed to create strided datatype: %s",
+                  ucs_status_string(status));
+    }
+
+    return status;
+}
+
 static ucs_status_t
 ucp_perf_test_alloc_host(ucx_perf_context_t *perf, size_t length,
                          void **address_p, ucp_mem_h *memh, int non_blk_flag)
@@ -971,8 +1041,25 @@ static ucs_status_t ucp_perf_test_alloc_mem(ucx_perf_context_t *perf)
         goto err_free_send_iov_buffers;
     }
 
+    /* Create strided datatypes */
+    status = ucp_perf_test_create_strided_dt(params, params->ucp.send_datatype,
+                                             &perf->ucp.send_strided_dt);
+    if (UCS_OK != status) {
+        goto err_free_iov_buffers;
+    }
+
+    status = ucp_perf_test_create_strided_dt(params, params->ucp.recv_datatype,
+                                             &perf->ucp.recv_strided_dt);
+    if (UCS_OK != status) {
+        goto err_destroy_send_strided_dt;
+    }
+
     return UCS_OK;
 
+err_destroy_send_strided_dt:
+    ucp_dt_destroy(perf->ucp.send_strided_dt);
+err_free_iov_buffers:
+    free(perf->ucp.recv_iov);
 err_free_send_iov_buffers:
     free(perf->ucp.send_iov);
 err_free_buffers:
@@ -985,6 +1072,8 @@ err:
 
 static void ucp_perf_test_free_mem(ucx_perf_context_t *perf)
 {
+    ucp_dt_destroy(perf->ucp.recv_strided_dt);
+    ucp_dt_destroy(perf->ucp.send_strided_dt);
     free(perf->ucp.recv_iov);
     free(perf->ucp.send_iov);
     perf->allocator->ucp_free(perf, perf->recv_buffer, perf->ucp.recv_memh);
@@ -1008,6 +1097,7 @@ static void ucp_perf_test_destroy_eps(ucx_perf_context_t* perf,
         if (perf->ucp.peers[i].ep != NULL) {
             reqs[i] = ucp_disconnect_nb(perf->ucp.peers[i].ep);
         }
+        free(perf->ucp.peers[i].address);
     }
 
     for (i = 0; i < group_size; ++i) {
@@ -1130,6 +1220,15 @@ static ucs_status_t ucp_perf_test_setup_endpoints(ucx_perf_context_t *perf,
         rkey_buffer = (void*)address + remote_info->ucp.addr_len;
         perf->ucp.peers[i].remote_addr = remote_info->recv_buffer;
 
+        /* Keep the remote address for tests which create more endpoints */
+        perf->ucp.peers[i].address = malloc(remote_info->ucp.addr_len);
+        if (perf->ucp.peers[i].address == NULL) {
+            ucs_error("Failed to allocate remote address buffer");
+            status = UCS_ERR_NO_MEMORY;
+            goto err_free_buffer;
+        }
+        memcpy(perf->ucp.peers[i].address, address, remote_info->ucp.addr_len);
+
         ep_params.field_mask = UCP_EP_PARAM_FIELD_REMOTE_ADDRESS;
         ep_params.address    = address;
 
@@ -1179,6 +1278,19 @@ err:
     return status;
 }
 
+static void ucp_perf_test_print_lanes(ucx_perf_context_t *perf,
+                                      unsigned group_size)
+{
+    unsigned i;
+
+    for (i = 0; i < group_size; ++i) {
+        if (perf->ucp.peers[i].ep != NULL) {
+            ucp_ep_print_info(perf->ucp.peers[i].ep, stdout);
+        }
+    }
+    fflush(stdout);
+}
+
 static void ucp_perf_test_cleanup_endpoints(ucx_perf_context_t *perf)
 {
     unsigned group_size;
@@ -1187,6 +1299,10 @@ static void ucp_perf_test_cleanup_endpoints(ucx_perf_context_t *perf)
 
     group_size  = rte_call(perf, group_size);
 
+    if (perf->params.flags & UCX_PERF_TEST_FLAG_PRINT_LANES) {
+        ucp_perf_test_print_lanes(perf, group_size);
+    }
+
     ucp_perf_test_destroy_eps(perf, group_size);
 }
 
@@ -1561,6 +1677,37 @@ typedef struct {
 } ucx_perf_thread_context_t;
 
 
+/* Sum the bandwidth and message rate of all threads, and average the latency */
+static void ucx_perf_thread_aggregate_result(ucx_perf_thread_context_t *tctx,
+                                             int ntid, ucx_perf_result_t *result)
+{
+    const ucx_perf_result_t *tresult;
+    int i;
+
+    for (i = 0; i < ntid; ++i) {
+        if (&tctx[i].result == result) {
+            continue;
+        }
+
+        tresult                           = &tctx[i].result;
+        result->iters                    += tresult->iters;
+        result->bytes                    += tresult->bytes;
+        result->elapsed_time              = ucs_max(result->elapsed_time,
+                                                    tresult->elapsed_time);
+        result->latency.typical          += tresult->latency.typical;
+        result->latency.moment_average   += tresult->latency.moment_average;
+        result->latency.total_average    += tresult->latency.total_average;
+        result->bandwidth.moment_average += tresult->bandwidth.moment_average;
+        result->bandwidth.total_average  += tresult->bandwidth.total_average;
+        result->msgrate.moment_average   += tresult->msgrate.moment_average;
+        result->msgrate.total_average    += tresult->msgrate.total_average;
+    }
+
+    result->latency.typical        /= ntid;
+    result->latency.moment_average /= ntid;
+    result->latency.total_average  /= ntid;
+}
+
 static void* ucx_perf_thread_run_test(void* arg)
 {
     ucx_perf_thread_context_t* tctx = (ucx_perf_thread_context_t*) arg;
@@ -1592,11 +1739,16 @@ static void* ucx_perf_thread_run_test(void* arg)
             goto out;
         }
     }
+    ucx_perf_calc_result(perf, result);
+#pragma omp barrier
 #pragma omp master
     {
-        /* Assuming all threads are fairly treated, reporting only tid==0
-            TODO: aggregate reports */
-        ucx_perf_calc_result(perf, result);
+        if (params->command == UCX_PERF_CMD_TAG_MT) {
+            /* Every thread has its own flow, report the total throughput */
+            ucx_perf_thread_aggregate_result(tctx - tid, tctx->ntid, result);
+        }
+        /* Otherwise, assuming all threads are fairly treated, reporting only
+           tid==0 */
         rte_call(perf, report, result, perf->params.report_arg, 1);
     }
 
@@ -1635,6 +1787,7 @@ static int ucx_perf_thread_spawn(ucx_perf_context_t *perf,
     tctx[ti].perf.send_buffer += ti * message_size;
     tctx[ti].perf.recv_buffer += ti * message_size;
     tctx[ti].perf.offset = ti * message_size;
+    tctx[ti].perf.thread_index = ti;
     ucx_perf_thread_run_test((void*)&tctx[ti]);
 }
 
@@ -50,6 +50,8 @@ struct ucx_perf_context {
     void                         *send_buffer;
     void                         *recv_buffer;
     ptrdiff_t                    offset;
+    unsigned                     thread_index; /* index of the thread running
+                                                  the test, if multi-threaded */
 
     /* Measurements */
     double                       start_time_acc;  /* accurate start time */
@@ -92,6 +94,8 @@ struct ucx_perf_context {
             ucp_mem_h            recv_memh;
             ucp_dt_iov_t         *send_iov;
             ucp_dt_iov_t         *recv_iov;
+            ucp_datatype_t       send_strided_dt;
+            ucp_datatype_t       recv_strided_dt;
         } ucp;
     };
 };
@@ -106,6 +110,7 @@ struct uct_peer {
 
 struct ucp_peer {
     ucp_ep_h                     ep;
+    ucp_address_t                *address;
     unsigned long                remote_addr;
     ucp_rkey_h                   rkey;
 };
@@ -9,6 +9,7 @@
 #include <tools/perf/lib/libperf_int.h>
 
 extern "C" {
+#include <ucs/arch/atomic.h>
 #include <ucs/debug/log.h>
 #include <ucs/sys/math.h>
 #include <ucs/sys/sys.h>
@@ -21,18 +22,34 @@ class ucp_perf_test_runner {
 public:
     static const ucp_tag_t TAG      = 0x1337a880u;
     static const ucp_tag_t TAG_MASK = (FLAGS & UCX_PERF_TEST_FLAG_TAG_WILDCARD) ? 0 : -1;
+    static const ucp_tag_t MIXED_TAG = TAG + 1;
+    static const unsigned  MIXED_MAX_OUTSTANDING = 256;
+    static const uint16_t  AM_ID    = 0;
 
     typedef uint8_t psn_t;
 
     ucp_perf_test_runner(ucx_perf_context_t &perf) :
         m_perf(perf),
         m_outstanding(0),
-        m_max_outstanding(m_perf.params.max_outstanding)
-
+        m_max_outstanding(m_perf.params.max_outstanding),
+        m_mixed_buffer(NULL),
+        m_mixed_first(0),
+        m_mixed_count(0),
+        m_am_batch(NULL),
+        m_am_batch_count(0),
+        m_am_recv_count(0),
+        m_remote_address(NULL)
     {
         ucs_assert_always(m_max_outstanding > 0);
     }
 
+    /* In multi-threaded tag test, every thread sends and receives with its
+     * own tag */
+    ucp_tag_t UCS_F_ALWAYS_INLINE tag() const
+    {
+        return (CMD == UCX_PERF_CMD_TAG_MT) ? (TAG + m_perf.thread_index) : TAG;
+    }
+
     void create_iov_buffer(ucp_dt_iov_t *iov, void *buffer)
     {
         size_t iov_length_it, iov_it;
@@ -55,6 +72,7 @@ public:
     }
 
     ucp_datatype_t ucp_perf_test_get_datatype(ucp_perf_datatype_t datatype, ucp_dt_iov_t *iov,
+                                              ucp_datatype_t strided_dt,
                                               size_t *length, void **buffer_p)
     {
         ucp_datatype_t type = ucp_dt_make_contig(1);
@@ -62,6 +80,10 @@ public:
             *buffer_p = iov;
             *length   = m_perf.params.msg_size_cnt;
             type      = ucp_dt_make_iov();
+        } else if (UCP_PERF_DATATYPE_STRIDED == datatype) {
+            /* a single element of the strided datatype is the whole message */
+            *length   = 1;
+            type      = strided_dt;
         }
         return type;
     }
@@ -150,12 +172,14 @@ public:
         switch (CMD) {
         case UCX_PERF_CMD_TAG:
         case UCX_PERF_CMD_TAG_SYNC:
+        case UCX_PERF_CMD_TAG_MT:
         case UCX_PERF_CMD_STREAM:
             wait_window(1);
             /* coverity[switch_selector_expr_is_constant] */
             switch (CMD) {
             case UCX_PERF_CMD_TAG:
-                request = ucp_tag_send_nb(ep, buffer, length, datatype, TAG,
+            case UCX_PERF_CMD_TAG_MT:
+                request = ucp_tag_send_nb(ep, buffer, length, datatype, tag(),
                                           send_cb);
                 break;
             case UCX_PERF_CMD_TAG_SYNC:
@@ -176,6 +200,13 @@ public:
             reinterpret_cast<ucp_perf_request_t*>(request)->context = this;
             send_started();
             return UCS_OK;
+        case UCX_PERF_CMD_AM_BATCH:
+            if (++m_am_batch_count < m_perf.params.ucp.am_batch_size) {
+                return UCS_OK;
+            }
+            return send_am_batch(ep);
+        case UCX_PERF_CMD_EP_CREATE:
+            return create_ep();
         case UCX_PERF_CMD_PUT:
             *((uint8_t*)buffer + length - 1) = sn;
             return ucp_put(ep, buffer, length, remote_addr, rkey);
@@ -229,13 +260,14 @@ public:
         switch (CMD) {
         case UCX_PERF_CMD_TAG:
         case UCX_PERF_CMD_TAG_SYNC:
+        case UCX_PERF_CMD_TAG_MT:
             if (FLAGS & UCX_PERF_TEST_FLAG_TAG_UNEXP_PROBE) {
                 ucp_tag_recv_info_t tag_info;
-                while (ucp_tag_probe_nb(worker, TAG, TAG_MASK, 0, &tag_info) == NULL) {
+                while (ucp_tag_probe_nb(worker, tag(), TAG_MASK, 0, &tag_info) == NULL) {
                     progress_responder();
                 }
             }
-            request = ucp_tag_recv_nb(worker, buffer, length, datatype, TAG, TAG_MASK,
+            request = ucp_tag_recv_nb(worker, buffer, length, datatype, tag(), TAG_MASK,
                                       (ucp_tag_recv_callback_t)ucs_empty_function);
             return wait(request, false);
         case UCX_PERF_CMD_PUT:
@@ -271,11 +303,74 @@ public:
             } else {
                 return recv_stream(ep, buffer, length, datatype, sn);
             }
+        case UCX_PERF_CMD_AM_BATCH:
+            while (m_am_recv_count == 0) {
+                progress_responder();
+            }
+            --m_am_recv_count;
+            return UCS_OK;
+        case UCX_PERF_CMD_EP_CREATE:
+            progress_responder();
+            return UCS_OK;
         default:
             return UCS_ERR_INVALID_PARAM;
         }
     }
 
+    /* In mixed-size mode, post a large transfer in the background every
+     * mixed_period iterations, so the measured messages compete with it */
+    void UCS_F_ALWAYS_INLINE mixed_start(ucp_worker_h worker, ucp_ep_h ep,
+                                         unsigned my_index,
+                                         ucx_perf_counter_t iter)
+    {
+        void *request;
+
+        if (ucs_likely((m_perf.params.ucp.mixed_size == 0) ||
+                       ((iter % m_perf.params.ucp.mixed_period) != 0))) {
+            return;
+        }
+
+        /* release completed transfers, oldest first */
+        while ((m_mixed_count > 0) &&
+               ((m_mixed_count == MIXED_MAX_OUTSTANDING) ||
+                ucp_request_is_completed(m_mixed_reqs[m_mixed_first]))) {
+            wait(m_mixed_reqs[m_mixed_first], true);
+            m_mixed_first = (m_mixed_first + 1) % MIXED_MAX_OUTSTANDING;
+            --m_mixed_count;
+        }
+
+        if (my_index == 0) {
+            request = ucp_tag_send_nb(ep, m_mixed_buffer,
+                                      m_perf.params.ucp.mixed_size,
+                                      ucp_dt_make_contig(1), MIXED_TAG,
+                                      (ucp_send_callback_t)ucs_empty_function);
+        } else {
+            request = ucp_tag_recv_nb(worker, m_mixed_buffer,
+                                      m_perf.params.ucp.mixed_size,
+                                      ucp_dt_make_contig(1), MIXED_TAG,
+                                      (ucp_tag_t)-1,
+                                      (ucp_tag_recv_callback_t)ucs_empty_function);
+        }
+
+        if (UCS_PTR_IS_PTR(request)) {
+            m_mixed_reqs[(m_mixed_first + m_mixed_count) %
+                         MIXED_MAX_OUTSTANDING] = request;
+            ++m_mixed_count;
+        } else if (UCS_PTR_IS_ERR(request)) {
+            ucs_warn("failed to start background transfer: %s",
+                     ucs_status_string(UCS_PTR_STATUS(request)));
+        }
+    }
+
+    void mixed_wait_all()
+    {
+        while (m_mixed_count > 0) {
+            wait(m_mixed_reqs[m_mixed_first], true);
+            m_mixed_first = (m_mixed_first + 1) % MIXED_MAX_OUTSTANDING;
+            --m_mixed_count;
+        }
+    }
+
     ucs_status_t run_pingpong()
     {
         unsigned my_index;
@@ -294,6 +389,12 @@ public:
         ucp_perf_test_prepare_iov_buffers();
 
         m_perf.allocator->memset((char*)m_perf.recv_buffer + length - 1, -1, 1);
+        if (m_perf.params.ucp.mixed_size != 0) {
+            m_mixed_buffer = malloc(m_perf.params.ucp.mixed_size);
+            if (m_mixed_buffer == NULL) {
+                return UCS_ERR_NO_MEMORY;
+            }
+        }
 
         ucp_perf_barrier(&m_perf);
 
@@ -311,14 +412,19 @@ public:
         send_length   = length;
         recv_length   = length;
         send_datatype = ucp_perf_test_get_datatype(m_perf.params.ucp.send_datatype,
-                                                   m_perf.ucp.send_iov, &send_length,
+                                                   m_perf.ucp.send_iov,
+                                                   m_perf.ucp.send_strided_dt,
+                                                   &send_length,
                                                    &send_buffer);
         recv_datatype = ucp_perf_test_get_datatype(m_perf.params.ucp.recv_datatype,
-                                                   m_perf.ucp.recv_iov, &recv_length,
+                                                   m_perf.ucp.recv_iov,
+                                                   m_perf.ucp.recv_strided_dt,
+                                                   &recv_length,
                                                    &recv_buffer);
 
         if (my_index == 0) {
             UCX_PERF_TEST_FOREACH(&m_perf) {
+                mixed_start(worker, ep, my_index, m_perf.current.iters);
                 send(ep, send_buffer, send_length, send_datatype, sn, remote_addr, rkey);
                 recv(worker, ep, recv_buffer, recv_length, recv_datatype, sn);
                 ucx_perf_update(&m_perf, 1, length);
@@ -326,6 +432,7 @@ public:
             }
         } else if (my_index == 1) {
             UCX_PERF_TEST_FOREACH(&m_perf) {
+                mixed_start(worker, ep, my_index, m_perf.current.iters);
                 recv(worker, ep, recv_buffer, recv_length, recv_datatype, sn);
                 send(ep, send_buffer, send_length, send_datatype, sn, remote_addr, rkey);
                 ucx_perf_update(&m_perf, 1, length);
@@ -333,6 +440,9 @@ public:
             }
         }
 
+        mixed_wait_all();
+        free(m_mixed_buffer);
+        m_mixed_buffer = NULL;
         wait_window(m_max_outstanding);
         ucp_worker_flush(m_perf.ucp.worker);
         ucx_perf_get_time(&m_perf);
@@ -350,6 +460,7 @@ public:
         uint64_t remote_addr;
         ucp_rkey_h rkey;
         size_t length, send_length, recv_length;
+        ucs_status_t status;
         uint8_t sn;
 
         length        = ucx_perf_get_message_size(&m_perf.params);
@@ -357,6 +468,13 @@ public:
 
         ucp_perf_test_prepare_iov_buffers();
 
+        if (CMD == UCX_PERF_CMD_AM_BATCH) {
+            status = am_batch_init(m_perf.send_buffer, length);
+            if (status != UCS_OK) {
+                return status;
+            }
+        }
+
         ucp_perf_barrier(&m_perf);
 
         my_index      = rte_call(&m_perf, group_index);
@@ -373,11 +491,16 @@ public:
         send_length   = length;
         recv_length   = length;
         send_datatype = ucp_perf_test_get_datatype(m_perf.params.ucp.send_datatype,
-                                                   m_perf.ucp.send_iov, &send_length,
+                                                   m_perf.ucp.send_iov,
+                                                   m_perf.ucp.send_strided_dt,
+                                                   &send_length,
                                                    &send_buffer);
         recv_datatype = ucp_perf_test_get_datatype(m_perf.params.ucp.recv_datatype,
-                                                   m_perf.ucp.recv_iov, &recv_length,
+                                                   m_perf.ucp.recv_iov,
+                                                   m_perf.ucp.recv_strided_dt,
+                                                   &recv_length,
                                                    &recv_buffer);
+        m_remote_address = m_perf.ucp.peers[1 - my_index].address;
 
         if (my_index == 0) {
             UCX_PERF_TEST_FOREACH(&m_perf) {
@@ -389,9 +512,14 @@ public:
             UCX_PERF_TEST_FOREACH(&m_perf) {
                 send(ep, send_buffer, send_length, send_datatype, sn,
                      remote_addr, rkey);
+                compute();
                 ucx_perf_update(&m_perf, 1, length);
                 ++sn;
             }
+
+            if ((CMD == UCX_PERF_CMD_AM_BATCH) && (m_am_batch_count > 0)) {
+                send_am_batch(ep);
+            }
         }
 
         wait_window(m_max_outstanding);
@@ -399,6 +527,8 @@ public:
         ucx_perf_get_time(&m_perf);
 
         ucp_perf_barrier(&m_perf);
+        free(m_am_batch);
+        m_am_batch = NULL;
         return UCS_OK;
     }
 
@@ -417,6 +547,90 @@ public:
     }
 
 private:
+    /* Simulate application computation after posting a send, without
+     * progressing the worker, so only the progress thread (if enabled) can
+     * advance the outstanding transfers */
+    void compute()
+    {
+        ucs_time_t end_time;
+
+        if (m_perf.params.ucp.compute_time == 0) {
+            return;
+        }
+
+        end_time = ucs_get_time() +
+                   ucs_time_from_usec(m_perf.params.ucp.compute_time);
+        while (ucs_get_time() < end_time) {
+            ucs_compiler_fence();
+        }
+    }
+
+    static ucs_status_t am_batch_cb(void *arg, void *data, size_t length,
+                                    ucp_ep_h reply_ep, unsigned flags)
+    {
+        ucp_perf_test_runner *self = (ucp_perf_test_runner*)arg;
+
+        ++self->m_am_recv_count;
+        return UCS_OK;
+    }
+
+    /* Every message of a batch is sent from the same buffer, so one array of
+     * items serves all outstanding batches */
+    ucs_status_t am_batch_init(void *buffer, size_t length)
+    {
+        unsigned i;
+
+        m_am_batch = (ucp_am_batch_item_t*)malloc(m_perf.params.ucp.am_batch_size *
+                                                  sizeof(*m_am_batch));
+        if (m_am_batch == NULL) {
+            return UCS_ERR_NO_MEMORY;
+        }
+
+        for (i = 0; i < m_perf.params.ucp.am_batch_size; ++i) {
+            m_am_batch[i].id     = AM_ID;
+            m_am_batch[i].buffer = buffer;
+            m_am_batch[i].length = length;
+        }
+
+        return ucp_worker_set_am_handler(m_perf.ucp.worker, AM_ID, am_batch_cb,
+                                         this, UCP_AM_FLAG_WHOLE_MSG);
+    }
+
+    /* Connect one more endpoint to the peer and close it right away, to
+     * measure the cost of transport selection and endpoint setup */
+    ucs_status_t UCS_F_ALWAYS_INLINE create_ep()
+    {
+        ucp_ep_params_t ep_params;
+        ucs_status_t status;
+        ucp_ep_h ep;
+
+        ep_params.field_mask = UCP_EP_PARAM_FIELD_REMOTE_ADDRESS;
+        ep_params.address    = m_remote_address;
+
+        status = ucp_ep_create(m_perf.ucp.worker, &ep_params, &ep);
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        return wait(ucp_ep_close_nb(ep, UCP_EP_CLOSE_MODE_FLUSH), true);
+    }
+
+    ucs_status_t UCS_F_ALWAYS_INLINE send_am_batch(ucp_ep_h ep)
+    {
+        void *request;
+
+        wait_window(1);
+        request          = ucp_am_send_batch(ep, m_am_batch, m_am_batch_count,
+                                             send_cb, 0);
+        m_am_batch_count = 0;
+        if (ucs_likely(!UCS_PTR_IS_PTR(request))) {
+            return UCS_PTR_STATUS(request);
+        }
+        reinterpret_cast<ucp_perf_request_t*>(request)->context = this;
+        send_started();
+        return UCS_OK;
+    }
+
     ucs_status_t UCS_F_ALWAYS_INLINE
     recv_stream_data(ucp_ep_h ep, unsigned length, ucp_datatype_t datatype,
                      uint8_t sn)
@@ -469,17 +683,35 @@ private:
 
     void UCS_F_ALWAYS_INLINE send_started()
     {
-        ++m_outstanding;
+        if (CMD == UCX_PERF_CMD_TAG_MT) {
+            ucs_atomic_add32(&m_outstanding, 1);
+        } else {
+            ++m_outstanding;
+        }
     }
 
     void UCS_F_ALWAYS_INLINE send_completed()
     {
-        --m_outstanding;
+        /* In multi-threaded test, send callback may be called by any thread
+         * which progresses the worker */
+        if (CMD == UCX_PERF_CMD_TAG_MT) {
+            ucs_atomic_sub32(&m_outstanding, 1);
+        } else {
+            --m_outstanding;
+        }
     }
 
     ucx_perf_context_t &m_perf;
-    unsigned           m_outstanding;
+    uint32_t           m_outstanding;
     const unsigned     m_max_outstanding;
+    void               *m_mixed_buffer;
+    void               *m_mixed_reqs[MIXED_MAX_OUTSTANDING];
+    unsigned           m_mixed_first;
+    unsigned           m_mixed_count;
+    ucp_am_batch_item_t *m_am_batch;
+    unsigned           m_am_batch_count;
+    unsigned           m_am_recv_count;
+    ucp_address_t      *m_remote_address;
 };
 
 
@@ -536,7 +768,8 @@ ucs_status_t ucp_perf_test_dispatch(ucx_perf_context_t *perf)
         (UCX_PERF_CMD_TAG,      UCX_PERF_TEST_TYPE_PINGPONG),
         (UCX_PERF_CMD_TAG,      UCX_PERF_TEST_TYPE_STREAM_UNI),
         (UCX_PERF_CMD_TAG_SYNC, UCX_PERF_TEST_TYPE_PINGPONG),
-        (UCX_PERF_CMD_TAG_SYNC, UCX_PERF_TEST_TYPE_STREAM_UNI)
+        (UCX_PERF_CMD_TAG_SYNC, UCX_PERF_TEST_TYPE_STREAM_UNI),
+        (UCX_PERF_CMD_TAG_MT,   UCX_PERF_TEST_TYPE_STREAM_UNI)
         );
 
     UCS_PP_FOREACH(TEST_CASE_ALL_STREAM, perf,
@@ -544,6 +777,9 @@ ucs_status_t ucp_perf_test_dispatch(ucx_perf_context_t *perf)
         (UCX_PERF_CMD_STREAM,   UCX_PERF_TEST_TYPE_PINGPONG)
         );
 
+    TEST_CASE(perf, UCX_PERF_CMD_AM_BATCH, UCX_PERF_TEST_TYPE_STREAM_UNI, 0, 0)
+    TEST_CASE(perf, UCX_PERF_CMD_EP_CREATE, UCX_PERF_TEST_TYPE_STREAM_UNI, 0, 0)
+
     ucs_error("Invalid test case: %d/%d/0x%x",
               perf->params.command, perf->params.test_type,
               perf->params.flags);
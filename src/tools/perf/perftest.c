@@ -39,7 +39,7 @@
 
 #define MAX_BATCH_FILES         32
 #define TL_RESOURCE_NAME_NONE   "<none>"
-#define TEST_PARAMS_ARGS        "t:n:s:W:O:w:D:i:H:oSCqM:r:T:d:x:A:BUm:"
+#define TEST_PARAMS_ARGS        "t:n:s:W:O:w:D:i:H:oSCqM:r:T:d:x:A:BUm:LX:G:I:"
 
 
 enum {
@@ -152,6 +152,15 @@ test_type_t tests[] = {
     {"stream_lat", UCX_PERF_API_UCP, UCX_PERF_CMD_STREAM, UCX_PERF_TEST_TYPE_PINGPONG,
      "stream latency"},
 
+    {"am_batch", UCX_PERF_API_UCP, UCX_PERF_CMD_AM_BATCH, UCX_PERF_TEST_TYPE_STREAM_UNI,
+     "batched active message rate"},
+
+    {"ep_create", UCX_PERF_API_UCP, UCX_PERF_CMD_EP_CREATE, UCX_PERF_TEST_TYPE_STREAM_UNI,
+     "endpoint creation rate"},
+
+    {"tag_mt", UCX_PERF_API_UCP, UCX_PERF_CMD_TAG_MT, UCX_PERF_TEST_TYPE_STREAM_UNI,
+     "tag match message rate, total over threads"},
+
      {NULL}
 };
 
@@ -414,8 +423,22 @@ static void usage(const struct perftest_context *ctx, const char *program)
     printf("                    data layout for sender and receiver side (contig)\n");
     printf("                        contig - Continuous datatype\n");
     printf("                        iov    - Scatter-gather list\n");
+    printf("                        strided - Vector of equal blocks, sized by \"-s\"\n");
+    printf("                                  and placed \"-i\" bytes apart\n");
     printf("     -C             use wild-card tag for tag tests\n");
     printf("     -U             force unexpected flow by using tag probe\n");
+    printf("     -L             print endpoint lanes and bytes sent on each rendezvous\n");
+    printf("                    lane at the end of the test (requires statistics support)\n");
+    printf("     -X <size>[:<n>]\n");
+    printf("                    mixed-size mode for tag latency tests: every <n> (%u)\n",
+           ctx->params.ucp.mixed_period);
+    printf("                    iterations, also transfer a message of <size> in the\n");
+    printf("                    background; only the regular messages are reported\n");
+    printf("     -G <count>     number of active messages per batch for am_batch (%u)\n",
+           ctx->params.ucp.am_batch_size);
+    printf("     -I <usec>      compute time between posting sends in bandwidth tests,\n");
+    printf("                    without progressing the worker, to measure overlap (%u)\n",
+           ctx->params.ucp.compute_time);
     printf("     -r <mode>      receive mode for stream tests (recv)\n");
     printf("                        recv       : Use ucp_stream_recv_nb\n");
     printf("                        recv_data  : Use ucp_stream_recv_data_nb\n");
@@ -440,9 +463,13 @@ static ucs_status_t parse_ucp_datatype_params(const char *optarg,
     const size_t iov_type_size    = strlen("iov");
     const char  *contig_type      = "contig";
     const size_t contig_type_size = strlen("contig");
+    const char  *strided_type      = "strided";
+    const size_t strided_type_size = strlen("strided");
 
     if (0 == strncmp(optarg, iov_type, iov_type_size)) {
         *datatype = UCP_PERF_DATATYPE_IOV;
+    } else if (0 == strncmp(optarg, strided_type, strided_type_size)) {
+        *datatype = UCP_PERF_DATATYPE_STRIDED;
     } else if (0 == strncmp(optarg, contig_type, contig_type_size)) {
         *datatype = UCP_PERF_DATATYPE_CONTIG;
     } else {
@@ -495,6 +522,48 @@ static ucs_status_t parse_message_sizes_params(const char *optarg,
     return UCS_OK;
 }
 
+static ucs_status_t parse_mixed_size(const char *optarg,
+                                     ucx_perf_params_t *params)
+{
+    unsigned long period = params->ucp.mixed_period;
+    unsigned long size;
+    char *endptr;
+
+    size = strtoul(optarg, &endptr, 10);
+    if ((endptr != optarg) && (*endptr == ':')) {
+        optarg = endptr + 1;
+        period = strtoul(optarg, &endptr, 10);
+    }
+
+    if ((endptr == optarg) || (*endptr != '\0') || (size == 0) ||
+        (period == 0)) {
+        ucs_error("Invalid option argument for -X");
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    params->ucp.mixed_size   = size;
+    params->ucp.mixed_period = period;
+    return UCS_OK;
+}
+
+static ucs_status_t parse_positive_count(const char *optarg, char opt,
+                                         unsigned *count_p)
+{
+    long value;
+    char *endptr;
+
+    errno = 0;
+    value = strtol(optarg, &endptr, 10);
+    if ((endptr == optarg) || (*endptr != '\0') || (errno != 0) ||
+        (value <= 0) || (value > UINT_MAX)) {
+        ucs_error("Invalid option argument for -%c", opt);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    *count_p = value;
+    return UCS_OK;
+}
+
 static ucs_status_t init_test_params(ucx_perf_params_t *params)
 {
     memset(params, 0, sizeof(*params));
@@ -520,6 +589,10 @@ static ucs_status_t init_test_params(ucx_perf_params_t *params)
     params->iov_stride        = 0;
     params->ucp.send_datatype = UCP_PERF_DATATYPE_CONTIG;
     params->ucp.recv_datatype = UCP_PERF_DATATYPE_CONTIG;
+    params->ucp.mixed_size    = 0;
+    params->ucp.mixed_period  = 16;
+    params->ucp.am_batch_size = 16;
+    params->ucp.compute_time  = 0;
     strcpy(params->uct.dev_name, TL_RESOURCE_NAME_NONE);
     strcpy(params->uct.tl_name,  TL_RESOURCE_NAME_NONE);
 
@@ -618,6 +691,15 @@ static ucs_status_t parse_test_params(ucx_perf_params_t *params, char opt, const
     case 'U':
         params->flags |= UCX_PERF_TEST_FLAG_TAG_UNEXP_PROBE;
         return UCS_OK;
+    case 'L':
+        params->flags |= UCX_PERF_TEST_FLAG_PRINT_LANES;
+        return UCS_OK;
+    case 'X':
+        return parse_mixed_size(optarg, params);
+    case 'G':
+        return parse_positive_count(optarg, opt, &params->ucp.am_batch_size);
+    case 'I':
+        return parse_positive_count(optarg, opt, &params->ucp.compute_time);
     case 'M':
         if (!strcmp(optarg, "single")) {
             params->thread_mode = UCS_THREAD_MODE_SINGLE;
@@ -403,13 +403,17 @@ enum {
  * @ingroup UCP_WORKER
  * @brief Flags for a UCP Active Message callback.
  *
- * Flags that indicate how to handle UCP Active Messages
- * Currently only UCP_AM_FLAG_WHOLE_MSG is supported,
- * which indicates the entire message is handled in one
- * callback.
+ * Flags that indicate how to handle UCP Active Messages.
+ * UCP_AM_FLAG_WHOLE_MSG indicates the entire message is handled in one
+ * callback. UCP_AM_FLAG_RNDV indicates the callback accepts rendezvous
+ * descriptors (@ref UCP_CB_PARAM_FLAG_RNDV) of large messages, and fetches
+ * their data with @ref ucp_am_recv_data_nb. Otherwise, the data of such
+ * messages is fetched to a buffer allocated by UCP before the callback is
+ * invoked.
  */
 enum ucp_am_cb_flags {
-    UCP_AM_FLAG_WHOLE_MSG = UCS_BIT(0)
+    UCP_AM_FLAG_WHOLE_MSG = UCS_BIT(0),
+    UCP_AM_FLAG_RNDV      = UCS_BIT(1)
 };
 
 
@@ -427,6 +431,19 @@ enum ucp_send_am_flags {
 };
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Active Message of a batch.
+ *
+ * One of the Active Messages sent together by @ref ucp_am_send_batch.
+ */
+typedef struct ucp_am_batch_item {
+    uint16_t   id;      /**< Active Message id */
+    const void *buffer; /**< Contiguous data of the message */
+    size_t     length;  /**< Length of the data, in bytes */
+} ucp_am_batch_item_t;
+
+
 /**
  * @ingroup UCP_ENDPOINT
  * @brief Descriptor flags for Active Message callback.
@@ -436,9 +453,17 @@ enum ucp_send_am_flags {
  * returned from the callback, the data parameter will persist 
  * and the user has to call @ref ucp_am_data_release when data is
  * no longer needed.
+ *
+ * If flags is set to UCP_CB_PARAM_FLAG_RNDV, the message was sent with the
+ * rendezvous protocol and data is an opaque descriptor of it. The user
+ * fetches the message to a buffer of its choice with
+ * @ref ucp_am_recv_data_nb, or drops it with @ref ucp_am_data_release.
+ * If UCS_INPROGRESS is returned from the callback and the descriptor was
+ * not used, it persists until one of these routines is called.
  */
 enum ucp_cb_param_flags {
-    UCP_CB_PARAM_FLAG_DATA = UCS_BIT(0)
+    UCP_CB_PARAM_FLAG_DATA = UCS_BIT(0),
+    UCP_CB_PARAM_FLAG_RNDV = UCS_BIT(1)
 };
 
 
@@ -494,6 +519,25 @@ typedef enum {
 } ucp_stream_recv_flags_t;
 
 
+/**
+ * @ingroup UCP_WORKER
+ * @brief Stream endpoint events
+ *
+ * This enumeration defines the events an endpoint is polled for by
+ * @ref ucp_stream_worker_poll, see @ref ucp_stream_ep_set_poll_events. The
+ * events are edge-triggered: an endpoint is returned once per event, and is
+ * returned again only after a new event occurs on it.
+ */
+typedef enum {
+    UCP_STREAM_POLL_FLAG_IN  = UCS_BIT(0), /**< New stream data arrived on the
+                                                endpoint. */
+    UCP_STREAM_POLL_FLAG_OUT = UCS_BIT(1)  /**< Stream sends which waited for
+                                                the remote receive window were
+                                                started, see UCX_STREAM_WINDOW.
+                                                */
+} ucp_stream_poll_flags_t;
+
+
 /**
  * @ingroup UCP_DATATYPE
  * @brief Generate an identifier for contiguous data type.
@@ -543,6 +587,28 @@ typedef struct ucp_dt_iov {
 } ucp_dt_iov_t;
 
 
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Maximal number of dimensions of a strided datatype.
+ */
+#define UCP_DT_STRIDED_MAX_DIMS 3
+
+
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Dimension of a strided datatype.
+ *
+ * This structure describes one dimension of a strided datatype created by
+ * @ref ucp_dt_create_strided "ucp_dt_create_strided()": @a count items of the
+ * inner dimension (or contiguous blocks, for the innermost dimension), whose
+ * starting addresses are @a stride bytes apart.
+ */
+typedef struct ucp_dt_strided_dim {
+    size_t   count;   /**< Number of items in the dimension */
+    ssize_t  stride;  /**< Distance in bytes between consecutive items */
+} ucp_dt_strided_dim_t;
+
+
 /**
  * @ingroup UCP_DATATYPE
  * @brief UCP generic data type descriptor
@@ -658,6 +724,29 @@ typedef struct ucp_generic_dt_ops {
 } ucp_generic_dt_ops_t;
 
 
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Generic datatype flags.
+ *
+ * The enumeration list describes the properties of the routines of a generic
+ * datatype, passed to @ref ucp_dt_create_generic_ext
+ * "ucp_dt_create_generic_ext()".
+ */
+enum ucp_dt_generic_flags {
+    UCP_DT_GENERIC_FLAG_THREAD_SAFE = UCS_BIT(0)  /**< The @ref
+                                                       ucp_generic_dt_ops::pack
+                                                       "pack()" routine may be
+                                                       called concurrently from
+                                                       UCP helper threads, for
+                                                       different offsets of the
+                                                       same state. It must
+                                                       accept any byte offset
+                                                       and pack all the
+                                                       requested length, unless
+                                                       the packed data ends. */
+};
+
+
 /**
  * @ingroup UCP_CONFIG
  * @brief Tuning parameters for UCP library.
@@ -1003,14 +1092,22 @@ typedef struct ucp_stream_poll_ep {
     void        *user_data;
 
     /**
-     * Reserved for future use.
+     * Events which occurred on the endpoint, a combination of
+     * @ref ucp_stream_poll_flags_t.
      */
     unsigned    flags;
 
+    /**
+     * Amount of stream data which is ready to be received from the endpoint
+     * without waiting. Valid if @ref UCP_STREAM_POLL_FLAG_IN is set in
+     * @a flags.
+     */
+    size_t      length;
+
     /**
      * Reserved for future use.
      */
-    uint8_t     reserved[16];
+    uint8_t     reserved[8];
 } ucp_stream_poll_ep_t;
 
 
@@ -1430,6 +1527,28 @@ void ucp_worker_release_address(ucp_worker_h worker, ucp_address_t *address);
 unsigned ucp_worker_progress(ucp_worker_h worker);
 
 
+/**
+ * @ingroup UCP_WORKER
+ * @brief Progress communications on a specific worker, with a budget.
+ *
+ * This routine is the same as @ref ucp_worker_progress
+ * "ucp_worker_progress()", except that it stops progressing the interfaces
+ * once they report at least @a max_events events. Latency sensitive interfaces,
+ * such as shared memory ones, are always progressed first, so a small budget
+ * reduces the overhead of polling the other interfaces while the latency
+ * sensitive ones are busy.
+ *
+ * @note The interfaces which are not progressed because of the budget are
+ * progressed by later calls, once the latency sensitive interfaces are idle.
+ *
+ * @param [in]  worker      Worker to progress.
+ * @param [in]  max_events  Maximal number of events to progress.
+ *
+ * @return Number of progressed events, may be larger than @a max_events.
+ */
+unsigned ucp_worker_progress_budget(ucp_worker_h worker, unsigned max_events);
+
+
 /**
  * @ingroup UCP_WORKER
  * @brief Poll for endpoints that are ready to consume streaming data.
@@ -1437,6 +1556,10 @@ unsigned ucp_worker_progress(ucp_worker_h worker);
  * This non-blocking routine returns endpoints on a worker which are ready
  * to consume streaming data. The ready endpoints are placed in @a poll_eps
  * array, and the function return value indicates how many are there.
+ * Finding the ready endpoints does not depend on the total number of endpoints
+ * on the worker. Reporting @ref ucp_stream_poll_ep_t::length walks the
+ * received data segments queued on each returned endpoint, so its cost grows
+ * with the number of segments which were not consumed yet.
  *
  * @param [in]   worker    Worker to poll.
  * @param [out]  poll_eps  Pointer to array of endpoints, should be
@@ -1455,6 +1578,24 @@ ssize_t ucp_stream_worker_poll(ucp_worker_h worker,
                                unsigned flags);
 
 
+/**
+ * @ingroup UCP_WORKER
+ * @brief Select the events an endpoint is polled for.
+ *
+ * This routine selects which events make @ref ucp_stream_worker_poll return
+ * the endpoint. By default, an endpoint is polled for
+ * @ref UCP_STREAM_POLL_FLAG_IN only. If the endpoint has stream data which
+ * was not received yet when @ref UCP_STREAM_POLL_FLAG_IN is selected, the
+ * endpoint is returned by the next poll.
+ *
+ * @param [in]  ep      Endpoint to set the events for.
+ * @param [in]  events  Combination of @ref ucp_stream_poll_flags_t.
+ *
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_stream_ep_set_poll_events(ucp_ep_h ep, unsigned events);
+
+
 /**
  * @ingroup UCP_WAKEUP
  * @brief Obtain an event file descriptor for event notification.
@@ -1509,6 +1650,10 @@ ucs_status_t ucp_worker_get_efd(ucp_worker_h worker, int *fd);
  * notification and may not progress some of the requests as it would when
  * calling @ref ucp_worker_progress (which is not invoked in that duration).
  *
+ * @note If UCX_WAIT_SPIN_TIME is set, this routine first calls
+ * @ref ucp_worker_progress for an adaptive period of time, and returns without
+ * blocking if it progressed any communication.
+ *
  * @note UCP @ref ucp_feature "features" have to be triggered
  *   with @ref UCP_FEATURE_WAKEUP to select proper transport
  *
@@ -2196,10 +2341,11 @@ void ucp_rkey_destroy(ucp_rkey_h rkey);
  *                          in to every invocation of the callback as the
  *                          arg argument.
  * @param [in]  flags       Dictates how an Active Message is handled on the
- *                          remote endpoint. Currently only
- *                          UCP_AM_FLAG_WHOLE_MSG is supported, which
- *                          indicates the callback will not be invoked
- *                          until all data has arrived.
+ *                          remote endpoint, see @ref ucp_am_cb_flags.
+ *                          UCP_AM_FLAG_WHOLE_MSG indicates the callback will
+ *                          not be invoked until all data has arrived, or
+ *                          until the rendezvous descriptor has arrived if
+ *                          UCP_AM_FLAG_RNDV is set.
  *
  * @return error code if the worker does not support Active Messages or
  *         requested callback flags.
@@ -2214,7 +2360,9 @@ ucs_status_t ucp_worker_set_am_handler(ucp_worker_h worker, uint16_t id,
  * @brief Send Active Message.
  *
  * This routine sends an Active Message to an ep. It does not support
- * CUDA memory.
+ * CUDA memory. Messages larger than the UCX_AM_RNDV_THRESH configuration
+ * are sent with the rendezvous protocol, so the receiver fetches the data
+ * directly from @a buffer.
  *
  * @param [in]  ep          UCP endpoint where the Active Message will be run.
  * @param [in]  id          Active Message id. Specifies which registered
@@ -2238,6 +2386,38 @@ ucs_status_ptr_t ucp_am_send_nb(ucp_ep_h ep, uint16_t id,
                                 ucp_send_callback_t cb, unsigned flags);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Send a batch of Active Messages.
+ *
+ * This routine sends several small Active Messages to an ep, packing as many
+ * of them as possible into each transport message. The receiver invokes the
+ * callbacks in the order of @a items, without @ref UCP_CB_PARAM_FLAG_DATA, so
+ * the data does not persist after a callback returns. Every message must fit
+ * into a single transport message together with its header; larger messages
+ * should be sent with @ref ucp_am_send_nb.
+ *
+ * @param [in]  ep          UCP endpoint where the Active Messages will be run.
+ * @param [in]  items       Array of the messages to send. The array and the
+ *                          data of the messages must not be modified until the
+ *                          operation is completed.
+ * @param [in]  count       Number of elements in @a items.
+ * @param [in]  cb          Callback that is invoked upon completion of the
+ *                          data transfer if it is not completed immediately.
+ * @param [in]  flags       Can be @ref UCP_AM_SEND_REPLY to pass the sending
+ *                          ep to all callbacks.
+ *
+ * @return NULL             All messages were sent immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) Error sending the messages.
+ * @return otherwise        Pointer to request, and the messages are known
+ *                          to be completed after cb is run.
+ */
+ucs_status_ptr_t ucp_am_send_batch(ucp_ep_h ep,
+                                   const ucp_am_batch_item_t *items,
+                                   size_t count, ucp_send_callback_t cb,
+                                   unsigned flags);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Releases Active Message data.
@@ -2249,10 +2429,44 @@ ucs_status_ptr_t ucp_am_send_nb(ucp_ep_h ep, uint16_t id,
  * @param [in] data         Pointer to data that was passed into
  *                          the Active Message callback as the data
  *                          parameter.
+ *
+ * @note If @a data is a rendezvous descriptor, the message is dropped and
+ *       the sender is notified that it was received.
  */
 void ucp_am_data_release(ucp_worker_h worker, void *data);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Receive the data of a rendezvous Active Message.
+ *
+ * This routine fetches the data of an Active Message which was passed to the
+ * callback with the @ref UCP_CB_PARAM_FLAG_RNDV flag into a user buffer. It
+ * can be called from the Active Message callback, or later if the callback
+ * returned UCS_INPROGRESS. The descriptor must not be used after this call.
+ *
+ * @param [in]  worker      Worker which received the Active Message.
+ * @param [in]  data_desc   Descriptor which was passed into the Active
+ *                          Message callback as the data parameter.
+ * @param [in]  buffer      Pointer to the buffer to receive the data to.
+ * @param [in]  count       Number of elements to receive into @a buffer.
+ * @param [in]  datatype    Datatype descriptor for the elements in the buffer.
+ * @param [in]  cb          Callback that is invoked when the data is received,
+ *                          if it is not received immediately.
+ *
+ * @return NULL                 The data was received immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) Error receiving the data. If the buffer is too
+ *                              small, UCS_ERR_MESSAGE_TRUNCATED is returned.
+ * @return otherwise            Pointer to request, and the data is known to be
+ *                              received after cb is run. The request must be
+ *                              released with @ref ucp_request_free.
+ */
+ucs_status_ptr_t ucp_am_recv_data_nb(ucp_worker_h worker, void *data_desc,
+                                     void *buffer, size_t count,
+                                     ucp_datatype_t datatype,
+                                     ucp_am_recv_data_callback_t cb);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking stream send operation.
@@ -3059,6 +3273,60 @@ ucs_status_t ucp_dt_create_generic(const ucp_generic_dt_ops_t *ops, void *contex
                                    ucp_datatype_t *datatype_p);
 
 
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Create a generic datatype with extra properties.
+ *
+ * This routine is the same as @ref ucp_dt_create_generic
+ * "ucp_dt_create_generic()", and in addition accepts @a flags which describe
+ * the routines of @a ops. If @ref UCP_DT_GENERIC_FLAG_THREAD_SAFE is set, UCP
+ * may pack large messages on helper threads of the worker (see
+ * UCX_GENERIC_DT_PACK_THREADS), overlapping the packing with the sending.
+ *
+ * @param [in]  ops          Generic datatype function table as defined by
+ *                           @ref ucp_generic_dt_ops_t .
+ * @param [in]  context      Application defined context passed to this
+ *                           routine.  The context is passed as a parameter
+ *                           to the routines in the @a ops table.
+ * @param [in]  flags        Bitmap of @ref ucp_dt_generic_flags.
+ * @param [out] datatype_p   A pointer to datatype object.
+ *
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_dt_create_generic_ext(const ucp_generic_dt_ops_t *ops,
+                                       void *context, unsigned flags,
+                                       ucp_datatype_t *datatype_p);
+
+
+/**
+ * @ingroup UCP_DATATYPE
+ * @brief Create a strided datatype.
+ *
+ * This routine creates a datatype object which describes a (nested) vector:
+ * contiguous blocks of @a blocklen bytes laid out according to @a dims, where
+ * dims[0] is the innermost dimension. For example, a single dimension
+ * {count, stride} describes @a count blocks which start @a stride bytes apart.
+ * When the datatype is used with an element count larger than 1, consecutive
+ * elements start dims[dim_count - 1].count * dims[dim_count - 1].stride bytes
+ * apart. The data is packed by UCP itself, so strided datatypes do not need
+ * user-defined routines like @ref ucp_dt_create_generic "generic" ones.
+ * The application is responsible for releasing the @a datatype_p object using
+ * @ref ucp_dt_destroy "ucp_dt_destroy()" routine.
+ *
+ * @param [in]  blocklen     Size in bytes of a contiguous block.
+ * @param [in]  dims         Array of @a dim_count dimensions, innermost first.
+ * @param [in]  dim_count    Number of dimensions, at most
+ *                           @ref UCP_DT_STRIDED_MAX_DIMS.
+ * @param [out] datatype_p   A pointer to datatype object.
+ *
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_dt_create_strided(size_t blocklen,
+                                   const ucp_dt_strided_dim_t *dims,
+                                   unsigned dim_count,
+                                   ucp_datatype_t *datatype_p);
+
+
 /**
  * @ingroup UCP_DATATYPE
  * @brief Destroy a datatype and release its resources.
@@ -3066,7 +3334,9 @@ ucs_status_t ucp_dt_create_generic(const ucp_generic_dt_ops_t *ops, void *contex
  * This routine destroys the @a datatype object and
  * releases any resources that are associated with the object.
  * The @a datatype object must be allocated using @ref ucp_dt_create_generic
- * "ucp_dt_create_generic()" routine.
+ * "ucp_dt_create_generic()", @ref ucp_dt_create_generic_ext
+ * "ucp_dt_create_generic_ext()" or @ref ucp_dt_create_strided
+ * "ucp_dt_create_strided()" routine.
  *
  * @warning
  * @li Once the @a datatype object is released an access to this object may
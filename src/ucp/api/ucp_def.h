@@ -488,6 +488,10 @@ typedef enum ucp_wakeup_event_types {
  * @param [in]  flags    If this flag is set to UCP_CB_PARAM_FLAG_DATA,
  *                       the callback can return UCS_INPROGRESS and
  *                       data will persist after the callback returns.
+ *                       If it is set to UCP_CB_PARAM_FLAG_RNDV, data is a
+ *                       rendezvous descriptor and @a length is the length of
+ *                       the message, which is received with
+ *                       @ref ucp_am_recv_data_nb.
  *
  * @return UCS_OK        @a data will not persist after the callback returns.
  *
@@ -506,6 +510,25 @@ typedef ucs_status_t (*ucp_am_callback_t)(void *arg, void *data, size_t length,
                                           ucp_ep_h reply_ep, unsigned flags);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Completion callback for receiving the data of a rendezvous Active
+ * Message.
+ *
+ * This callback routine is invoked whenever the @ref ucp_am_recv_data_nb
+ * "receive operation" is completed and the data is ready in the receive buffer.
+ *
+ * @param [in]  request   The completed receive request.
+ * @param [in]  status    Completion status. If the receive operation was
+ *                        completed successfully UCS_OK is returned. Otherwise,
+ *                        an @ref ucs_status_t "error status" is returned.
+ * @param [in]  length    The size of the received data in bytes. The value is
+ *                        valid only if the status is UCS_OK.
+ */
+typedef void (*ucp_am_recv_data_callback_t)(void *request, ucs_status_t status,
+                                            size_t length);
+
+
 /**
  * @ingroup UCP_ENDPOINT
  * @brief Tuning parameters for the UCP endpoint.
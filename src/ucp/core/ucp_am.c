@@ -16,32 +16,189 @@
 #include <ucp/core/ucp_ep.inl>
 #include <ucp/core/ucp_worker.h>
 #include <ucp/core/ucp_context.h>
+#include <ucp/core/ucp_mm.h>
 #include <ucp/proto/proto.h>
 #include <ucp/proto/proto_am.inl>
 #include <ucp/dt/dt.h>
 #include <ucp/dt/dt.inl>
+#include <ucp/tag/rndv.h>
 
-void ucp_am_ep_init(ucp_ep_h ep)
+static ucs_mpool_ops_t ucp_am_buf_mpool_ops = {
+    .chunk_alloc   = ucp_am_buf_mpool_malloc,
+    .chunk_release = ucp_am_buf_mpool_free,
+    .obj_init      = ucp_mpool_obj_init,
+    .obj_cleanup   = ucs_empty_function
+};
+
+/* Allocate a receive descriptor followed by a buffer of the given size */
+static ucp_recv_desc_t *ucp_am_buf_get(ucp_worker_h worker, size_t size,
+                                       const char *name)
 {
-    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
-    
-    if (ep->worker->context->config.features & UCP_FEATURE_AM) {
-        ucs_list_head_init(&ep_ext->am.started_ams);
+    unsigned mp_index = (size <= UCS_BIT(UCP_AM_BUF_MP_MIN_SHIFT)) ? 0 :
+                        (ucs_ilog2(size - 1) + 1 - UCP_AM_BUF_MP_MIN_SHIFT);
+    ucp_mem_desc_t *mdesc;
+    ucp_recv_desc_t *rdesc;
+
+    if (ucs_likely(mp_index < UCP_AM_BUF_MP_COUNT)) {
+        mdesc = ucs_mpool_get_inline(&worker->am.buf_mp[mp_index]);
+        if (ucs_unlikely(mdesc == NULL)) {
+            return NULL;
+        }
+
+        rdesc        = (ucp_recv_desc_t*)(mdesc + 1);
+        rdesc->flags = UCP_RECV_DESC_FLAG_AM_MPOOL;
+    } else {
+        rdesc = ucs_malloc(size + sizeof(*rdesc), name);
+        if (ucs_unlikely(rdesc == NULL)) {
+            return NULL;
+        }
+
+        rdesc->flags = UCP_RECV_DESC_FLAG_MALLOC;
+    }
+
+    return rdesc;
+}
+
+static void ucp_am_buf_put(ucp_recv_desc_t *rdesc)
+{
+    if (rdesc->flags & UCP_RECV_DESC_FLAG_AM_MPOOL) {
+        ucs_mpool_put_inline((ucp_mem_desc_t*)rdesc - 1);
+    } else {
+        ucs_free(rdesc);
+    }
+}
+
+ucs_status_t ucp_am_worker_init(ucp_worker_h worker)
+{
+    size_t buf_size;
+    ucs_status_t status;
+    unsigned i;
+
+    if (!(worker->context->config.features & UCP_FEATURE_AM)) {
+        return UCS_OK;
+    }
+
+    for (i = 0; i < UCP_AM_BUF_MP_COUNT; ++i) {
+        buf_size = UCS_BIT(UCP_AM_BUF_MP_MIN_SHIFT + i);
+        status   = ucs_mpool_init(&worker->am.buf_mp[i], sizeof(ucp_worker_h),
+                                  sizeof(ucp_mem_desc_t) +
+                                  sizeof(ucp_recv_desc_t) + buf_size,
+                                  sizeof(ucp_mem_desc_t) +
+                                  sizeof(ucp_recv_desc_t),
+                                  UCS_SYS_CACHE_LINE_SIZE,
+                                  ucs_max(UCS_MBYTE / buf_size, 4), UINT_MAX,
+                                  &ucp_am_buf_mpool_ops, "ucp_am_long_bufs");
+        if (status != UCS_OK) {
+            goto err_cleanup_mpools;
+        }
+
+        *(ucp_worker_h*)ucs_mpool_priv(&worker->am.buf_mp[i]) = worker;
+    }
+
+    kh_init_inplace(ucp_am_unfinished_hash, &worker->am.unfinished);
+    return UCS_OK;
+
+err_cleanup_mpools:
+    while (i-- > 0) {
+        ucs_mpool_cleanup(&worker->am.buf_mp[i], 1);
+    }
+    return status;
+}
+
+void ucp_am_worker_cleanup(ucp_worker_h worker)
+{
+    ucp_am_unfinished_t unfinished;
+    unsigned i;
+
+    if (!(worker->context->config.features & UCP_FEATURE_AM)) {
+        return;
+    }
+
+    kh_foreach_value(&worker->am.unfinished, unfinished, {
+        ucp_am_buf_put(unfinished.all_data);
+    })
+    kh_destroy_inplace(ucp_am_unfinished_hash, &worker->am.unfinished);
+
+    for (i = 0; i < UCP_AM_BUF_MP_COUNT; ++i) {
+        ucs_mpool_cleanup(&worker->am.buf_mp[i], 1);
     }
 }
 
 void ucp_am_ep_cleanup(ucp_ep_h ep)
 {
-    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
+    ucp_worker_h worker = ep->worker;
+    ucp_am_unfinished_t *unfinished;
+    khiter_t iter;
+
+    if (!(worker->context->config.features & UCP_FEATURE_AM) ||
+        (kh_size(&worker->am.unfinished) == 0)) {
+        return;
+    }
 
-    if (ep->worker->context->config.features & UCP_FEATURE_AM) {
-        if (ucs_unlikely(!ucs_list_is_empty(&ep_ext->am.started_ams))) {
-            ucs_warn("worker : %p not all UCP active messages have been" 
-                     "run to completion", ep->worker);
+    for (iter = kh_begin(&worker->am.unfinished);
+         iter != kh_end(&worker->am.unfinished); ++iter) {
+        if (!kh_exist(&worker->am.unfinished, iter)) {
+            continue;
+        }
+
+        unfinished = &kh_value(&worker->am.unfinished, iter);
+        if (unfinished->ep == ep) {
+            ucs_warn("ep %p: dropping active message which has not been run"
+                     " to completion", ep);
+            ucp_am_buf_put(unfinished->all_data);
+            kh_del(ucp_am_unfinished_hash, &worker->am.unfinished, iter);
         }
     }
 }
 
+static void ucp_am_rndv_recv_init(ucp_request_t *req, ucp_worker_h worker,
+                                  void *buffer, size_t count,
+                                  ucp_datatype_t datatype, uint32_t flags,
+                                  ucp_tag_recv_callback_t cb)
+{
+    req->status        = UCS_OK;
+    req->flags         = UCP_REQUEST_FLAG_RECV | flags;
+    req->recv.worker   = worker;
+    req->recv.buffer   = buffer;
+    req->recv.datatype = datatype;
+
+    ucp_dt_recv_state_init(&req->recv.state, buffer, datatype, count);
+
+    req->recv.length   = ucp_dt_length(datatype, count, buffer,
+                                       &req->recv.state);
+    req->recv.mem_type = ucp_memory_type_detect(worker->context, buffer,
+                                                req->recv.length);
+    req->recv.tag.cb   = cb;
+}
+
+/* Let the sender complete a rendezvous message without fetching its data */
+static void ucp_am_rndv_drop(ucp_worker_h worker,
+                             const ucp_rndv_rts_hdr_t *rndv_rts_hdr)
+{
+    ucp_request_t *req;
+
+    req = ucp_request_get(worker);
+    if (req == NULL) {
+        ucs_error("failed to allocate request to drop active message");
+        return;
+    }
+
+    /* an empty receive is truncated, so only an ack is sent back */
+    ucp_am_rndv_recv_init(req, worker, NULL, 0, ucp_dt_make_contig(1),
+                          UCP_REQUEST_FLAG_RELEASED, NULL);
+    ucp_rndv_matched(worker, req, rndv_rts_hdr);
+}
+
+/* The descriptor is owned by the active message handler while the user
+ * callback runs on it, and is released when the callback returns */
+static void ucp_am_rndv_desc_done(ucp_recv_desc_t *rdesc)
+{
+    rdesc->flags |= UCP_RECV_DESC_FLAG_AM_RNDV_DONE;
+    if (!(rdesc->flags & UCP_RECV_DESC_FLAG_AM_CB)) {
+        ucp_recv_desc_release(rdesc);
+    }
+}
+
 UCS_PROFILE_FUNC_VOID(ucp_am_data_release,
                       (worker, data),
                       ucp_worker_h worker, void *data)
@@ -49,8 +206,15 @@ UCS_PROFILE_FUNC_VOID(ucp_am_data_release,
     ucp_recv_desc_t *rdesc = (ucp_recv_desc_t *)data - 1;
     ucp_recv_desc_t *desc;
 
-    if (rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC) {
-        ucs_free(rdesc);
+    if (rdesc->flags & UCP_RECV_DESC_FLAG_RNDV) {
+        UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+        ucp_am_rndv_drop(worker, data);
+        ucp_am_rndv_desc_done(rdesc);
+        UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+        return;
+    } else if (rdesc->flags & (UCP_RECV_DESC_FLAG_MALLOC |
+                               UCP_RECV_DESC_FLAG_AM_MPOOL)) {
+        ucp_am_buf_put(rdesc);
         return;
     } else if (rdesc->flags & UCP_RECV_DESC_FLAG_AM_HDR) {
         desc = rdesc;
@@ -353,6 +517,52 @@ static ucs_status_t ucp_am_zcopy_multi_reply(uct_pending_req_t *self)
                                  ucp_proto_am_zcopy_req_complete, 0);
 }
 
+static size_t ucp_am_rndv_rts_pack(void *dest, void *arg)
+{
+    ucp_request_t *sreq              = arg;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = dest;
+    ucp_am_hdr_t *hdr                = dest;
+
+    UCS_STATIC_ASSERT(sizeof(*hdr) == sizeof(rndv_rts_hdr->super));
+
+    /* the length of the message is carried by the rendezvous header */
+    hdr->am_hdr.am_id  = sreq->send.am.am_id;
+    hdr->am_hdr.length = 0;
+    hdr->am_hdr.flags  = sreq->send.am.flags;
+
+    return ucp_rndv_rts_pack(sreq, rndv_rts_hdr);
+}
+
+static ucs_status_t ucp_am_progress_rndv_rts(uct_pending_req_t *self)
+{
+    ucp_request_t *sreq = ucs_container_of(self, ucp_request_t, send.uct);
+    size_t packed_rkey_size;
+
+    /* the request is completed when the receiver acknowledges the data */
+    packed_rkey_size = ucp_ep_config(sreq->send.ep)->tag.rndv.rkey_size;
+    return ucp_do_am_single(self, UCP_AM_ID_AM_RNDV_RTS, ucp_am_rndv_rts_pack,
+                            sizeof(ucp_rndv_rts_hdr_t) + packed_rkey_size);
+}
+
+static ucs_status_t ucp_am_send_start_rndv(ucp_request_t *sreq)
+{
+    ucs_status_t status;
+
+    ucp_trace_req(sreq, "start am rndv to %s buffer %p length %zu",
+                  ucp_ep_peer_name(sreq->send.ep), sreq->send.buffer,
+                  sreq->send.length);
+    UCS_PROFILE_REQUEST_EVENT(sreq, "start_am_rndv", sreq->send.length);
+
+    status = ucp_rndv_send_buffer_reg(sreq);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ucs_assert(sreq->send.lane == ucp_ep_get_am_lane(sreq->send.ep));
+    sreq->send.uct.func = ucp_am_progress_rndv_rts;
+    return UCS_OK;
+}
+
 static void ucp_am_send_req_init(ucp_request_t *req, ucp_ep_h ep,
                                  const void *buffer, uintptr_t datatype,
                                  size_t count, uint16_t flags, 
@@ -379,18 +589,26 @@ ucp_am_send_req(ucp_request_t *req, size_t count,
                 ucp_send_callback_t cb, const ucp_proto_t *proto)
 {
     
+    size_t rndv_thresh  = ucp_ep_config(req->send.ep)->am_u.rndv_thresh;
     size_t zcopy_thresh = ucp_proto_get_zcopy_threshold(req, msg_config,
-                                                        count, SIZE_MAX);
+                                                        count, rndv_thresh);
     size_t max_short;
     ucs_status_t status;
     
     max_short = ucp_am_get_short_max(req, msg_config);
     
     status = ucp_request_send_start(req, max_short, 
-                                    zcopy_thresh, SIZE_MAX,
+                                    zcopy_thresh, rndv_thresh,
                                     count, msg_config,
                                     proto);
-    if (status != UCS_OK) {
+    if (ucs_unlikely(status == UCS_ERR_NO_PROGRESS)) {
+        status = ucp_am_send_start_rndv(req);
+        if (status != UCS_OK) {
+            return UCS_STATUS_PTR(status);
+        }
+
+        UCP_EP_STAT_AM_OP(req->send.ep, RNDV);
+    } else if (status != UCS_OK) {
        return UCS_STATUS_PTR(status);
     }
 
@@ -471,6 +689,143 @@ out:
     return ret;
 }
 
+static UCS_F_ALWAYS_INLINE size_t
+ucp_am_batch_item_size(const ucp_am_batch_item_t *item)
+{
+    return sizeof(ucp_am_hdr_t) + item->length;
+}
+
+static size_t ucp_am_batch_pack(void *dest, void *arg)
+{
+    ucp_am_batch_hdr_t *batch_hdr = dest;
+    ucp_request_t *req            = arg;
+    size_t max_bcopy              = ucp_ep_get_max_bcopy(req->send.ep,
+                                                         req->send.lane);
+    size_t offset                 = sizeof(*batch_hdr);
+    const ucp_am_batch_item_t *item;
+    ucp_am_hdr_t *hdr;
+    size_t length;
+
+    batch_hdr->ep_ptr = (req->send.am_batch.flags & UCP_AM_SEND_REPLY) ?
+                        ucp_request_get_dest_ep_ptr(req) : 0;
+
+    /* pack the messages which fit, without padding after the last one */
+    do {
+        item               = &req->send.am_batch.items[req->send.am_batch.index];
+        hdr                = UCS_PTR_BYTE_OFFSET(dest, offset);
+        hdr->am_hdr.am_id  = item->id;
+        hdr->am_hdr.length = item->length;
+        hdr->am_hdr.flags  = 0;
+        memcpy(hdr + 1, item->buffer, item->length);
+
+        length  = offset + ucp_am_batch_item_size(item);
+        offset  = ucs_align_up_pow2(length, sizeof(ucp_am_hdr_t));
+        ++req->send.am_batch.index;
+    } while ((req->send.am_batch.index < req->send.am_batch.count) &&
+             ((offset + ucp_am_batch_item_size(item + 1)) <= max_bcopy));
+
+    return length;
+}
+
+static ucs_status_t ucp_am_batch_progress(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_ep_t *ep       = req->send.ep;
+    size_t index       = req->send.am_batch.index;
+    ssize_t packed_len;
+
+    req->send.lane = ucp_ep_get_am_lane(ep);
+    packed_len     = uct_ep_am_bcopy(ep->uct_eps[req->send.lane],
+                                     UCP_AM_ID_AM_BATCH, ucp_am_batch_pack,
+                                     req, 0);
+    if (ucs_unlikely(packed_len < 0)) {
+        req->send.am_batch.index = index;
+        return (ucs_status_t)packed_len;
+    }
+
+    if (req->send.am_batch.index < req->send.am_batch.count) {
+        return UCS_INPROGRESS;
+    }
+
+    ucp_request_complete_send(req, UCS_OK);
+    return UCS_OK;
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_send_batch,
+                 (ep, items, count, cb, flags),
+                 ucp_ep_h ep, const ucp_am_batch_item_t *items,
+                 size_t count, ucp_send_callback_t cb, unsigned flags)
+{
+    size_t max_item_size;
+    ucs_status_t status;
+    ucs_status_ptr_t ret;
+    ucp_request_t *req;
+    size_t i;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(ep->worker->context, UCP_FEATURE_AM,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+
+    if (ucs_unlikely((flags != 0) && !(flags & UCP_AM_SEND_REPLY))) {
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    if (ucs_unlikely(count == 0)) {
+        return UCS_STATUS_PTR(UCS_OK);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    max_item_size = ucp_ep_get_max_bcopy(ep, ep->am_lane) -
+                    sizeof(ucp_am_batch_hdr_t);
+    for (i = 0; i < count; ++i) {
+        if (ucs_unlikely(ucp_am_batch_item_size(&items[i]) > max_item_size)) {
+            ucs_error("ep %p: active message %zu of the batch is too long "
+                      "(%zu bytes, max: %zu)", ep, i, items[i].length,
+                      max_item_size - sizeof(ucp_am_hdr_t));
+            ret = UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+            goto out;
+        }
+    }
+
+    if (flags & UCP_AM_SEND_REPLY) {
+        status = ucp_ep_resolve_dest_ep_ptr(ep, ep->am_lane);
+        if (ucs_unlikely(status != UCS_OK)) {
+            ret = UCS_STATUS_PTR(status);
+            goto out;
+        }
+    }
+
+    req = ucp_request_get(ep->worker);
+    if (ucs_unlikely(req == NULL)) {
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    req->flags                = 0;
+    req->send.ep              = ep;
+    req->send.mem_type        = UCS_MEMORY_TYPE_HOST;
+    req->send.lane            = ep->am_lane;
+    req->send.am_batch.items  = items;
+    req->send.am_batch.count  = count;
+    req->send.am_batch.index  = 0;
+    req->send.am_batch.flags  = flags;
+    req->send.uct.func        = ucp_am_batch_progress;
+
+    status = ucp_request_send(req, 0);
+    if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
+        ucp_request_put(req);
+        ret = UCS_STATUS_PTR(status);
+        goto out;
+    }
+
+    ucp_request_set_callback(req, send.cb, cb);
+    ret = req + 1;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+    return ret;
+}
+
 static ucs_status_t
 ucp_am_handler_common(ucp_worker_h worker, void *hdr_end,
                       size_t hdr_size, size_t args_length,
@@ -556,50 +911,37 @@ ucp_am_handler(void *am_arg, void *am_data, size_t am_length,
                                  am_flags);    
 }
 
-static ucp_am_unfinished_t *
-ucp_am_find_unfinished(ucp_worker_h worker, ucp_ep_h ep, 
-                       ucp_ep_ext_proto_t *ep_ext, 
-                       ucp_am_long_hdr_t *hdr, size_t am_length)
-{
-    ucp_am_unfinished_t *unfinished;
-    /* TODO make this hash table for faster lookup */
-    ucs_list_for_each(unfinished, &ep_ext->am.started_ams, list) {
-        if (unfinished->msg_id == hdr->msg_id) {
-            return unfinished;
-        }
-    }
-    
-    return NULL;
-}
-
 static ucs_status_t
-ucp_am_handle_unfinished(ucp_worker_h worker,
-                         ucp_am_unfinished_t *unfinished, 
-                         ucp_am_long_hdr_t *long_hdr, 
-                         size_t am_length, ucp_ep_h reply_ep) 
+ucp_am_batch_handler(void *am_arg, void *am_data, size_t am_length,
+                     unsigned am_flags)
 {
+    ucp_worker_h worker           = (ucp_worker_h)am_arg;
+    ucp_am_batch_hdr_t *batch_hdr = (ucp_am_batch_hdr_t*)am_data;
+    size_t offset                 = sizeof(*batch_hdr);
+    ucp_ep_h reply_ep;
+    ucp_am_hdr_t *hdr;
     uint16_t am_id;
-    ucs_status_t status;
 
-    memcpy(UCS_PTR_BYTE_OFFSET(unfinished->all_data + 1, long_hdr->offset),
-           long_hdr + 1, am_length - sizeof(*long_hdr));
-    unfinished->left -= am_length - sizeof(*long_hdr);
-    if (unfinished->left == 0) {
-        am_id = long_hdr->am_id;
-        status = worker->am_cbs[am_id].cb(worker->am_cbs[am_id].context,
-                                          unfinished->all_data + 1,
-                                          long_hdr->total_size,
-                                          reply_ep,
-                                          UCP_CB_PARAM_FLAG_DATA);
-
-        if (status != UCS_INPROGRESS) {
-            ucs_free(unfinished->all_data);
+    reply_ep = (batch_hdr->ep_ptr == 0) ? NULL :
+               ucp_worker_get_ep_by_ptr(worker, batch_hdr->ep_ptr);
+
+    /* the data of a batched message is valid only during its callback */
+    while (offset < am_length) {
+        hdr   = UCS_PTR_BYTE_OFFSET(am_data, offset);
+        am_id = hdr->am_hdr.am_id;
+        if (ucs_likely((am_id < worker->am_cb_array_len) &&
+                       (worker->am_cbs[am_id].cb != NULL))) {
+            worker->am_cbs[am_id].cb(worker->am_cbs[am_id].context, hdr + 1,
+                                     hdr->am_hdr.length, reply_ep, 0);
+        } else {
+            ucs_warn("UCP Active Message was received with id : %u, but there"
+                     "is no registered callback for that id", am_id);
         }
 
-        ucs_list_del(&unfinished->list);
-        ucs_free(unfinished);
+        offset += ucs_align_up_pow2(sizeof(*hdr) + hdr->am_hdr.length,
+                                    sizeof(*hdr));
     }
-    
+
     return UCS_OK;
 }
 
@@ -609,12 +951,13 @@ ucp_am_long_handler_common(void *am_arg, void *am_data, size_t am_length,
 {
     ucp_worker_h worker         = (ucp_worker_h)am_arg;
     ucp_am_long_hdr_t *long_hdr = (ucp_am_long_hdr_t *)am_data;
-    ucp_ep_h ep                 = ucp_worker_get_ep_by_ptr(worker, 
-                                                           long_hdr->ep);
-    ucp_ep_ext_proto_t *ep_ext  = ucp_ep_ext_proto(ep);
-    ucp_recv_desc_t *all_data;
-    size_t left;
+    size_t length               = am_length - sizeof(*long_hdr);
+    ucp_am_unfinished_key_t key;
     ucp_am_unfinished_t *unfinished;
+    ucp_recv_desc_t *all_data;
+    ucs_status_t status;
+    khiter_t iter;
+    int ret;
 
     if (ucs_unlikely((long_hdr->am_id >= worker->am_cb_array_len) ||
                      (worker->am_cbs[long_hdr->am_id].cb == NULL))) {
@@ -623,49 +966,43 @@ ucp_am_long_handler_common(void *am_arg, void *am_data, size_t am_length,
         return UCS_OK;
     }
 
-    /* if there are multiple messages,
-     * we first check to see if any of the other messages
-     * have arrived. If any messages have arrived,
-     * we copy ourselves into the buffer and leave
-     */
-    unfinished = ucp_am_find_unfinished(worker, ep, ep_ext, long_hdr, am_length);
-    
-    if (unfinished) {
-        return ucp_am_handle_unfinished(worker, unfinished, 
-                                        long_hdr, am_length,
-                                        reply_ep);
-    }
-    
-    /* If I am first, I make the buffer for everyone to go into,
-     * copy myself in, and put myself on the list so people can find me
-     */
-    all_data = ucs_malloc(long_hdr->total_size + sizeof(ucp_recv_desc_t),
-                          "ucp recv desc for long AM");
-    if (ucs_unlikely(all_data == NULL)) {
-        return UCS_ERR_NO_MEMORY;
-    }
+    /* The first arriving part allocates the buffer for the whole message,
+     * and the others find it by the endpoint and message id */
+    key.ep     = long_hdr->ep;
+    key.msg_id = long_hdr->msg_id;
+    iter       = kh_put(ucp_am_unfinished_hash, &worker->am.unfinished, key,
+                        &ret);
+    unfinished = &kh_value(&worker->am.unfinished, iter);
+    if (ret != 0) {
+        /* initialize a previously empty hash entry */
+        all_data = ucp_am_buf_get(worker, long_hdr->total_size,
+                                  "ucp recv desc for long AM");
+        if (ucs_unlikely(all_data == NULL)) {
+            kh_del(ucp_am_unfinished_hash, &worker->am.unfinished, iter);
+            return UCS_ERR_NO_MEMORY;
+        }
 
-    all_data->flags = UCP_RECV_DESC_FLAG_MALLOC;
+        unfinished->all_data = all_data;
+        unfinished->ep       = ucp_worker_get_ep_by_ptr(worker, long_hdr->ep);
+        unfinished->left     = long_hdr->total_size;
+    }
 
-    left = long_hdr->total_size - (am_length -
-                                   sizeof(ucp_am_long_hdr_t));
-    
-    memcpy(UCS_PTR_BYTE_OFFSET(all_data + 1, long_hdr->offset),
-           long_hdr + 1, am_length - sizeof(ucp_am_long_hdr_t));
-    
-    /* Can't use a desc for this because of the buffer */
-    unfinished           = ucs_malloc(sizeof(ucp_am_unfinished_t),
-                                         "unfinished UCP AM");
-    if (ucs_unlikely(unfinished == NULL)) {
-        ucs_free(all_data);
-        return UCS_ERR_NO_MEMORY;
+    memcpy(UCS_PTR_BYTE_OFFSET(unfinished->all_data + 1, long_hdr->offset),
+           long_hdr + 1, length);
+    unfinished->left -= length;
+    if (unfinished->left > 0) {
+        return UCS_OK;
     }
 
-    unfinished->all_data = all_data;
-    unfinished->left     = left;
-    unfinished->msg_id   = long_hdr->msg_id;
+    all_data = unfinished->all_data;
+    kh_del(ucp_am_unfinished_hash, &worker->am.unfinished, iter);
 
-    ucs_list_add_head(&ep_ext->am.started_ams, &unfinished->list);
+    status = worker->am_cbs[long_hdr->am_id].cb(
+                     worker->am_cbs[long_hdr->am_id].context, all_data + 1,
+                     long_hdr->total_size, reply_ep, UCP_CB_PARAM_FLAG_DATA);
+    if (status != UCS_INPROGRESS) {
+        ucp_am_buf_put(all_data);
+    }
 
     return UCS_OK;
 }
@@ -691,6 +1028,183 @@ ucp_am_long_handler(void *am_arg, void *am_data, size_t am_length,
                                       NULL); 
 }
 
+static void ucp_am_rndv_recv_completed(void *request, ucs_status_t status,
+                                       ucp_tag_recv_info_t *info)
+{
+    ucp_request_t *req = (ucp_request_t*)request - 1;
+
+    req->recv.tag.am.cb(request, status, info->length);
+}
+
+/* The handler does not accept rendezvous descriptors, so the message is
+ * fetched to an allocated buffer and passed to it when it arrives */
+static void ucp_am_rndv_recv_whole_completed(void *request, ucs_status_t status,
+                                             ucp_tag_recv_info_t *info)
+{
+    ucp_request_t *req     = (ucp_request_t*)request - 1;
+    ucp_worker_h worker    = req->recv.worker;
+    uint16_t am_id         = req->recv.tag.am.am_id;
+    ucp_recv_desc_t *rdesc = (ucp_recv_desc_t*)req->recv.buffer - 1;
+
+    if (ucs_likely(status == UCS_OK)) {
+        status = worker->am_cbs[am_id].cb(worker->am_cbs[am_id].context,
+                                          rdesc + 1, info->length,
+                                          req->recv.tag.am.reply_ep,
+                                          UCP_CB_PARAM_FLAG_DATA);
+        if (status == UCS_INPROGRESS) {
+            return;
+        }
+    } else {
+        ucs_error("worker %p failed to receive active message on callback"
+                  " %u: %s", worker, am_id, ucs_status_string(status));
+    }
+
+    ucp_am_buf_put(rdesc);
+}
+
+static ucs_status_t
+ucp_am_rndv_recv_whole(ucp_worker_h worker,
+                       const ucp_rndv_rts_hdr_t *rndv_rts_hdr,
+                       ucp_ep_h reply_ep, uint16_t am_id)
+{
+    ucp_recv_desc_t *all_data;
+    ucp_request_t *req;
+
+    all_data = ucp_am_buf_get(worker, rndv_rts_hdr->size,
+                              "ucp recv desc for rndv AM");
+    if (ucs_unlikely(all_data == NULL)) {
+        ucp_am_rndv_drop(worker, rndv_rts_hdr);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    req = ucp_request_get(worker);
+    if (ucs_unlikely(req == NULL)) {
+        ucp_am_buf_put(all_data);
+        ucp_am_rndv_drop(worker, rndv_rts_hdr);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    ucp_am_rndv_recv_init(req, worker, all_data + 1, rndv_rts_hdr->size,
+                          ucp_dt_make_contig(1),
+                          UCP_REQUEST_FLAG_CALLBACK | UCP_REQUEST_FLAG_RELEASED,
+                          ucp_am_rndv_recv_whole_completed);
+    req->recv.tag.am.reply_ep = reply_ep;
+    req->recv.tag.am.am_id    = am_id;
+
+    ucp_rndv_matched(worker, req, rndv_rts_hdr);
+    return UCS_OK;
+}
+
+static ucs_status_t
+ucp_am_rndv_rts_handler(void *am_arg, void *am_data, size_t am_length,
+                        unsigned am_flags)
+{
+    ucp_worker_h worker              = (ucp_worker_h)am_arg;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = (ucp_rndv_rts_hdr_t*)am_data;
+    ucp_am_hdr_t *hdr                = (ucp_am_hdr_t*)am_data;
+    uint16_t am_id                   = hdr->am_hdr.am_id;
+    ucp_ep_h reply_ep                = NULL;
+    ucp_recv_desc_t *desc            = NULL;
+    ucs_status_t status;
+
+    if (ucs_unlikely((am_id >= worker->am_cb_array_len) ||
+                     (worker->am_cbs[am_id].cb == NULL))) {
+        ucs_warn("UCP Active Message was received with id : %u, but there" 
+                 "is no registered callback for that id", am_id);
+        ucp_am_rndv_drop(worker, rndv_rts_hdr);
+        return UCS_OK;
+    }
+
+    if (hdr->am_hdr.flags & UCP_AM_SEND_REPLY) {
+        reply_ep = ucp_worker_get_ep_by_ptr(worker, rndv_rts_hdr->sreq.ep_ptr);
+    }
+
+    if (!(worker->am_cbs[am_id].flags & UCP_AM_FLAG_RNDV)) {
+        return ucp_am_rndv_recv_whole(worker, rndv_rts_hdr, reply_ep, am_id);
+    }
+
+    status = ucp_recv_desc_init(worker, am_data, am_length, 0, am_flags, 0,
+                                UCP_RECV_DESC_FLAG_RNDV |
+                                UCP_RECV_DESC_FLAG_AM_CB, 0, &desc);
+    if (ucs_unlikely(UCS_STATUS_IS_ERR(status))) {
+        ucs_error("worker %p  could not allocate descriptor for active message"
+                  "on callback : %u", worker, am_id);
+        ucp_am_rndv_drop(worker, rndv_rts_hdr);
+        return status;
+    }
+
+    status = worker->am_cbs[am_id].cb(worker->am_cbs[am_id].context,
+                                      desc + 1, rndv_rts_hdr->size, reply_ep,
+                                      UCP_CB_PARAM_FLAG_RNDV);
+    desc->flags &= ~UCP_RECV_DESC_FLAG_AM_CB;
+
+    if (!(desc->flags & UCP_RECV_DESC_FLAG_AM_RNDV_DONE)) {
+        if (status == UCS_INPROGRESS) {
+            /* the user keeps the descriptor */
+            return (am_flags & UCT_CB_PARAM_FLAG_DESC) ? UCS_INPROGRESS : UCS_OK;
+        }
+
+        ucp_am_rndv_drop(worker, (ucp_rndv_rts_hdr_t*)(desc + 1));
+    }
+
+    if (!(am_flags & UCT_CB_PARAM_FLAG_DESC)) {
+        ucp_recv_desc_release(desc);
+    }
+
+    return UCS_OK;
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_recv_data_nb,
+                 (worker, data_desc, buffer, count, datatype, cb),
+                 ucp_worker_h worker, void *data_desc, void *buffer,
+                 size_t count, ucp_datatype_t datatype,
+                 ucp_am_recv_data_callback_t cb)
+{
+    ucp_recv_desc_t *rdesc = (ucp_recv_desc_t*)data_desc - 1;
+    ucs_status_ptr_t ret;
+    ucs_status_t status;
+    ucp_request_t *req;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_AM,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+
+    if (ucs_unlikely(!(rdesc->flags & UCP_RECV_DESC_FLAG_RNDV) ||
+                     (rdesc->flags & UCP_RECV_DESC_FLAG_AM_RNDV_DONE))) {
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    req = ucp_request_get(worker);
+    if (ucs_unlikely(req == NULL)) {
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    ucp_am_rndv_recv_init(req, worker, buffer, count, datatype, 0,
+                          ucp_am_rndv_recv_completed);
+    ucp_rndv_matched(worker, req, data_desc);
+    ucp_am_rndv_desc_done(rdesc);
+
+    /* If it is completed immediately, release the request and return the
+     * status. Otherwise, return the request. */
+    if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
+        status = req->status;
+        ucs_trace_req("releasing receive request %p, returning status %s", req,
+                      ucs_status_string(status));
+        ucp_request_put(req);
+        ret = UCS_STATUS_PTR(status);
+        goto out;
+    }
+
+    ucp_request_set_callback(req, recv.tag.am.cb, cb);
+    ret = req + 1;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return ret;
+}
+
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_SINGLE,
               ucp_am_handler, NULL, 0);
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_MULTI,
@@ -699,6 +1213,10 @@ UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_SINGLE_REPLY,
               ucp_am_handler_reply, NULL, 0);
 UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_MULTI_REPLY,
               ucp_am_long_handler_reply, NULL, 0);
+UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_AM_RNDV_RTS,
+              ucp_am_rndv_rts_handler, NULL, 0);
+UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_AM_BATCH,
+              ucp_am_batch_handler, NULL, 0);
 
 const ucp_proto_t ucp_am_proto = {
     .contig_short           = ucp_am_contig_short,
@@ -4,10 +4,21 @@
  * See file LICENSE for terms.
  */
 
+#ifndef UCP_AM_H_
+#define UCP_AM_H_
+
 #include "ucp_ep.h"
 
+#include <ucs/datastruct/khash.h>
+#include <ucs/datastruct/mpool.h>
+
 #define UCP_AM_CB_BLOCK_SIZE 16
 
+/* Long AM reassembly buffers come from registered memory pools of power-of-2
+ * size classes, from 4kB to 1MB; larger messages use malloc */
+#define UCP_AM_BUF_MP_MIN_SHIFT 12
+#define UCP_AM_BUF_MP_COUNT     9
+
 
 typedef union {
     struct {
@@ -31,6 +42,12 @@ typedef struct {
     uintptr_t    ep_ptr;
 } UCS_S_PACKED ucp_am_reply_hdr_t;
 
+typedef struct {
+    uintptr_t    ep_ptr;          /* ep for replies, or 0. Followed by the
+                                     messages, each one with @ref ucp_am_hdr_t
+                                     aligned to the size of that header */
+} UCS_S_PACKED ucp_am_batch_hdr_t;
+
 typedef struct {
     size_t            total_size; /* length of buffer needed for all data */
     uint64_t          msg_id;     /* method to match parts of the same AM */
@@ -42,12 +59,42 @@ typedef struct {
 } UCS_S_PACKED ucp_am_long_hdr_t;
 
 typedef struct {
-    ucs_list_link_t   list;       /* entry into list of unfinished AM's */
     ucp_recv_desc_t  *all_data;   /* buffer for all parts of the AM */
-    uint64_t          msg_id;     /* way to match up all parts of AM */
-    size_t            left;
+    ucp_ep_h          ep;         /* endpoint the AM is arriving on */
+    size_t            left;       /* bytes still expected */
 } ucp_am_unfinished_t;
 
-void ucp_am_ep_init(ucp_ep_h ep);
+
+typedef struct {
+    uintptr_t         ep;         /* endpoint the AM is arriving on, as sent
+                                     by the peer */
+    uint64_t          msg_id;     /* message id, unique for the sender */
+} ucp_am_unfinished_key_t;
+
+
+#define ucp_am_unfinished_key_hash(_key) \
+    kh_int64_hash_func((uint64_t)(_key).ep ^ (_key).msg_id)
+
+#define ucp_am_unfinished_key_equal(_key1, _key2) \
+    (((_key1).ep == (_key2).ep) && ((_key1).msg_id == (_key2).msg_id))
+
+
+/* Hash of long AMs being reassembled, by endpoint and message id, since
+ * message ids of different senders may be the same */
+KHASH_INIT(ucp_am_unfinished_hash, ucp_am_unfinished_key_t, ucp_am_unfinished_t,
+           1, ucp_am_unfinished_key_hash, ucp_am_unfinished_key_equal);
+
+
+typedef struct {
+    khash_t(ucp_am_unfinished_hash) unfinished; /* Long AMs being reassembled */
+    ucs_mpool_t       buf_mp[UCP_AM_BUF_MP_COUNT]; /* Reassembly buffers */
+} ucp_am_worker_t;
+
+
+ucs_status_t ucp_am_worker_init(ucp_worker_h worker);
+
+void ucp_am_worker_cleanup(ucp_worker_h worker);
 
 void ucp_am_ep_cleanup(ucp_ep_h ep);
+
+#endif
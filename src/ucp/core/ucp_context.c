@@ -150,6 +150,25 @@ static ucs_config_field_t ucp_config_table[] = {
    "Maximal number of devices on which a rendezvous operation may be executed in parallel",
    ucs_offsetof(ucp_config_t, ctx.max_rndv_lanes), UCS_CONFIG_TYPE_UINT},
 
+  {"RNDV_RKEY_CACHE_SIZE", "0",
+   "Maximal number of remote keys received in rendezvous requests which are kept\n"
+   "unpacked on every endpoint, so that repeated transfers from the same remote\n"
+   "buffer would not unpack the remote key again. A cached key is dropped when the\n"
+   "peer sends a different key for an overlapping memory region, or when the\n"
+   "endpoint is closed. The peer is not notified when the key is cached, so a\n"
+   "transport which attaches remote memory (e.g shared memory) may keep the peer's\n"
+   "buffer mapped after the peer unmaps it, until the key is dropped.\n"
+   "0 - disable.",
+   ucs_offsetof(ucp_config_t, ctx.rndv_rkey_cache_size), UCS_CONFIG_TYPE_UINT},
+
+  {"LANES_CACHE_SIZE", "64",
+   "Maximal number of transport selection results which are kept on every worker.\n"
+   "Connecting to a peer whose address has the same set of transports, devices\n"
+   "and capabilities as a peer we already connected to reuses the selected lanes\n"
+   "instead of scoring all resources again. When the cache is full, the least\n"
+   "recently used result is replaced. 0 - disable.",
+   ucs_offsetof(ucp_config_t, ctx.lanes_cache_size), UCS_CONFIG_TYPE_UINT},
+
   {"RNDV_SCHEME", "auto",
    "Communication scheme in RNDV protocol.\n"
    " get_zcopy - use get_zcopy scheme in RNDV protocol.\n"
@@ -161,6 +180,15 @@ static ucs_config_field_t ucp_config_table[] = {
    "Threshold for switching from buffer copy to zero copy protocol",
    ucs_offsetof(ucp_config_t, ctx.zcopy_thresh), UCS_CONFIG_TYPE_MEMUNITS},
 
+  {"THRESH_TUNE", "n",
+   "Adjust the zero copy and rendezvous thresholds of tag send operations at\n"
+   "runtime, according to measured completion times of both protocols around\n"
+   "each threshold. Only synchronous sends are measured, since they complete at\n"
+   "the same point with all protocols. Only thresholds which are set to \"auto\"\n"
+   "are adjusted, within x4 of their initial value. The protocols are not changed\n"
+   "on the wire.",
+   ucs_offsetof(ucp_config_t, ctx.thresh_tune), UCS_CONFIG_TYPE_BOOL},
+
   {"BCOPY_BW", "5800mb",
    "Estimation of buffer copy bandwidth",
    ucs_offsetof(ucp_config_t, ctx.bcopy_bw), UCS_CONFIG_TYPE_MEMUNITS},
@@ -238,6 +266,44 @@ static ucs_config_field_t ucp_config_table[] = {
    "RNDV fragment size \n",
    ucs_offsetof(ucp_config_t, ctx.rndv_frag_size), UCS_CONFIG_TYPE_MEMUNITS},
 
+  {"RNDV_AM_WINDOW", "inf",
+   "How much data the sender is allowed to send ahead of the receiver when the\n"
+   "rendezvous protocol uses active messages. The receiver grants more credit\n"
+   "after half of the window has arrived, so the sender does not have to stop.",
+   ucs_offsetof(ucp_config_t, ctx.rndv_am_window), UCS_CONFIG_TYPE_MEMUNITS},
+
+  {"AM_RNDV_THRESH", "inf",
+   "Threshold for switching from eager to rendezvous protocol for active messages.\n"
+   "The default, inf, keeps active messages eager and does not select remote\n"
+   "memory access lanes for them.\n"
+   "auto - use the rendezvous threshold of the tag-matching protocols.",
+   ucs_offsetof(ucp_config_t, ctx.am_rndv_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
+  {"STREAM_RNDV_THRESH", "inf",
+   "Threshold for switching from eager to rendezvous protocol for stream sends.\n"
+   "The receiver fetches such data directly to a posted receive buffer which\n"
+   "has room for all of it. The default, inf, keeps stream sends eager.\n"
+   "auto - use the rendezvous threshold of the tag-matching protocols.",
+   ucs_offsetof(ucp_config_t, ctx.stream_rndv_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
+  {"STREAM_WINDOW", "inf",
+   "How much stream data a sender may have in flight or not consumed by the\n"
+   "receiver, per endpoint. Sends above it wait for the receiver to grant more\n"
+   "credit, which it does after the application consumed half of the window.\n"
+   "A single send larger than the window fails with UCS_ERR_EXCEEDS_LIMIT.\n"
+   "Endpoints between processes with different values fail to connect.",
+   ucs_offsetof(ucp_config_t, ctx.stream_window), UCS_CONFIG_TYPE_MEMUNITS},
+
+  {"RNDV_MAX_INFLIGHT", "inf",
+   "Maximal amount of rendezvous get data a worker keeps in flight. Receives\n"
+   "which match above this budget wait and are served in round-robin order by\n"
+   "fragments of RNDV_FRAG_SIZE, with priority to the ones closest to completion.",
+   ucs_offsetof(ucp_config_t, ctx.rndv_max_inflight), UCS_CONFIG_TYPE_MEMUNITS},
+
+  {"RNDV_MAX_INFLIGHT_OPS", "inf",
+   "Maximal number of rendezvous get fragments a worker keeps in flight.",
+   ucs_offsetof(ucp_config_t, ctx.rndv_max_inflight_ops), UCS_CONFIG_TYPE_ULUNITS},
+
   {"MEMTYPE_CACHE", "y",
    "Enable memory type(cuda) cache \n",
    ucs_offsetof(ucp_config_t, ctx.enable_memtype_cache), UCS_CONFIG_TYPE_BOOL},
@@ -248,12 +314,84 @@ static ucs_config_field_t ucp_config_table[] = {
    "another thread, or incoming active messages, but consumes more resources.",
    ucs_offsetof(ucp_config_t, ctx.flush_worker_eps), UCS_CONFIG_TYPE_BOOL},
 
+  {"MT_TRY_PROGRESS", "n",
+   "In a worker created with UCS_THREAD_MODE_MULTI, return from ucp_worker_progress()\n"
+   "without progressing if another thread currently holds the worker, instead\n"
+   "of waiting for it. Reduces the contention when several threads progress\n"
+   "the same worker concurrently.",
+   ucs_offsetof(ucp_config_t, ctx.mt_try_progress), UCS_CONFIG_TYPE_BOOL},
+
+  {"PROGRESS_BACKOFF", "n",
+   "Progress interfaces of network transports less often while they have no\n"
+   "events, doubling the number of skipped ucp_worker_progress_budget() calls\n"
+   "after every idle poll, up to 32. Reduces the polling overhead of idle\n"
+   "transports when many transports are enabled, at the cost of delaying their\n"
+   "first events after an idle period.",
+   ucs_offsetof(ucp_config_t, ctx.progress_backoff), UCS_CONFIG_TYPE_BOOL},
+
+  {"WAIT_SPIN_TIME", "0",
+   "Maximal time ucp_worker_wait() progresses the worker before blocking. The\n"
+   "actual spin time adapts to the average time between the recent events:\n"
+   "it is twice that time if the events are frequent enough, and a fraction of\n"
+   "the maximum otherwise. 0 - block immediately.",
+   ucs_offsetof(ucp_config_t, ctx.wait_spin_time), UCS_CONFIG_TYPE_TIME},
+
+  {"WAIT_SPIN_YIELD", "n",
+   "Yield the CPU between progress calls while spinning in ucp_worker_wait().",
+   ucs_offsetof(ucp_config_t, ctx.wait_spin_yield), UCS_CONFIG_TYPE_BOOL},
+
+  {"LAZY_IFACE_OPEN", "n",
+   "Open the interfaces which can not be connected to only when the first\n"
+   "endpoint uses them, instead of when the worker is created. Currently these\n"
+   "are only the client side interfaces of sockaddr transports; interfaces which\n"
+   "are a part of the worker address are always opened with the worker, so the\n"
+   "saving in worker creation time and memory is small.",
+   ucs_offsetof(ucp_config_t, ctx.lazy_iface_open), UCS_CONFIG_TYPE_BOOL},
+
+  {"PROGRESS_THREAD", "n",
+   "Progress every worker on a dedicated thread, so rendezvous and synchronous\n"
+   "sends make progress while the application does not call ucp_worker_progress().\n"
+   "The worker is then protected by a lock, as in UCS_THREAD_MODE_MULTI. Request\n"
+   "callbacks are still invoked from ucp_worker_progress() on the application\n"
+   "threads, while active message handlers are invoked on the progress thread.",
+   ucs_offsetof(ucp_config_t, ctx.progress_thread), UCS_CONFIG_TYPE_BOOL},
+
+  {"PROGRESS_THREAD_IDLE_TIME", "10us",
+   "How long the progress thread sleeps after finding no events. 0 - only yield\n"
+   "the CPU, which keeps a core busy while the worker is idle.",
+   ucs_offsetof(ucp_config_t, ctx.progress_thread_idle), UCS_CONFIG_TYPE_TIME},
+
+  {"TAG_AGGREGATE_THRESH", "0",
+   "Maximal size of a tagged eager message which is aggregated with other ones\n"
+   "to the same endpoint into a single active message, when they are queued\n"
+   "because the transport is out of send resources. 0 - disable aggregation.",
+   ucs_offsetof(ucp_config_t, ctx.tag_aggregate_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
   {"UNIFIED_MODE", "n",
    "Enable various optimizations intended for homogeneous environment.\n"
    "Enabling this mode implies that the local transport resources/devices\n"
    "of all entities which connect to each other are the same.",
    ucs_offsetof(ucp_config_t, ctx.unified_mode), UCS_CONFIG_TYPE_BOOL},
 
+  {"ADDRESS_COMPACT", "n",
+   "Use a compact worker address format, to reduce the amount of data exchanged\n"
+   "between processes at large scale. Device addresses which are the same for\n"
+   "several devices are packed once, and transport attributes are quantized.\n"
+   "The format is marked in the address, so processes with different values can\n"
+   "connect to each other.",
+   ucs_offsetof(ucp_config_t, ctx.address_compact), UCS_CONFIG_TYPE_BOOL},
+
+  {"GENERIC_DT_PACK_THREADS", "0",
+   "Number of helper threads per worker which pack large messages of generic\n"
+   "datatypes created with UCP_DT_GENERIC_FLAG_THREAD_SAFE, overlapping the\n"
+   "packing with the sending. 0 - pack on the calling thread.",
+   ucs_offsetof(ucp_config_t, ctx.generic_dt_pack_threads), UCS_CONFIG_TYPE_UINT},
+
+  {"GENERIC_DT_PACK_THRESH", "256k",
+   "Minimal message size to pack by the helper threads, see\n"
+   "GENERIC_DT_PACK_THREADS.",
+   ucs_offsetof(ucp_config_t, ctx.generic_dt_pack_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
   {"SOCKADDR_CM_ENABLE", "n" /* TODO: set try by default */,
    "Enable alternative wireup protocol for sockaddr connected endpoints.\n"
    "Enabling this mode changes underlying UCT mechanism for connection\n"
@@ -778,6 +916,7 @@ static void ucp_free_resources(ucp_context_t *context)
         ucs_memtype_cache_destroy(context->memtype_cache);
     }
 
+    ucs_free(context->tl_iface_attrs);
     ucs_free(context->tl_rscs);
     for (i = 0; i < context->num_mds; ++i) {
         uct_md_close(context->tl_mds[i].md);
@@ -1098,6 +1237,7 @@ static ucs_status_t ucp_fill_resources(ucp_context_h context,
     context->num_mds          = 0;
     context->tl_rscs          = NULL;
     context->num_tls          = 0;
+    context->tl_iface_attrs   = NULL;
     context->memtype_cache    = NULL;
     context->num_mem_type_detect_mds = 0;
 
@@ -1201,6 +1341,15 @@ static ucs_status_t ucp_fill_resources(ucp_context_h context,
      */
     context->tl_bitmap = config->ctx.unified_mode ? 0 : UCS_MASK(context->num_tls);
 
+    context->tl_iface_attrs_map = 0;
+    context->tl_iface_attrs     = ucs_calloc(context->num_tls,
+                                             sizeof(*context->tl_iface_attrs),
+                                             "ucp_tl_iface_attrs");
+    if (context->tl_iface_attrs == NULL) {
+        status = UCS_ERR_NO_MEMORY;
+        goto err_free_resources;
+    }
+
     /* Warn about devices and transports which were specified explicitly in the
      * configuration, but are not available
      */
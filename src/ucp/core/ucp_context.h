@@ -47,6 +47,8 @@ typedef struct ucp_context_config {
     double                                 rndv_perf_diff;
     /** Threshold for switching UCP to zero copy protocol */
     size_t                                 zcopy_thresh;
+    /** Adjust automatic tag send thresholds at runtime */
+    int                                    thresh_tune;
     /** Communication scheme in RNDV protocol */
     ucp_rndv_mode_t                        rndv_mode;
     /** Estimation of bcopy bandwidth */
@@ -55,6 +57,18 @@ typedef struct ucp_context_config {
     size_t                                 seg_size;
     /** RNDV pipeline fragment size */
     size_t                                 rndv_frag_size;
+    /** How much RNDV data can be sent by active messages without credit */
+    size_t                                 rndv_am_window;
+    /** Threshold for switching active messages to rendezvous protocol */
+    size_t                                 am_rndv_thresh;
+    /** Threshold for switching stream sends to rendezvous protocol */
+    size_t                                 stream_rndv_thresh;
+    /** How much stream data can be sent ahead of the receiver per endpoint */
+    size_t                                 stream_window;
+    /** Maximal amount of RNDV get data in flight per worker */
+    size_t                                 rndv_max_inflight;
+    /** Maximal number of RNDV get fragments in flight per worker */
+    size_t                                 rndv_max_inflight_ops;
     /** Threshold for using tag matching offload capabilities. Smaller buffers
      *  will not be posted to the transport. */
     size_t                                 tm_thresh;
@@ -75,6 +89,10 @@ typedef struct ucp_context_config {
     unsigned                               max_eager_lanes;
     /** Rendezvous-get multi-lane support */
     unsigned                               max_rndv_lanes;
+    /** Maximal number of cached rendezvous remote keys per endpoint */
+    unsigned                               rndv_rkey_cache_size;
+    /** Maximal number of cached lanes selection results per worker */
+    unsigned                               lanes_cache_size;
     /** Estimated number of endpoints */
     size_t                                 estimated_num_eps;
     /** Estimated number of processes per node */
@@ -83,8 +101,30 @@ typedef struct ucp_context_config {
     int                                    enable_memtype_cache;
     /** Enable flushing endpoints while flushing a worker */
     int                                    flush_worker_eps;
+    /** Do not wait for the worker lock in ucp_worker_progress() */
+    int                                    mt_try_progress;
+    /** Progress idle network interfaces less often */
+    int                                    progress_backoff;
+    /** Maximal time to spin in ucp_worker_wait() before blocking */
+    double                                 wait_spin_time;
+    /** Yield the CPU while spinning in ucp_worker_wait() */
+    int                                    wait_spin_yield;
+    /** Open interfaces which are not used by the worker address on demand */
+    int                                    lazy_iface_open;
+    /** Progress every worker on a dedicated thread */
+    int                                    progress_thread;
+    /** Sleep time of the progress thread after an idle poll */
+    double                                 progress_thread_idle;
+    /** Maximal size of tagged eager messages which are aggregated */
+    size_t                                 tag_aggregate_thresh;
     /** Enable optimizations suitable for homogeneous systems */
     int                                    unified_mode;
+    /** Use compact worker address format */
+    int                                    address_compact;
+    /** Number of helper threads which pack generic datatypes */
+    unsigned                               generic_dt_pack_threads;
+    /** Minimal message size to pack by the helper threads */
+    size_t                                 generic_dt_pack_thresh;
     /** Enable cm wireup-and-close protocol for client-server connections */
     ucs_ternary_value_t                    sockaddr_cm_enable;
 } ucp_context_config_t;
@@ -173,6 +213,11 @@ typedef struct ucp_context {
                                                * Not all resources may be used if unified
                                                * mode is enabled. */
     ucp_rsc_index_t               num_tls;    /* Number of resources in the array */
+    uct_iface_attr_t              *tl_iface_attrs; /* Interface attributes of the
+                                                    * resources, cached by the first
+                                                    * worker to open interfaces
+                                                    * lazily on next workers */
+    uint64_t                      tl_iface_attrs_map; /* Map of cached attributes */
 
     /* Mask of memory type communication resources */
     uint64_t                      mem_type_access_tls[UCS_MEMORY_TYPE_LAST];
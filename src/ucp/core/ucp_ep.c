@@ -19,6 +19,7 @@
 #include <ucp/wireup/wireup.h>
 #include <ucp/tag/eager.h>
 #include <ucp/tag/offload.h>
+#include <ucp/tag/rndv.h>
 #include <ucp/stream/stream.h>
 #include <ucp/core/ucp_listener.h>
 #include <ucs/datastruct/queue.h>
@@ -29,6 +30,21 @@
 #include <string.h>
 
 
+/* Sample every N-th tag send with a length near a tuned threshold */
+#define UCP_EP_TUNE_SAMPLE_INTERVAL  32
+/* Maximal log2 of sampling interval growth while a threshold does not move */
+#define UCP_EP_TUNE_MAX_BACKOFF      5
+/* Number of samples of every protocol on every side of a tuned threshold which
+ * are needed to adjust it */
+#define UCP_EP_TUNE_MIN_SAMPLES      16
+/* Maximal ratio between a tuned threshold and its initial value */
+#define UCP_EP_TUNE_MAX_RATIO        4
+/* The other protocol has to be faster by this factor to move the threshold */
+#define UCP_EP_TUNE_PERF_DIFF        0.9
+/* Sample which did not complete for that long is dropped */
+#define UCP_EP_TUNE_SAMPLE_TIMEOUT   1.0
+
+
 typedef struct {
     double reg_growth;
     double reg_overhead;
@@ -42,13 +58,21 @@ extern const ucp_proto_t ucp_am_proto;
 extern const ucp_proto_t ucp_am_reply_proto;
 
 #if ENABLE_STATS
+#define UCP_EP_STAT_RNDV_GET_BYTES_NAME(_, _lane) \
+    [UCP_EP_STAT_RNDV_GET_BYTES + _lane] = \
+        "rndv_get_bytes_lane" UCS_PP_MAKE_STRING(_lane),
+
 static ucs_stats_class_t ucp_ep_stats_class = {
     .name           = "ucp_ep",
     .num_counters   = UCP_EP_STAT_LAST,
     .counter_names  = {
         [UCP_EP_STAT_TAG_TX_EAGER]      = "tx_eager",
         [UCP_EP_STAT_TAG_TX_EAGER_SYNC] = "tx_eager_sync",
-        [UCP_EP_STAT_TAG_TX_RNDV]       = "tx_rndv"
+        [UCP_EP_STAT_TAG_TX_RNDV]       = "tx_rndv",
+        [UCP_EP_STAT_AM_TX_RNDV]        = "am_tx_rndv",
+        [UCP_EP_STAT_STREAM_TX_RNDV]    = "stream_tx_rndv",
+        UCS_PP_FOREACH(UCP_EP_STAT_RNDV_GET_BYTES_NAME, _,
+                       UCS_PP_SEQ(UCP_MAX_LANES))
     }
 };
 #endif
@@ -100,7 +124,7 @@ ucs_status_t ucp_ep_new(ucp_worker_h worker, const char *peer_name,
     ep->conn_sn                     = -1;
     ucp_ep_ext_gen(ep)->user_data   = NULL;
     ucp_ep_ext_gen(ep)->dest_ep_ptr = 0;
-    ucp_ep_ext_gen(ep)->err_cb      = NULL;
+    ucp_ep_ext_gen(ep)->proto       = NULL;
     UCS_STATIC_ASSERT(sizeof(ucp_ep_ext_gen(ep)->ep_match) >=
                       sizeof(ucp_ep_ext_gen(ep)->listener));
     UCS_STATIC_ASSERT(sizeof(ucp_ep_ext_gen(ep)->ep_match) >=
@@ -108,9 +132,6 @@ ucs_status_t ucp_ep_new(ucp_worker_h worker, const char *peer_name,
     memset(&ucp_ep_ext_gen(ep)->ep_match, 0,
            sizeof(ucp_ep_ext_gen(ep)->ep_match));
 
-    ucp_stream_ep_init(ep);
-    ucp_am_ep_init(ep);
-
     for (lane = 0; lane < UCP_MAX_LANES; ++lane) {
         ep->uct_eps[lane] = NULL;
     }
@@ -141,11 +162,45 @@ void ucp_ep_delete(ucp_ep_h ep)
 {
     ucs_callbackq_remove_if(&ep->worker->uct->progress_q,
                             ucp_wireup_msg_ack_cb_pred, ep);
+    if (ucp_ep_ext_proto(ep) != NULL) {
+        ucp_ep_rkey_cache_cleanup(ep);
+        ucp_stream_ep_destroy(ep);
+        ucs_mpool_put(ucp_ep_ext_proto(ep));
+    }
     UCS_STATS_NODE_FREE(ep->stats);
     ucs_list_del(&ucp_ep_ext_gen(ep)->ep_list);
     ucs_strided_alloc_put(&ep->worker->ep_alloc, ep);
 }
 
+ucp_ep_ext_proto_t *ucp_ep_ext_proto_alloc(ucp_ep_h ep)
+{
+    ucp_ep_ext_proto_t *ep_ext;
+    ucs_status_t status;
+
+    ucs_assert(ucp_ep_ext_proto(ep) == NULL);
+
+    ep_ext = ucs_mpool_get(&ep->worker->ep_ext_mp);
+    if (ep_ext == NULL) {
+        ucs_error("ep %p: failed to allocate protocol extension", ep);
+        return NULL;
+    }
+
+    ep_ext->ep                = ep;
+    ep_ext->err_cb            = NULL;
+    ep_ext->rkey_cache        = NULL;
+    ep_ext->tag.bundle_req    = NULL;
+    ucp_ep_ext_gen(ep)->proto = ep_ext;
+
+    status = ucp_stream_ep_init(ep);
+    if (status != UCS_OK) {
+        ucp_ep_ext_gen(ep)->proto = NULL;
+        ucs_mpool_put(ep_ext);
+        return NULL;
+    }
+
+    return ep_ext;
+}
+
 ucs_status_t ucp_ep_create_sockaddr_aux(ucp_worker_h worker,
                                         const ucp_ep_params_t *params,
                                         const ucp_unpacked_address_t *remote_address,
@@ -200,6 +255,8 @@ int ucp_ep_is_sockaddr_stub(ucp_ep_h ep)
 static ucs_status_t
 ucp_ep_adjust_params(ucp_ep_h ep, const ucp_ep_params_t *params)
 {
+    ucp_ep_ext_proto_t *ep_ext;
+
     /* handle a case where the existing endpoint is incomplete */
 
     if (params->field_mask & UCP_EP_PARAM_FIELD_ERR_HANDLING_MODE) {
@@ -211,8 +268,13 @@ ucp_ep_adjust_params(ucp_ep_h ep, const ucp_ep_params_t *params)
     }
 
     if (params->field_mask & UCP_EP_PARAM_FIELD_ERR_HANDLER) {
+        ep_ext = ucp_ep_ext_proto_get(ep);
+        if (ep_ext == NULL) {
+            return UCS_ERR_NO_MEMORY;
+        }
+
         ucp_ep_ext_gen(ep)->user_data = params->err_handler.arg;
-        ucp_ep_ext_gen(ep)->err_cb    = params->err_handler.cb;
+        ep_ext->err_cb                = params->err_handler.cb;
     }
 
     if (params->field_mask & UCP_EP_PARAM_FIELD_USER_DATA) {
@@ -332,6 +394,11 @@ ucs_status_t ucp_ep_create_to_worker_addr(ucp_worker_h worker,
     ucs_status_t status;
     ucp_ep_h ep;
 
+    status = ucp_wireup_check_stream_window(worker, remote_address);
+    if (status != UCS_OK) {
+        goto err;
+    }
+
     /* allocate endpoint */
     status = ucp_ep_new(worker, remote_address->name, message, &ep);
     if (status != UCS_OK) {
@@ -741,6 +808,8 @@ void ucp_ep_disconnected(ucp_ep_h ep, int force)
 
     ucp_stream_ep_cleanup(ep);
     ucp_am_ep_cleanup(ep);
+    ucp_rndv_get_sched_purge(ep, UCS_ERR_CANCELED);
+    ucp_ep_rkey_cache_invalidate(ep);
 
     ep->flags &= ~UCP_EP_FLAG_USED;
     ep->flags |= UCP_EP_FLAG_CLOSED;
@@ -1153,6 +1222,223 @@ static void ucp_ep_config_init_attrs(ucp_worker_t *worker, ucp_rsc_index_t rsc_i
     }
 }
 
+static size_t ucp_ep_config_tune_get(const ucp_ep_config_t *config, int index)
+{
+    if (index == UCP_EP_TUNE_ZCOPY) {
+        return config->tag.eager.mem_type_zcopy_thresh[UCS_MEMORY_TYPE_HOST];
+    } else {
+        return ucs_min(config->tag.rndv.rma_thresh, config->tag.rndv.am_thresh);
+    }
+}
+
+static void ucp_ep_config_tune_set(ucp_ep_config_t *config, int index,
+                                   size_t thresh)
+{
+    if (index == UCP_EP_TUNE_ZCOPY) {
+        config->tag.eager.zcopy_thresh[0]                            = thresh;
+        config->tag.eager.sync_zcopy_thresh[0]                       = thresh;
+        config->tag.eager.mem_type_zcopy_thresh[UCS_MEMORY_TYPE_HOST] = thresh;
+    } else {
+        /* Both thresholds were calculated by the same formula, keep them
+         * aligned unless a protocol is disabled */
+        if (config->tag.rndv.rma_thresh != SIZE_MAX) {
+            config->tag.rndv.rma_thresh = thresh;
+        }
+        if (config->tag.rndv.am_thresh != SIZE_MAX) {
+            config->tag.rndv.am_thresh = thresh;
+        }
+    }
+}
+
+static void ucp_ep_config_tune_init_thresh(ucp_ep_config_t *config, int index,
+                                           size_t min_value, size_t max_value)
+{
+    ucp_ep_thresh_tune_t *tune = &config->tune[index];
+    size_t thresh              = ucp_ep_config_tune_get(config, index);
+
+    if ((thresh == 0) || (thresh == SIZE_MAX)) {
+        return;
+    }
+
+    tune->min = ucs_max(thresh / UCP_EP_TUNE_MAX_RATIO, min_value);
+    tune->max = ucs_min(thresh * UCP_EP_TUNE_MAX_RATIO, max_value);
+    if ((tune->max < thresh) || (tune->min > thresh)) {
+        tune->max = 0; /* Do not tune a threshold which is out of bounds */
+    }
+}
+
+static void ucp_ep_config_tune_init(ucp_worker_h worker, ucp_ep_config_t *config,
+                                    size_t max_rndv_thresh)
+{
+    ucp_context_h context = worker->context;
+
+    if (!context->config.ext.thresh_tune ||
+        !(context->config.features & UCP_FEATURE_TAG) ||
+        (config->key.err_mode == UCP_ERR_HANDLING_MODE_PEER)) {
+        return;
+    }
+
+    if (config->tag.eager.zcopy_auto_thresh) {
+        ucp_ep_config_tune_init_thresh(config, UCP_EP_TUNE_ZCOPY,
+                                       ucs_max(config->tag.eager.max_short + 1, 1),
+                                       SIZE_MAX / UCP_EP_TUNE_MAX_RATIO);
+    }
+
+    if (context->config.ext.rndv_thresh == UCS_MEMUNITS_AUTO) {
+        ucp_ep_config_tune_init_thresh(config, UCP_EP_TUNE_RNDV,
+                                       ucs_max(config->tag.rndv.min_get_zcopy, 1),
+                                       ucs_min(max_rndv_thresh,
+                                               SIZE_MAX / UCP_EP_TUNE_MAX_RATIO));
+    }
+}
+
+static void ucp_ep_config_tune_update(ucp_ep_config_t *config, int index,
+                                      int above)
+{
+    ucp_ep_thresh_tune_t *tune = &config->tune[index];
+    ucp_ep_tune_stat_t *stat   = tune->stat[above];
+    size_t thresh, new_thresh;
+    double avg[2];
+    int higher;
+
+    for (higher = 0; higher < 2; ++higher) {
+        if (stat[higher].count < UCP_EP_TUNE_MIN_SAMPLES) {
+            return;
+        }
+        avg[higher] = stat[higher].time / stat[higher].count;
+    }
+
+    thresh = ucp_ep_config_tune_get(config, index);
+    if (!above && (avg[1] < (avg[0] * UCP_EP_TUNE_PERF_DIFF))) {
+        /* The higher protocol is faster below the threshold */
+        new_thresh = ucs_max(thresh - (thresh / 4), tune->min);
+    } else if (above && (avg[0] < (avg[1] * UCP_EP_TUNE_PERF_DIFF))) {
+        /* The lower protocol is faster above the threshold */
+        new_thresh = ucs_min(thresh + (thresh / 4), tune->max);
+    } else {
+        new_thresh = thresh;
+    }
+
+    if (new_thresh != thresh) {
+        ucs_debug("ep_cfg %p: %s threshold changed from %zu to %zu", config,
+                  (index == UCP_EP_TUNE_ZCOPY) ? "zcopy" : "rndv", thresh,
+                  new_thresh);
+        ucp_ep_config_tune_set(config, index, new_thresh);
+        ++tune->num_updates;
+        tune->backoff = 0;
+        /* Samples from the other side were taken with the old threshold */
+        memset(tune->stat, 0, sizeof(tune->stat));
+    } else {
+        tune->backoff = ucs_min(tune->backoff + 1, UCP_EP_TUNE_MAX_BACKOFF);
+        memset(stat, 0, sizeof(tune->stat[above]));
+    }
+}
+
+void ucp_ep_config_tune_start(ucp_request_t *req, ssize_t max_short,
+                              size_t *zcopy_thresh_p, size_t *rndv_thresh_p)
+{
+    ucp_ep_config_t *config = ucp_ep_config(req->send.ep);
+    size_t length           = req->send.length;
+    ucp_ep_thresh_tune_t *tune;
+    size_t thresh;
+    unsigned interval;
+    ucs_time_t now;
+    int index, above, higher;
+
+    /* Eager and rendezvous sends are sampled from start to the sender-side
+     * completion, which is what the application waits for. Synchronous and
+     * regular sends are mixed in the same way in all statistics slots, since
+     * the slot does not depend on the send type. */
+    if (!UCP_DT_IS_CONTIG(req->send.datatype) ||
+        !UCP_MEM_IS_HOST(req->send.mem_type) ||
+        ((ssize_t)length <= max_short)) {
+        return;
+    }
+
+    for (index = 0; index < UCP_EP_TUNE_LAST; ++index) {
+        tune   = &config->tune[index];
+        thresh = (index == UCP_EP_TUNE_ZCOPY) ? *zcopy_thresh_p :
+                                                *rndv_thresh_p;
+        if ((tune->max == 0) || (length < (thresh / 2)) ||
+            ((length / 2) >= thresh) ||
+            ((index == UCP_EP_TUNE_ZCOPY) && (length >= *rndv_thresh_p))) {
+            continue;
+        }
+
+        interval = UCP_EP_TUNE_SAMPLE_INTERVAL << tune->backoff;
+        if ((++tune->seq % interval) != 0) {
+            continue;
+        }
+
+        now = ucs_get_time();
+        if ((tune->sample_req != NULL) &&
+            ((now - tune->sample_start) <
+             ucs_time_from_sec(UCP_EP_TUNE_SAMPLE_TIMEOUT))) {
+            continue; /* Previous sample is still in progress */
+        }
+
+        /* Every other sample uses the protocol from the other side of the
+         * threshold, as long as the length is valid for it */
+        above  = (length >= thresh);
+        higher = above ^ ((tune->seq / interval) & 1);
+        if ((higher && (length < tune->min)) ||
+            (!higher && (length >= tune->max))) {
+            continue;
+        }
+
+        thresh = higher ? length : (length + 1);
+        if (index == UCP_EP_TUNE_ZCOPY) {
+            *zcopy_thresh_p = thresh;
+        } else {
+            /* Zero copy threshold which was limited by the rendezvous
+             * threshold may be unsupported by the transport, so keep it
+             * limited by the new one */
+            if (*zcopy_thresh_p >= *rndv_thresh_p) {
+                *zcopy_thresh_p = thresh;
+            } else {
+                *zcopy_thresh_p = ucs_min(*zcopy_thresh_p, thresh);
+            }
+            *rndv_thresh_p = thresh;
+        }
+
+        req->flags          |= UCP_REQUEST_FLAG_TUNE_SAMPLE;
+        req->send.tune_index = index;
+        tune->sample_req     = req;
+        tune->sample_start   = now;
+        tune->sample_slot    = (above << 1) | higher;
+        return;
+    }
+}
+
+void ucp_ep_config_tune_complete(ucp_request_t *req, ucs_status_t status)
+{
+    ucp_ep_config_t *config = ucp_ep_config(req->send.ep);
+    ucp_ep_thresh_tune_t *tune;
+    ucp_ep_tune_stat_t *stat;
+
+    req->flags &= ~UCP_REQUEST_FLAG_TUNE_SAMPLE;
+
+    ucs_assert(req->send.tune_index < UCP_EP_TUNE_LAST);
+    tune = &config->tune[req->send.tune_index];
+    if (tune->sample_req != req) {
+        /* Endpoint configuration was changed, or the sample timed out */
+        return;
+    }
+
+    tune->sample_req = NULL;
+    if ((status != UCS_OK) || (req->send.length == 0)) {
+        return;
+    }
+
+    stat        = &tune->stat[tune->sample_slot >> 1][tune->sample_slot & 1];
+    stat->time += (double)(ucs_get_time() - tune->sample_start) /
+                  req->send.length;
+    ++stat->count;
+
+    ucp_ep_config_tune_update(config, req->send.tune_index,
+                              tune->sample_slot >> 1);
+}
+
 static ucs_status_t ucp_ep_config_key_copy(ucp_ep_config_key_t *dst,
                                            const ucp_ep_config_key_t *src)
 {
@@ -1226,6 +1512,8 @@ ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
     config->stream.proto                = &ucp_stream_am_proto;
     config->am_u.proto                  = &ucp_am_proto;
     config->am_u.reply_proto            = &ucp_am_reply_proto;
+    config->am_u.rndv_thresh            = SIZE_MAX;
+    config->stream.rndv_thresh          = SIZE_MAX;
     max_rndv_thresh                     = SIZE_MAX;
     max_am_rndv_thresh                  = SIZE_MAX;
 
@@ -1365,8 +1653,25 @@ ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
             /* Stub endpoint */
             config->am.max_bcopy = UCP_MIN_BCOPY;
         }
+
+        if (context->config.ext.am_rndv_thresh == UCS_MEMUNITS_AUTO) {
+            config->am_u.rndv_thresh = ucs_min(config->tag.rndv.rma_thresh,
+                                               config->tag.rndv.am_thresh);
+        } else {
+            config->am_u.rndv_thresh = context->config.ext.am_rndv_thresh;
+        }
+
+        if (context->config.ext.stream_rndv_thresh == UCS_MEMUNITS_AUTO) {
+            config->stream.rndv_thresh = ucs_min(config->tag.rndv.rma_thresh,
+                                                 config->tag.rndv.am_thresh);
+        } else {
+            config->stream.rndv_thresh = context->config.ext.stream_rndv_thresh;
+        }
     }
 
+    ucp_ep_config_tune_init(worker, config,
+                            ucs_min(max_rndv_thresh, max_am_rndv_thresh));
+
     memset(&config->rma, 0, sizeof(config->rma));
 
     /* Configuration for remote memory access */
@@ -1646,6 +1951,22 @@ static void ucp_ep_config_print(FILE *stream, ucp_worker_h worker,
                                        config->tag.rndv.am_thresh);
      }
 
+     if (context->config.features & UCP_FEATURE_AM) {
+         ucp_ep_config_print_tag_proto(stream, "am_send",
+                                       config->am.max_short,
+                                       config->am.zcopy_thresh[0],
+                                       config->am_u.rndv_thresh,
+                                       config->am_u.rndv_thresh);
+     }
+
+     if (context->config.features & UCP_FEATURE_STREAM) {
+         ucp_ep_config_print_tag_proto(stream, "stream_send",
+                                       config->am.max_short,
+                                       config->am.zcopy_thresh[0],
+                                       config->stream.rndv_thresh,
+                                       config->stream.rndv_thresh);
+     }
+
      if (context->config.features & UCP_FEATURE_RMA) {
          for (lane = 0; lane < config->key.num_lanes; ++lane) {
              if (ucp_ep_config_get_multi_lane_prio(config->key.rma_lanes, lane) == -1) {
@@ -1660,7 +1981,8 @@ static void ucp_ep_config_print(FILE *stream, ucp_worker_h worker,
          }
      }
 
-     if (context->config.features & (UCP_FEATURE_TAG|UCP_FEATURE_RMA)) {
+     if (context->config.features & (UCP_FEATURE_TAG|UCP_FEATURE_RMA|
+                                     UCP_FEATURE_AM|UCP_FEATURE_STREAM)) {
          fprintf(stream, "#\n");
          fprintf(stream, "# %23s: mds ", "rma_bw");
          ucs_for_each_bit(md_index, config->key.rma_bw_md_map) {
@@ -1668,7 +1990,8 @@ static void ucp_ep_config_print(FILE *stream, ucp_worker_h worker,
          }
      }
 
-     if (context->config.features & UCP_FEATURE_TAG) {
+     if (context->config.features & (UCP_FEATURE_TAG|UCP_FEATURE_AM|
+                                     UCP_FEATURE_STREAM)) {
          fprintf(stream, "rndv_rkey_size %zu\n", config->tag.rndv.rkey_size);
      }
 }
@@ -1699,6 +2022,24 @@ void ucp_ep_print_info(ucp_ep_h ep, FILE *stream)
     ucp_ep_config_print(stream, ep->worker, ucp_ep_config(ep), NULL,
                         aux_rsc_index);
 
+#if ENABLE_STATS
+    if (ep->worker->context->config.features & UCP_FEATURE_TAG) {
+        ucp_lane_index_t lane;
+
+        fprintf(stream, "#\n");
+        fprintf(stream, "# %23s:", "rndv_get bytes");
+        for (lane = 0; lane < ucp_ep_num_lanes(ep); ++lane) {
+            if (ucp_ep_config_get_multi_lane_prio(ucp_ep_config(ep)->key.rma_bw_lanes,
+                                                  lane) != -1) {
+                fprintf(stream, " lane[%d] %" PRIu64, lane,
+                        UCS_STATS_GET_COUNTER(ep->stats,
+                                              UCP_EP_STAT_RNDV_GET_BYTES + lane));
+            }
+        }
+        fprintf(stream, "\n");
+    }
+#endif
+
     fprintf(stream, "#\n");
 
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
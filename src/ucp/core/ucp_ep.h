@@ -16,6 +16,7 @@
 #include <ucs/stats/stats.h>
 #include <ucs/datastruct/strided_alloc.h>
 #include <ucs/debug/assert.h>
+#include <ucs/time/time.h>
 
 
 #define UCP_MAX_IOV                16UL
@@ -50,6 +51,10 @@ enum {
                                                         worker address from the client) */
     UCP_EP_FLAG_CONNECT_PRE_REQ_QUEUED = UCS_BIT(9), /* Pre-Connection request was queued */
     UCP_EP_FLAG_CLOSED                 = UCS_BIT(10),/* EP was closed */
+    UCP_EP_FLAG_STREAM_NO_POLL_IN      = UCS_BIT(11),/* EP is not polled for stream data */
+    UCP_EP_FLAG_STREAM_POLL_OUT        = UCS_BIT(12),/* EP is polled for started stream sends */
+    UCP_EP_FLAG_STREAM_OUT_READY       = UCS_BIT(13),/* Waiting stream sends were started
+                                                        since the EP was last polled */
 
     /* DEBUG bits */
     UCP_EP_FLAG_CONNECT_REQ_SENT       = UCS_BIT(16),/* DEBUG: Connection request was sent */
@@ -73,7 +78,11 @@ enum {
     UCP_EP_STAT_TAG_TX_EAGER,
     UCP_EP_STAT_TAG_TX_EAGER_SYNC,
     UCP_EP_STAT_TAG_TX_RNDV,
-    UCP_EP_STAT_LAST
+    UCP_EP_STAT_AM_TX_RNDV,
+    UCP_EP_STAT_STREAM_TX_RNDV,
+    UCP_EP_STAT_RNDV_GET_BYTES,  /* Bytes fetched by rendezvous get, per lane:
+                                    UCP_EP_STAT_RNDV_GET_BYTES + lane index */
+    UCP_EP_STAT_LAST = UCP_EP_STAT_RNDV_GET_BYTES + UCP_MAX_LANES
 };
 
 
@@ -89,6 +98,12 @@ enum {
 #define UCP_EP_STAT_TAG_OP(_ep, _op) \
     UCS_STATS_UPDATE_COUNTER((_ep)->stats, UCP_EP_STAT_TAG_TX_##_op, 1);
 
+#define UCP_EP_STAT_AM_OP(_ep, _op) \
+    UCS_STATS_UPDATE_COUNTER((_ep)->stats, UCP_EP_STAT_AM_TX_##_op, 1);
+
+#define UCP_EP_STAT_STREAM_OP(_ep, _op) \
+    UCS_STATS_UPDATE_COUNTER((_ep)->stats, UCP_EP_STAT_STREAM_TX_##_op, 1);
+
 
 /*
  * Endpoint configuration key.
@@ -180,6 +195,50 @@ typedef struct ucp_ep_msg_config {
 } ucp_ep_msg_config_t;
 
 
+/*
+ * Protocol thresholds which can be adjusted at runtime
+ */
+enum {
+    UCP_EP_TUNE_ZCOPY,                  /* Eager bcopy -> eager zcopy */
+    UCP_EP_TUNE_RNDV,                   /* Eager -> rendezvous */
+    UCP_EP_TUNE_LAST
+};
+
+
+/*
+ * Completion time statistics of sends using one protocol, in one message size
+ * range around a tuned threshold.
+ */
+typedef struct ucp_ep_tune_stat {
+    unsigned               count;       /* Number of samples */
+    double                 time;        /* Sum of completion time per byte */
+} ucp_ep_tune_stat_t;
+
+
+/*
+ * Runtime tuning state of a protocol threshold. Sends with length in
+ * [thresh/2, thresh*2) are sampled, one at a time. Every other sample uses the
+ * protocol on the other side of the threshold, so both protocols are measured
+ * just below and just above the threshold, and the threshold is moved toward
+ * the size where they perform the same. Sampling becomes less frequent while
+ * the threshold stays in place.
+ */
+typedef struct ucp_ep_thresh_tune {
+    size_t                 min;         /* Lower bound for the threshold */
+    size_t                 max;         /* Upper bound for the threshold, 0 if
+                                           tuning is disabled */
+    unsigned               seq;         /* Counter of sends in the sampled range */
+    unsigned               num_updates; /* How many times the threshold was moved */
+    const void             *sample_req; /* Send request being measured */
+    ucs_time_t             sample_start;/* Start time of sample_req */
+    uint8_t                sample_slot; /* Statistics slot of sample_req */
+    uint8_t                backoff;     /* Log2 of sampling interval factor, grows
+                                           while the threshold does not move */
+    /* Statistics, indexed by [above threshold][uses the higher protocol] */
+    ucp_ep_tune_stat_t     stat[2][2];
+} ucp_ep_thresh_tune_t;
+
+
 /*
  * Thresholds with and without non-host memory
  */
@@ -242,7 +301,8 @@ typedef struct ucp_ep_config {
             size_t          am_thresh;
             /* Total size of packed rkey, according to high-bw md_map */
             size_t          rkey_size;
-            /* BW based scale factor */
+            /* BW based scale factor, lane bandwidth relative to the fastest
+             * rma_bw lane */
             double          scale[UCP_MAX_LANES];
         } rndv;
 
@@ -269,14 +329,21 @@ typedef struct ucp_ep_config {
         /* Protocols used for stream operations
          * (currently it's only AM based). */
         const ucp_proto_t   *proto;
+        /* Threshold for switching from eager to rendezvous */
+        size_t              rndv_thresh;
     } stream;
     
     struct {
         /* Protocols used for am operations */
         const ucp_proto_t *proto;
         const ucp_proto_t *reply_proto;
+        /* Threshold for switching from eager to rendezvous */
+        size_t            rndv_thresh;
     } am_u;
 
+    /* Runtime tuning of tag send thresholds */
+    ucp_ep_thresh_tune_t    tune[UCP_EP_TUNE_LAST];
+
 } ucp_ep_config_t;
 
 
@@ -322,6 +389,9 @@ typedef struct {
                                                    used in close protocol */
 } ucp_ep_close_proto_req_t;
 
+typedef struct ucp_ep_ext_proto ucp_ep_ext_proto_t;
+
+
 /*
  * Endpoint extension for generic non fast-path data
  */
@@ -329,7 +399,8 @@ typedef struct {
     uintptr_t                     dest_ep_ptr;   /* Remote EP pointer */
     void                          *user_data;    /* User data associated with ep */
     ucs_list_link_t               ep_list;       /* List entry in worker's all eps list */
-    ucp_err_handler_cb_t          err_cb;        /* Error handler */
+    ucp_ep_ext_proto_t            *proto;        /* Protocol extension, allocated
+                                                    on first use */
 
     /* Endpoint match context and remote completion status are mutually exclusive,
      * since remote completions are counted only after the endpoint is already
@@ -345,19 +416,31 @@ typedef struct {
 
 
 /*
- * Endpoint extension for specific protocols
+ * Endpoint extension for specific protocols and rarely used state. It is
+ * allocated only for endpoints which need it, so endpoints which are used just
+ * for tag matching or RMA do not pay for it.
  */
-typedef struct {
+struct ucp_ep_ext_proto {
+    ucp_ep_h                      ep;            /* Endpoint this extension belongs to */
+    ucp_err_handler_cb_t          err_cb;        /* Error handler */
+    ucp_rkey_cache_t              *rkey_cache;   /* Remote keys received in
+                                                    rendezvous requests, allocated
+                                                    on first use */
     struct {
         ucs_list_link_t           ready_list;    /* List entry in worker's EP list */
         ucs_queue_head_t          match_q;       /* Queue of receive data or requests,
                                                     depends on UCP_EP_FLAG_STREAM_HAS_DATA */
+        ucs_queue_head_t          rndv_q;        /* Data which arrived while a
+                                                    rendezvous fetch is in progress */
+        ucp_request_t             *rndv_rreq;    /* Rendezvous fetch in progress */
+        struct ucp_stream_ep_fc   *fc;           /* Flow control state, allocated
+                                                    only if the window is limited */
     } stream;
-
     struct {
-        ucs_list_link_t           started_ams;
-    } am;
-} ucp_ep_ext_proto_t;
+        ucp_request_t             *bundle_req;   /* Pending eager send which small
+                                                    sends are aggregated with */
+    } tag;
+};
 
 
 enum {
@@ -407,6 +490,8 @@ ucs_status_t ucp_ep_new(ucp_worker_h worker, const char *peer_name,
 
 void ucp_ep_delete(ucp_ep_h ep);
 
+ucp_ep_ext_proto_t *ucp_ep_ext_proto_alloc(ucp_ep_h ep);
+
 ucs_status_t ucp_ep_init_create_wireup(ucp_ep_h ep,
                                        const ucp_ep_params_t *params,
                                        ucp_wireup_ep_t **wireup_ep);
@@ -457,6 +542,11 @@ int ucp_ep_config_is_equal(const ucp_ep_config_key_t *key1,
 int ucp_ep_config_get_multi_lane_prio(const ucp_lane_index_t *lanes,
                                       ucp_lane_index_t lane);
 
+void ucp_ep_config_tune_start(ucp_request_t *req, ssize_t max_short,
+                              size_t *zcopy_thresh_p, size_t *rndv_thresh_p);
+
+void ucp_ep_config_tune_complete(ucp_request_t *req, ucs_status_t status);
+
 size_t ucp_ep_config_get_zcopy_auto_thresh(size_t iovcnt,
                                            const uct_linear_growth_t *reg_cost,
                                            const ucp_context_h context,
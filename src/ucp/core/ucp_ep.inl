@@ -117,9 +117,23 @@ static UCS_F_ALWAYS_INLINE ucp_ep_ext_gen_t* ucp_ep_ext_gen(ucp_ep_h ep)
     return (ucp_ep_ext_gen_t*)ucs_strided_elem_get(ep, 0, 1);
 }
 
+/* Protocol extension of the endpoint, or NULL if it was not allocated yet */
 static UCS_F_ALWAYS_INLINE ucp_ep_ext_proto_t* ucp_ep_ext_proto(ucp_ep_h ep)
 {
-    return (ucp_ep_ext_proto_t*)ucs_strided_elem_get(ep, 0, 2);
+    return ucp_ep_ext_gen(ep)->proto;
+}
+
+/* Protocol extension of the endpoint, allocated on first use. Returns NULL if
+ * it could not be allocated. */
+static UCS_F_ALWAYS_INLINE ucp_ep_ext_proto_t* ucp_ep_ext_proto_get(ucp_ep_h ep)
+{
+    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
+
+    if (ucs_likely(ep_ext != NULL)) {
+        return ep_ext;
+    }
+
+    return ucp_ep_ext_proto_alloc(ep);
 }
 
 static UCS_F_ALWAYS_INLINE ucp_ep_h ucp_ep_from_ext_gen(ucp_ep_ext_gen_t *ep_ext)
@@ -129,7 +143,14 @@ static UCS_F_ALWAYS_INLINE ucp_ep_h ucp_ep_from_ext_gen(ucp_ep_ext_gen_t *ep_ext
 
 static UCS_F_ALWAYS_INLINE ucp_ep_h ucp_ep_from_ext_proto(ucp_ep_ext_proto_t *ep_ext)
 {
-    return (ucp_ep_h)ucs_strided_elem_get(ep_ext, 2, 0);
+    return ep_ext->ep;
+}
+
+static inline ucp_err_handler_cb_t ucp_ep_err_cb(ucp_ep_h ep)
+{
+    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
+
+    return (ep_ext == NULL) ? NULL : ep_ext->err_cb;
 }
 
 static UCS_F_ALWAYS_INLINE ucp_ep_flush_state_t* ucp_ep_flush_state(ucp_ep_h ep)
@@ -655,6 +655,21 @@ void ucp_frag_mpool_free(ucs_mpool_t *mp, void *chunk)
     ucp_mpool_free(worker, mp, chunk);
 }
 
+ucs_status_t ucp_am_buf_mpool_malloc(ucs_mpool_t *mp, size_t *size_p,
+                                     void **chunk_p)
+{
+    ucp_worker_h worker = *(ucp_worker_h*)ucs_mpool_priv(mp);
+
+    return ucp_mpool_malloc(worker, mp, size_p, chunk_p);
+}
+
+void ucp_am_buf_mpool_free(ucs_mpool_t *mp, void *chunk)
+{
+    ucp_worker_h worker = *(ucp_worker_h*)ucs_mpool_priv(mp);
+
+    ucp_mpool_free(worker, mp, chunk);
+}
+
 void ucp_mem_print_info(const char *mem_size, ucp_context_h context, FILE *stream)
 {
     size_t min_page_size, max_page_size;
@@ -61,6 +61,37 @@ typedef struct ucp_rkey {
 } ucp_rkey_t;
 
 
+/**
+ * Remote key cache entry.
+ * Holds an unpacked remote key which was received from the peer by a rendezvous
+ * protocol, so it could be reused by subsequent transfers from the same remote
+ * buffer. The entry is identified by the packed key contents, and covers the
+ * remote address range which was accessed with it so far.
+ */
+typedef struct ucp_rkey_cache_entry {
+    ucp_rkey_h                    rkey;         /* Unpacked remote key */
+    void                          *packed_rkey; /* Copy of the packed remote key */
+    size_t                        packed_size;  /* Size of the packed remote key */
+    uint32_t                      hash;         /* Checksum of the packed remote key */
+    uint64_t                      start;        /* Remote region start address */
+    uint64_t                      end;          /* Remote region end address */
+    uint64_t                      last_used;    /* Last use stamp, for LRU eviction */
+    unsigned                      refcount;     /* How many operations use the key */
+    ucp_ep_cfg_index_t            ep_cfg_index; /* EP configuration of the key */
+    uint8_t                       stale;        /* Do not reuse, release when unused */
+} ucp_rkey_cache_entry_t;
+
+
+/**
+ * Per-endpoint cache of remote keys received by rendezvous protocols.
+ */
+struct ucp_rkey_cache {
+    uint64_t                      use_sn;       /* Current use stamp */
+    unsigned                      count;        /* Number of valid entries */
+    ucp_rkey_cache_entry_t        entries[0];   /* Cache entries */
+};
+
+
 /**
  * Memory handle.
  * Contains general information, and a list of UCT handles.
@@ -104,6 +135,11 @@ ucs_status_t ucp_frag_mpool_malloc(ucs_mpool_t *mp, size_t *size_p, void **chunk
 
 void ucp_frag_mpool_free(ucs_mpool_t *mp, void *chunk);
 
+ucs_status_t ucp_am_buf_mpool_malloc(ucs_mpool_t *mp, size_t *size_p,
+                                     void **chunk_p);
+
+void ucp_am_buf_mpool_free(ucs_mpool_t *mp, void *chunk);
+
 /**
  * Update memory registration to a specified set of memory domains.
  *
@@ -146,6 +182,34 @@ ssize_t ucp_rkey_pack_uct(ucp_context_h context, ucp_md_map_t md_map,
 
 void ucp_rkey_dump_packed(const void *rkey_buffer, char *buffer, size_t max);
 
+size_t ucp_rkey_packed_buffer_size(const void *rkey_buffer);
+
+/**
+ * Unpack a remote key received from the peer, and keep it in the endpoint
+ * remote key cache, or return a cached one if the same key was already
+ * received. The key must be released by @ref ucp_ep_rkey_cache_release.
+ *
+ * @param [in]  ep          Endpoint the key was received on.
+ * @param [in]  address     Remote address which is going to be accessed.
+ * @param [in]  length      Length of the remote region to access.
+ * @param [in]  rkey_buffer Packed remote key.
+ * @param [out] rkey_p      Filled with the unpacked remote key.
+ */
+ucs_status_t ucp_ep_rkey_cache_unpack(ucp_ep_h ep, uint64_t address,
+                                      size_t length, const void *rkey_buffer,
+                                      ucp_rkey_h *rkey_p);
+
+void ucp_ep_rkey_cache_release(ucp_ep_h ep, ucp_rkey_h rkey);
+
+/**
+ * Drop all remote keys cached on the endpoint, so that memory of the peer
+ * would not stay attached after the endpoint is closed. Keys which are in use
+ * are destroyed when released.
+ */
+void ucp_ep_rkey_cache_invalidate(ucp_ep_h ep);
+
+void ucp_ep_rkey_cache_cleanup(ucp_ep_h ep);
+
 ucs_status_t ucp_mem_type_reg_buffers(ucp_worker_h worker, void *remote_addr,
                                       size_t length, ucs_memory_type_t mem_type,
                                       ucp_md_index_t md_index, uct_mem_h *memh,
@@ -205,8 +205,9 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_request_memory_reg,
                  size_t length, ucp_datatype_t datatype, ucp_dt_state_t *state,
                  ucs_memory_type_t mem_type, ucp_request_t *req_dbg, unsigned uct_flags)
 {
-    size_t iov_it, iovcnt;
+    size_t iov_it, iovcnt, region_it, region_end;
     const ucp_dt_iov_t *iov;
+    void *start, *end;
     ucp_dt_reg_t *dt_reg;
     ucs_status_t status;
     int flags;
@@ -234,23 +235,40 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_request_memory_reg,
             status = UCS_ERR_NO_MEMORY;
             goto err;
         }
-        for (iov_it = 0; iov_it < iovcnt; ++iov_it) {
+        iov_it = 0;
+        while (iov_it < iovcnt) {
             dt_reg[iov_it].md_map = 0;
-            if (iov[iov_it].length) {
-                status = ucp_mem_rereg_mds(context, md_map, iov[iov_it].buffer,
-                                           iov[iov_it].length, flags, NULL,
-                                           mem_type, NULL, dt_reg[iov_it].memh,
+            if (!iov[iov_it].length) {
+                ++iov_it;
+                continue;
+            }
+
+            /* Register adjacent and overlapping items as a single region. Only
+             * the first item owns the registration, the rest share its
+             * handles, so they are not deregistered again. */
+            region_end = ucp_dt_iov_region(iov, iovcnt, iov_it, &start, &end);
+            status     = ucp_mem_rereg_mds(context, md_map, start,
+                                           UCS_PTR_BYTE_DIFF(start, end), flags,
+                                           NULL, mem_type, NULL,
+                                           dt_reg[iov_it].memh,
                                            &dt_reg[iov_it].md_map);
-                if (status != UCS_OK) {
-                    /* unregister previously registered memory */
-                    ucp_request_dt_dereg(context, dt_reg, iov_it, req_dbg);
-                    ucs_free(dt_reg);
-                    goto err;
-                }
-                ucp_trace_req(req_dbg,
-                              "mem reg iov %ld/%ld md_map 0x%"PRIx64"/0x%"PRIx64,
-                              iov_it, iovcnt, dt_reg[iov_it].md_map, md_map);
+            if (status != UCS_OK) {
+                /* unregister previously registered memory */
+                ucp_request_dt_dereg(context, dt_reg, iov_it, req_dbg);
+                ucs_free(dt_reg);
+                goto err;
+            }
+            ucp_trace_req(req_dbg,
+                          "mem reg iov %ld..%ld/%ld md_map 0x%"PRIx64"/0x%"PRIx64,
+                          iov_it, region_end - 1, iovcnt,
+                          dt_reg[iov_it].md_map, md_map);
+
+            for (region_it = iov_it + 1; region_it < region_end; ++region_it) {
+                dt_reg[region_it].md_map = 0;
+                memcpy(dt_reg[region_it].memh, dt_reg[iov_it].memh,
+                       sizeof(dt_reg[iov_it].memh));
             }
+            iov_it = region_end;
         }
         state->dt.iov.dt_reg = dt_reg;
         break;
@@ -359,7 +377,7 @@ ucp_request_send_start(ucp_request_t *req, ssize_t max_short,
             if (dt_count <= msg_config->max_iov) {
                 multi = 0;
             } else {
-                multi = ucp_dt_iov_count_nonempty(req->send.buffer, dt_count) >
+                multi = ucp_dt_iov_count_coalesced(req->send.buffer, dt_count) >
                         msg_config->max_iov;
             }
         } else {
@@ -33,17 +33,20 @@
 enum {
     UCP_REQUEST_FLAG_COMPLETED            = UCS_BIT(0),
     UCP_REQUEST_FLAG_RELEASED             = UCS_BIT(1),
+    UCP_REQUEST_FLAG_RNDV_GET_SCHED       = UCS_BIT(2),
     UCP_REQUEST_FLAG_EXPECTED             = UCS_BIT(3),
     UCP_REQUEST_FLAG_LOCAL_COMPLETED      = UCS_BIT(4),
     UCP_REQUEST_FLAG_REMOTE_COMPLETED     = UCS_BIT(5),
     UCP_REQUEST_FLAG_CALLBACK             = UCS_BIT(6),
     UCP_REQUEST_FLAG_RECV                 = UCS_BIT(7),
     UCP_REQUEST_FLAG_SYNC                 = UCS_BIT(8),
+    UCP_REQUEST_FLAG_RNDV_WAIT_CREDIT     = UCS_BIT(9),
     UCP_REQUEST_FLAG_OFFLOADED            = UCS_BIT(10),
     UCP_REQUEST_FLAG_BLOCK_OFFLOAD        = UCS_BIT(11),
     UCP_REQUEST_FLAG_STREAM_RECV_WAITALL  = UCS_BIT(12),
     UCP_REQUEST_FLAG_SEND_AM              = UCS_BIT(13),
     UCP_REQUEST_FLAG_SEND_TAG             = UCS_BIT(14),
+    UCP_REQUEST_FLAG_TUNE_SAMPLE          = UCS_BIT(15),
 #if UCS_ENABLE_ASSERT
     UCP_REQUEST_FLAG_STREAM_RECV          = UCS_BIT(16),
     UCP_REQUEST_DEBUG_FLAG_EXTERNAL       = UCS_BIT(17)
@@ -82,7 +85,14 @@ enum {
                                                        uct and the ucp level am header must
                                                        be accounted for when releasing 
                                                        descriptors */
-    UCP_RECV_DESC_FLAG_AM_REPLY       = UCS_BIT(8)  /* AM that needed a reply */
+    UCP_RECV_DESC_FLAG_AM_REPLY       = UCS_BIT(8), /* AM that needed a reply */
+    UCP_RECV_DESC_FLAG_AM_CB          = UCS_BIT(9), /* AM callback is running on the
+                                                       descriptor, so it must not be
+                                                       released */
+    UCP_RECV_DESC_FLAG_AM_RNDV_DONE   = UCS_BIT(10), /* AM rendezvous data was fetched
+                                                        or dropped */
+    UCP_RECV_DESC_FLAG_AM_MPOOL       = UCS_BIT(11)  /* AM reassembly buffer from the
+                                                        worker's registered pools */
 };
 
 
@@ -121,10 +131,27 @@ struct ucp_request {
                 /* Tagged send */
                 struct {
                     ucp_tag_t        tag;
-                    uint64_t         message_id;  /* message ID used in AM */
-                    ucp_lane_index_t am_bw_index; /* AM BW lane index */
-                    uintptr_t        rreq_ptr;    /* receive request ptr on the
-                                                     recv side (used in AM rndv) */
+                    union {
+                        struct {
+                            uint64_t         message_id;  /* message ID used in AM */
+                            ucp_lane_index_t am_bw_index; /* AM BW lane index */
+                            uintptr_t        rreq_ptr;    /* receive request ptr on the
+                                                             recv side (used in AM rndv) */
+                            size_t           rndv_end;    /* end of the data the receiver
+                                                             granted credit for (used in
+                                                             AM rndv) */
+                            size_t           rndv_credit; /* offset of the fragment which
+                                                             asks for more credit, or
+                                                             SIZE_MAX (used in AM rndv) */
+                        };
+                        struct {
+                            ucs_queue_elem_t bundle_elem; /* Element in the queue
+                                                             of the bundle leader */
+                            ucs_queue_head_t bundle_q;    /* Small sends which are
+                                                             aggregated with this
+                                                             one (bundle leader) */
+                        };
+                    };
                 } tag;
 
                 struct {
@@ -150,8 +177,12 @@ struct ucp_request {
                     uintptr_t            remote_request; /* pointer to the sender's send request */
                     ucp_request_t       *rreq;           /* receive request on the recv side */
                     ucp_rkey_h           rkey;           /* key for remote send buffer */
+                    double               scale_sum;      /* sum of BW scale factors of used lanes */
                     ucp_lane_map_t       lanes_map;      /* used lanes map */
                     ucp_lane_index_t     lane_count;     /* number of lanes used in transaction */
+                    size_t               sched_bytes;    /* data posted in the current scheduled
+                                                            fragment, if UCP_REQUEST_FLAG_RNDV_GET_SCHED
+                                                            is set */
                 } rndv_get;
 
                 struct {
@@ -167,6 +198,22 @@ struct ucp_request {
                     ucp_request_t     *rreq;
                 } rndv_rtr;
 
+                struct {
+                    uintptr_t         remote_request; /* pointer to the send request on sender side */
+                    size_t            offset;         /* offset of the received data */
+                } rndv_credit;
+
+                struct {
+                    ucs_queue_elem_t  queue;          /* Element in the endpoint's
+                                                         queue of sends waiting
+                                                         for credit */
+                    size_t            count;          /* Datatype count */
+                } stream;
+
+                struct {
+                    size_t            credit;         /* how much data to grant */
+                } stream_credit;
+
                 struct {
                     ucp_request_callback_t flushed_cb;/* Called when flushed */
                     ucp_request_t          *worker_req;
@@ -213,6 +260,13 @@ struct ucp_request {
                                              of a large message */
                     unsigned flags;
                 } am;
+
+                struct {
+                    const ucp_am_batch_item_t *items; /* Messages to send */
+                    size_t                    count;  /* Number of messages */
+                    size_t                    index;  /* Next message to pack */
+                    unsigned                  flags;  /* Send flags */
+                } am_batch;
             };
 
             /* This structure holds all mutable fields, and everything else
@@ -227,6 +281,9 @@ struct ucp_request {
             ucp_lane_index_t      pending_lane; /* Lane on which request was moved
                                                  * to pending state */
             ucp_lane_index_t      lane;     /* Lane on which this request is being sent */
+            uint8_t               tune_index; /* Tuned threshold this request is a
+                                                 sample for, valid if
+                                                 UCP_REQUEST_FLAG_TUNE_SAMPLE is set */
             uct_pending_req_t     uct;      /* UCT pending request */
             ucp_mem_desc_t        *mdesc;
         } send;
@@ -244,9 +301,28 @@ struct ucp_request {
 
             union {
                 struct {
-                    ucp_tag_t               tag;      /* Expected tag */
-                    ucp_tag_t               tag_mask; /* Expected tag mask */
-                    uint64_t                sn;       /* Tag match sequence */
+                    union {
+                        struct {
+                            ucp_tag_t       tag;      /* Expected tag */
+                            ucp_tag_t       tag_mask; /* Expected tag mask */
+                            uint64_t        sn;       /* Tag match sequence */
+                        };
+
+                        /* Active message rendezvous, which is not matched */
+                        struct {
+                            ucp_am_recv_data_callback_t cb; /* User callback */
+                            ucp_ep_h        reply_ep; /* Reply endpoint */
+                            uint16_t        am_id;    /* Callback index */
+                        } am;
+
+                        /* Stream rendezvous fetch, which is not matched */
+                        struct {
+                            ucp_ep_h        ep;       /* Receiving endpoint */
+                            ucp_request_t   *req;     /* Stream receive request the
+                                                         data is fetched to, or
+                                                         NULL for a bounce buffer */
+                        } stream;
+                    };
                     ucp_tag_recv_callback_t cb;       /* Completion callback */
                     ucp_tag_recv_info_t     info;     /* Completion info to fill */
                     ucp_mem_desc_t          *rdesc;   /* Offload bounce buffer */
@@ -13,6 +13,7 @@
 
 #include <ucp/core/ucp_worker.h>
 #include <ucp/dt/dt.h>
+#include <ucp/dt/dt_pack_pool.h>
 #include <ucs/profile/profile.h>
 #include <ucs/datastruct/mpool.inl>
 #include <ucp/dt/dt.inl>
@@ -87,6 +88,43 @@ ucp_request_put(ucp_request_t *req)
     ucs_mpool_put_inline(req);
 }
 
+static UCS_F_ALWAYS_INLINE ucp_worker_h
+ucp_request_cb_worker(ucp_request_t *req, ucp_request_cb_type_t cb_type)
+{
+    switch (cb_type) {
+    case UCP_REQUEST_CB_SEND:
+        return req->send.ep->worker;
+    case UCP_REQUEST_CB_FLUSH_WORKER:
+        return req->flush_worker.worker;
+    default:
+        return req->recv.worker;
+    }
+}
+
+/* On the progress thread of the worker, keep the request uncompleted and pass
+ * it to an application thread, which invokes the user callback from
+ * ucp_worker_progress(). Returns nonzero if the completion was deferred. */
+static UCS_F_ALWAYS_INLINE int
+ucp_request_complete_defer(ucp_request_t *req, ucs_status_t status,
+                           ucp_request_cb_type_t cb_type)
+{
+    ucp_worker_h worker;
+
+    if (!(req->flags & UCP_REQUEST_FLAG_CALLBACK)) {
+        return 0;
+    }
+
+    worker = ucp_request_cb_worker(req, cb_type);
+    if (ucs_likely(!(worker->flags & UCP_WORKER_FLAG_PROGRESS_THREAD)) ||
+        !ucp_worker_is_progress_thread(worker)) {
+        return 0;
+    }
+
+    req->status = status;
+    ucp_worker_progress_thread_defer(worker, req, cb_type);
+    return 1;
+}
+
 static UCS_F_ALWAYS_INLINE void
 ucp_request_complete_send(ucp_request_t *req, ucs_status_t status)
 {
@@ -94,6 +132,13 @@ ucp_request_complete_send(ucp_request_t *req, ucs_status_t status)
                   req, req + 1, UCP_REQUEST_FLAGS_ARG(req->flags),
                   ucs_status_string(status));
     UCS_PROFILE_REQUEST_EVENT(req, "complete_send", status);
+    if (ucs_unlikely(req->flags & UCP_REQUEST_FLAG_TUNE_SAMPLE)) {
+        ucp_ep_config_tune_complete(req, status);
+    }
+    if (ucs_unlikely(ucp_request_complete_defer(req, status,
+                                                UCP_REQUEST_CB_SEND))) {
+        return;
+    }
     ucp_request_complete(req, send.cb, status);
 }
 
@@ -106,6 +151,10 @@ ucp_request_complete_tag_recv(ucp_request_t *req, ucs_status_t status)
                   req->recv.tag.info.sender_tag, req->recv.tag.info.length,
                   ucs_status_string(status));
     UCS_PROFILE_REQUEST_EVENT(req, "complete_recv", status);
+    if (ucs_unlikely(ucp_request_complete_defer(req, status,
+                                                UCP_REQUEST_CB_TAG_RECV))) {
+        return;
+    }
     ucp_request_complete(req, recv.tag.cb, status, &req->recv.tag.info);
 }
 
@@ -126,6 +175,10 @@ ucp_request_complete_stream_recv(ucp_request_t *req, ucp_ep_ext_proto_t* ep_ext,
                   req, req + 1, UCP_REQUEST_FLAGS_ARG(req->flags),
                   req->recv.stream.length, ucs_status_string(status));
     UCS_PROFILE_REQUEST_EVENT(req, "complete_recv", status);
+    if (ucs_unlikely(ucp_request_complete_defer(req, status,
+                                                UCP_REQUEST_CB_STREAM_RECV))) {
+        return;
+    }
     ucp_request_complete(req, recv.stream.cb, status, req->recv.stream.length);
 }
 
@@ -214,6 +267,9 @@ void ucp_request_send_generic_dt_finish(ucp_request_t *req)
     if (UCP_DT_IS_GENERIC(req->send.datatype)) {
         dt = ucp_dt_generic(req->send.datatype);
         ucs_assert(NULL != dt);
+        if (req->send.state.dt.dt.generic.pipeline != NULL) {
+            ucp_dt_pack_pipeline_destroy(req->send.state.dt.dt.generic.pipeline);
+        }
         dt->ops.finish(req->send.state.dt.dt.generic.state);
     }
 }
@@ -253,11 +309,14 @@ ucp_request_send_state_init(ucp_request_t *req, ucp_datatype_t datatype,
         req->send.state.dt.dt.iov.iovcnt        = dt_count;
         req->send.state.dt.dt.iov.dt_reg        = NULL;
         return;
+    case UCP_DATATYPE_STRIDED:
+        return;
     case UCP_DATATYPE_GENERIC:
         dt_gen    = ucp_dt_generic(datatype);
         state_gen = dt_gen->ops.start_pack(dt_gen->context, req->send.buffer,
                                            dt_count);
-        req->send.state.dt.dt.generic.state = state_gen;
+        req->send.state.dt.dt.generic.state    = state_gen;
+        req->send.state.dt.dt.generic.pipeline = NULL;
         return;
     default:
         ucs_fatal("Invalid data type");
@@ -459,6 +518,11 @@ ucp_request_recv_data_unpack(ucp_request_t *req, const void *data,
         req->recv.state.offset += length;
         return UCS_OK;
 
+    case UCP_DATATYPE_STRIDED:
+        UCS_PROFILE_CALL_VOID(ucp_dt_strided_unpack, req->recv.datatype,
+                              req->recv.buffer, offset, data, length);
+        return UCS_OK;
+
     case UCP_DATATYPE_GENERIC:
         dt_gen = ucp_dt_generic(req->recv.datatype);
         status = UCS_PROFILE_NAMED_CALL("dt_unpack", dt_gen->ops.unpack,
@@ -13,6 +13,7 @@
 #include "ucp_ep.inl"
 
 #include <ucp/rma/rma.h>
+#include <ucs/algorithm/crc.h>
 #include <ucs/datastruct/mpool.inl>
 #include <ucs/profile/profile.h>
 #include <ucs/sys/string.h>
@@ -367,6 +368,251 @@ void ucp_rkey_destroy(ucp_rkey_h rkey)
     }
 }
 
+size_t ucp_rkey_packed_buffer_size(const void *rkey_buffer)
+{
+    const void *p = rkey_buffer;
+    ucp_md_map_t md_map;
+    unsigned md_index;
+
+    md_map = *(const ucp_md_map_t*)p;
+    p     += sizeof(ucp_md_map_t) + sizeof(uint8_t);
+
+    ucs_for_each_bit(md_index, md_map) {
+        p += sizeof(uint8_t) + *(const uint8_t*)p;
+    }
+
+    return p - rkey_buffer;
+}
+
+static void ucp_rkey_cache_remove(ucp_rkey_cache_t *cache, unsigned index)
+{
+    ucp_rkey_cache_entry_t *entry = &cache->entries[index];
+
+    ucs_assert(entry->refcount == 0);
+    ucs_trace("rkey_cache %p: remove rkey %p [0x%"PRIx64"..0x%"PRIx64"]",
+              cache, entry->rkey, entry->start, entry->end);
+
+    ucp_rkey_destroy(entry->rkey);
+    ucs_free(entry->packed_rkey);
+    *entry = cache->entries[--cache->count];
+}
+
+/* Mark entries whose remote region overlaps [start, end), but which were not
+ * matched by the packed key, as stale: the peer has registered this memory
+ * again, so the old key should not be used anymore. Also invalidate entries
+ * which were unpacked with a different endpoint configuration. */
+static void ucp_rkey_cache_invalidate(ucp_ep_h ep, ucp_rkey_cache_t *cache,
+                                      uint64_t start, uint64_t end)
+{
+    ucp_rkey_cache_entry_t *entry;
+    unsigned i;
+
+    i = 0;
+    while (i < cache->count) {
+        entry = &cache->entries[i];
+        if ((entry->ep_cfg_index != ep->cfg_index) ||
+            ((start < entry->end) && (end > entry->start))) {
+            entry->stale = 1;
+        }
+
+        if (entry->stale && (entry->refcount == 0)) {
+            ucp_rkey_cache_remove(cache, i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+static ucp_rkey_cache_t *ucp_ep_rkey_cache(ucp_ep_h ep)
+{
+    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
+
+    return (ep_ext == NULL) ? NULL : ep_ext->rkey_cache;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_ep_rkey_cache_unpack,
+                 (ep, address, length, rkey_buffer, rkey_p),
+                 ucp_ep_h ep, uint64_t address, size_t length,
+                 const void *rkey_buffer, ucp_rkey_h *rkey_p)
+{
+    unsigned max_entries = ep->worker->context->config.ext.rndv_rkey_cache_size;
+    uint64_t end         = address + length;
+    ucp_ep_ext_proto_t *ep_ext;
+    ucp_rkey_cache_entry_t *entry, *lru_entry;
+    ucp_rkey_cache_t *cache;
+    size_t packed_size;
+    ucs_status_t status;
+    ucp_rkey_h rkey;
+    uint32_t hash;
+    unsigned i;
+
+    /* check the cache size first, to not allocate the protocol extension
+     * when the cache is disabled */
+    if (max_entries == 0) {
+        return ucp_ep_rkey_unpack(ep, rkey_buffer, rkey_p);
+    }
+
+    ep_ext = ucp_ep_ext_proto_get(ep);
+    if (ep_ext == NULL) {
+        return ucp_ep_rkey_unpack(ep, rkey_buffer, rkey_p);
+    }
+
+    cache = ep_ext->rkey_cache;
+    if (ucs_unlikely(cache == NULL)) {
+        cache = ucs_malloc(sizeof(*cache) + (sizeof(*entry) * max_entries),
+                           "ucp_rkey_cache");
+        if (cache == NULL) {
+            return ucp_ep_rkey_unpack(ep, rkey_buffer, rkey_p);
+        }
+
+        cache->use_sn      = 0;
+        cache->count       = 0;
+        ep_ext->rkey_cache = cache;
+    }
+
+    packed_size = ucp_rkey_packed_buffer_size(rkey_buffer);
+    hash        = ucs_crc32(0, rkey_buffer, packed_size);
+
+    for (i = 0; i < cache->count; ++i) {
+        entry = &cache->entries[i];
+        if (!entry->stale && (entry->hash == hash) &&
+            (entry->packed_size == packed_size) &&
+            (entry->ep_cfg_index == ep->cfg_index) &&
+            !memcmp(entry->packed_rkey, rkey_buffer, packed_size)) {
+            entry->start     = ucs_min(entry->start, address);
+            entry->end       = ucs_max(entry->end, end);
+            entry->last_used = ++cache->use_sn;
+            ++entry->refcount;
+            ucs_trace("ep %p: rkey_cache hit rkey %p for 0x%"PRIx64" len %zu",
+                      ep, entry->rkey, address, length);
+            *rkey_p = entry->rkey;
+            return UCS_OK;
+        }
+    }
+
+    ucp_rkey_cache_invalidate(ep, cache, address, end);
+
+    status = ucp_ep_rkey_unpack(ep, rkey_buffer, &rkey);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    if (cache->count < max_entries) {
+        entry = &cache->entries[cache->count];
+    } else {
+        /* evict least recently used key which is not in use */
+        lru_entry = NULL;
+        for (i = 0; i < cache->count; ++i) {
+            entry = &cache->entries[i];
+            if ((entry->refcount == 0) &&
+                ((lru_entry == NULL) ||
+                 (entry->last_used < lru_entry->last_used))) {
+                lru_entry = entry;
+            }
+        }
+
+        if (lru_entry == NULL) {
+            /* all cached keys are in use, do not cache the new one */
+            goto out;
+        }
+
+        ucp_rkey_cache_remove(cache, lru_entry - cache->entries);
+        entry = &cache->entries[cache->count];
+    }
+
+    entry->packed_rkey = ucs_malloc(packed_size, "ucp_rkey_cache_packed");
+    if (entry->packed_rkey == NULL) {
+        goto out;
+    }
+
+    memcpy(entry->packed_rkey, rkey_buffer, packed_size);
+    entry->rkey         = rkey;
+    entry->packed_size  = packed_size;
+    entry->hash         = hash;
+    entry->start        = address;
+    entry->end          = end;
+    entry->last_used    = ++cache->use_sn;
+    entry->refcount     = 1;
+    entry->ep_cfg_index = ep->cfg_index;
+    entry->stale        = 0;
+    ++cache->count;
+
+    ucs_trace("ep %p: rkey_cache add rkey %p for 0x%"PRIx64" len %zu", ep,
+              rkey, address, length);
+
+out:
+    *rkey_p = rkey;
+    return UCS_OK;
+}
+
+void ucp_ep_rkey_cache_release(ucp_ep_h ep, ucp_rkey_h rkey)
+{
+    ucp_rkey_cache_t *cache = ucp_ep_rkey_cache(ep);
+    ucp_rkey_cache_entry_t *entry;
+    unsigned i;
+
+    if (cache != NULL) {
+        for (i = 0; i < cache->count; ++i) {
+            entry = &cache->entries[i];
+            if (entry->rkey != rkey) {
+                continue;
+            }
+
+            ucs_assert(entry->refcount > 0);
+            if ((--entry->refcount == 0) && entry->stale) {
+                ucp_rkey_cache_remove(cache, i);
+            }
+            return;
+        }
+    }
+
+    /* the key was not cached */
+    ucp_rkey_destroy(rkey);
+}
+
+void ucp_ep_rkey_cache_invalidate(ucp_ep_h ep)
+{
+    ucp_rkey_cache_t *cache = ucp_ep_rkey_cache(ep);
+    unsigned i;
+
+    if (cache == NULL) {
+        return;
+    }
+
+    /* keys which are still used by rendezvous operations are destroyed when
+     * released */
+    i = 0;
+    while (i < cache->count) {
+        cache->entries[i].stale = 1;
+        if (cache->entries[i].refcount == 0) {
+            ucp_rkey_cache_remove(cache, i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void ucp_ep_rkey_cache_cleanup(ucp_ep_h ep)
+{
+    ucp_rkey_cache_t *cache = ucp_ep_rkey_cache(ep);
+
+    if (cache == NULL) {
+        return;
+    }
+
+    while (cache->count > 0) {
+        if (cache->entries[0].refcount != 0) {
+            ucs_debug("ep %p: rkey %p is still in use by %u operations", ep,
+                      cache->entries[0].rkey, cache->entries[0].refcount);
+            cache->entries[0].refcount = 0;
+        }
+        ucp_rkey_cache_remove(cache, 0);
+    }
+
+    ucs_free(cache);
+    ucp_ep_ext_proto(ep)->rkey_cache = NULL;
+}
+
 static ucp_lane_index_t ucp_config_find_rma_lane(ucp_context_h context,
                                                  const ucp_ep_config_t *config,
                                                  ucs_memory_type_t mem_type,
@@ -51,6 +51,7 @@ typedef struct ucp_worker_iface         ucp_worker_iface_t;
 typedef struct ucp_worker_cm            ucp_worker_cm_t;
 typedef struct ucp_rma_proto            ucp_rma_proto_t;
 typedef struct ucp_amo_proto            ucp_amo_proto_t;
+typedef struct ucp_rkey_cache           ucp_rkey_cache_t;
 
 
 /**
@@ -62,6 +63,7 @@ enum {
     UCP_AM_ID_EAGER_ONLY        =  2, /* Single packet eager TAG */
     UCP_AM_ID_EAGER_FIRST       =  3, /* First eager fragment */
     UCP_AM_ID_EAGER_MIDDLE      =  4, /* Middle eager fragment */
+    UCP_AM_ID_EAGER_BUNDLE      =  5, /* Bundle of single packet eager TAGs */
 
     UCP_AM_ID_EAGER_SYNC_ONLY   =  6, /* Single packet eager-sync */
     UCP_AM_ID_EAGER_SYNC_FIRST  =  7, /* First eager-sync fragment */
@@ -73,6 +75,8 @@ enum {
                                           with a generic datatype */
     UCP_AM_ID_RNDV_DATA         =  12, /* Rndv data fragments when using software
                                           rndv (bcopy) */
+    UCP_AM_ID_STREAM_CREDIT     =  13, /* Stream data credit granted by the
+                                          receiver */
     UCP_AM_ID_OFFLOAD_SYNC_ACK  =  14, /* Eager sync ack for tag offload proto */
 
     UCP_AM_ID_STREAM_DATA       =  15, /* Eager STREAM packet */
@@ -91,6 +95,15 @@ enum {
     UCP_AM_ID_SINGLE_REPLY      =  25, /* For user defined AM when a reply
                                           is needed */
     UCP_AM_ID_MULTI_REPLY       =  26,
+    UCP_AM_ID_RNDV_DATA_CREDIT  =  27, /* Rndv data fragment which asks the
+                                          receiver for more credit */
+    UCP_AM_ID_RNDV_CREDIT       =  28, /* Rndv data credit granted by the
+                                          receiver */
+    UCP_AM_ID_AM_RNDV_RTS       =  29, /* Ready-to-Send of a user defined AM
+                                          which uses rendezvous */
+    UCP_AM_ID_AM_BATCH          =  30, /* Batch of user defined AMs */
+    UCP_AM_ID_STREAM_RNDV_RTS   =  31, /* Ready-to-Send of stream data which
+                                          uses rendezvous */
     UCP_AM_ID_LAST
 };
 
@@ -131,4 +144,16 @@ typedef void (*ucp_am_tracer_t)(ucp_worker_h worker, uct_am_trace_type_t type,
 typedef void (*ucp_request_callback_t)(ucp_request_t *req);
 
 
+/**
+ * Kind of the user callback of a request, used to invoke it later from another
+ * thread.
+ */
+typedef enum {
+    UCP_REQUEST_CB_SEND,
+    UCP_REQUEST_CB_TAG_RECV,
+    UCP_REQUEST_CB_STREAM_RECV,
+    UCP_REQUEST_CB_FLUSH_WORKER
+} ucp_request_cb_type_t;
+
+
 #endif
@@ -18,6 +18,7 @@
 #include <ucp/wireup/wireup_ep.h>
 #include <ucp/tag/eager.h>
 #include <ucp/tag/offload.h>
+#include <ucp/tag/rndv.h>
 #include <ucp/stream/stream.h>
 #include <ucs/config/parser.h>
 #include <ucs/datastruct/mpool.inl>
@@ -28,6 +29,8 @@
 #include <sys/poll.h>
 #include <sys/eventfd.h>
 #include <sys/epoll.h>
+#include <inttypes.h>
+#include <sched.h>
 
 
 #define UCP_WORKER_HEADROOM_SIZE \
@@ -419,6 +422,8 @@ static unsigned ucp_worker_iface_err_handle_progress(void *arg)
         }
     }
 
+    ucp_rndv_get_sched_purge(ucp_ep, status);
+
     /* Move failed lane to index 0 */
     if ((failed_lane != 0) && (failed_lane != UCP_NULL_LANE)) {
         ucp_ep->uct_eps[0] = ucp_ep->uct_eps[failed_lane];
@@ -456,12 +461,12 @@ static unsigned ucp_worker_iface_err_handle_progress(void *arg)
 
     ucp_ep->am_lane = 0;
 
-    if (ucp_ep_ext_gen(ucp_ep)->err_cb != NULL) {
+    if (ucp_ep_err_cb(ucp_ep) != NULL) {
         ucs_assert(ucp_ep->flags & UCP_EP_FLAG_USED);
         ucs_debug("ep %p: calling user error callback %p with arg %p", ucp_ep,
-                  ucp_ep_ext_gen(ucp_ep)->err_cb,  ucp_ep_ext_gen(ucp_ep)->user_data);
-        ucp_ep_ext_gen(ucp_ep)->err_cb(ucp_ep_ext_gen(ucp_ep)->user_data, ucp_ep,
-                                       key.status);
+                  ucp_ep_err_cb(ucp_ep),  ucp_ep_ext_gen(ucp_ep)->user_data);
+        ucp_ep_err_cb(ucp_ep)(ucp_ep_ext_gen(ucp_ep)->user_data, ucp_ep,
+                              key.status);
     } else if (!(ucp_ep->flags & UCP_EP_FLAG_USED)) {
         ucs_debug("ep %p: destroy internal endpoint due to peer failure", ucp_ep);
         ucp_ep_disconnected(ucp_ep, 1);
@@ -524,7 +529,7 @@ ucs_status_t ucp_worker_set_ep_failed(ucp_worker_h worker, ucp_ep_h ucp_ep,
                                       err_handle_arg, UCS_CALLBACKQ_FLAG_ONESHOT,
                                       &prog_id);
 
-    if ((ucp_ep_ext_gen(ucp_ep)->err_cb == NULL) &&
+    if ((ucp_ep_err_cb(ucp_ep) == NULL) &&
         (ucp_ep->flags & UCP_EP_FLAG_USED)) {
         if (lane != UCP_NULL_LANE) {
             rsc_index = ucp_ep_get_rsc_index(ucp_ep, lane);
@@ -589,6 +594,23 @@ ucp_worker_iface_error_handler(void *arg, uct_ep_h uct_ep, ucs_status_t status)
     return UCS_ERR_NO_ELEM;
 }
 
+/* Progress hints of an interface: shared memory and loopback interfaces are
+ * latency sensitive, network ones may back off while idle */
+static unsigned ucp_worker_iface_progress_hints(ucp_worker_iface_t *wiface)
+{
+    ucp_context_h context = wiface->worker->context;
+
+    switch (context->tl_rscs[wiface->rsc_index].tl_rsc.dev_type) {
+    case UCT_DEVICE_TYPE_SHM:
+    case UCT_DEVICE_TYPE_SELF:
+        return UCT_PROGRESS_PRIO;
+    case UCT_DEVICE_TYPE_NET:
+        return context->config.ext.progress_backoff ? UCT_PROGRESS_BACKOFF : 0;
+    default:
+        return 0;
+    }
+}
+
 void ucp_worker_iface_activate(ucp_worker_iface_t *wiface, unsigned uct_flags)
 {
     ucp_worker_h worker = wiface->worker;
@@ -619,7 +641,8 @@ void ucp_worker_iface_activate(ucp_worker_iface_t *wiface, unsigned uct_flags)
     ++worker->num_active_ifaces;
 
     uct_iface_progress_enable(wiface->iface,
-                              UCT_PROGRESS_SEND | UCT_PROGRESS_RECV | uct_flags);
+                              UCT_PROGRESS_SEND | UCT_PROGRESS_RECV | uct_flags |
+                              ucp_worker_iface_progress_hints(wiface));
 }
 
 static void ucp_worker_iface_deactivate(ucp_worker_iface_t *wiface, int force)
@@ -925,6 +948,76 @@ static ucs_status_t ucp_worker_select_best_ifaces(ucp_worker_h worker,
     return UCS_OK;
 }
 
+/* Allocate an interface which is not opened yet; its attributes are taken
+ * from the context cache, if present */
+static ucs_status_t ucp_worker_iface_alloc(ucp_worker_h worker,
+                                           ucp_rsc_index_t tl_id,
+                                           ucp_worker_iface_t **wiface_p)
+{
+    ucp_context_h context = worker->context;
+    ucp_worker_iface_t *wiface;
+
+    wiface = ucs_calloc(1, sizeof(*wiface), "ucp_iface");
+    if (wiface == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    wiface->rsc_index        = tl_id;
+    wiface->worker           = worker;
+    wiface->iface            = NULL;
+    wiface->event_fd         = -1;
+    wiface->activate_count   = 0;
+    wiface->check_events_id  = UCS_CALLBACKQ_ID_NULL;
+    wiface->proxy_recv_count = 0;
+    wiface->post_count       = 0;
+    wiface->flags            = 0;
+
+    if (context->tl_iface_attrs_map & UCS_BIT(tl_id)) {
+        wiface->attr = context->tl_iface_attrs[tl_id];
+    }
+
+    *wiface_p = wiface;
+    return UCS_OK;
+}
+
+/* Interfaces which can not be connected to are not a part of the worker
+ * address, so they are opened only when the first endpoint uses them */
+static int ucp_worker_iface_is_lazy(ucp_context_h context, ucp_rsc_index_t tl_id)
+{
+    uct_iface_attr_t *attr = &context->tl_iface_attrs[tl_id];
+
+    return context->config.ext.lazy_iface_open &&
+           (context->tl_iface_attrs_map & UCS_BIT(tl_id)) &&
+           !(attr->cap.flags & (UCT_IFACE_FLAG_CONNECT_TO_IFACE |
+                                UCT_IFACE_FLAG_CONNECT_TO_EP));
+}
+
+static void ucp_worker_iface_params_init(ucp_context_h context,
+                                         ucp_rsc_index_t tl_id,
+                                         uct_iface_params_t *iface_params)
+{
+    ucp_tl_resource_desc_t *resource = &context->tl_rscs[tl_id];
+
+    iface_params->field_mask = UCT_IFACE_PARAM_FIELD_OPEN_MODE;
+    if (resource->flags & UCP_TL_RSC_FLAG_SOCKADDR) {
+        iface_params->open_mode            = UCT_IFACE_OPEN_MODE_SOCKADDR_CLIENT;
+    } else {
+        iface_params->open_mode            = UCT_IFACE_OPEN_MODE_DEVICE;
+        iface_params->field_mask          |= UCT_IFACE_PARAM_FIELD_DEVICE;
+        iface_params->mode.device.tl_name  = resource->tl_rsc.tl_name;
+        iface_params->mode.device.dev_name = resource->tl_rsc.dev_name;
+    }
+}
+
+static void ucp_worker_iface_set_mem_type_access(ucp_context_h context,
+                                                 ucp_rsc_index_t tl_id)
+{
+    ucp_tl_resource_desc_t *resource = &context->tl_rscs[tl_id];
+
+    context->mem_type_access_tls[context->tl_mds[resource->md_index].
+                                 attr.cap.access_mem_type] |= UCS_BIT(tl_id);
+}
+
 /**
  * @brief  Open all resources as interfaces on this worker
  *
@@ -932,7 +1025,9 @@ static ucs_status_t ucp_worker_select_best_ifaces(ucp_worker_h worker,
  * bitmap in the context. If bitmap is not set, the routine opens interfaces
  * on all available resources and select the best ones. Then it caches obtained
  * bitmap on the context, so the next workers could use it instead of
- * constructing it themselves.
+ * constructing it themselves. Interfaces which can not be connected to are
+ * kept closed until an endpoint uses them, see @ref ucp_worker_iface_open_lazy;
+ * only their attributes, cached on the context, are used meanwhile.
  *
  * @param [in]  worker     UCP worker.
  *
@@ -941,7 +1036,6 @@ static ucs_status_t ucp_worker_select_best_ifaces(ucp_worker_h worker,
 static ucs_status_t ucp_worker_add_resource_ifaces(ucp_worker_h worker)
 {
     ucp_context_h context = worker->context;
-    ucp_tl_resource_desc_t *resource;
     uct_iface_params_t iface_params;
     ucp_rsc_index_t tl_id, iface_id;
     ucp_worker_iface_t *wiface;
@@ -967,23 +1061,25 @@ static ucs_status_t ucp_worker_add_resource_ifaces(ucp_worker_h worker)
 
     iface_id = 0;
     ucs_for_each_bit(tl_id, tl_bitmap) {
-        iface_params.field_mask = UCT_IFACE_PARAM_FIELD_OPEN_MODE;
-        resource = &context->tl_rscs[tl_id];
-
-        if (resource->flags & UCP_TL_RSC_FLAG_SOCKADDR) {
-            iface_params.open_mode            = UCT_IFACE_OPEN_MODE_SOCKADDR_CLIENT;
-        } else {
-            iface_params.open_mode            = UCT_IFACE_OPEN_MODE_DEVICE;
-            iface_params.field_mask          |= UCT_IFACE_PARAM_FIELD_DEVICE;
-            iface_params.mode.device.tl_name  = resource->tl_rsc.tl_name;
-            iface_params.mode.device.dev_name = resource->tl_rsc.dev_name;
+        if (ucp_worker_iface_is_lazy(context, tl_id)) {
+            status = ucp_worker_iface_alloc(worker, tl_id,
+                                            &worker->ifaces[iface_id++]);
+            if (status != UCS_OK) {
+                return status;
+            }
+            continue;
         }
 
+        ucp_worker_iface_params_init(context, tl_id, &iface_params);
         status = ucp_worker_iface_open(worker, tl_id, &iface_params,
-                                       &worker->ifaces[iface_id++]);
+                                       &worker->ifaces[iface_id]);
         if (status != UCS_OK) {
             return status;
         }
+
+        /* Cache the attributes, so next workers could skip opening the iface */
+        context->tl_iface_attrs[tl_id]  = worker->ifaces[iface_id++]->attr;
+        context->tl_iface_attrs_map    |= UCS_BIT(tl_id);
     }
 
     if (!ctx_tl_bitmap) {
@@ -1017,8 +1113,17 @@ static ucs_status_t ucp_worker_add_resource_ifaces(ucp_worker_h worker)
 
     iface_id = 0;
     ucs_for_each_bit(tl_id, tl_bitmap) {
-        status = ucp_worker_iface_init(worker, tl_id,
-                                       worker->ifaces[iface_id++]);
+        wiface = worker->ifaces[iface_id++];
+        if (ucp_worker_iface_is_lazy(context, tl_id)) {
+            if (wiface->iface != NULL) {
+                /* Was opened only to query its attributes */
+                ucp_worker_uct_iface_close(wiface);
+            }
+            ucp_worker_iface_set_mem_type_access(context, tl_id);
+            continue;
+        }
+
+        status = ucp_worker_iface_init(worker, tl_id, wiface);
         if (status != UCS_OK) {
             return status;
         }
@@ -1037,6 +1142,9 @@ static void ucp_worker_close_ifaces(ucp_worker_h worker)
         wiface = worker->ifaces[iface_id];
         if (wiface->iface != NULL) {
             ucp_worker_iface_cleanup(wiface);
+        } else {
+            /* Not opened yet */
+            ucs_free(wiface);
         }
     }
     ucs_free(worker->ifaces);
@@ -1055,20 +1163,11 @@ ucs_status_t ucp_worker_iface_open(ucp_worker_h worker, ucp_rsc_index_t tl_id,
     ucp_worker_iface_t *wiface;
     ucs_status_t status;
 
-    wiface = ucs_calloc(1, sizeof(*wiface), "ucp_iface");
-    if (wiface == NULL) {
-        return UCS_ERR_NO_MEMORY;
+    status = ucp_worker_iface_alloc(worker, tl_id, &wiface);
+    if (status != UCS_OK) {
+        return status;
     }
 
-    wiface->rsc_index        = tl_id;
-    wiface->worker           = worker;
-    wiface->event_fd         = -1;
-    wiface->activate_count   = 0;
-    wiface->check_events_id  = UCS_CALLBACKQ_ID_NULL;
-    wiface->proxy_recv_count = 0;
-    wiface->post_count       = 0;
-    wiface->flags            = 0;
-
     /* Read interface or md configuration */
     if (resource->flags & UCP_TL_RSC_FLAG_SOCKADDR) {
         cfg_tl_name = NULL;
@@ -1137,8 +1236,7 @@ err_free_iface:
 ucs_status_t ucp_worker_iface_init(ucp_worker_h worker, ucp_rsc_index_t tl_id,
                                    ucp_worker_iface_t *wiface)
 {
-    ucp_context_h context            = worker->context;
-    ucp_tl_resource_desc_t *resource = &context->tl_rscs[tl_id];
+    ucp_context_h context = worker->context;
     ucs_status_t status;
 
     ucs_assert(wiface != NULL);
@@ -1147,7 +1245,8 @@ ucs_status_t ucp_worker_iface_init(ucp_worker_h worker, ucp_rsc_index_t tl_id,
     if (wiface->attr.cap.flags & UCP_WORKER_UCT_ALL_EVENT_CAP_FLAGS) {
         status = uct_iface_event_fd_get(wiface->iface, &wiface->event_fd);
         if (status != UCS_OK) {
-            goto out_close_iface;
+            wiface->event_fd = -1;
+            return status;
         }
 
         /* Register event handler without actual events so we could modify it later. */
@@ -1168,7 +1267,7 @@ ucs_status_t ucp_worker_iface_init(ucp_worker_h worker, ucp_rsc_index_t tl_id,
         status = uct_iface_set_am_tracer(wiface->iface, ucp_worker_am_tracer,
                                          worker);
         if (status != UCS_OK) {
-            goto out_close_iface;
+            return status;
         }
 
         if (context->config.ext.adaptive_progress &&
@@ -1180,13 +1279,44 @@ ucs_status_t ucp_worker_iface_init(ucp_worker_h worker, ucp_rsc_index_t tl_id,
         }
     }
 
-    context->mem_type_access_tls[context->tl_mds[resource->md_index].
-                                 attr.cap.access_mem_type] |= UCS_BIT(tl_id);
-
+    ucp_worker_iface_set_mem_type_access(context, tl_id);
     return UCS_OK;
+}
 
-out_close_iface:
-    ucp_worker_uct_iface_close(wiface);
+ucs_status_t ucp_worker_iface_open_lazy(ucp_worker_h worker,
+                                        ucp_rsc_index_t tl_id)
+{
+    ucp_context_h context    = worker->context;
+    ucp_rsc_index_t iface_id = ucs_bitmap2idx(context->tl_bitmap, tl_id);
+    ucp_worker_iface_t *wiface;
+    uct_iface_params_t iface_params;
+    ucs_status_t status;
+
+    if (worker->ifaces[iface_id]->iface != NULL) {
+        return UCS_OK;
+    }
+
+    UCS_ASYNC_BLOCK(&worker->async);
+
+    ucp_worker_iface_params_init(context, tl_id, &iface_params);
+    status = ucp_worker_iface_open(worker, tl_id, &iface_params, &wiface);
+    if (status != UCS_OK) {
+        goto out;
+    }
+
+    status = ucp_worker_iface_init(worker, tl_id, wiface);
+    if (status != UCS_OK) {
+        ucp_worker_iface_cleanup(wiface);
+        goto out;
+    }
+
+    ucs_free(worker->ifaces[iface_id]);
+    worker->ifaces[iface_id] = wiface;
+    ucs_debug("worker %p: opened interface[%d]=%p on demand", worker, tl_id,
+              wiface->iface);
+
+out:
+    UCS_ASYNC_UNBLOCK(&worker->async);
     return status;
 }
 
@@ -1558,8 +1688,15 @@ static ucs_status_t ucp_worker_init_mpools(ucp_worker_h worker)
         goto err_release_reg_mpool;
     }
 
+    status = ucp_am_worker_init(worker);
+    if (status != UCS_OK) {
+        goto err_release_rndv_frag_mpool;
+    }
+
     return UCS_OK;
 
+err_release_rndv_frag_mpool:
+    ucs_mpool_cleanup(&worker->rndv_frag_mp, 0);
 err_release_reg_mpool:
     ucs_mpool_cleanup(&worker->reg_mp, 0);
 err_release_am_mpool:
@@ -1617,6 +1754,148 @@ static ucs_mpool_ops_t ucp_rkey_mpool_ops = {
     .obj_cleanup   = NULL
 };
 
+static ucs_mpool_ops_t ucp_ep_ext_mpool_ops = {
+    .chunk_alloc   = ucs_mpool_chunk_malloc,
+    .chunk_release = ucs_mpool_chunk_free,
+    .obj_init      = NULL,
+    .obj_cleanup   = NULL
+};
+
+static ucs_mpool_ops_t ucp_worker_cmpl_mpool_ops = {
+    .chunk_alloc   = ucs_mpool_chunk_malloc,
+    .chunk_release = ucs_mpool_chunk_free,
+    .obj_init      = NULL,
+    .obj_cleanup   = NULL
+};
+
+void ucp_worker_progress_thread_defer(ucp_worker_h worker, ucp_request_t *req,
+                                      ucp_request_cb_type_t cb_type)
+{
+    ucp_worker_cmpl_t *cmpl;
+
+    cmpl = ucs_mpool_get(&worker->progress_thread.cmpl_mp);
+    if (cmpl == NULL) {
+        ucs_fatal("worker %p: failed to defer completion of request %p",
+                  worker, req);
+    }
+
+    ucs_trace_req("deferring completion of request %p to application thread",
+                  req);
+    cmpl->req     = req;
+    cmpl->cb_type = cb_type;
+    if (ucs_queue_is_empty(&worker->progress_thread.cmpl_q)) {
+        /* wake up an application thread which waits for events */
+        ucp_worker_signal_internal(worker);
+    }
+    ucs_queue_push(&worker->progress_thread.cmpl_q, &cmpl->queue);
+}
+
+/* Invoke the callbacks of the requests completed by the progress thread.
+ * Must be called with the worker lock held. */
+static unsigned ucp_worker_progress_thread_dispatch(ucp_worker_h worker)
+{
+    unsigned count = 0;
+    ucp_worker_cmpl_t *cmpl;
+    ucp_request_t *req;
+
+    while (!ucs_queue_is_empty(&worker->progress_thread.cmpl_q)) {
+        cmpl = ucs_queue_pull_elem_non_empty(&worker->progress_thread.cmpl_q,
+                                             ucp_worker_cmpl_t, queue);
+        req  = cmpl->req;
+        switch (cmpl->cb_type) {
+        case UCP_REQUEST_CB_SEND:
+            ucp_request_complete(req, send.cb, req->status);
+            break;
+        case UCP_REQUEST_CB_TAG_RECV:
+            ucp_request_complete(req, recv.tag.cb, req->status,
+                                 &req->recv.tag.info);
+            break;
+        case UCP_REQUEST_CB_STREAM_RECV:
+            ucp_request_complete(req, recv.stream.cb, req->status,
+                                 req->recv.stream.length);
+            break;
+        case UCP_REQUEST_CB_FLUSH_WORKER:
+            ucp_request_complete(req, flush_worker.cb, req->status);
+            break;
+        }
+        ucs_mpool_put(cmpl);
+        ++count;
+    }
+
+    return count;
+}
+
+static void *ucp_worker_progress_thread_func(void *arg)
+{
+    ucp_worker_h worker = arg;
+    unsigned count;
+
+    worker->progress_thread.thread = pthread_self();
+
+    while (!worker->progress_thread.stop) {
+        /* an application thread which holds the worker either progresses it,
+         * or posts an operation and would release it shortly */
+        if (!UCP_WORKER_THREAD_CS_TRY_ENTER_CONDITIONAL(worker)) {
+            sched_yield();
+            continue;
+        }
+
+        ucs_assert(worker->inprogress++ == 0);
+        count = uct_worker_progress(worker->uct);
+        ucs_async_check_miss(&worker->async);
+        ucs_assert(--worker->inprogress == 0);
+
+        UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+
+        if (count == 0) {
+            if (worker->progress_thread.idle_usec > 0) {
+                usleep(worker->progress_thread.idle_usec);
+            } else {
+                sched_yield();
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static ucs_status_t ucp_worker_progress_thread_start(ucp_worker_h worker)
+{
+    ucp_context_h context = worker->context;
+    int ret;
+
+    worker->progress_thread.stop      = 0;
+    worker->progress_thread.idle_usec = context->config.ext.progress_thread_idle *
+                                        UCS_USEC_PER_SEC;
+
+    /* from now on, callbacks of requests completed on the progress thread are
+     * deferred to the application threads; set before the thread starts so
+     * that its first completions are deferred as well */
+    worker->flags |= UCP_WORKER_FLAG_PROGRESS_THREAD;
+
+    ret = pthread_create(&worker->progress_thread.thread, NULL,
+                         ucp_worker_progress_thread_func, worker);
+    if (ret != 0) {
+        ucs_error("failed to create progress thread: %s", strerror(ret));
+        worker->flags &= ~UCP_WORKER_FLAG_PROGRESS_THREAD;
+        return UCS_ERR_IO_ERROR;
+    }
+
+    ucs_debug("worker %p: started progress thread", worker);
+    return UCS_OK;
+}
+
+static void ucp_worker_progress_thread_stop(ucp_worker_h worker)
+{
+    worker->progress_thread.stop = 1;
+    pthread_join(worker->progress_thread.thread, NULL);
+    worker->flags &= ~UCP_WORKER_FLAG_PROGRESS_THREAD;
+
+    UCS_ASYNC_BLOCK(&worker->async);
+    ucp_worker_progress_thread_dispatch(worker);
+    UCS_ASYNC_UNBLOCK(&worker->async);
+}
+
 ucs_status_t ucp_worker_create(ucp_context_h context,
                                const ucp_worker_params_t *params,
                                ucp_worker_h *worker_p)
@@ -1649,6 +1928,9 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
 
         if (params->thread_mode == UCS_THREAD_MODE_MULTI) {
             worker->flags |= UCP_WORKER_FLAG_MT;
+            if (context->config.ext.mt_try_progress) {
+                worker->flags |= UCP_WORKER_FLAG_MT_TRY_PROGRESS;
+            }
         }
 #else
         if (params->thread_mode != UCS_THREAD_MODE_SINGLE) {
@@ -1657,6 +1939,16 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
 #endif
     }
 
+    if (context->config.ext.progress_thread) {
+#if ENABLE_MT
+        /* the progress thread and the application use the worker concurrently */
+        uct_thread_mode = UCS_THREAD_MODE_SERIALIZED;
+        worker->flags  |= UCP_WORKER_FLAG_MT;
+#else
+        ucs_warn("progress thread requires multi-thread support");
+#endif
+    }
+
     worker->context           = context;
     worker->uuid              = ucs_generate_uuid((uintptr_t)worker);
     worker->flush_ops_count   = 0;
@@ -1665,18 +1957,22 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     worker->ep_config_count   = 0;
     worker->num_active_ifaces = 0;
     worker->am_message_id     = ucs_generate_uuid(0);
+    worker->dt_pack_pool      = NULL;
+    worker->wait.spin_max     = ucs_time_from_sec(context->config.ext.wait_spin_time);
+    worker->wait.avg_time     = worker->wait.spin_max / 2;
     ucs_list_head_init(&worker->arm_ifaces);
     ucs_list_head_init(&worker->stream_ready_eps);
+    ucs_queue_head_init(&worker->rndv_get_sched.queue);
+    worker->rndv_get_sched.bytes       = 0;
+    worker->rndv_get_sched.ops         = 0;
+    worker->rndv_get_sched.dispatching = 0;
     ucs_list_head_init(&worker->all_eps);
     ucp_ep_match_init(&worker->ep_match_ctx);
+    ucp_wireup_select_cache_init(&worker->select_cache,
+                                 context->config.ext.lanes_cache_size);
 
     UCS_STATIC_ASSERT(sizeof(ucp_ep_ext_gen_t) <= sizeof(ucp_ep_t));
-    if (context->config.features & (UCP_FEATURE_STREAM | UCP_FEATURE_AM)) {
-        UCS_STATIC_ASSERT(sizeof(ucp_ep_ext_proto_t) <= sizeof(ucp_ep_t));
-        ucs_strided_alloc_init(&worker->ep_alloc, sizeof(ucp_ep_t), 3);
-    } else {
-        ucs_strided_alloc_init(&worker->ep_alloc, sizeof(ucp_ep_t), 2);
-    }
+    ucs_strided_alloc_init(&worker->ep_alloc, sizeof(ucp_ep_t), 2);
 
     if (params->field_mask & UCP_WORKER_PARAM_FIELD_USER_DATA) {
         worker->user_data = params->user_data;
@@ -1740,10 +2036,27 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
         goto err_req_mp_cleanup;
     }
 
+    /* create memory pool for endpoint protocol extensions */
+    status = ucs_mpool_init(&worker->ep_ext_mp, 0, sizeof(ucp_ep_ext_proto_t),
+                            0, UCS_SYS_CACHE_LINE_SIZE, 128, UINT_MAX,
+                            &ucp_ep_ext_mpool_ops, "ucp_ep_ext_proto");
+    if (status != UCS_OK) {
+        goto err_rkey_mp_cleanup;
+    }
+
+    /* create memory pool for completions deferred by the progress thread */
+    status = ucs_mpool_init(&worker->progress_thread.cmpl_mp, 0,
+                            sizeof(ucp_worker_cmpl_t), 0, 1, 128, UINT_MAX,
+                            &ucp_worker_cmpl_mpool_ops, "ucp_deferred_cmpl");
+    if (status != UCS_OK) {
+        goto err_ep_ext_mp_cleanup;
+    }
+    ucs_queue_head_init(&worker->progress_thread.cmpl_q);
+
     /* Create UCS event set which combines events from all transports */
     status = ucp_worker_wakeup_init(worker, params);
     if (status != UCS_OK) {
-        goto err_rkey_mp_cleanup;
+        goto err_cmpl_mp_cleanup;
     }
 
     if (params->field_mask & UCP_WORKER_PARAM_FIELD_CPU_MASK) {
@@ -1785,6 +2098,14 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     /* Select atomic resources */
     ucp_worker_init_atomic_tls(worker);
 
+    if ((worker->flags & UCP_WORKER_FLAG_MT) &&
+        context->config.ext.progress_thread) {
+        status = ucp_worker_progress_thread_start(worker);
+        if (status != UCS_OK) {
+            goto err_close_cms;
+        }
+    }
+
     /* At this point all UCT memory domains and interfaces are already created
      * so warn about unused environment variables.
      */
@@ -1800,6 +2121,10 @@ err_close_ifaces:
     ucp_tag_match_cleanup(&worker->tm);
 err_wakeup_cleanup:
     ucp_worker_wakeup_cleanup(worker);
+err_cmpl_mp_cleanup:
+    ucs_mpool_cleanup(&worker->progress_thread.cmpl_mp, 1);
+err_ep_ext_mp_cleanup:
+    ucs_mpool_cleanup(&worker->ep_ext_mp, 1);
 err_rkey_mp_cleanup:
     ucs_mpool_cleanup(&worker->rkey_mp, 1);
 err_req_mp_cleanup:
@@ -1843,9 +2168,16 @@ void ucp_worker_destroy(ucp_worker_h worker)
 {
     ucs_trace_func("worker=%p", worker);
 
+    if (worker->flags & UCP_WORKER_FLAG_PROGRESS_THREAD) {
+        ucp_worker_progress_thread_stop(worker);
+    }
+
     UCS_ASYNC_BLOCK(&worker->async);
     ucs_free(worker->am_cbs);
     ucp_worker_destroy_eps(worker);
+    /* rendezvous gets which waited for the budget were purged with their
+     * endpoints */
+    ucs_assert(ucs_queue_is_empty(&worker->rndv_get_sched.queue));
     ucp_worker_remove_am_handlers(worker);
     ucp_worker_close_cms(worker);
     UCS_ASYNC_UNBLOCK(&worker->async);
@@ -1854,14 +2186,21 @@ void ucp_worker_destroy(ucp_worker_h worker)
     ucs_mpool_cleanup(&worker->am_mp, 1);
     ucs_mpool_cleanup(&worker->reg_mp, 1);
     ucs_mpool_cleanup(&worker->rndv_frag_mp, 1);
+    ucp_am_worker_cleanup(worker);
+    if (worker->dt_pack_pool != NULL) {
+        ucp_dt_pack_pool_destroy(worker->dt_pack_pool);
+    }
     ucp_worker_close_ifaces(worker);
     ucp_tag_match_cleanup(&worker->tm);
     ucp_worker_wakeup_cleanup(worker);
+    ucs_mpool_cleanup(&worker->progress_thread.cmpl_mp, 1);
+    ucs_mpool_cleanup(&worker->ep_ext_mp, 1);
     ucs_mpool_cleanup(&worker->rkey_mp, 1);
     ucs_mpool_cleanup(&worker->req_mp, 1);
     uct_worker_destroy(worker->uct);
     ucs_async_context_cleanup(&worker->async);
     ucp_ep_match_cleanup(&worker->ep_match_ctx);
+    ucp_wireup_select_cache_cleanup(&worker->select_cache);
     ucs_strided_alloc_cleanup(&worker->ep_alloc);
     UCS_STATS_NODE_FREE(worker->tm_offload_stats);
     UCS_STATS_NODE_FREE(worker->stats);
@@ -1908,20 +2247,39 @@ ucs_status_t ucp_worker_query(ucp_worker_h worker,
     return status;
 }
 
-unsigned ucp_worker_progress(ucp_worker_h worker)
+static UCS_F_ALWAYS_INLINE unsigned
+ucp_worker_progress_common(ucp_worker_h worker, unsigned max_events)
 {
     unsigned count;
 
+    if (ucs_unlikely(worker->flags & UCP_WORKER_FLAG_MT_TRY_PROGRESS)) {
+        /* Another thread which holds the worker either progresses it, or
+         * posts an operation and would release it shortly, so there is no
+         * point to wait for it */
+        if (!UCP_WORKER_THREAD_CS_TRY_ENTER_CONDITIONAL(worker)) {
+            return 0;
+        }
+    } else {
+        UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+    }
+
     /* worker->inprogress is used only for assertion check.
      * coverity[assert_side_effect]
      */
-    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
-
     /* check that ucp_worker_progress is not called from within ucp_worker_progress */
     ucs_assert(worker->inprogress++ == 0);
-    count = uct_worker_progress(worker->uct);
+    if (max_events == UINT_MAX) {
+        count = uct_worker_progress(worker->uct);
+    } else {
+        count = ucs_callbackq_dispatch_budget(&worker->uct->progress_q,
+                                              max_events);
+    }
     ucs_async_check_miss(&worker->async);
 
+    if (ucs_unlikely(!ucs_queue_is_empty(&worker->progress_thread.cmpl_q))) {
+        count += ucp_worker_progress_thread_dispatch(worker);
+    }
+
     /* coverity[assert_side_effect] */
     ucs_assert(--worker->inprogress == 0);
 
@@ -1930,6 +2288,16 @@ unsigned ucp_worker_progress(ucp_worker_h worker)
     return count;
 }
 
+unsigned ucp_worker_progress(ucp_worker_h worker)
+{
+    return ucp_worker_progress_common(worker, UINT_MAX);
+}
+
+unsigned ucp_worker_progress_budget(ucp_worker_h worker, unsigned max_events)
+{
+    return ucp_worker_progress_common(worker, max_events);
+}
+
 ssize_t ucp_stream_worker_poll(ucp_worker_h worker,
                                ucp_stream_poll_ep_t *poll_eps,
                                size_t max_eps, unsigned flags)
@@ -1937,6 +2305,7 @@ ssize_t ucp_stream_worker_poll(ucp_worker_h worker,
     ssize_t            count = 0;
     ucp_ep_ext_proto_t *ep_ext;
     ucp_ep_h           ep;
+    unsigned           events;
 
     UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_STREAM,
                                     return UCS_ERR_INVALID_PARAM);
@@ -1946,8 +2315,25 @@ ssize_t ucp_stream_worker_poll(ucp_worker_h worker,
     while ((count < max_eps) && !ucs_list_is_empty(&worker->stream_ready_eps)) {
         ep_ext                    = ucp_stream_worker_dequeue_ep_head(worker);
         ep                        = ucp_ep_from_ext_proto(ep_ext);
+        events                    = 0;
+        poll_eps[count].length    = 0;
+
+        if ((ep->flags & (UCP_EP_FLAG_STREAM_HAS_DATA |
+                          UCP_EP_FLAG_STREAM_NO_POLL_IN)) ==
+            UCP_EP_FLAG_STREAM_HAS_DATA) {
+            events                 |= UCP_STREAM_POLL_FLAG_IN;
+            poll_eps[count].length  = ucp_stream_ep_ready_length(ep_ext);
+        }
+
+        if (ep->flags & UCP_EP_FLAG_STREAM_OUT_READY) {
+            events    |= UCP_STREAM_POLL_FLAG_OUT;
+            ep->flags &= ~UCP_EP_FLAG_STREAM_OUT_READY;
+        }
+
+        ucs_assert(events != 0);
         poll_eps[count].ep        = ep;
         poll_eps[count].user_data = ucp_ep_ext_gen(ep)->user_data;
+        poll_eps[count].flags     = events;
         ++count;
     }
 
@@ -2009,6 +2395,12 @@ ucs_status_t ucp_worker_arm(ucp_worker_h worker)
 
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
 
+    /* Completions of the progress thread are reported by ucp_worker_progress() */
+    if (!ucs_queue_is_empty(&worker->progress_thread.cmpl_q)) {
+        status = UCS_ERR_BUSY;
+        goto out_unlock;
+    }
+
     /* Go over arm_list of active interfaces which support events and arm them */
     ucs_list_for_each(wiface, &worker->arm_ifaces, arm_list) {
         ucs_assert(wiface->activate_count > 0);
@@ -2034,11 +2426,63 @@ void ucp_worker_wait_mem(ucp_worker_h worker, void *address)
     ucs_arch_wait_mem(address);
 }
 
+/* Time to spin before blocking: twice the average time until an event if
+ * events are expected soon, otherwise a fraction of the maximum, to catch the
+ * beginning of a new burst of events */
+static ucs_time_t ucp_worker_wait_spin_time(ucp_worker_h worker)
+{
+    ucs_time_t avg_time;
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+    avg_time = worker->wait.avg_time;
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+
+    if (avg_time < worker->wait.spin_max) {
+        return ucs_min(2 * avg_time, worker->wait.spin_max);
+    }
+
+    return worker->wait.spin_max / 8;
+}
+
+/* Progress the worker until it has events, for at most the spin time */
+static int ucp_worker_wait_spin(ucp_worker_h worker, ucs_time_t start_time)
+{
+    ucs_time_t spin_time = ucp_worker_wait_spin_time(worker);
+
+    if (spin_time == 0) {
+        return 0;
+    }
+
+    do {
+        if (ucp_worker_progress(worker)) {
+            return 1;
+        }
+
+        if (worker->context->config.ext.wait_spin_yield) {
+            sched_yield();
+        }
+    } while ((ucs_get_time() - start_time) < spin_time);
+
+    return 0;
+}
+
+static void ucp_worker_wait_update(ucp_worker_h worker, ucs_time_t start_time)
+{
+    ucs_time_t elapsed = ucs_get_time() - start_time;
+
+    /* moving average with weight 1/4 for the last sample, several threads may
+     * wait on the same worker */
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+    worker->wait.avg_time = (3 * worker->wait.avg_time + elapsed) / 4;
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+}
+
 ucs_status_t ucp_worker_wait(ucp_worker_h worker)
 {
     ucp_worker_iface_t *wiface;
     struct pollfd *pfd;
     ucs_status_t status;
+    ucs_time_t start_time;
     nfds_t nfds;
     int ret;
 
@@ -2047,6 +2491,16 @@ ucs_status_t ucp_worker_wait(ucp_worker_h worker)
     UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_WAKEUP,
                                     return UCS_ERR_INVALID_PARAM);
 
+    if (worker->wait.spin_max != 0) {
+        start_time = ucs_get_time();
+        if (ucp_worker_wait_spin(worker, start_time)) {
+            ucp_worker_wait_update(worker, start_time);
+            return UCS_OK;
+        }
+    } else {
+        start_time = 0;
+    }
+
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
 
     status = ucp_worker_arm(worker);
@@ -2082,7 +2536,7 @@ ucs_status_t ucp_worker_wait(ucp_worker_h worker)
         if (ret >= 0) {
             ucs_assertv(ret == 1, "ret=%d", ret);
             status = UCS_OK;
-            goto out;
+            goto out_update;
         } else {
             if (errno != EINTR) {
                 ucs_error("poll(nfds=%d) returned %d: %m", (int)nfds, ret);
@@ -2094,6 +2548,10 @@ ucs_status_t ucp_worker_wait(ucp_worker_h worker)
 
 out_unlock:
      UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+out_update:
+    if ((status == UCS_OK) && (worker->wait.spin_max != 0)) {
+        ucp_worker_wait_update(worker, start_time);
+    }
 out:
     return status;
 }
@@ -2127,6 +2585,103 @@ void ucp_worker_release_address(ucp_worker_h worker, ucp_address_t *address)
 }
 
 
+static void ucp_worker_print_thresh(FILE *stream, const char *name,
+                                    size_t thresh,
+                                    const ucp_ep_thresh_tune_t *tune)
+{
+    if (thresh == SIZE_MAX) {
+        fprintf(stream, " %s (inf)", name);
+    } else {
+        fprintf(stream, " %s %zu", name, thresh);
+    }
+
+    if (tune->max != 0) {
+        fprintf(stream, " [tuned %zu..%zu, %u updates]", tune->min, tune->max,
+                tune->num_updates);
+    }
+}
+
+static void ucp_worker_print_ep_config_thresh(FILE *stream, ucp_worker_h worker,
+                                              ucp_ep_cfg_index_t cfg_index)
+{
+    const ucp_ep_config_t *config = &worker->ep_config[cfg_index];
+
+    if (config->tag.lane == UCP_NULL_LANE) {
+        return;
+    }
+
+    fprintf(stream, "#        ep_config[%d]:", cfg_index);
+    ucp_worker_print_thresh(stream, "zcopy_thresh",
+                            config->tag.eager.mem_type_zcopy_thresh[UCS_MEMORY_TYPE_HOST],
+                            &config->tune[UCP_EP_TUNE_ZCOPY]);
+    ucp_worker_print_thresh(stream, "rndv_thresh",
+                            ucs_min(config->tag.rndv.rma_thresh,
+                                    config->tag.rndv.am_thresh),
+                            &config->tune[UCP_EP_TUNE_RNDV]);
+    fprintf(stream, "\n");
+}
+
+static void ucp_worker_print_ep_mem_line(FILE *stream, const char *name,
+                                         unsigned count, size_t size)
+{
+    fprintf(stream, "#%24s: %u x %zu bytes\n", name, count, size);
+}
+
+static void ucp_worker_print_ep_memory(FILE *stream, ucp_worker_h worker)
+{
+    size_t rkey_cache_size = sizeof(ucp_rkey_cache_t) +
+                             (sizeof(ucp_rkey_cache_entry_t) *
+                              worker->context->config.ext.rndv_rkey_cache_size);
+    unsigned num_eps       = 0;
+    unsigned num_ext       = 0;
+    unsigned num_rkey      = 0;
+    unsigned num_fc        = 0;
+    unsigned num_uct_eps   = 0;
+    ucp_ep_ext_gen_t *ep_ext_gen;
+    ucp_ep_ext_proto_t *ep_ext;
+    ucp_lane_index_t lane;
+    size_t total;
+    ucp_ep_h ep;
+
+    ucs_list_for_each(ep_ext_gen, &worker->all_eps, ep_list) {
+        ep = ucp_ep_from_ext_gen(ep_ext_gen);
+        ++num_eps;
+
+        for (lane = 0; lane < ucp_ep_num_lanes(ep); ++lane) {
+            num_uct_eps += (ep->uct_eps[lane] != NULL);
+        }
+
+        ep_ext = ep_ext_gen->proto;
+        if (ep_ext == NULL) {
+            continue;
+        }
+
+        ++num_ext;
+        num_rkey += (ep_ext->rkey_cache != NULL);
+        if (worker->context->config.features & UCP_FEATURE_STREAM) {
+            num_fc += (ep_ext->stream.fc != NULL);
+        }
+    }
+
+    total = (num_eps * (sizeof(ucp_ep_t) + sizeof(ucp_ep_ext_gen_t))) +
+            (num_ext * sizeof(ucp_ep_ext_proto_t)) +
+            (num_rkey * rkey_cache_size) +
+            (num_fc * sizeof(ucp_stream_ep_fc_t));
+
+    fprintf(stream, "#               endpoints: %u, %zu bytes\n", num_eps,
+            total);
+    ucp_worker_print_ep_mem_line(stream, "ucp_ep", num_eps, sizeof(ucp_ep_t));
+    ucp_worker_print_ep_mem_line(stream, "generic extension", num_eps,
+                                 sizeof(ucp_ep_ext_gen_t));
+    ucp_worker_print_ep_mem_line(stream, "protocol extension", num_ext,
+                                 sizeof(ucp_ep_ext_proto_t));
+    ucp_worker_print_ep_mem_line(stream, "rkey cache", num_rkey,
+                                 rkey_cache_size);
+    ucp_worker_print_ep_mem_line(stream, "stream flow control", num_fc,
+                                 sizeof(ucp_stream_ep_fc_t));
+    fprintf(stream, "#           uct endpoints: %u\n", num_uct_eps);
+}
+
 void ucp_worker_print_info(ucp_worker_h worker, FILE *stream)
 {
     ucp_context_h context = worker->context;
@@ -2134,6 +2689,7 @@ void ucp_worker_print_info(ucp_worker_h worker, FILE *stream)
     size_t address_length;
     ucs_status_t status;
     ucp_rsc_index_t rsc_index;
+    ucp_ep_cfg_index_t cfg_index;
     int first;
 
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
@@ -2145,7 +2701,8 @@ void ucp_worker_print_info(ucp_worker_h worker, FILE *stream)
     status = ucp_worker_get_address(worker, &address, &address_length);
     if (status == UCS_OK) {
         ucp_worker_release_address(worker, address);
-        fprintf(stream, "#                 address: %zu bytes\n", address_length);
+        fprintf(stream, "#                 address: %zu bytes%s\n", address_length,
+                worker->context->config.ext.address_compact ? " (compact)" : "");
     } else {
         fprintf(stream, "# <failed to get address>\n");
     }
@@ -2166,6 +2723,17 @@ void ucp_worker_print_info(ucp_worker_h worker, FILE *stream)
         fprintf(stream, "\n");
     }
 
+    if (context->config.features & UCP_FEATURE_TAG) {
+        for (cfg_index = 0; cfg_index < worker->ep_config_count; ++cfg_index) {
+            ucp_worker_print_ep_config_thresh(stream, worker, cfg_index);
+        }
+    }
+
+    ucp_worker_print_ep_memory(stream, worker);
+    fprintf(stream, "#             lanes cache: %u entries, %"PRIu64" hits, "
+            "%"PRIu64" misses\n", worker->select_cache.count,
+            worker->select_cache.hits, worker->select_cache.misses);
+
     fprintf(stream, "#\n");
 
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
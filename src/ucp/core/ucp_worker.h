@@ -9,12 +9,14 @@
 #define UCP_WORKER_H_
 
 #include "ucp_ep.h"
+#include "ucp_am.h"
 #include "ucp_context.h"
 #include "ucp_thread.h"
 
 #include <ucp/proto/proto.h>
 #include <ucp/tag/tag_match.h>
 #include <ucp/wireup/ep_match.h>
+#include <ucp/wireup/select_cache.h>
 #include <ucs/datastruct/mpool.h>
 #include <ucs/datastruct/queue_types.h>
 #include <ucs/datastruct/strided_alloc.h>
@@ -45,10 +47,18 @@
     } while (0)
 
 
+/* Evaluates to nonzero if the worker was locked, or 0 if it is currently held
+ * by another thread */
+#define UCP_WORKER_THREAD_CS_TRY_ENTER_CONDITIONAL(_worker)             \
+    (!((_worker)->flags & UCP_WORKER_FLAG_MT) ||                        \
+     ucs_async_try_block(&(_worker)->async))
+
+
 #else
 
 #define UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(_worker)
 #define UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(_worker)
+#define UCP_WORKER_THREAD_CS_TRY_ENTER_CONDITIONAL(_worker)  1
 
 #endif
 
@@ -59,10 +69,27 @@
 enum {
     UCP_WORKER_FLAG_EXTERNAL_EVENT_FD = UCS_BIT(0), /**< worker event fd is external */
     UCP_WORKER_FLAG_EDGE_TRIGGERED    = UCS_BIT(1), /**< events are edge-triggered */
-    UCP_WORKER_FLAG_MT                = UCS_BIT(2)  /**< MT locking is required */
+    UCP_WORKER_FLAG_MT                = UCS_BIT(2), /**< MT locking is required */
+    UCP_WORKER_FLAG_MT_TRY_PROGRESS   = UCS_BIT(3), /**< Skip progress if another
+                                                         thread holds the worker */
+    UCP_WORKER_FLAG_NO_DT_PACK_POOL   = UCS_BIT(4), /**< Generic datatype pack
+                                                         threads could not be
+                                                         created */
+    UCP_WORKER_FLAG_PROGRESS_THREAD   = UCS_BIT(5)  /**< The worker is progressed
+                                                         by a dedicated thread */
 };
 
 
+/**
+ * Request completion deferred by the progress thread
+ */
+typedef struct ucp_worker_cmpl {
+    ucs_queue_elem_t              queue;         /* Element in the worker queue */
+    ucp_request_t                 *req;          /* Completed request */
+    ucp_request_cb_type_t         cb_type;       /* Which callback to invoke */
+} ucp_worker_cmpl_t;
+
+
 /**
  * UCP iface flags
  */
@@ -209,6 +236,7 @@ typedef struct ucp_worker {
     uct_worker_h                  uct;           /* UCT worker handle */
     ucs_mpool_t                   req_mp;        /* Memory pool for requests */
     ucs_mpool_t                   rkey_mp;       /* Pool for small memory keys */
+    ucs_mpool_t                   ep_ext_mp;     /* Pool for endpoint protocol extensions */
     uint64_t                      atomic_tls;    /* Which resources can be used for atomics */
 
     int                           inprogress;
@@ -227,6 +255,7 @@ typedef struct ucp_worker {
     ucs_list_link_t               stream_ready_eps; /* List of EPs with received stream data */
     ucs_list_link_t               all_eps;       /* List of all endpoints */
     ucp_ep_match_ctx_t            ep_match_ctx;  /* Endpoint-to-endpoint matching context */
+    ucp_wireup_select_cache_t     select_cache;  /* Cache of lanes selection results */
     ucp_worker_iface_t            **ifaces;      /* Array of pointers to interfaces,
                                                     one for each resource */
     unsigned                      num_ifaces;    /* Number of elements in ifaces array  */
@@ -236,15 +265,37 @@ typedef struct ucp_worker {
     ucs_mpool_t                   am_mp;         /* Memory pool for AM receives */
     ucs_mpool_t                   reg_mp;        /* Registered memory pool */
     ucs_mpool_t                   rndv_frag_mp;  /* Memory pool for RNDV fragments */
+    struct {
+        size_t                    bytes;         /* RNDV get data reserved by scheduled fragments */
+        unsigned                  ops;           /* Number of scheduled RNDV get fragments */
+        int                       dispatching;   /* Whether waiting requests are being resumed */
+        ucs_queue_head_t          queue;         /* RNDV get requests waiting for budget */
+    } rndv_get_sched;
     ucp_tag_match_t               tm;            /* Tag-matching queues and offload info */
     uint64_t                      am_message_id; /* For matching long am's */
     ucp_ep_h                      mem_type_ep[UCS_MEMORY_TYPE_LAST];/* memory type eps */
+    struct ucp_dt_pack_pool       *dt_pack_pool; /* Generic datatype pack threads,
+                                                    created on first use */
+    struct {
+        ucs_time_t                spin_max;      /* Maximal spin time before blocking */
+        ucs_time_t                avg_time;      /* Average time until an event */
+    } wait;
+
+    struct {
+        pthread_t                 thread;        /* Background progress thread */
+        volatile int              stop;          /* Tells the thread to exit */
+        unsigned                  idle_usec;     /* Sleep time after an idle poll */
+        ucs_mpool_t               cmpl_mp;       /* Pool of deferred completions */
+        ucs_queue_head_t          cmpl_q;        /* Completions to report on an
+                                                    application thread */
+    } progress_thread;
 
     UCS_STATS_NODE_DECLARE(stats);
     UCS_STATS_NODE_DECLARE(tm_offload_stats);
 
     ucp_worker_am_entry_t        *am_cbs;          /*array of callbacks and their data */
     size_t                        am_cb_array_len; /*len of callback array */
+    ucp_am_worker_t               am;              /* Long AM reassembly state */
 
     ucs_cpu_set_t                 cpu_mask;        /* Save CPU mask for subsequent calls to ucp_worker_listen */
     unsigned                      ep_config_max;   /* Maximal number of configurations */
@@ -277,6 +328,10 @@ ucs_status_t ucp_worker_iface_open(ucp_worker_h worker, ucp_rsc_index_t tl_id,
 ucs_status_t ucp_worker_iface_init(ucp_worker_h worker, ucp_rsc_index_t tl_id,
                                    ucp_worker_iface_t *wiface);
 
+/* Open the interface of @a tl_id, if it was not opened yet */
+ucs_status_t ucp_worker_iface_open_lazy(ucp_worker_h worker,
+                                        ucp_rsc_index_t tl_id);
+
 void ucp_worker_iface_cleanup(ucp_worker_iface_t *wiface);
 
 void ucp_worker_iface_progress_ep(ucp_worker_iface_t *wiface);
@@ -285,6 +340,9 @@ void ucp_worker_iface_unprogress_ep(ucp_worker_iface_t *wiface);
 
 void ucp_worker_signal_internal(ucp_worker_h worker);
 
+void ucp_worker_progress_thread_defer(ucp_worker_h worker, ucp_request_t *req,
+                                      ucp_request_cb_type_t cb_type);
+
 void ucp_worker_iface_activate(ucp_worker_iface_t *wiface, unsigned uct_flags);
 
 int ucp_worker_err_handle_remove_filter(const ucs_callbackq_elem_t *elem,
@@ -310,6 +368,12 @@ static inline ucp_ep_h ucp_worker_get_ep_by_ptr(ucp_worker_h worker,
     return ep;
 }
 
+static UCS_F_ALWAYS_INLINE int
+ucp_worker_is_progress_thread(ucp_worker_h worker)
+{
+    return pthread_equal(pthread_self(), worker->progress_thread.thread);
+}
+
 static UCS_F_ALWAYS_INLINE ucp_worker_iface_t*
 ucp_worker_iface(ucp_worker_h worker, ucp_rsc_index_t rsc_index)
 {
@@ -9,6 +9,7 @@
 #endif
 
 #include "dt.h"
+#include "dt_pack_pool.h"
 
 #include <ucp/core/ucp_ep.inl>
 #include <ucp/core/ucp_request.h>
@@ -93,6 +94,46 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_mem_type_pack,
     return status;
 }
 
+/* Start packing a large message of a thread-safe generic datatype by the
+ * helper threads of the worker */
+static void ucp_dt_generic_pack_pipeline_start(ucp_worker_h worker,
+                                               ucp_dt_generic_t *dt,
+                                               ucp_dt_state_t *state)
+{
+    ucp_context_h context = worker->context;
+    size_t packed_size;
+    ucs_status_t status;
+
+    if ((context->config.ext.generic_dt_pack_threads == 0) ||
+        (worker->flags & UCP_WORKER_FLAG_NO_DT_PACK_POOL) ||
+        !(dt->flags & UCP_DT_GENERIC_FLAG_THREAD_SAFE) ||
+        (state->offset != 0)) {
+        return;
+    }
+
+    packed_size = dt->ops.packed_size(state->dt.generic.state);
+    if (packed_size < context->config.ext.generic_dt_pack_thresh) {
+        return;
+    }
+
+    if (worker->dt_pack_pool == NULL) {
+        status = ucp_dt_pack_pool_create(context->config.ext.generic_dt_pack_threads,
+                                         &worker->dt_pack_pool);
+        if (status != UCS_OK) {
+            /* disable packing by helper threads on this worker */
+            worker->flags |= UCP_WORKER_FLAG_NO_DT_PACK_POOL;
+            return;
+        }
+    }
+
+    status = ucp_dt_pack_pipeline_create(worker->dt_pack_pool, dt,
+                                         state->dt.generic.state, packed_size,
+                                         &state->dt.generic.pipeline);
+    if (status != UCS_OK) {
+        state->dt.generic.pipeline = NULL;
+    }
+}
+
 size_t ucp_dt_pack(ucp_worker_h worker, ucp_datatype_t datatype,
                    ucs_memory_type_t mem_type, void *dest, const void *src,
                    ucp_dt_state_t *state, size_t length)
@@ -123,11 +164,27 @@ size_t ucp_dt_pack(ucp_worker_h worker, ucp_datatype_t datatype,
         result_len = length;
         break;
 
+    case UCP_DATATYPE_STRIDED:
+        UCS_PROFILE_CALL_VOID(ucp_dt_strided_pack, datatype, dest, src,
+                              state->offset, length);
+        result_len = length;
+        break;
+
     case UCP_DATATYPE_GENERIC:
         dt = ucp_dt_generic(datatype);
-        result_len = UCS_PROFILE_NAMED_CALL("dt_pack", dt->ops.pack,
-                                            state->dt.generic.state,
-                                            state->offset, dest, length);
+        if (state->dt.generic.pipeline == NULL) {
+            ucp_dt_generic_pack_pipeline_start(worker, dt, state);
+        }
+
+        if (state->dt.generic.pipeline != NULL) {
+            result_len = UCS_PROFILE_CALL(ucp_dt_pack_pipeline_pack,
+                                          state->dt.generic.pipeline,
+                                          state->offset, dest, length);
+        } else {
+            result_len = UCS_PROFILE_NAMED_CALL("dt_pack", dt->ops.pack,
+                                                state->dt.generic.state,
+                                                state->offset, dest, length);
+        }
         break;
 
     default:
@@ -10,6 +10,7 @@
 
 #include "dt_contig.h"
 #include "dt_iov.h"
+#include "dt_strided.h"
 #include "dt_generic.h"
 
 #include <ucp/core/ucp_types.h>
@@ -17,6 +18,9 @@
 #include <ucp/api/ucp.h>
 
 
+typedef struct ucp_dt_pack_pipeline ucp_dt_pack_pipeline_t;
+
+
 /**
  * Memory registration state of a buffer/operation
  */
@@ -41,6 +45,7 @@ typedef struct ucp_dt_state {
         } iov;
         struct {
             void                  *state;
+            ucp_dt_pack_pipeline_t *pipeline;     /* Packing by helper threads */
         } generic;
     } dt;
 } ucp_dt_state_t;
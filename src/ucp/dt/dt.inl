@@ -26,6 +26,9 @@ size_t ucp_dt_length(ucp_datatype_t datatype, size_t count,
         ucs_assert(NULL != iov);
         return ucp_dt_iov_length(iov, count);
 
+    case UCP_DATATYPE_STRIDED:
+        return ucp_dt_strided_length(datatype, count);
+
     case UCP_DATATYPE_GENERIC:
         dt_gen = ucp_dt_generic(datatype);
         ucs_assert(NULL != state);
@@ -75,6 +78,16 @@ ucp_dt_unpack_only(ucp_worker_h worker, void *buffer, size_t count,
                          &iov_offset, &iovcnt_offset);
         return UCS_OK;
 
+    case UCP_DATATYPE_STRIDED:
+        if (truncation &&
+            ucs_unlikely(length > (buffer_size = ucp_dt_strided_length(datatype,
+                                                                       count)))) {
+            goto err_truncated;
+        }
+        UCS_PROFILE_CALL_VOID(ucp_dt_strided_unpack, datatype, buffer, 0, data,
+                              length);
+        return UCS_OK;
+
     case UCP_DATATYPE_GENERIC:
         dt_gen = ucp_dt_generic(datatype);
         state  = UCS_PROFILE_NAMED_CALL("dt_start", dt_gen->ops.start_unpack,
@@ -120,11 +133,15 @@ ucp_dt_recv_state_init(ucp_dt_state_t *dt_state, void *buffer,
         dt_state->dt.iov.iovcnt        = dt_count;
         dt_state->dt.iov.dt_reg        = NULL;
         break;
+    case UCP_DATATYPE_STRIDED:
+        /* strided unpack is stateless, it works by the data offset */
+        break;
     case UCP_DATATYPE_GENERIC:
         dt_gen = ucp_dt_generic(dt);
         dt_state->dt.generic.state =
             UCS_PROFILE_NAMED_CALL("dt_start", dt_gen->ops.start_unpack,
                                    dt_gen->context, buffer, dt_count);
+        dt_state->dt.generic.pipeline = NULL;
         ucs_trace("dt state %p buffer %p count %zu dt_gen state=%p", dt_state,
                   buffer, dt_count, dt_state->dt.generic.state);
         break;
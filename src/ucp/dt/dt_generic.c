@@ -9,6 +9,7 @@
 #endif
 
 #include "dt_generic.h"
+#include "dt_strided.h"
 
 #include <ucs/sys/math.h>
 #include <ucs/debug/memtrack.h>
@@ -16,6 +17,13 @@
 
 ucs_status_t ucp_dt_create_generic(const ucp_generic_dt_ops_t *ops, void *context,
                                    ucp_datatype_t *datatype_p)
+{
+    return ucp_dt_create_generic_ext(ops, context, 0, datatype_p);
+}
+
+ucs_status_t ucp_dt_create_generic_ext(const ucp_generic_dt_ops_t *ops,
+                                       void *context, unsigned flags,
+                                       ucp_datatype_t *datatype_p)
 {
     ucp_dt_generic_t *dt;
     int ret;
@@ -29,6 +37,7 @@ ucs_status_t ucp_dt_create_generic(const ucp_generic_dt_ops_t *ops, void *contex
 
     dt->ops      = *ops;
     dt->context  = context;
+    dt->flags    = flags;
     *datatype_p = ((uintptr_t)dt) | UCP_DATATYPE_GENERIC;
     return UCS_OK;
 }
@@ -40,6 +49,9 @@ void ucp_dt_destroy(ucp_datatype_t datatype)
     switch (datatype & UCP_DATATYPE_CLASS_MASK) {
     case UCP_DATATYPE_CONTIG:
         break;
+    case UCP_DATATYPE_STRIDED:
+        ucs_free(ucp_dt_strided(datatype));
+        break;
     case UCP_DATATYPE_GENERIC:
         dt = ucp_dt_generic(datatype);
         ucs_free(dt);
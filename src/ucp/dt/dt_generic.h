@@ -17,6 +17,7 @@
 typedef struct ucp_dt_generic {
     void                     *context;
     ucp_generic_dt_ops_t     ops;
+    unsigned                 flags;    /* ucp_dt_generic_flags */
 } ucp_dt_generic_t;
 
 
@@ -98,13 +98,47 @@ void ucp_dt_iov_seek(ucp_dt_iov_t *iov, size_t iovcnt, ptrdiff_t distance,
     *iov_offset = new_iov_offset;
 }
 
-size_t ucp_dt_iov_count_nonempty(const ucp_dt_iov_t *iov, size_t iovcnt)
+size_t ucp_dt_iov_count_coalesced(const ucp_dt_iov_t *iov, size_t iovcnt)
 {
+    void *end = NULL;
     size_t iov_it, count;
 
     count = 0;
     for (iov_it = 0; iov_it < iovcnt; ++iov_it) {
-        count += iov[iov_it].length != 0;
+        if (iov[iov_it].length == 0) {
+            continue;
+        }
+
+        count += iov[iov_it].buffer != end;
+        end    = UCS_PTR_BYTE_OFFSET(iov[iov_it].buffer, iov[iov_it].length);
     }
     return count;
 }
+
+size_t ucp_dt_iov_region(const ucp_dt_iov_t *iov, size_t iovcnt, size_t iov_it,
+                         void **start_p, void **end_p)
+{
+    void *start, *end, *item_end;
+
+    ucs_assert(iov[iov_it].length != 0);
+
+    start = iov[iov_it].buffer;
+    end   = UCS_PTR_BYTE_OFFSET(start, iov[iov_it].length);
+    for (++iov_it; iov_it < iovcnt; ++iov_it) {
+        if (iov[iov_it].length == 0) {
+            continue;
+        }
+
+        item_end = UCS_PTR_BYTE_OFFSET(iov[iov_it].buffer, iov[iov_it].length);
+        if ((item_end < start) || (iov[iov_it].buffer > end)) {
+            break;
+        }
+
+        start = ucs_min(start, iov[iov_it].buffer);
+        end   = ucs_max(end, item_end);
+    }
+
+    *start_p = start;
+    *end_p   = end;
+    return iov_it;
+}
@@ -89,13 +89,31 @@ void ucp_dt_iov_seek(ucp_dt_iov_t *iov, size_t iovcnt, ptrdiff_t distance,
 
 
 /**
- * Count non-empty buffers in the iov
+ * Count the buffers which remain in the iov after coalescing of adjacent
+ * non-empty buffers, as done by zero-copy protocols
  *
  * @param [in]     iov            @ref ucp_dt_iov_t buffer to count
  * @param [in]     iovcnt         Number of entries the @a iov buffer
  *
- * @return Number of non-empty buffers in the iovec
+ * @return Number of non-empty buffers in the iovec, which do not start right
+ *         after the previous non-empty one
  */
-size_t ucp_dt_iov_count_nonempty(const ucp_dt_iov_t *iov, size_t iovcnt);
+size_t ucp_dt_iov_count_coalesced(const ucp_dt_iov_t *iov, size_t iovcnt);
+
+
+/**
+ * Find the region which starts at the @a iov item @a iov_it and contains all
+ * following items, which are adjacent to or overlap with the region.
+ *
+ * @param [in]     iov            @ref ucp_dt_iov_t buffer
+ * @param [in]     iovcnt         Number of entries the @a iov buffer
+ * @param [in]     iov_it         Non-empty item to start the region from
+ * @param [out]    start_p        Region start address
+ * @param [out]    end_p          Region end address
+ *
+ * @return Index of the first item after the region
+ */
+size_t ucp_dt_iov_region(const ucp_dt_iov_t *iov, size_t iovcnt, size_t iov_it,
+                         void **start_p, void **end_p);
 
 #endif
@@ -0,0 +1,295 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2020.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "dt_pack_pool.h"
+
+#include <ucs/arch/cpu.h>
+#include <ucs/arch/bitops.h>
+#include <ucs/datastruct/queue.h>
+#include <ucs/debug/assert.h>
+#include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
+#include <ucs/sys/math.h>
+#include <string.h>
+#include <sched.h>
+
+
+static void ucp_dt_pack_chunk_do_pack(ucp_dt_pack_chunk_t *chunk)
+{
+    ucp_dt_pack_pipeline_t *pipeline = chunk->pipeline;
+    size_t offset                    = chunk->index * UCP_DT_PACK_CHUNK_SIZE;
+
+    chunk->length = pipeline->dt->ops.pack(pipeline->dt_state, offset,
+                                           chunk->data,
+                                           ucs_min(UCP_DT_PACK_CHUNK_SIZE,
+                                                   pipeline->length - offset));
+    ucs_memory_cpu_store_fence();
+    chunk->state  = UCP_DT_PACK_CHUNK_READY;
+}
+
+static void *ucp_dt_pack_pool_thread_func(void *arg)
+{
+    ucp_dt_pack_pool_t *pool = arg;
+    ucp_dt_pack_chunk_t *chunk;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && ucs_queue_is_empty(&pool->queue)) {
+            pthread_cond_wait(&pool->cond, &pool->lock);
+        }
+
+        if (pool->stop) {
+            break;
+        }
+
+        chunk = ucs_queue_pull_elem_non_empty(&pool->queue,
+                                              ucp_dt_pack_chunk_t, queue);
+        ucs_assert(chunk->state == UCP_DT_PACK_CHUNK_QUEUED);
+        chunk->state = UCP_DT_PACK_CHUNK_PACKING;
+        pthread_mutex_unlock(&pool->lock);
+
+        ucp_dt_pack_chunk_do_pack(chunk);
+
+        pthread_mutex_lock(&pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+static void ucp_dt_pack_pool_stop(ucp_dt_pack_pool_t *pool,
+                                  unsigned num_threads)
+{
+    unsigned i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < num_threads; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+}
+
+ucs_status_t ucp_dt_pack_pool_create(unsigned num_threads,
+                                     ucp_dt_pack_pool_t **pool_p)
+{
+    ucp_dt_pack_pool_t *pool;
+    unsigned i;
+    int ret;
+
+    pool = ucs_malloc(sizeof(*pool) + (sizeof(*pool->threads) * num_threads),
+                      "ucp_dt_pack_pool");
+    if (pool == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+    ucs_queue_head_init(&pool->queue);
+    pool->stop        = 0;
+    pool->num_threads = num_threads;
+
+    for (i = 0; i < num_threads; ++i) {
+        ret = pthread_create(&pool->threads[i], NULL,
+                             ucp_dt_pack_pool_thread_func, pool);
+        if (ret != 0) {
+            ucs_error("failed to create datatype pack thread: %s",
+                      strerror(ret));
+            ucp_dt_pack_pool_stop(pool, i);
+            pthread_cond_destroy(&pool->cond);
+            pthread_mutex_destroy(&pool->lock);
+            ucs_free(pool);
+            return UCS_ERR_IO_ERROR;
+        }
+    }
+
+    ucs_debug("created datatype pack pool %p with %u threads", pool,
+              num_threads);
+    *pool_p = pool;
+    return UCS_OK;
+}
+
+void ucp_dt_pack_pool_destroy(ucp_dt_pack_pool_t *pool)
+{
+    ucp_dt_pack_pool_stop(pool, pool->num_threads);
+    if (!ucs_queue_is_empty(&pool->queue)) {
+        ucs_warn("datatype pack pool %p destroyed with queued chunks", pool);
+    }
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+    ucs_free(pool);
+}
+
+/* Must be called with the pool lock held */
+static void ucp_dt_pack_chunk_enqueue(ucp_dt_pack_chunk_t *chunk, size_t index)
+{
+    ucp_dt_pack_pool_t *pool = chunk->pipeline->pool;
+
+    chunk->index = index;
+    chunk->state = UCP_DT_PACK_CHUNK_QUEUED;
+    ucs_queue_push(&pool->queue, &chunk->queue);
+    pthread_cond_signal(&pool->cond);
+}
+
+ucs_status_t ucp_dt_pack_pipeline_create(ucp_dt_pack_pool_t *pool,
+                                         ucp_dt_generic_t *dt, void *dt_state,
+                                         size_t length,
+                                         ucp_dt_pack_pipeline_t **pipeline_p)
+{
+    ucp_dt_pack_pipeline_t *pipeline;
+    unsigned depth, i;
+    void *data;
+
+    /* double-buffer every helper thread */
+    depth = ucs_min(ucs_max(2 * pool->num_threads, 2),
+                    ucs_div_round_up(length, UCP_DT_PACK_CHUNK_SIZE));
+    pipeline = ucs_malloc(sizeof(*pipeline) +
+                          ((sizeof(*pipeline->chunks) +
+                            UCP_DT_PACK_CHUNK_SIZE) * depth),
+                          "ucp_dt_pack_pipeline");
+    if (pipeline == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    pipeline->pool       = pool;
+    pipeline->dt         = dt;
+    pipeline->dt_state   = dt_state;
+    pipeline->length     = length;
+    pipeline->num_chunks = ucs_div_round_up(length, UCP_DT_PACK_CHUNK_SIZE);
+    pipeline->depth      = depth;
+
+    data = pipeline->chunks + depth;
+    pthread_mutex_lock(&pool->lock);
+    for (i = 0; i < depth; ++i) {
+        pipeline->chunks[i].pipeline = pipeline;
+        pipeline->chunks[i].data     = UCS_PTR_BYTE_OFFSET(data,
+                                                           i * UCP_DT_PACK_CHUNK_SIZE);
+        ucp_dt_pack_chunk_enqueue(&pipeline->chunks[i], i);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    ucs_trace("datatype pack pipeline %p: length %zu chunks %zu depth %u",
+              pipeline, length, pipeline->num_chunks, depth);
+    *pipeline_p = pipeline;
+    return UCS_OK;
+}
+
+void ucp_dt_pack_pipeline_destroy(ucp_dt_pack_pipeline_t *pipeline)
+{
+    ucp_dt_pack_pool_t *pool = pipeline->pool;
+    ucp_dt_pack_chunk_t *chunk;
+    unsigned i;
+
+    pthread_mutex_lock(&pool->lock);
+    for (i = 0; i < pipeline->depth; ++i) {
+        chunk = &pipeline->chunks[i];
+        if (chunk->state == UCP_DT_PACK_CHUNK_QUEUED) {
+            ucs_queue_remove(&pool->queue, &chunk->queue);
+            chunk->state = UCP_DT_PACK_CHUNK_FREE;
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    /* the chunks which are still packed by helper threads use the pipeline */
+    for (i = 0; i < pipeline->depth; ++i) {
+        while (pipeline->chunks[i].state == UCP_DT_PACK_CHUNK_PACKING) {
+            sched_yield();
+        }
+    }
+
+    ucs_free(pipeline);
+}
+
+/* Make sure the chunk which has @a index is packed, and return it, or return
+ * NULL if the chunk is not in the ring */
+static ucp_dt_pack_chunk_t*
+ucp_dt_pack_pipeline_get_chunk(ucp_dt_pack_pipeline_t *pipeline, size_t index)
+{
+    ucp_dt_pack_chunk_t *chunk = &pipeline->chunks[index % pipeline->depth];
+    ucp_dt_pack_pool_t *pool   = pipeline->pool;
+
+    if ((chunk->state == UCP_DT_PACK_CHUNK_FREE) || (chunk->index != index)) {
+        return NULL;
+    }
+
+    if (chunk->state == UCP_DT_PACK_CHUNK_QUEUED) {
+        /* no helper thread took the chunk yet, so pack it here */
+        pthread_mutex_lock(&pool->lock);
+        if (chunk->state == UCP_DT_PACK_CHUNK_QUEUED) {
+            ucs_queue_remove(&pool->queue, &chunk->queue);
+            chunk->state = UCP_DT_PACK_CHUNK_PACKING;
+            pthread_mutex_unlock(&pool->lock);
+            ucp_dt_pack_chunk_do_pack(chunk);
+        } else {
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+
+    while (chunk->state != UCP_DT_PACK_CHUNK_READY) {
+        sched_yield();
+    }
+    ucs_memory_cpu_load_fence();
+
+    return chunk;
+}
+
+size_t ucp_dt_pack_pipeline_pack(ucp_dt_pack_pipeline_t *pipeline,
+                                 size_t offset, void *dest, size_t length)
+{
+    size_t result = 0;
+    ucp_dt_pack_chunk_t *chunk;
+    size_t chunk_offset, copy_length, packed;
+    size_t index;
+
+    while (result < length) {
+        index        = offset / UCP_DT_PACK_CHUNK_SIZE;
+        chunk_offset = offset % UCP_DT_PACK_CHUNK_SIZE;
+        chunk        = ucp_dt_pack_pipeline_get_chunk(pipeline, index);
+        if (chunk == NULL) {
+            /* the data was already consumed, e.g the send was restarted */
+            copy_length = ucs_min(length - result,
+                                  UCP_DT_PACK_CHUNK_SIZE - chunk_offset);
+            packed      = pipeline->dt->ops.pack(pipeline->dt_state, offset,
+                                                 dest, copy_length);
+        } else {
+            ucs_assertv(chunk->length == ucs_min(UCP_DT_PACK_CHUNK_SIZE,
+                                                 pipeline->length -
+                                                 (index * UCP_DT_PACK_CHUNK_SIZE)),
+                        "chunk %zu packed length %zu", index, chunk->length);
+            copy_length = ucs_min(length - result,
+                                  chunk->length - chunk_offset);
+            memcpy(dest, UCS_PTR_BYTE_OFFSET(chunk->data, chunk_offset),
+                   copy_length);
+            packed      = copy_length;
+
+            if (chunk_offset + copy_length == chunk->length) {
+                /* the chunk is consumed, reuse its slot for a next one */
+                pthread_mutex_lock(&pipeline->pool->lock);
+                if ((index + pipeline->depth) < pipeline->num_chunks) {
+                    ucp_dt_pack_chunk_enqueue(chunk, index + pipeline->depth);
+                } else {
+                    chunk->state = UCP_DT_PACK_CHUNK_FREE;
+                }
+                pthread_mutex_unlock(&pipeline->pool->lock);
+            }
+        }
+
+        result += packed;
+        offset += packed;
+        dest    = UCS_PTR_BYTE_OFFSET(dest, packed);
+        if (packed < copy_length) {
+            break;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,95 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2020.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+
+#ifndef UCP_DT_PACK_POOL_H_
+#define UCP_DT_PACK_POOL_H_
+
+#include "dt.h"
+
+#include <ucs/datastruct/queue_types.h>
+#include <ucs/sys/math.h>
+#include <ucs/type/status.h>
+#include <pthread.h>
+
+
+/* Size of a chunk packed by a helper thread */
+#define UCP_DT_PACK_CHUNK_SIZE  (64 * UCS_KBYTE)
+
+
+/**
+ * Helper threads which pack chunks of large messages of thread-safe generic
+ * datatypes, ahead of sending them.
+ */
+typedef struct ucp_dt_pack_pool {
+    pthread_mutex_t               lock;
+    pthread_cond_t                cond;
+    ucs_queue_head_t              queue;       /* Chunks waiting to be packed */
+    int                           stop;
+    unsigned                      num_threads;
+    pthread_t                     threads[0];
+} ucp_dt_pack_pool_t;
+
+
+/**
+ * State of a chunk of a pipeline.
+ */
+typedef enum {
+    UCP_DT_PACK_CHUNK_FREE,     /* Not used */
+    UCP_DT_PACK_CHUNK_QUEUED,   /* Waiting for a helper thread */
+    UCP_DT_PACK_CHUNK_PACKING,  /* Being packed */
+    UCP_DT_PACK_CHUNK_READY     /* Packed, waiting to be sent */
+} ucp_dt_pack_chunk_state_t;
+
+
+typedef struct ucp_dt_pack_chunk {
+    ucs_queue_elem_t              queue;       /* Element in pool queue */
+    ucp_dt_pack_pipeline_t        *pipeline;
+    size_t                        index;       /* Chunk index in the message */
+    size_t                        length;      /* Packed length */
+    volatile int                  state;       /* ucp_dt_pack_chunk_state_t */
+    void                          *data;
+} ucp_dt_pack_chunk_t;
+
+
+/**
+ * Packing pipeline of a single send operation: a ring of chunks, so that
+ * helper threads pack the next chunks while the current one is sent.
+ */
+struct ucp_dt_pack_pipeline {
+    ucp_dt_pack_pool_t            *pool;
+    ucp_dt_generic_t              *dt;
+    void                          *dt_state;   /* Generic datatype state */
+    size_t                        length;      /* Total packed length */
+    size_t                        num_chunks;  /* Number of chunks in message */
+    unsigned                      depth;       /* Number of chunks in ring */
+    ucp_dt_pack_chunk_t           chunks[0];   /* Chunk i uses ring slot
+                                                  i % depth */
+};
+
+
+ucs_status_t ucp_dt_pack_pool_create(unsigned num_threads,
+                                     ucp_dt_pack_pool_t **pool_p);
+
+void ucp_dt_pack_pool_destroy(ucp_dt_pack_pool_t *pool);
+
+ucs_status_t ucp_dt_pack_pipeline_create(ucp_dt_pack_pool_t *pool,
+                                         ucp_dt_generic_t *dt, void *dt_state,
+                                         size_t length,
+                                         ucp_dt_pack_pipeline_t **pipeline_p);
+
+void ucp_dt_pack_pipeline_destroy(ucp_dt_pack_pipeline_t *pipeline);
+
+/**
+ * Copy @a length bytes of packed data at @a offset to @a dest, waiting for
+ * the helper threads if needed.
+ *
+ * @return Number of bytes copied.
+ */
+size_t ucp_dt_pack_pipeline_pack(ucp_dt_pack_pipeline_t *pipeline,
+                                 size_t offset, void *dest, size_t length);
+
+#endif /* UCP_DT_PACK_POOL_H_ */
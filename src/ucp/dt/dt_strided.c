@@ -0,0 +1,226 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2020.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "dt_strided.h"
+
+#include <ucs/arch/cpu.h>
+#include <ucs/sys/math.h>
+#include <ucs/debug/assert.h>
+#include <ucs/debug/memtrack.h>
+#include <string.h>
+
+
+/* Copy blocks of a fixed size; with a constant @a blocklen the compiler
+ * replaces memcpy() by a few vector loads and stores */
+static UCS_F_ALWAYS_INLINE void
+ucp_dt_strided_copy_blocks_fixed(void *dst, ssize_t dst_stride,
+                                 const void *src, ssize_t src_stride,
+                                 size_t blocklen, size_t nblocks)
+{
+    for (; nblocks > 0; --nblocks) {
+        memcpy(dst, src, blocklen);
+        dst = UCS_PTR_BYTE_OFFSET(dst, dst_stride);
+        src = UCS_PTR_BYTE_OFFSET(src, src_stride);
+    }
+}
+
+static void ucp_dt_strided_copy_blocks(void *dst, ssize_t dst_stride,
+                                       const void *src, ssize_t src_stride,
+                                       size_t blocklen, size_t nblocks)
+{
+    switch (blocklen) {
+    case 4:
+        ucp_dt_strided_copy_blocks_fixed(dst, dst_stride, src, src_stride,
+                                         4, nblocks);
+        break;
+    case 8:
+        ucp_dt_strided_copy_blocks_fixed(dst, dst_stride, src, src_stride,
+                                         8, nblocks);
+        break;
+    case 16:
+        ucp_dt_strided_copy_blocks_fixed(dst, dst_stride, src, src_stride,
+                                         16, nblocks);
+        break;
+    case 32:
+        ucp_dt_strided_copy_blocks_fixed(dst, dst_stride, src, src_stride,
+                                         32, nblocks);
+        break;
+    case 64:
+        ucp_dt_strided_copy_blocks_fixed(dst, dst_stride, src, src_stride,
+                                         64, nblocks);
+        break;
+    default:
+        for (; nblocks > 0; --nblocks) {
+            ucs_memcpy_relaxed(dst, src, blocklen);
+            dst = UCS_PTR_BYTE_OFFSET(dst, dst_stride);
+            src = UCS_PTR_BYTE_OFFSET(src, src_stride);
+        }
+        break;
+    }
+}
+
+/* Move the block position @a idx by @a nblocks along the innermost dimension,
+ * which must not cross its end by more than one step */
+static UCS_F_ALWAYS_INLINE void*
+ucp_dt_strided_advance(const ucp_dt_strided_t *dt, size_t *idx, void *ptr,
+                       size_t nblocks)
+{
+    unsigned dim;
+
+    idx[0] += nblocks;
+    ptr     = UCS_PTR_BYTE_OFFSET(ptr, nblocks * dt->stride[0]);
+
+    for (dim = 0; idx[dim] == dt->count[dim]; ++dim) {
+        ptr      = UCS_PTR_BYTE_OFFSET(ptr, -(ssize_t)dt->count[dim] *
+                                            dt->stride[dim]);
+        idx[dim] = 0;
+        if (dim + 1 == dt->dim_count) {
+            /* next element */
+            return UCS_PTR_BYTE_OFFSET(ptr, dt->extent);
+        }
+
+        ++idx[dim + 1];
+        ptr = UCS_PTR_BYTE_OFFSET(ptr, dt->stride[dim + 1]);
+    }
+
+    return ptr;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_dt_strided_copy(const ucp_dt_strided_t *dt, void *buffer, size_t offset,
+                    void *packed, size_t length, int is_pack)
+{
+    size_t idx[UCP_DT_STRIDED_MAX_DIMS];
+    size_t block, block_offset, copied, chunk, nblocks;
+    unsigned dim;
+    void *ptr;
+
+    /* find the block which contains the packed offset */
+    block        = offset / dt->blocklen;
+    block_offset = offset % dt->blocklen;
+    ptr          = UCS_PTR_BYTE_OFFSET(buffer, (block / dt->block_count) *
+                                               dt->extent);
+    block       %= dt->block_count;
+    for (dim = 0; dim < dt->dim_count; ++dim) {
+        idx[dim] = block % dt->count[dim];
+        block   /= dt->count[dim];
+        ptr      = UCS_PTR_BYTE_OFFSET(ptr, idx[dim] * dt->stride[dim]);
+    }
+
+    copied = 0;
+    while (copied < length) {
+        if ((block_offset != 0) || ((length - copied) < dt->blocklen)) {
+            chunk = ucs_min(dt->blocklen - block_offset, length - copied);
+            if (is_pack) {
+                memcpy(UCS_PTR_BYTE_OFFSET(packed, copied),
+                       UCS_PTR_BYTE_OFFSET(ptr, block_offset), chunk);
+            } else {
+                memcpy(UCS_PTR_BYTE_OFFSET(ptr, block_offset),
+                       UCS_PTR_BYTE_OFFSET(packed, copied), chunk);
+            }
+            copied       += chunk;
+            block_offset += chunk;
+            if (block_offset < dt->blocklen) {
+                break;
+            }
+            block_offset = 0;
+            nblocks      = 1;
+        } else {
+            /* a run of full blocks along the innermost dimension */
+            nblocks = ucs_min(dt->count[0] - idx[0],
+                              (length - copied) / dt->blocklen);
+            if (is_pack) {
+                ucp_dt_strided_copy_blocks(UCS_PTR_BYTE_OFFSET(packed, copied),
+                                           dt->blocklen, ptr, dt->stride[0],
+                                           dt->blocklen, nblocks);
+            } else {
+                ucp_dt_strided_copy_blocks(ptr, dt->stride[0],
+                                           UCS_PTR_BYTE_OFFSET(packed, copied),
+                                           dt->blocklen, dt->blocklen, nblocks);
+            }
+            copied += nblocks * dt->blocklen;
+        }
+
+        ptr = ucp_dt_strided_advance(dt, idx, ptr, nblocks);
+    }
+}
+
+void ucp_dt_strided_pack(ucp_datatype_t datatype, void *dest,
+                         const void *buffer, size_t offset, size_t length)
+{
+    ucp_dt_strided_copy(ucp_dt_strided(datatype), (void*)buffer, offset, dest,
+                        length, 1);
+}
+
+void ucp_dt_strided_unpack(ucp_datatype_t datatype, void *buffer,
+                           size_t offset, const void *src, size_t length)
+{
+    ucp_dt_strided_copy(ucp_dt_strided(datatype), buffer, offset, (void*)src,
+                        length, 0);
+}
+
+ucs_status_t ucp_dt_create_strided(size_t blocklen,
+                                   const ucp_dt_strided_dim_t *dims,
+                                   unsigned dim_count,
+                                   ucp_datatype_t *datatype_p)
+{
+    ucp_dt_strided_t *dt;
+    unsigned dim;
+    int ret;
+
+    if ((blocklen == 0) || (dim_count == 0) ||
+        (dim_count > UCP_DT_STRIDED_MAX_DIMS)) {
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    for (dim = 0; dim < dim_count; ++dim) {
+        if (dims[dim].count == 0) {
+            return UCS_ERR_INVALID_PARAM;
+        }
+    }
+
+    ret = ucs_posix_memalign((void **)&dt,
+                             ucs_max(sizeof(void *), UCS_BIT(UCP_DATATYPE_SHIFT)),
+                             sizeof(*dt), "strided_dt");
+    if (ret != 0) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    dt->blocklen  = blocklen;
+    dt->extent    = dims[dim_count - 1].count * dims[dim_count - 1].stride;
+    dt->dim_count = 0;
+    for (dim = 0; dim < dim_count; ++dim) {
+        if ((dt->dim_count == 0) && ((size_t)dims[dim].stride == dt->blocklen)) {
+            /* dense innermost dimension - merge it into the block */
+            dt->blocklen *= dims[dim].count;
+            continue;
+        }
+
+        dt->count[dt->dim_count]  = dims[dim].count;
+        dt->stride[dt->dim_count] = dims[dim].stride;
+        ++dt->dim_count;
+    }
+
+    if (dt->dim_count == 0) {
+        /* the whole layout is contiguous */
+        dt->count[0]  = 1;
+        dt->stride[0] = dt->blocklen;
+        dt->dim_count = 1;
+    }
+
+    dt->block_count = 1;
+    for (dim = 0; dim < dt->dim_count; ++dim) {
+        dt->block_count *= dt->count[dim];
+    }
+    dt->elem_size = dt->block_count * dt->blocklen;
+
+    *datatype_p = ((uintptr_t)dt) | UCP_DATATYPE_STRIDED;
+    return UCS_OK;
+}
@@ -0,0 +1,60 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2020.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+
+#ifndef UCP_DT_STRIDED_H_
+#define UCP_DT_STRIDED_H_
+
+#include <ucp/api/ucp.h>
+
+
+/**
+ * Strided datatype structure.
+ *
+ * The layout is a contiguous block of @a blocklen bytes, repeated over
+ * @a dim_count nested dimensions; dimension 0 is the innermost one.
+ * Consecutive elements of the datatype are @a extent bytes apart.
+ */
+typedef struct ucp_dt_strided {
+    size_t                   blocklen;     /* Size of contiguous block */
+    unsigned                 dim_count;    /* Number of valid dimensions */
+    size_t                   count[UCP_DT_STRIDED_MAX_DIMS];
+    ssize_t                  stride[UCP_DT_STRIDED_MAX_DIMS];
+    size_t                   block_count;  /* Number of blocks in one element */
+    size_t                   elem_size;    /* Packed size of one element */
+    ssize_t                  extent;       /* Distance between elements */
+} ucp_dt_strided_t;
+
+
+static inline ucp_dt_strided_t* ucp_dt_strided(ucp_datatype_t datatype)
+{
+    return (ucp_dt_strided_t*)(void*)(datatype & ~UCP_DATATYPE_CLASS_MASK);
+}
+
+#define UCP_DT_IS_STRIDED(_datatype) \
+          (((_datatype) & UCP_DATATYPE_CLASS_MASK) == UCP_DATATYPE_STRIDED)
+
+static inline size_t ucp_dt_strided_length(ucp_datatype_t datatype, size_t count)
+{
+    return count * ucp_dt_strided(datatype)->elem_size;
+}
+
+
+/**
+ * Gather @a length bytes of packed data, starting at packed @a offset, from
+ * the strided elements located at @a buffer into @a dest.
+ */
+void ucp_dt_strided_pack(ucp_datatype_t datatype, void *dest,
+                         const void *buffer, size_t offset, size_t length);
+
+/**
+ * Scatter @a length bytes of packed data from @a src to packed @a offset of
+ * the strided elements located at @a buffer.
+ */
+void ucp_dt_strided_unpack(ucp_datatype_t datatype, void *buffer,
+                           size_t offset, const void *src, size_t length);
+
+#endif /* UCP_DT_STRIDED_H_ */
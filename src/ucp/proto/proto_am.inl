@@ -46,15 +46,19 @@ ucs_status_t ucp_do_am_bcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
     ucp_ep_t *ep       = req->send.ep;
     ucs_status_t status;
     size_t UCS_V_UNUSED max_middle;
+    ucp_lane_index_t start_lane;
+    ucp_lane_index_t am_bw_index;
     ssize_t packed_len;
     uct_ep_h uct_ep;
     size_t offset;
     int pending_adde_res;
 
     offset         = req->send.state.dt.offset;
+    am_bw_index    = req->send.tag.am_bw_index;
     req->send.lane = (!enable_am_bw || !offset) ? /* first part of message must be sent */
                      ucp_ep_get_am_lane(ep) :     /* via AM lane */
                      ucp_send_request_get_next_am_bw_lane(req);
+    start_lane     = req->send.lane;
     uct_ep         = ep->uct_eps[req->send.lane];
     max_middle     = ucp_ep_get_max_bcopy(ep, req->send.lane) - hdr_size_middle;
 
@@ -84,6 +88,23 @@ ucs_status_t ucp_do_am_bcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
         }
 
         if (ucs_unlikely(packed_len < 0)) {
+            if (enable_am_bw && offset &&
+                (packed_len == UCS_ERR_NO_RESOURCE)) {
+                /* the receiver places middle fragments by their offset, so
+                 * send this one on the next lane which has resources, instead
+                 * of waiting for the busy one */
+                req->send.lane = ucp_send_request_get_next_am_bw_lane(req);
+                if (req->send.lane != start_lane) {
+                    uct_ep     = ep->uct_eps[req->send.lane];
+                    max_middle = ucp_ep_get_max_bcopy(ep, req->send.lane) -
+                                 hdr_size_middle;
+                    continue;
+                }
+
+                /* all lanes are busy; the retry starts from the same lane */
+                req->send.tag.am_bw_index = am_bw_index;
+            }
+
             if (req->send.lane != req->send.pending_lane) {
                 /* switch to new pending lane */
                 pending_adde_res = ucp_request_pending_add(req, &status, 0);
@@ -109,9 +130,11 @@ void ucp_dt_iov_copy_uct(ucp_context_h context, uct_iov_t *iov, size_t *iovcnt,
                          size_t length_max, ucp_md_index_t md_index,
                          ucp_mem_desc_t *mdesc)
 {
-    size_t iov_offset, max_src_iov, src_it, dst_it;
+    size_t iov_offset, max_src_iov, src_it, dst_it, length;
     size_t length_it = 0;
     ucp_md_index_t memh_index;
+    uct_mem_h memh;
+    void *buffer;
 
     switch (datatype & UCP_DATATYPE_CLASS_MASK) {
     case UCP_DATATYPE_CONTIG:
@@ -140,20 +163,33 @@ void ucp_dt_iov_copy_uct(ucp_context_h context, uct_iov_t *iov, size_t *iovcnt,
         src_it                      = state->dt.iov.iovcnt_offset;
         dst_it                      = 0;
         state->dt.iov.iov_offset    = 0;
-        while ((dst_it < max_dst_iov) && (src_it < max_src_iov)) {
+        while (src_it < max_src_iov) {
             if (src_iov[src_it].length) {
-                iov[dst_it].buffer  = src_iov[src_it].buffer + iov_offset;
-                iov[dst_it].length  = src_iov[src_it].length - iov_offset;
-                iov[dst_it].memh    = state->dt.iov.dt_reg[src_it].memh[0];
-                iov[dst_it].stride  = 0;
-                iov[dst_it].count   = 1;
-                length_it          += iov[dst_it].length;
-
-                ++dst_it;
+                buffer = UCS_PTR_BYTE_OFFSET(src_iov[src_it].buffer, iov_offset);
+                length = src_iov[src_it].length - iov_offset;
+                memh   = state->dt.iov.dt_reg[src_it].memh[0];
+                if ((dst_it > 0) && (iov[dst_it - 1].memh == memh) &&
+                    (UCS_PTR_BYTE_OFFSET(iov[dst_it - 1].buffer,
+                                         iov[dst_it - 1].length) == buffer)) {
+                    /* adjacent to the previous item of the same region */
+                    iov[dst_it - 1].length += length;
+                } else if (dst_it < max_dst_iov) {
+                    iov[dst_it].buffer  = buffer;
+                    iov[dst_it].length  = length;
+                    iov[dst_it].memh    = memh;
+                    iov[dst_it].stride  = 0;
+                    iov[dst_it].count   = 1;
+                    ++dst_it;
+                } else {
+                    break;
+                }
+
+                length_it += length;
                 if (length_it >= length_max) {
                     iov[dst_it - 1].length      -= (length_it - length_max);
+                    state->dt.iov.iov_offset     = iov_offset + length -
+                                                   (length_it - length_max);
                     length_it                    = length_max;
-                    state->dt.iov.iov_offset     = iov_offset + iov[dst_it - 1].length;
                     break;
                 }
             }
@@ -377,21 +413,27 @@ ucp_proto_get_zcopy_threshold(const ucp_request_t *req,
         } else if (!msg_config->zcopy_auto_thresh) {
             /* The user defined threshold or no zcopy enabled */
             zcopy_thresh = msg_config->zcopy_thresh[0];
-        } else if (count <= UCP_MAX_IOV) {
-            /* Using pre-calculated thresholds */
-            zcopy_thresh = msg_config->zcopy_thresh[count - 1];
         } else {
-            /* Calculate threshold */
-            lane         = req->send.lane;
-            rsc_index    = ucp_ep_config(req->send.ep)->key.lanes[lane].rsc_index;
-            worker       = req->send.ep->worker;
-            zcopy_thresh = ucp_ep_config_get_zcopy_auto_thresh(count,
-                              &ucp_ep_md_attr(req->send.ep, lane)->reg_cost,
-                              worker->context,
-                              ucp_worker_iface_bandwidth(worker, rsc_index));
+            /* Adjacent items are registered and sent as a single one */
+            count = ucs_max(ucp_dt_iov_count_coalesced(req->send.buffer, count),
+                            1);
+            if (count <= UCP_MAX_IOV) {
+                /* Using pre-calculated thresholds */
+                zcopy_thresh = msg_config->zcopy_thresh[count - 1];
+            } else {
+                /* Calculate threshold */
+                lane         = req->send.lane;
+                rsc_index    = ucp_ep_config(req->send.ep)->key.lanes[lane].rsc_index;
+                worker       = req->send.ep->worker;
+                zcopy_thresh = ucp_ep_config_get_zcopy_auto_thresh(count,
+                                  &ucp_ep_md_attr(req->send.ep, lane)->reg_cost,
+                                  worker->context,
+                                  ucp_worker_iface_bandwidth(worker, rsc_index));
+            }
         }
         return ucs_min(max_zcopy, zcopy_thresh);
-    } else if (UCP_DT_IS_GENERIC(req->send.datatype)) {
+    } else if (UCP_DT_IS_STRIDED(req->send.datatype) ||
+               UCP_DT_IS_GENERIC(req->send.datatype)) {
         return max_zcopy;
     }
 
@@ -362,7 +362,10 @@ static void ucp_worker_flush_complete_one(ucp_request_t *req, ucs_status_t statu
 
     if (complete) {
         ucs_assert(status != UCS_INPROGRESS);
-        ucp_request_complete(req, flush_worker.cb, status);
+        if (!ucp_request_complete_defer(req, status,
+                                        UCP_REQUEST_CB_FLUSH_WORKER)) {
+            ucp_request_complete(req, flush_worker.cb, status);
+        }
     }
 }
 
@@ -17,6 +17,24 @@ typedef struct {
 } UCS_S_PACKED ucp_stream_am_hdr_t;
 
 
+typedef struct {
+    uintptr_t                ep_ptr;
+    size_t                   credit;   /* how much stream data was consumed */
+} UCS_S_PACKED ucp_stream_credit_hdr_t;
+
+
+/* Per-endpoint stream flow control state */
+typedef struct ucp_stream_ep_fc {
+    ucs_queue_head_t         send_q;        /* Sends waiting for credit */
+    size_t                   send_credit;   /* How much more data can be sent
+                                               to the remote peer */
+    size_t                   recv_consumed; /* Consumed data which was not
+                                               granted to the remote peer */
+    uct_worker_cb_id_t       credit_cb_id;  /* Progress callback which retries
+                                               granting the consumed data */
+} ucp_stream_ep_fc_t;
+
+
 typedef struct {
     union {
         ucp_stream_am_hdr_t  hdr;
@@ -25,12 +43,20 @@ typedef struct {
 } ucp_stream_am_data_t;
 
 
-void ucp_stream_ep_init(ucp_ep_h ep);
+ucs_status_t ucp_stream_ep_init(ucp_ep_h ep);
+
+void ucp_stream_ep_destroy(ucp_ep_h ep);
 
 void ucp_stream_ep_cleanup(ucp_ep_h ep);
 
 void ucp_stream_ep_activate(ucp_ep_h ep);
 
+size_t ucp_stream_ep_ready_length(ucp_ep_ext_proto_t *ep_ext);
+
+void ucp_stream_send_credit(ucp_ep_h ep);
+
+void ucp_stream_ep_send_cleanup(ucp_ep_h ep);
+
 
 static UCS_F_ALWAYS_INLINE int ucp_stream_ep_is_queued(ucp_ep_ext_proto_t *ep_ext)
 {
@@ -42,6 +68,16 @@ static UCS_F_ALWAYS_INLINE int ucp_stream_ep_has_data(ucp_ep_ext_proto_t *ep_ext
     return ucp_ep_from_ext_proto(ep_ext)->flags & UCP_EP_FLAG_STREAM_HAS_DATA;
 }
 
+/* Whether the EP has events it is polled for, so it should be on the worker's
+ * ready list */
+static UCS_F_ALWAYS_INLINE int ucp_stream_ep_has_events(ucp_ep_h ep)
+{
+    return ((ep->flags & (UCP_EP_FLAG_STREAM_HAS_DATA |
+                          UCP_EP_FLAG_STREAM_NO_POLL_IN)) ==
+            UCP_EP_FLAG_STREAM_HAS_DATA) ||
+           (ep->flags & UCP_EP_FLAG_STREAM_OUT_READY);
+}
+
 static UCS_F_ALWAYS_INLINE
 void ucp_stream_ep_enqueue(ucp_ep_ext_proto_t *ep_ext, ucp_worker_h worker)
 {
@@ -55,6 +91,27 @@ static UCS_F_ALWAYS_INLINE void ucp_stream_ep_dequeue(ucp_ep_ext_proto_t *ep_ext
     ep_ext->stream.ready_list.next = NULL;
 }
 
+/* Add or remove the EP from the worker's ready list according to its events */
+static UCS_F_ALWAYS_INLINE void ucp_stream_ep_update_ready(ucp_ep_h ep)
+{
+    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
+
+    if (ep_ext == NULL) {
+        /* no stream data or sends were queued on the endpoint */
+        ucs_assert(!ucp_stream_ep_has_events(ep));
+        return;
+    }
+
+    if (!ucp_stream_ep_has_events(ep)) {
+        if (ucp_stream_ep_is_queued(ep_ext)) {
+            ucp_stream_ep_dequeue(ep_ext);
+        }
+    } else if (!ucp_stream_ep_is_queued(ep_ext) &&
+               (ep->flags & UCP_EP_FLAG_USED)) {
+        ucp_stream_ep_enqueue(ep_ext, ep->worker);
+    }
+}
+
 static UCS_F_ALWAYS_INLINE ucp_ep_ext_proto_t*
 ucp_stream_worker_dequeue_ep_head(ucp_worker_h worker)
 {
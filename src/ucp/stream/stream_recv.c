@@ -14,9 +14,11 @@
 #include <ucp/core/ucp_request.h>
 #include <ucp/core/ucp_request.inl>
 #include <ucp/stream/stream.h>
+#include <ucp/tag/rndv.h>
 
 #include <ucs/datastruct/mpool.inl>
 #include <ucs/profile/profile.h>
+#include <ucs/sys/string.h>
 
 
 /* @verbatim
@@ -43,6 +45,12 @@
  *                'ucp_recv_desc_t *' inside @ref ucp_stream_release_data after
  *                the buffer was returned to user by
  *                @ref ucp_stream_recv_data_nb as a pointer to 'paylod'
+ *
+ * Stream data which is sent with rendezvous protocol is fetched directly to
+ * the receive request at the head of 'match_q', if it has room for all of it,
+ * or otherwise to a bounce buffer of the same layout which is allocated with
+ * malloc. Stream data which arrives while the fetch is in progress is kept in
+ * order on 'rndv_q'.
  */
 
 
@@ -60,6 +68,33 @@
     ((ucp_stream_am_data_t *)_data - 1)->rdesc
 
 
+static UCS_F_ALWAYS_INLINE void ucp_stream_rdesc_release(ucp_recv_desc_t *rdesc)
+{
+    if (ucs_unlikely(rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC)) {
+        ucs_free(rdesc);
+    } else {
+        ucp_recv_desc_release(rdesc);
+    }
+}
+
+/* Grant the consumed data back to the sender when half of the window is
+ * consumed */
+static UCS_F_ALWAYS_INLINE void
+ucp_stream_ep_consumed(ucp_ep_ext_proto_t *ep_ext, size_t length)
+{
+    ucp_ep_h ep   = ucp_ep_from_ext_proto(ep_ext);
+    size_t window = ep->worker->context->config.ext.stream_window;
+
+    if (ucs_likely(window == UCS_MEMUNITS_INF)) {
+        return;
+    }
+
+    ep_ext->stream.fc->recv_consumed += length;
+    if (ep_ext->stream.fc->recv_consumed >= (window / 2)) {
+        ucp_stream_send_credit(ep);
+    }
+}
+
 static UCS_F_ALWAYS_INLINE ucp_recv_desc_t *
 ucp_stream_rdesc_dequeue(ucp_ep_ext_proto_t *ep_ext)
 {
@@ -69,7 +104,8 @@ ucp_stream_rdesc_dequeue(ucp_ep_ext_proto_t *ep_ext)
     ucs_assert(ucp_stream_ep_has_data(ep_ext));
     if (ucs_unlikely(ucs_queue_is_empty(&ep_ext->stream.match_q))) {
         ucp_ep_from_ext_proto(ep_ext)->flags &= ~UCP_EP_FLAG_STREAM_HAS_DATA;
-        if (ucp_stream_ep_is_queued(ep_ext)) {
+        if (ucp_stream_ep_is_queued(ep_ext) &&
+            !ucp_stream_ep_has_events(ucp_ep_from_ext_proto(ep_ext))) {
             ucp_stream_ep_dequeue(ep_ext);
         }
     }
@@ -94,19 +130,22 @@ ucp_stream_rdesc_get(ucp_ep_ext_proto_t *ep_ext)
 static UCS_F_ALWAYS_INLINE ucs_status_ptr_t
 ucp_stream_recv_data_nb_nolock(ucp_ep_h ep, size_t *length)
 {
-    ucp_ep_ext_proto_t   *ep_ext = ucp_ep_ext_proto(ep);
+    ucp_ep_ext_proto_t   *ep_ext;
     ucp_recv_desc_t      *rdesc;
     ucp_stream_am_data_t *am_data;
 
-    if (ucs_unlikely(!ucp_stream_ep_has_data(ep_ext))) {
+    /* the protocol extension exists if the endpoint has data */
+    if (ucs_unlikely(!(ep->flags & UCP_EP_FLAG_STREAM_HAS_DATA))) {
         return UCS_STATUS_PTR(UCS_OK);
     }
 
-    rdesc = ucp_stream_rdesc_dequeue(ep_ext);
+    ep_ext = ucp_ep_ext_proto(ep);
+    rdesc  = ucp_stream_rdesc_dequeue(ep_ext);
 
     *length         = rdesc->length;
     am_data         = ucp_stream_rdesc_am_data(rdesc);
     am_data->rdesc  = rdesc;
+    ucp_stream_ep_consumed(ep_ext, rdesc->length);
     return am_data + 1;
 }
 
@@ -134,7 +173,7 @@ ucp_stream_rdesc_dequeue_and_release(ucp_recv_desc_t *rdesc,
                                                       ucp_recv_desc_t,
                                                       stream_queue));
     ucp_stream_rdesc_dequeue(ep_ext);
-    ucp_recv_desc_release(rdesc);
+    ucp_stream_rdesc_release(rdesc);
 }
 
 UCS_PROFILE_FUNC_VOID(ucp_stream_data_release, (ep, data),
@@ -144,7 +183,7 @@ UCS_PROFILE_FUNC_VOID(ucp_stream_data_release, (ep, data),
 
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
 
-    ucp_recv_desc_release(rdesc);
+    ucp_stream_rdesc_release(rdesc);
 
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
 }
@@ -210,7 +249,12 @@ ucp_stream_process_rdesc_inplace(ucp_recv_desc_t *rdesc, ucp_datatype_t dt,
     status   = ucp_dt_unpack_only(worker, buffer, count, dt, mem_type,
                                   ucp_stream_rdesc_payload(rdesc), length, 0);
 
-    unpacked = ucs_likely(status == UCS_OK) ? length : status;
+    if (ucs_likely(status == UCS_OK)) {
+        unpacked = length;
+        ucp_stream_ep_consumed(ep_ext, length);
+    } else {
+        unpacked = status;
+    }
 
     return ucp_stream_rdesc_advance(rdesc, unpacked, ep_ext);
 }
@@ -224,6 +268,9 @@ ucp_stream_process_rdesc(ucp_recv_desc_t *rdesc, ucp_ep_ext_proto_t *ep_ext,
     unpacked = ucp_stream_rdata_unpack(ucp_stream_rdesc_payload(rdesc),
                                        rdesc->length, req);
     ucs_assert(req->recv.stream.offset <= req->recv.length);
+    if (ucs_likely(unpacked > 0)) {
+        ucp_stream_ep_consumed(ep_ext, unpacked);
+    }
 
     return ucp_stream_rdesc_advance(rdesc, unpacked, ep_ext);
 }
@@ -269,7 +316,7 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_stream_recv_nb,
                  size_t *length, unsigned flags)
 {
     ucs_status_t        status     = UCS_OK;
-    ucp_ep_ext_proto_t  *ep_ext    = ucp_ep_ext_proto(ep);
+    ucp_ep_ext_proto_t  *ep_ext;
     size_t              dt_length;
     ucp_request_t       *req;
     ucp_recv_desc_t     *rdesc;
@@ -278,6 +325,12 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_stream_recv_nb,
                                     return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
 
+    ep_ext = ucp_ep_ext_proto_get(ep);
+    if (ucs_unlikely(ep_ext == NULL)) {
+        status = UCS_ERR_NO_MEMORY;
+        goto out_status;
+    }
+
     if (ucs_likely(!UCP_DT_IS_GENERIC(datatype))) {
         dt_length = ucp_dt_length(datatype, count, buffer, NULL);
         if (ucs_likely(ucp_stream_recv_nb_is_inplace(ep_ext, dt_length))) {
@@ -344,43 +397,101 @@ out:
     return req;
 }
 
+static UCS_F_ALWAYS_INLINE int ucp_stream_ep_rndv_busy(ucp_ep_ext_proto_t *ep_ext)
+{
+    return (ep_ext->stream.rndv_rreq != NULL) ||
+           !ucs_queue_is_empty(&ep_ext->stream.rndv_q);
+}
+
+/* Unpack the data to the posted receive requests. The payload offset of
+ * 'rdesc' is relative to 'base'. Returns nonzero if all data was consumed. */
+static UCS_F_ALWAYS_INLINE int
+ucp_stream_rdata_process_expected(ucp_ep_ext_proto_t *ep_ext, void *base,
+                                  ucp_recv_desc_t *rdesc)
+{
+    void          *payload;
+    ucp_request_t *req;
+    ssize_t       unpacked;
+
+    if (ucp_stream_ep_has_data(ep_ext)) {
+        return 0;
+    }
+
+    while (!ucs_queue_is_empty(&ep_ext->stream.match_q)) {
+        req      = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
+                                                 ucp_request_t, recv.queue);
+        payload  = UCS_PTR_BYTE_OFFSET(base, rdesc->payload_offset);
+        unpacked = ucp_stream_rdata_unpack(payload, rdesc->length, req);
+        if (ucs_unlikely(unpacked < 0)) {
+            ucs_fatal("failed to unpack from am_data %p with offset %u to request %p",
+                      base, rdesc->payload_offset, req);
+        }
+
+        ucp_stream_ep_consumed(ep_ext, unpacked);
+        if (unpacked == rdesc->length) {
+            if (ucp_request_can_complete_stream_recv(req)) {
+                ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
+            }
+            return 1;
+        }
+        /* Partially consumed, 'rdesc' may be on the stack so it must not go
+         * through ucp_stream_rdesc_advance() which can release it */
+        rdesc->length         -= unpacked;
+        rdesc->payload_offset += unpacked;
+        /* This request is full, try next one */
+        ucs_assert(ucp_request_can_complete_stream_recv(req));
+        ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
+    }
+
+    return 0;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_stream_rdesc_enqueue(ucp_ep_ext_proto_t *ep_ext, ucp_recv_desc_t *rdesc)
+{
+    ucp_ep_h ep = ucp_ep_from_ext_proto(ep_ext);
+
+    ucs_assert(rdesc->length > 0);
+
+    ep->flags |= UCP_EP_FLAG_STREAM_HAS_DATA;
+    ucs_queue_push(&ep_ext->stream.match_q, &rdesc->stream_queue);
+
+    if (!ucp_stream_ep_is_queued(ep_ext) &&
+        ((ep->flags & (UCP_EP_FLAG_USED | UCP_EP_FLAG_STREAM_NO_POLL_IN)) ==
+         UCP_EP_FLAG_USED)) {
+        ucp_stream_ep_enqueue(ep_ext, ep->worker);
+    }
+}
+
+static void ucp_stream_rdesc_deliver(ucp_ep_ext_proto_t *ep_ext,
+                                     ucp_recv_desc_t *rdesc)
+{
+    if (ucp_stream_rdata_process_expected(ep_ext, rdesc, rdesc)) {
+        ucp_stream_rdesc_release(rdesc);
+    } else {
+        ucp_stream_rdesc_enqueue(ep_ext, rdesc);
+    }
+}
+
 static UCS_F_ALWAYS_INLINE ucs_status_t
 ucp_stream_am_data_process(ucp_worker_t *worker, ucp_ep_ext_proto_t *ep_ext,
                            ucp_stream_am_data_t *am_data, size_t length,
                            unsigned am_flags)
 {
     ucp_recv_desc_t  rdesc_tmp;
-    void            *payload;
     ucp_recv_desc_t *rdesc;
-    ucp_request_t   *req;
-    ssize_t          unpacked;
 
     rdesc_tmp.length         = length;
     rdesc_tmp.payload_offset = sizeof(*am_data); /* add sizeof(*rdesc) only if
                                                     am_data wont be handled in
                                                     place */
+    rdesc_tmp.flags          = 0;
 
-    /* First, process expected requests */
-    if (!ucp_stream_ep_has_data(ep_ext)) {
-        while (!ucs_queue_is_empty(&ep_ext->stream.match_q)) {
-            req      = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
-                                                     ucp_request_t, recv.queue);
-            payload  = UCS_PTR_BYTE_OFFSET(am_data, rdesc_tmp.payload_offset);
-            unpacked = ucp_stream_rdata_unpack(payload, rdesc_tmp.length, req);
-            if (ucs_unlikely(unpacked < 0)) {
-                ucs_fatal("failed to unpack from am_data %p with offset %u to request %p",
-                          am_data, rdesc_tmp.payload_offset, req);
-            } else if (unpacked == rdesc_tmp.length) {
-                if (ucp_request_can_complete_stream_recv(req)) {
-                    ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
-                }
-                return UCS_OK;
-            }
-            ucp_stream_rdesc_advance(&rdesc_tmp, unpacked, ep_ext);
-            /* This request is full, try next one */
-            ucs_assert(ucp_request_can_complete_stream_recv(req));
-            ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
-        }
+    /* First, process expected requests, unless the data has to wait for a
+     * rendezvous fetch of the data before it */
+    if (ucs_likely(!ucp_stream_ep_rndv_busy(ep_ext)) &&
+        ucp_stream_rdata_process_expected(ep_ext, am_data, &rdesc_tmp)) {
+        return UCS_OK;
     }
 
     ucs_assert(rdesc_tmp.length > 0);
@@ -406,37 +517,272 @@ ucp_stream_am_data_process(ucp_worker_t *worker, ucp_ep_ext_proto_t *ep_ext,
         rdesc->flags          = UCP_RECV_DESC_FLAG_UCT_DESC;
     }
 
-    ucp_ep_from_ext_proto(ep_ext)->flags |= UCP_EP_FLAG_STREAM_HAS_DATA;
-    ucs_queue_push(&ep_ext->stream.match_q, &rdesc->stream_queue);
+    if (ucs_unlikely(ucp_stream_ep_rndv_busy(ep_ext))) {
+        ucs_queue_push(&ep_ext->stream.rndv_q, &rdesc->stream_queue);
+    } else {
+        ucp_stream_rdesc_enqueue(ep_ext, rdesc);
+    }
 
     return UCS_INPROGRESS;
 }
 
-void ucp_stream_ep_init(ucp_ep_h ep)
+static void ucp_stream_rndv_recv_init(ucp_request_t *rreq, ucp_ep_h ep,
+                                      void *buffer, size_t length,
+                                      ucs_memory_type_t mem_type,
+                                      uint32_t flags, ucp_request_t *req)
+{
+    rreq->status              = UCS_OK;
+    rreq->flags               = UCP_REQUEST_FLAG_RECV |
+                                UCP_REQUEST_FLAG_RELEASED | flags;
+    rreq->recv.worker         = ep->worker;
+    rreq->recv.buffer         = buffer;
+    rreq->recv.datatype       = ucp_dt_make_contig(1);
+    rreq->recv.length         = length;
+    rreq->recv.mem_type       = mem_type;
+    rreq->recv.tag.stream.ep  = ep;
+    rreq->recv.tag.stream.req = req;
+
+    ucp_dt_recv_state_init(&rreq->recv.state, buffer, rreq->recv.datatype,
+                           length);
+}
+
+/* Let the sender complete a rendezvous send without fetching its data */
+static void ucp_stream_rndv_drop(ucp_ep_h ep,
+                                 const ucp_rndv_rts_hdr_t *rndv_rts_hdr)
+{
+    ucp_request_t *rreq;
+
+    rreq = ucp_request_get(ep->worker);
+    if (rreq == NULL) {
+        ucs_error("failed to allocate request to drop stream data");
+        return;
+    }
+
+    /* an empty receive is truncated, so only an ack is sent back */
+    ucp_stream_rndv_recv_init(rreq, ep, NULL, 0, UCS_MEMORY_TYPE_HOST, 0, NULL);
+    ucp_rndv_matched(ep->worker, rreq, rndv_rts_hdr);
+}
+
+static void ucp_stream_rndv_start(ucp_ep_ext_proto_t *ep_ext,
+                                  const ucp_rndv_rts_hdr_t *rndv_rts_hdr);
+
+static void ucp_stream_rndv_progress_q(ucp_ep_ext_proto_t *ep_ext)
+{
+    ucp_recv_desc_t *rdesc;
+
+    while ((ep_ext->stream.rndv_rreq == NULL) &&
+           !ucs_queue_is_empty(&ep_ext->stream.rndv_q)) {
+        rdesc = ucs_queue_pull_elem_non_empty(&ep_ext->stream.rndv_q,
+                                              ucp_recv_desc_t, stream_queue);
+        if (rdesc->flags & UCP_RECV_DESC_FLAG_RNDV) {
+            ucp_stream_rndv_start(ep_ext, (ucp_rndv_rts_hdr_t*)(rdesc + 1));
+            ucp_recv_desc_release(rdesc);
+        } else {
+            ucp_stream_rdesc_deliver(ep_ext, rdesc);
+        }
+    }
+}
+
+static void ucp_stream_rndv_recv_completed(void *request, ucs_status_t status,
+                                           ucp_tag_recv_info_t *info)
+{
+    ucp_request_t      *rreq = (ucp_request_t*)request - 1;
+    ucp_ep_h           ep    = rreq->recv.tag.stream.ep;
+    ucp_request_t      *req  = rreq->recv.tag.stream.req;
+    ucp_recv_desc_t    *rdesc;
+    ucp_ep_ext_proto_t *ep_ext;
+
+    if (req == NULL) {
+        rdesc = UCS_PTR_BYTE_OFFSET(rreq->recv.buffer,
+                                    -(sizeof(*rdesc) +
+                                      sizeof(ucp_stream_am_data_t)));
+    } else {
+        rdesc = NULL;
+    }
+
+    if (ep == NULL) {
+        /* the endpoint was destroyed while the data was fetched */
+        ucs_free(rdesc);
+        return;
+    }
+
+    ep_ext = ucp_ep_ext_proto(ep);
+    ucs_assert(ep_ext->stream.rndv_rreq == rreq);
+    ep_ext->stream.rndv_rreq = NULL;
+
+    if (ucs_unlikely(status != UCS_OK)) {
+        ucs_error("ep %p: failed to fetch %zu bytes of stream data: %s", ep,
+                  rreq->recv.length, ucs_status_string(status));
+        if (req != NULL) {
+            ucs_queue_pull_non_empty(&ep_ext->stream.match_q);
+            req->recv.stream.length = req->recv.stream.offset;
+            if (!ucp_request_complete_defer(req, status,
+                                            UCP_REQUEST_CB_STREAM_RECV)) {
+                ucp_request_complete(req, recv.stream.cb, status,
+                                     req->recv.stream.length);
+            }
+        } else {
+            ucs_free(rdesc);
+        }
+    } else if (req != NULL) {
+        req->recv.stream.offset += info->length;
+        ucp_stream_ep_consumed(ep_ext, info->length);
+        if (ucp_request_can_complete_stream_recv(req)) {
+            ucp_request_complete_stream_recv(req, ep_ext, UCS_OK);
+        }
+    } else {
+        ucp_stream_rdesc_deliver(ep_ext, rdesc);
+    }
+
+    ucp_stream_rndv_progress_q(ep_ext);
+}
+
+static void ucp_stream_rndv_start(ucp_ep_ext_proto_t *ep_ext,
+                                  const ucp_rndv_rts_hdr_t *rndv_rts_hdr)
+{
+    ucp_ep_h          ep    = ucp_ep_from_ext_proto(ep_ext);
+    ucp_request_t     *req  = NULL;
+    size_t            size  = rndv_rts_hdr->size;
+    ucp_recv_desc_t   *rdesc;
+    ucp_request_t     *rreq;
+    ucs_memory_type_t mem_type;
+    void              *buffer;
+
+    ucs_assert(ep_ext->stream.rndv_rreq == NULL);
+
+    rreq = ucp_request_get(ep->worker);
+    if (ucs_unlikely(rreq == NULL)) {
+        ucs_error("failed to allocate request for stream rendezvous");
+        return;
+    }
+
+    /* Fetch directly to the posted receive if all the data fits in it */
+    if (!ucp_stream_ep_has_data(ep_ext) &&
+        !ucs_queue_is_empty(&ep_ext->stream.match_q)) {
+        req = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
+                                            ucp_request_t, recv.queue);
+        if (!UCP_DT_IS_CONTIG(req->recv.datatype) ||
+            ((req->recv.length - req->recv.stream.offset) < size)) {
+            req = NULL;
+        }
+    }
+
+    if (req != NULL) {
+        buffer   = UCS_PTR_BYTE_OFFSET(req->recv.buffer,
+                                       req->recv.stream.offset);
+        mem_type = req->recv.mem_type;
+    } else {
+        rdesc = ucs_malloc(sizeof(*rdesc) + sizeof(ucp_stream_am_data_t) + size,
+                           "stream rndv rdesc");
+        if (ucs_unlikely(rdesc == NULL)) {
+            ucs_error("failed to allocate %zu bytes for stream data", size);
+            ucp_request_put(rreq);
+            ucp_stream_rndv_drop(ep, rndv_rts_hdr);
+            return;
+        }
+
+        rdesc->length         = size;
+        rdesc->payload_offset = sizeof(*rdesc) + sizeof(ucp_stream_am_data_t);
+        rdesc->flags          = UCP_RECV_DESC_FLAG_MALLOC;
+        buffer                = ucp_stream_rdesc_payload(rdesc);
+        mem_type              = UCS_MEMORY_TYPE_HOST;
+    }
+
+    ucs_trace_data("ep %p: fetching %zu stream bytes to %s %p", ep, size,
+                   (req != NULL) ? "request" : "bounce buffer", buffer);
+
+    ucp_stream_rndv_recv_init(rreq, ep, buffer, size, mem_type,
+                              UCP_REQUEST_FLAG_CALLBACK, req);
+    rreq->recv.tag.cb        = ucp_stream_rndv_recv_completed;
+    ep_ext->stream.rndv_rreq = rreq;
+    ucp_rndv_matched(ep->worker, rreq, rndv_rts_hdr);
+}
+
+ucs_status_t ucp_stream_ep_init(ucp_ep_h ep)
 {
     ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
+    size_t window              = ep->worker->context->config.ext.stream_window;
+    ucp_stream_ep_fc_t *fc;
+
+    if (!(ep->worker->context->config.features & UCP_FEATURE_STREAM)) {
+        return UCS_OK;
+    }
+
+    ep_ext->stream.ready_list.prev = NULL;
+    ep_ext->stream.ready_list.next = NULL;
+    ucs_queue_head_init(&ep_ext->stream.match_q);
+    ucs_queue_head_init(&ep_ext->stream.rndv_q);
+    ep_ext->stream.rndv_rreq       = NULL;
+    ep_ext->stream.fc              = NULL;
 
-    if (ep->worker->context->config.features & UCP_FEATURE_STREAM) {
-        ep_ext->stream.ready_list.prev = NULL;
-        ep_ext->stream.ready_list.next = NULL;
-        ucs_queue_head_init(&ep_ext->stream.match_q);
+    if (window == UCS_MEMUNITS_INF) {
+        return UCS_OK;
+    }
+
+    fc = ucs_malloc(sizeof(*fc), "ucp_stream_ep_fc");
+    if (fc == NULL) {
+        ucs_error("failed to allocate stream flow control state");
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    ucs_queue_head_init(&fc->send_q);
+    fc->send_credit   = window;
+    fc->recv_consumed = 0;
+    fc->credit_cb_id  = UCS_CALLBACKQ_ID_NULL;
+    ep_ext->stream.fc = fc;
+    return UCS_OK;
+}
+
+void ucp_stream_ep_destroy(ucp_ep_h ep)
+{
+    ucp_stream_ep_fc_t *fc;
+
+    if (!(ep->worker->context->config.features & UCP_FEATURE_STREAM)) {
+        return;
+    }
+
+    fc = ucp_ep_ext_proto(ep)->stream.fc;
+    if (fc != NULL) {
+        uct_worker_progress_unregister_safe(ep->worker->uct,
+                                            &fc->credit_cb_id);
+        ucs_free(fc);
     }
 }
 
 void ucp_stream_ep_cleanup(ucp_ep_h ep)
 {
+    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
+    ucp_recv_desc_t *rdesc;
     size_t length;
     void *data;
 
-    if (ep->worker->context->config.features & UCP_FEATURE_STREAM) {
-        while ((data = ucp_stream_recv_data_nb_nolock(ep, &length)) != NULL) {
-            ucs_assert_always(!UCS_PTR_IS_ERR(data));
-            ucp_stream_data_release(ep, data);
-        }
+    if (!(ep->worker->context->config.features & UCP_FEATURE_STREAM) ||
+        (ep_ext == NULL)) {
+        return;
+    }
 
-        if (ucp_stream_ep_is_queued(ucp_ep_ext_proto(ep))) {
-            ucp_stream_ep_dequeue(ucp_ep_ext_proto(ep));
-        }
+    ucp_stream_ep_send_cleanup(ep);
+
+    if (ep_ext->stream.rndv_rreq != NULL) {
+        /* the fetch can't be canceled, so its data is dropped */
+        ep_ext->stream.rndv_rreq->recv.tag.stream.ep = NULL;
+        ep_ext->stream.rndv_rreq                     = NULL;
+    }
+
+    while (!ucs_queue_is_empty(&ep_ext->stream.rndv_q)) {
+        rdesc = ucs_queue_pull_elem_non_empty(&ep_ext->stream.rndv_q,
+                                              ucp_recv_desc_t,
+                                              stream_queue);
+        ucp_stream_rdesc_release(rdesc);
+    }
+
+    while ((data = ucp_stream_recv_data_nb_nolock(ep, &length)) != NULL) {
+        ucs_assert_always(!UCS_PTR_IS_ERR(data));
+        ucp_stream_data_release(ep, data);
+    }
+
+    if (ucp_stream_ep_is_queued(ep_ext)) {
+        ucp_stream_ep_dequeue(ep_ext);
     }
 }
 
@@ -445,11 +791,56 @@ void ucp_stream_ep_activate(ucp_ep_h ep)
     ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
 
     if ((ep->worker->context->config.features & UCP_FEATURE_STREAM) &&
-        ucp_stream_ep_has_data(ep_ext) && !ucp_stream_ep_is_queued(ep_ext)) {
+        (ep_ext != NULL) && ucp_stream_ep_has_events(ep) &&
+        !ucp_stream_ep_is_queued(ep_ext)) {
         ucp_stream_ep_enqueue(ep_ext, ep->worker);
     }
 }
 
+size_t ucp_stream_ep_ready_length(ucp_ep_ext_proto_t *ep_ext)
+{
+    size_t length = 0;
+    ucp_recv_desc_t *rdesc;
+
+    if (!ucp_stream_ep_has_data(ep_ext)) {
+        return 0;
+    }
+
+    ucs_queue_for_each(rdesc, &ep_ext->stream.match_q, stream_queue) {
+        length += rdesc->length;
+    }
+
+    return length;
+}
+
+ucs_status_t ucp_stream_ep_set_poll_events(ucp_ep_h ep, unsigned events)
+{
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(ep->worker->context, UCP_FEATURE_STREAM,
+                                    return UCS_ERR_INVALID_PARAM);
+
+    if (events & ~(UCP_STREAM_POLL_FLAG_IN | UCP_STREAM_POLL_FLAG_OUT)) {
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    ep->flags &= ~(UCP_EP_FLAG_STREAM_NO_POLL_IN | UCP_EP_FLAG_STREAM_POLL_OUT);
+    if (!(events & UCP_STREAM_POLL_FLAG_IN)) {
+        ep->flags |= UCP_EP_FLAG_STREAM_NO_POLL_IN;
+    }
+    if (events & UCP_STREAM_POLL_FLAG_OUT) {
+        ep->flags |= UCP_EP_FLAG_STREAM_POLL_OUT;
+    } else {
+        ep->flags &= ~UCP_EP_FLAG_STREAM_OUT_READY;
+    }
+
+    ucp_stream_ep_update_ready(ep);
+
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+
+    return UCS_OK;
+}
+
 static UCS_F_ALWAYS_INLINE ucs_status_t
 ucp_stream_am_handler(void *am_arg, void *am_data, size_t am_length,
                       unsigned am_flags)
@@ -462,8 +853,7 @@ ucp_stream_am_handler(void *am_arg, void *am_data, size_t am_length,
 
     ucs_assert(am_length >= sizeof(ucp_stream_am_hdr_t));
 
-    ep     = ucp_worker_get_ep_by_ptr(worker, data->hdr.ep_ptr);
-    ep_ext = ucp_ep_ext_proto(ep);
+    ep = ucp_worker_get_ep_by_ptr(worker, data->hdr.ep_ptr);
 
     if (ucs_unlikely(ep->flags & UCP_EP_FLAG_CLOSED)) {
         ucs_trace_data("ep %p: stream is invalid", ep);
@@ -471,6 +861,12 @@ ucp_stream_am_handler(void *am_arg, void *am_data, size_t am_length,
         return UCS_OK;
     }
 
+    ep_ext = ucp_ep_ext_proto_get(ep);
+    if (ucs_unlikely(ep_ext == NULL)) {
+        ucs_error("ep %p: dropping stream data", ep);
+        return UCS_OK;
+    }
+
     status = ucp_stream_am_data_process(worker, ep_ext, data,
                                         am_length - sizeof(data->hdr),
                                         am_flags);
@@ -480,11 +876,6 @@ ucp_stream_am_handler(void *am_arg, void *am_data, size_t am_length,
     }
 
     ucs_assert(status == UCS_INPROGRESS);
-
-    if (!ucp_stream_ep_is_queued(ep_ext) && (ep->flags & UCP_EP_FLAG_USED)) {
-        ucp_stream_ep_enqueue(ep_ext, worker);
-    }
-
     return (am_flags & UCT_CB_PARAM_FLAG_DESC) ? UCS_INPROGRESS : UCS_OK;
 }
 
@@ -504,7 +895,62 @@ static void ucp_stream_am_dump(ucp_worker_h worker, uct_am_trace_type_t type,
                      length - hdr_len);
 }
 
+static ucs_status_t
+ucp_stream_rndv_rts_handler(void *am_arg, void *am_data, size_t am_length,
+                            unsigned am_flags)
+{
+    ucp_worker_h       worker        = am_arg;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = am_data;
+    ucp_recv_desc_t    *rdesc;
+    ucp_ep_h           ep;
+    ucp_ep_ext_proto_t *ep_ext;
+    ucs_status_t       status;
+
+    ep     = ucp_worker_get_ep_by_ptr(worker, rndv_rts_hdr->sreq.ep_ptr);
+    ep_ext = (ep->flags & UCP_EP_FLAG_CLOSED) ? NULL : ucp_ep_ext_proto_get(ep);
+
+    if (ucs_unlikely(ep_ext == NULL)) {
+        ucs_trace_data("ep %p: stream is invalid", ep);
+        ucp_stream_rndv_drop(ep, rndv_rts_hdr);
+        return UCS_OK;
+    }
+
+    if (ucs_likely(!ucp_stream_ep_rndv_busy(ep_ext))) {
+        ucp_stream_rndv_start(ep_ext, rndv_rts_hdr);
+        return UCS_OK;
+    }
+
+    /* keep the stream order, the RTS is handled after the current fetch */
+    status = ucp_recv_desc_init(worker, am_data, am_length, 0, am_flags, 0,
+                                UCP_RECV_DESC_FLAG_RNDV, 0, &rdesc);
+    if (ucs_unlikely(UCS_STATUS_IS_ERR(status))) {
+        ucs_error("ep %p: failed to allocate descriptor for stream rendezvous",
+                  ep);
+        ucp_stream_rndv_drop(ep, rndv_rts_hdr);
+        return UCS_OK;
+    }
+
+    ucs_queue_push(&ep_ext->stream.rndv_q, &rdesc->stream_queue);
+    return status;
+}
+
+static void ucp_stream_rndv_rts_dump(ucp_worker_h worker,
+                                     uct_am_trace_type_t type, uint8_t id,
+                                     const void *data, size_t length,
+                                     char *buffer, size_t max)
+{
+    const ucp_rndv_rts_hdr_t *rndv_rts_hdr = data;
+
+    snprintf(buffer, max, "STREAM_RNDV_RTS ep_ptr 0x%lx sreq 0x%lx "
+             "address 0x%"PRIx64" size %zu", rndv_rts_hdr->sreq.ep_ptr,
+             rndv_rts_hdr->sreq.reqptr, rndv_rts_hdr->address,
+             rndv_rts_hdr->size);
+}
+
 UCP_DEFINE_AM(UCP_FEATURE_STREAM, UCP_AM_ID_STREAM_DATA, ucp_stream_am_handler,
               ucp_stream_am_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_STREAM, UCP_AM_ID_STREAM_RNDV_RTS,
+              ucp_stream_rndv_rts_handler, ucp_stream_rndv_rts_dump, 0);
 
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_STREAM_DATA);
+UCP_DEFINE_AM_PROXY(UCP_AM_ID_STREAM_RNDV_RTS);
@@ -15,8 +15,10 @@
 #include <ucp/proto/proto.h>
 #include <ucp/proto/proto_am.inl>
 #include <ucp/stream/stream.h>
+#include <ucp/tag/rndv.h>
 #include <ucp/dt/dt.h>
 #include <ucp/dt/dt.inl>
+#include <ucs/sys/string.h>
 
 
 static UCS_F_ALWAYS_INLINE ucs_status_t
@@ -28,6 +30,31 @@ ucp_stream_send_am_short(ucp_ep_t *ep, const void *buffer, size_t length)
                            ucp_ep_dest_ep_ptr(ep), buffer, length);
 }
 
+static UCS_F_ALWAYS_INLINE int ucp_stream_send_window_enabled(ucp_ep_h ep)
+{
+    return ep->worker->context->config.ext.stream_window != UCS_MEMUNITS_INF;
+}
+
+/* Whether a new send of the given length may start now, or has to wait for
+ * credit, keeping the order of the sends which are already waiting */
+static UCS_F_ALWAYS_INLINE int
+ucp_stream_send_has_credit(ucp_ep_h ep, size_t length)
+{
+    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(ep);
+
+    return !ucp_stream_send_window_enabled(ep) ||
+           ((length <= ep_ext->stream.fc->send_credit) &&
+            ucs_queue_is_empty(&ep_ext->stream.fc->send_q));
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_stream_send_take_credit(ucp_ep_h ep, size_t length)
+{
+    if (ucp_stream_send_window_enabled(ep)) {
+        ucp_ep_ext_proto(ep)->stream.fc->send_credit -= length;
+    }
+}
+
 static void ucp_stream_send_req_init(ucp_request_t* req, ucp_ep_h ep,
                                      const void* buffer, uintptr_t datatype,
                                      size_t count, uint32_t flags)
@@ -47,18 +74,149 @@ static void ucp_stream_send_req_init(ucp_request_t* req, ucp_ep_h ep,
     VALGRIND_MAKE_MEM_UNDEFINED(&req->send.tag, sizeof(req->send.tag));
 }
 
+static size_t ucp_stream_rndv_rts_pack(void *dest, void *arg)
+{
+    ucp_request_t *sreq              = arg;
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = dest;
+
+    /* the endpoint is carried by the rendezvous header */
+    rndv_rts_hdr->super.tag = 0;
+    return ucp_rndv_rts_pack(sreq, rndv_rts_hdr);
+}
+
+static ucs_status_t ucp_stream_progress_rndv_rts(uct_pending_req_t *self)
+{
+    ucp_request_t *sreq = ucs_container_of(self, ucp_request_t, send.uct);
+    size_t packed_rkey_size;
+
+    /* the request is completed when the receiver acknowledges the data */
+    packed_rkey_size = ucp_ep_config(sreq->send.ep)->tag.rndv.rkey_size;
+    return ucp_do_am_single(self, UCP_AM_ID_STREAM_RNDV_RTS,
+                            ucp_stream_rndv_rts_pack,
+                            sizeof(ucp_rndv_rts_hdr_t) + packed_rkey_size);
+}
+
+static ucs_status_t ucp_stream_send_start_rndv(ucp_request_t *sreq)
+{
+    ucs_status_t status;
+
+    ucp_trace_req(sreq, "start stream rndv to %s buffer %p length %zu",
+                  ucp_ep_peer_name(sreq->send.ep), sreq->send.buffer,
+                  sreq->send.length);
+    UCS_PROFILE_REQUEST_EVENT(sreq, "start_stream_rndv", sreq->send.length);
+
+    status = ucp_rndv_send_buffer_reg(sreq);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ucs_assert(sreq->send.lane == ucp_ep_get_am_lane(sreq->send.ep));
+    sreq->send.uct.func = ucp_stream_progress_rndv_rts;
+    return UCS_OK;
+}
+
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_stream_send_start(ucp_request_t *req, size_t count)
+{
+    ucp_ep_config_t *config = ucp_ep_config(req->send.ep);
+    size_t rndv_thresh      = config->stream.rndv_thresh;
+    size_t zcopy_thresh     = ucp_proto_get_zcopy_threshold(req, &config->am,
+                                                            count, rndv_thresh);
+    ssize_t max_short       = ucp_proto_get_short_max(req, &config->am);
+    ucs_status_t status;
+
+    status = ucp_request_send_start(req, max_short, zcopy_thresh, rndv_thresh,
+                                    count, &config->am, config->stream.proto);
+    if (ucs_unlikely(status == UCS_ERR_NO_PROGRESS)) {
+        status = ucp_stream_send_start_rndv(req);
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        UCP_EP_STAT_STREAM_OP(req->send.ep, RNDV);
+    }
+
+    return status;
+}
+
+static void ucp_stream_send_progress_queue(ucp_ep_h ep)
+{
+    ucp_stream_ep_fc_t *fc = ucp_ep_ext_proto(ep)->stream.fc;
+    int blocked            = !ucs_queue_is_empty(&fc->send_q);
+    ucp_request_t *req;
+    ucs_status_t status;
+
+    while (!ucs_queue_is_empty(&fc->send_q)) {
+        req = ucs_queue_head_elem_non_empty(&fc->send_q, ucp_request_t,
+                                            send.stream.queue);
+        if (req->send.length > fc->send_credit) {
+            break;
+        }
+
+        ucs_queue_pull_non_empty(&fc->send_q);
+        fc->send_credit -= req->send.length;
+
+        status = ucp_stream_send_start(req, req->send.stream.count);
+        if (status != UCS_OK) {
+            ucp_request_complete_send(req, status);
+            continue;
+        }
+
+        ucp_request_send(req, 0);
+    }
+
+    if (blocked && ucs_queue_is_empty(&fc->send_q) &&
+        (ep->flags & UCP_EP_FLAG_STREAM_POLL_OUT)) {
+        ep->flags |= UCP_EP_FLAG_STREAM_OUT_READY;
+        ucp_stream_ep_update_ready(ep);
+    }
+}
+
+void ucp_stream_ep_send_cleanup(ucp_ep_h ep)
+{
+    ucp_stream_ep_fc_t *fc = ucp_ep_ext_proto(ep)->stream.fc;
+    ucp_request_t *req;
+
+    if (fc == NULL) {
+        return;
+    }
+
+    while (!ucs_queue_is_empty(&fc->send_q)) {
+        req = ucs_queue_pull_elem_non_empty(&fc->send_q, ucp_request_t,
+                                            send.stream.queue);
+        ucp_request_complete_send(req, UCS_ERR_CANCELED);
+    }
+}
+
 static UCS_F_ALWAYS_INLINE ucs_status_ptr_t
-ucp_stream_send_req(ucp_request_t *req, size_t count,
-                    const ucp_ep_msg_config_t* msg_config,
-                    ucp_send_callback_t cb, const ucp_proto_t *proto)
+ucp_stream_send_req(ucp_request_t *req, size_t count, ucp_send_callback_t cb)
 {
-    size_t zcopy_thresh = ucp_proto_get_zcopy_threshold(req, msg_config,
-                                                        count, SIZE_MAX);
-    ssize_t max_short   = ucp_proto_get_short_max(req, msg_config);
+    ucp_context_h context = req->send.ep->worker->context;
+    ucs_status_t status;
 
-    ucs_status_t status = ucp_request_send_start(req, max_short, zcopy_thresh,
-                                                 SIZE_MAX, count, msg_config,
-                                                 proto);
+    if (ucs_unlikely(!ucp_stream_send_has_credit(req->send.ep,
+                                                 req->send.length))) {
+        if (req->send.length > context->config.ext.stream_window) {
+            /* would never get enough credit */
+            ucs_debug("stream send length %zu exceeds the stream window %zu",
+                      req->send.length, context->config.ext.stream_window);
+            ucp_request_put(req);
+            return UCS_STATUS_PTR(UCS_ERR_EXCEEDS_LIMIT);
+        }
+
+        /* the receiver's window is full, start the send when it grants more
+         * credit */
+        ucs_trace_req("stream send request %p waits for credit", req);
+        req->send.stream.count = count;
+        ucs_queue_push(&ucp_ep_ext_proto(req->send.ep)->stream.fc->send_q,
+                       &req->send.stream.queue);
+        ucp_request_set_callback(req, send.cb, cb);
+        return req + 1;
+    }
+
+    ucp_stream_send_take_credit(req->send.ep, req->send.length);
+
+    status = ucp_stream_send_start(req, count);
     if (status != UCS_OK) {
         return UCS_STATUS_PTR(status);
     }
@@ -109,13 +267,22 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_stream_send_nb,
         goto out;
     }
 
+    /* the send credit is kept in the protocol extension */
+    if (ucs_unlikely(ucp_stream_send_window_enabled(ep)) &&
+        (ucp_ep_ext_proto_get(ep) == NULL)) {
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
     if (ucs_likely(UCP_DT_IS_CONTIG(datatype)) &&
         ucp_memory_type_cache_is_empty(ep->worker->context)) {
         length = ucp_contig_dt_length(datatype, count);
-        if (ucs_likely((ssize_t)length <= ucp_ep_config(ep)->am.max_short)) {
+        if (ucs_likely((ssize_t)length <= ucp_ep_config(ep)->am.max_short) &&
+            ucp_stream_send_has_credit(ep, length)) {
             status = UCS_PROFILE_CALL(ucp_stream_send_am_short, ep, buffer,
                                       length);
             if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
+                ucp_stream_send_take_credit(ep, length);
                 UCP_EP_STAT_TAG_OP(ep, EAGER);
                 ret = UCS_STATUS_PTR(status); /* UCS_OK also goes here */
                 goto out;
@@ -131,8 +298,7 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_stream_send_nb,
 
     ucp_stream_send_req_init(req, ep, buffer, datatype, count, flags);
 
-    ret = ucp_stream_send_req(req, count, &ucp_ep_config(ep)->am, cb,
-                              ucp_ep_config(ep)->stream.proto);
+    ret = ucp_stream_send_req(req, count, cb);
 
 out:
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
@@ -253,6 +419,125 @@ static ucs_status_t ucp_stream_eager_zcopy_multi(uct_pending_req_t *self)
                                  ucp_proto_am_zcopy_req_complete, 0);
 }
 
+static size_t ucp_stream_pack_credit(void *dest, void *arg)
+{
+    ucp_request_t *req           = arg;
+    ucp_stream_credit_hdr_t *hdr = dest;
+
+    hdr->ep_ptr = ucp_request_get_dest_ep_ptr(req);
+    hdr->credit = req->send.stream_credit.credit;
+    return sizeof(*hdr);
+}
+
+static ucs_status_t ucp_stream_progress_credit(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucs_status_t status;
+
+    status = ucp_do_am_single(self, UCP_AM_ID_STREAM_CREDIT,
+                              ucp_stream_pack_credit,
+                              sizeof(ucp_stream_credit_hdr_t));
+    if (status == UCS_OK) {
+        ucp_request_put(req);
+    }
+
+    return status;
+}
+
+static unsigned ucp_stream_send_credit_progress(void *arg)
+{
+    ucp_ep_h ep            = arg;
+    ucp_stream_ep_fc_t *fc = ucp_ep_ext_proto(ep)->stream.fc;
+
+    uct_worker_progress_unregister_safe(ep->worker->uct, &fc->credit_cb_id);
+    if (fc->recv_consumed == 0) {
+        return 0;
+    }
+
+    ucp_stream_send_credit(ep);
+    return 1;
+}
+
+void ucp_stream_send_credit(ucp_ep_h ep)
+{
+    ucp_stream_ep_fc_t *fc = ucp_ep_ext_proto(ep)->stream.fc;
+    ucp_request_t *req;
+    ucs_status_t status;
+
+    status = ucp_ep_resolve_dest_ep_ptr(ep, ep->am_lane);
+    if (status != UCS_OK) {
+        ucs_error("ep %p: failed to grant stream credit: %s", ep,
+                  ucs_status_string(status));
+        return;
+    }
+
+    req = ucp_request_get(ep->worker);
+    if (req == NULL) {
+        /* keep the consumed data and retry granting it from progress, since
+         * the sender could be waiting for this credit */
+        ucs_trace_data("ep %p: no request to grant stream credit, retrying",
+                       ep);
+        uct_worker_progress_register_safe(ep->worker->uct,
+                                          ucp_stream_send_credit_progress, ep,
+                                          0, &fc->credit_cb_id);
+        return;
+    }
+
+    ucs_trace_data("ep %p: granting %zu bytes of stream credit", ep,
+                   fc->recv_consumed);
+
+    req->flags                     = 0;
+    req->send.ep                   = ep;
+    req->send.mdesc                = NULL;
+    req->send.pending_lane         = UCP_NULL_LANE;
+    req->send.lane                 = ucp_ep_get_am_lane(ep);
+    req->send.uct.func             = ucp_stream_progress_credit;
+    req->send.stream_credit.credit = fc->recv_consumed;
+    fc->recv_consumed              = 0;
+
+    ucp_request_send(req, 0);
+}
+
+static ucs_status_t
+ucp_stream_credit_handler(void *am_arg, void *am_data, size_t am_length,
+                          unsigned am_flags)
+{
+    ucp_worker_h worker          = am_arg;
+    ucp_stream_credit_hdr_t *hdr = am_data;
+    ucp_ep_h ep;
+
+    ep = ucp_worker_get_ep_by_ptr(worker, hdr->ep_ptr);
+    if (ucs_unlikely(ep->flags & UCP_EP_FLAG_CLOSED)) {
+        return UCS_OK;
+    }
+
+    if ((ucp_ep_ext_proto(ep) == NULL) ||
+        (ucp_ep_ext_proto(ep)->stream.fc == NULL)) {
+        ucs_warn("ep %p: unexpected stream credit, STREAM_WINDOW differs from"
+                 " the remote peer", ep);
+        return UCS_OK;
+    }
+
+    ucp_ep_ext_proto(ep)->stream.fc->send_credit += hdr->credit;
+    ucp_stream_send_progress_queue(ep);
+    return UCS_OK;
+}
+
+static void ucp_stream_credit_dump(ucp_worker_h worker, uct_am_trace_type_t type,
+                                   uint8_t id, const void *data, size_t length,
+                                   char *buffer, size_t max)
+{
+    const ucp_stream_credit_hdr_t *hdr = data;
+
+    snprintf(buffer, max, "STREAM_CREDIT ep_ptr 0x%lx credit %zu", hdr->ep_ptr,
+             hdr->credit);
+}
+
+UCP_DEFINE_AM(UCP_FEATURE_STREAM, UCP_AM_ID_STREAM_CREDIT,
+              ucp_stream_credit_handler, ucp_stream_credit_dump, 0);
+
+UCP_DEFINE_AM_PROXY(UCP_AM_ID_STREAM_CREDIT);
+
 const ucp_proto_t ucp_stream_am_proto = {
     .contig_short            = ucp_stream_contig_am_short,
     .bcopy_single            = ucp_stream_bcopy_single,
@@ -62,6 +62,15 @@ typedef struct {
 } UCS_S_PACKED ucp_eager_sync_first_hdr_t;
 
 
+/*
+ * Header of every message in EAGER_BUNDLE
+ */
+typedef struct {
+    ucp_eager_hdr_t           super;
+    uint32_t                  length;
+} UCS_S_PACKED ucp_eager_bundle_hdr_t;
+
+
 extern const ucp_proto_t ucp_tag_eager_proto;
 extern const ucp_proto_t ucp_tag_eager_sync_proto;
 
@@ -78,4 +87,8 @@ void ucp_tag_eager_sync_zcopy_req_complete(ucp_request_t *req, ucs_status_t stat
 
 void ucp_tag_eager_sync_zcopy_completion(uct_completion_t *self, ucs_status_t status);
 
+int ucp_tag_eager_bundle_add(ucp_request_t *req, const ucp_proto_t *proto);
+
+void ucp_tag_eager_bundle_start(ucp_request_t *req, const ucp_proto_t *proto);
+
 #endif
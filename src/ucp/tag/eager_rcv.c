@@ -195,6 +195,36 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_eager_middle_handler,
     return status;
 }
 
+UCS_PROFILE_FUNC(ucs_status_t, ucp_eager_bundle_handler,
+                 (arg, data, length, am_flags),
+                 void *arg, void *data, size_t length, unsigned am_flags)
+{
+    size_t offset = 0;
+    ucp_eager_bundle_hdr_t *hdr;
+    size_t item_len;
+
+    /* the messages are copied out of the bundle, which is released when the
+     * handler returns */
+    while (offset < length) {
+        hdr = UCS_PTR_BYTE_OFFSET(data, offset);
+        if (ucs_unlikely((length - offset < sizeof(*hdr)) ||
+                         (length - offset < sizeof(*hdr) + hdr->length))) {
+            ucs_warn("worker %p: dropping malformed eager bundle of %zu bytes,"
+                     " message at offset %zu exceeds it", arg, length, offset);
+            break;
+        }
+
+        item_len = sizeof(*hdr) + hdr->length;
+        ucp_eager_tagged_handler(arg, hdr, item_len, 0,
+                                 UCP_RECV_DESC_FLAG_EAGER |
+                                 UCP_RECV_DESC_FLAG_EAGER_ONLY,
+                                 sizeof(*hdr), 0);
+        offset += ucs_align_up_pow2(item_len, sizeof(uint64_t));
+    }
+
+    return UCS_OK;
+}
+
 UCS_PROFILE_FUNC(ucs_status_t, ucp_eager_sync_only_handler,
                  (arg, data, length, am_flags),
                  void *arg, void *data, size_t length, unsigned am_flags)
@@ -305,6 +335,7 @@ static void ucp_eager_dump(ucp_worker_h worker, uct_am_trace_type_t type,
     const ucp_eager_sync_hdr_t *eagers_hdr       = data;
     const ucp_reply_hdr_t *rep_hdr               = data;
     const ucp_offload_ssend_hdr_t *off_rep_hdr   = data;
+    const ucp_eager_bundle_hdr_t *eagerb_hdr     = data;
     size_t header_len;
     char *p;
 
@@ -324,6 +355,11 @@ static void ucp_eager_dump(ucp_worker_h worker, uct_am_trace_type_t type,
                  eager_mid_hdr->msg_id, eager_mid_hdr->offset);
         header_len = sizeof(*eager_mid_hdr);
         break;
+    case UCP_AM_ID_EAGER_BUNDLE:
+        snprintf(buffer, max, "EGR_B tag %"PRIx64" len %u",
+                 eagerb_hdr->super.super.tag, eagerb_hdr->length);
+        header_len = sizeof(*eagerb_hdr);
+        break;
     case UCP_AM_ID_EAGER_SYNC_ONLY:
         ucs_assert(eagers_hdr->req.ep_ptr != 0);
         snprintf(buffer, max, "EGRS tag %"PRIx64" ep_ptr 0x%lx request 0x%lx",
@@ -366,6 +402,8 @@ UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_EAGER_FIRST, ucp_eager_first_handler,
               ucp_eager_dump, 0);
 UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_EAGER_MIDDLE, ucp_eager_middle_handler,
               ucp_eager_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_EAGER_BUNDLE, ucp_eager_bundle_handler,
+              ucp_eager_dump, 0);
 UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_EAGER_SYNC_ONLY,
               ucp_eager_sync_only_handler, ucp_eager_dump, 0);
 UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_EAGER_SYNC_FIRST,
@@ -378,6 +416,7 @@ UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_OFFLOAD_SYNC_ACK,
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_EAGER_ONLY);
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_EAGER_FIRST);
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_EAGER_MIDDLE);
+UCP_DEFINE_AM_PROXY(UCP_AM_ID_EAGER_BUNDLE);
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_EAGER_SYNC_ONLY);
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_EAGER_SYNC_FIRST);
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_EAGER_SYNC_ACK);
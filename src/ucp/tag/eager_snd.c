@@ -205,6 +205,195 @@ const ucp_proto_t ucp_tag_eager_proto = {
     .mid_hdr_size            = sizeof(ucp_eager_hdr_t)
 };
 
+/* eager bundle */
+
+typedef struct {
+    ucp_request_t         *req;        /* Bundle leader */
+    int                   pack_leader; /* Whether the leader was packed */
+    unsigned              count;       /* Number of packed followers */
+} ucp_tag_eager_bundle_pack_arg_t;
+
+static UCS_F_ALWAYS_INLINE size_t ucp_tag_eager_bundle_item_size(size_t length)
+{
+    return sizeof(ucp_eager_bundle_hdr_t) + length;
+}
+
+static size_t ucp_tag_eager_bundle_pack_item(void *dest, ucp_request_t *req)
+{
+    ucp_eager_bundle_hdr_t *hdr = dest;
+
+    hdr->super.super.tag = req->send.tag.tag;
+    hdr->length          = req->send.length;
+    memcpy(hdr + 1, req->send.buffer, req->send.length);
+    return ucp_tag_eager_bundle_item_size(req->send.length);
+}
+
+static size_t ucp_tag_eager_bundle_pack(void *dest, void *arg)
+{
+    ucp_tag_eager_bundle_pack_arg_t *pack_arg = arg;
+    ucp_request_t *req                        = pack_arg->req;
+    size_t max_bcopy                          = ucp_ep_get_max_bcopy(req->send.ep,
+                                                                     req->send.lane);
+    size_t length                             = 0;
+    size_t offset                             = 0;
+    ucp_request_t *sreq;
+
+    /* pack the messages which fit, without padding after the last one */
+    if (req->send.state.dt.offset == 0) {
+        length                = ucp_tag_eager_bundle_pack_item(dest, req);
+        offset                = ucs_align_up_pow2(length, sizeof(uint64_t));
+        pack_arg->pack_leader = 1;
+    }
+
+    ucs_queue_for_each(sreq, &req->send.tag.bundle_q, send.tag.bundle_elem) {
+        if ((offset + ucp_tag_eager_bundle_item_size(sreq->send.length)) >
+            max_bcopy) {
+            break;
+        }
+
+        length = offset +
+                 ucp_tag_eager_bundle_pack_item(UCS_PTR_BYTE_OFFSET(dest, offset),
+                                                sreq);
+        offset = ucs_align_up_pow2(length, sizeof(uint64_t));
+        ++pack_arg->count;
+    }
+
+    return length;
+}
+
+static void ucp_tag_eager_bundle_complete(ucp_request_t *req,
+                                          ucs_status_t status)
+{
+    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(req->send.ep);
+    ucp_request_t *sreq;
+
+    if (ep_ext->tag.bundle_req == req) {
+        ep_ext->tag.bundle_req = NULL;
+    }
+
+    ucs_queue_for_each_extract(sreq, &req->send.tag.bundle_q,
+                               send.tag.bundle_elem, 1) {
+        ucp_request_complete_send(sreq, status);
+    }
+}
+
+static void ucp_tag_eager_bundle_completion(uct_completion_t *self,
+                                            ucs_status_t status)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t,
+                                          send.state.uct_comp);
+
+    /* the leader was purged from the pending queue */
+    ucp_tag_eager_bundle_complete(req, status);
+    ucp_request_complete_send(req, status);
+}
+
+static ucs_status_t ucp_tag_eager_bundle_progress(uct_pending_req_t *self)
+{
+    ucp_request_t *req                       = ucs_container_of(self,
+                                                                ucp_request_t,
+                                                                send.uct);
+    ucp_ep_t *ep                             = req->send.ep;
+    ucp_tag_eager_bundle_pack_arg_t pack_arg = {req, 0, 0};
+    ucp_request_t *sreq;
+    ssize_t packed_len;
+
+    req->send.lane = ucp_ep_get_am_lane(ep);
+    packed_len     = uct_ep_am_bcopy(ep->uct_eps[req->send.lane],
+                                     UCP_AM_ID_EAGER_BUNDLE,
+                                     ucp_tag_eager_bundle_pack, &pack_arg, 0);
+    if (ucs_unlikely(packed_len < 0)) {
+        if (packed_len != UCS_ERR_NO_RESOURCE) {
+            /* the leader is completed by the caller */
+            ucp_tag_eager_bundle_complete(req, (ucs_status_t)packed_len);
+        }
+        return (ucs_status_t)packed_len;
+    }
+
+    if (pack_arg.pack_leader) {
+        req->send.state.dt.offset = req->send.length;
+    }
+
+    /* completion callbacks may add more messages to the bundle, after the
+     * ones which were sent */
+    for (; pack_arg.count > 0; --pack_arg.count) {
+        sreq = ucs_queue_pull_elem_non_empty(&req->send.tag.bundle_q,
+                                             ucp_request_t,
+                                             send.tag.bundle_elem);
+        ucp_request_complete_send(sreq, UCS_OK);
+    }
+
+    if (!ucs_queue_is_empty(&req->send.tag.bundle_q)) {
+        return UCS_INPROGRESS;
+    }
+
+    ucp_tag_eager_bundle_complete(req, UCS_OK);
+    ucp_request_complete_send(req, UCS_OK);
+    return UCS_OK;
+}
+
+static int ucp_tag_eager_bundle_is_allowed(ucp_request_t *req,
+                                           const ucp_proto_t *proto)
+{
+    ucp_ep_h ep = req->send.ep;
+
+    /* sync and offloaded sends have their own protocols */
+    return (proto == &ucp_tag_eager_proto) &&
+           UCP_DT_IS_CONTIG(req->send.datatype) &&
+           UCP_MEM_IS_HOST(req->send.mem_type) &&
+           (req->send.length <=
+            ep->worker->context->config.ext.tag_aggregate_thresh) &&
+           (ucp_tag_eager_bundle_item_size(req->send.length) <=
+            ucp_ep_get_max_bcopy(ep, ucp_ep_get_am_lane(ep)));
+}
+
+int ucp_tag_eager_bundle_add(ucp_request_t *req, const ucp_proto_t *proto)
+{
+    ucp_ep_ext_proto_t *ep_ext = ucp_ep_ext_proto(req->send.ep);
+    ucp_request_t *leader;
+
+    if ((ep_ext == NULL) || (ep_ext->tag.bundle_req == NULL)) {
+        return 0;
+    }
+
+    if (!ucp_tag_eager_bundle_is_allowed(req, proto)) {
+        /* the message is queued after the bundle, so new small messages must
+         * not be added to it anymore */
+        ep_ext->tag.bundle_req = NULL;
+        return 0;
+    }
+
+    leader = ep_ext->tag.bundle_req;
+    ucs_trace_req("adding send request %p to bundle %p", req, leader);
+    ucs_queue_push(&leader->send.tag.bundle_q, &req->send.tag.bundle_elem);
+    return 1;
+}
+
+void ucp_tag_eager_bundle_start(ucp_request_t *req, const ucp_proto_t *proto)
+{
+    ucp_ep_ext_proto_t *ep_ext;
+
+    /* only a single-fragment send waiting in the pending queue can lead a
+     * bundle */
+    if (((req->send.uct.func != proto->contig_short) &&
+         (req->send.uct.func != proto->bcopy_single)) ||
+        !ucp_tag_eager_bundle_is_allowed(req, proto)) {
+        return;
+    }
+
+    ep_ext = ucp_ep_ext_proto_get(req->send.ep);
+    if (ep_ext == NULL) {
+        return;
+    }
+
+    ucs_trace_req("send request %p starts a bundle", req);
+    ucs_queue_head_init(&req->send.tag.bundle_q);
+    req->send.state.dt.offset     = 0;
+    req->send.state.uct_comp.func = ucp_tag_eager_bundle_completion;
+    req->send.uct.func            = ucp_tag_eager_bundle_progress;
+    ep_ext->tag.bundle_req        = req;
+}
+
 /* eager sync */
 
 void ucp_tag_eager_sync_completion(ucp_request_t *req, uint32_t flag,
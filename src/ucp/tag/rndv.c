@@ -15,6 +15,7 @@
 #include <ucp/proto/proto.h>
 #include <ucp/proto/proto_am.inl>
 #include <ucs/datastruct/queue.h>
+#include <ucs/sys/string.h>
 
 static int ucp_rndv_is_get_zcopy(ucp_request_t *sreq, ucp_rndv_mode_t rndv_mode)
 {
@@ -24,14 +25,11 @@ static int ucp_rndv_is_get_zcopy(ucp_request_t *sreq, ucp_rndv_mode_t rndv_mode)
               UCP_MEM_IS_ROCM(sreq->send.mem_type))));
 }
 
-size_t ucp_tag_rndv_rts_pack(void *dest, void *arg)
+size_t ucp_rndv_rts_pack(ucp_request_t *sreq, ucp_rndv_rts_hdr_t *rndv_rts_hdr)
 {
-    ucp_request_t *sreq              = arg;   /* send request */
-    ucp_rndv_rts_hdr_t *rndv_rts_hdr = dest;
-    ucp_worker_h worker              = sreq->send.ep->worker;
+    ucp_worker_h worker = sreq->send.ep->worker;
     ssize_t packed_rkey_size;
 
-    rndv_rts_hdr->super.tag        = sreq->send.tag.tag;
     rndv_rts_hdr->sreq.reqptr      = (uintptr_t)sreq;
     rndv_rts_hdr->sreq.ep_ptr      = ucp_request_get_dest_ep_ptr(sreq);
     rndv_rts_hdr->size             = sreq->send.length;
@@ -61,6 +59,15 @@ size_t ucp_tag_rndv_rts_pack(void *dest, void *arg)
     return sizeof(*rndv_rts_hdr) + packed_rkey_size;
 }
 
+size_t ucp_tag_rndv_rts_pack(void *dest, void *arg)
+{
+    ucp_request_t *sreq              = arg;   /* send request */
+    ucp_rndv_rts_hdr_t *rndv_rts_hdr = dest;
+
+    rndv_rts_hdr->super.tag = sreq->send.tag.tag;
+    return ucp_rndv_rts_pack(sreq, rndv_rts_hdr);
+}
+
 UCS_PROFILE_FUNC(ucs_status_t, ucp_proto_progress_rndv_rts, (self),
                  uct_pending_req_t *self)
 {
@@ -78,6 +85,8 @@ static size_t ucp_tag_rndv_rtr_pack(void *dest, void *arg)
     ucp_request_t *rndv_req          = arg;
     ucp_rndv_rtr_hdr_t *rndv_rtr_hdr = dest;
     ucp_request_t *rreq              = rndv_req->send.rndv_rtr.rreq;
+    size_t window                    = rndv_req->send.ep->worker->context->
+                                           config.ext.rndv_am_window;
     ssize_t packed_rkey_size;
 
     rndv_rtr_hdr->sreq_ptr = rndv_req->send.rndv_rtr.remote_request;
@@ -99,20 +108,33 @@ static size_t ucp_tag_rndv_rtr_pack(void *dest, void *arg)
         packed_rkey_size      = 0;
     }
 
-    return sizeof(*rndv_rtr_hdr) + packed_rkey_size;
+    if (ucs_likely(window == UCS_MEMUNITS_INF)) {
+        return sizeof(*rndv_rtr_hdr) + packed_rkey_size;
+    }
+
+    /* the window is added only if it is limited, so the RTR of a receiver
+     * which does not limit it stays compatible with older peers */
+    *(size_t*)UCS_PTR_BYTE_OFFSET(rndv_rtr_hdr + 1, packed_rkey_size) = window;
+    return sizeof(*rndv_rtr_hdr) + packed_rkey_size + sizeof(window);
 }
 
 UCS_PROFILE_FUNC(ucs_status_t, ucp_proto_progress_rndv_rtr, (self),
                  uct_pending_req_t *self)
 {
     ucp_request_t *rndv_req = ucs_container_of(self, ucp_request_t, send.uct);
-    size_t packed_rkey_size;
+    ucp_worker_h worker     = rndv_req->send.ep->worker;
+    size_t max_packed_size;
     ucs_status_t status;
 
     /* send the RTR. the pack_cb will pack all the necessary fields in the RTR */
-    packed_rkey_size = ucp_ep_config(rndv_req->send.ep)->tag.rndv.rkey_size;
+    max_packed_size = sizeof(ucp_rndv_rtr_hdr_t) +
+                      ucp_ep_config(rndv_req->send.ep)->tag.rndv.rkey_size;
+    if (worker->context->config.ext.rndv_am_window != UCS_MEMUNITS_INF) {
+        max_packed_size += sizeof(size_t);
+    }
+
     status = ucp_do_am_single(self, UCP_AM_ID_RNDV_RTR, ucp_tag_rndv_rtr_pack,
-                              sizeof(ucp_rndv_rtr_hdr_t) + packed_rkey_size);
+                              max_packed_size);
     if (status == UCS_OK) {
         ucp_request_put(rndv_req);
     }
@@ -120,10 +142,23 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_proto_progress_rndv_rtr, (self),
     return status;
 }
 
+ucs_status_t ucp_rndv_send_buffer_reg(ucp_request_t *sreq)
+{
+    ucp_ep_h ep = sreq->send.ep;
+
+    if (UCP_DT_IS_CONTIG(sreq->send.datatype) &&
+        ucp_rndv_is_get_zcopy(sreq, ep->worker->context->config.ext.rndv_mode)) {
+        /* register a contiguous buffer for rma_get */
+        return ucp_request_send_buffer_reg(sreq,
+                                           ucp_ep_config(ep)->key.rma_bw_md_map);
+    }
+
+    return UCS_OK;
+}
+
 ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *sreq)
 {
     ucp_ep_h ep = sreq->send.ep;
-    ucp_md_map_t md_map;
     ucs_status_t status;
 
     ucp_trace_req(sreq, "start_rndv to %s buffer %p length %zu",
@@ -142,14 +177,9 @@ ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *sreq)
             return status;
         }
     } else {
-        if (UCP_DT_IS_CONTIG(sreq->send.datatype) &&
-            ucp_rndv_is_get_zcopy(sreq, ep->worker->context->config.ext.rndv_mode)) {
-            /* register a contiguous buffer for rma_get */
-            md_map = ucp_ep_config(ep)->key.rma_bw_md_map;
-            status = ucp_request_send_buffer_reg(sreq, md_map);
-            if (status != UCS_OK) {
-                return status;
-            }
+        status = ucp_rndv_send_buffer_reg(sreq);
+        if (status != UCS_OK) {
+            return status;
         }
 
         ucs_assert(sreq->send.lane == ucp_ep_get_am_lane(ep));
@@ -201,8 +231,8 @@ static void ucp_rndv_send_atp(ucp_request_t *sreq, uintptr_t remote_request)
     ucp_trace_req(sreq, "send atp remote_request 0x%lx", remote_request);
     UCS_PROFILE_REQUEST_EVENT(sreq, "send_atp", 0);
 
-    /* destroy rkey before it gets overridden by ATP protocol data */
-    ucp_rkey_destroy(sreq->send.rndv_put.rkey);
+    /* release rkey before it gets overridden by ATP protocol data */
+    ucp_ep_rkey_cache_release(sreq->send.ep, sreq->send.rndv_put.rkey);
 
     sreq->send.lane                 = ucp_ep_get_am_lane(sreq->send.ep);
     sreq->send.uct.func             = ucp_proto_progress_am_single;
@@ -231,13 +261,182 @@ static void ucp_rndv_complete_rma_get_zcopy(ucp_request_t *rndv_req)
     ucp_trace_req(rndv_req, "rndv_get completed");
     UCS_PROFILE_REQUEST_EVENT(rreq, "complete_rndv_get", 0);
 
-    ucp_rkey_destroy(rndv_req->send.rndv_get.rkey);
+    ucp_ep_rkey_cache_release(rndv_req->send.ep, rndv_req->send.rndv_get.rkey);
     ucp_request_send_buffer_dereg(rndv_req);
 
     ucp_rndv_req_send_ats(rndv_req, rreq, rndv_req->send.rndv_get.remote_request);
     ucp_rndv_zcopy_recv_req_complete(rreq, UCS_OK);
 }
 
+void ucp_rndv_get_completion(uct_completion_t *self, ucs_status_t status);
+
+static UCS_F_ALWAYS_INLINE int ucp_rndv_get_sched_is_enabled(ucp_worker_h worker)
+{
+    return (worker->context->config.ext.rndv_max_inflight     != UCS_MEMUNITS_INF) ||
+           (worker->context->config.ext.rndv_max_inflight_ops != UCS_ULUNITS_INF);
+}
+
+/* Get requests of pipelined memory-type fragments are bounded by the
+ * fragments pool, so only the ones posted directly to the user buffer are
+ * scheduled */
+static UCS_F_ALWAYS_INLINE int ucp_rndv_get_is_sched(ucp_request_t *rndv_req)
+{
+    return ucp_rndv_get_sched_is_enabled(rndv_req->send.ep->worker) &&
+           (rndv_req->send.state.uct_comp.func == ucp_rndv_get_completion);
+}
+
+/* Data reserved from the worker budget by the current fragment of the
+ * request: the fragment size, or less for the last fragment */
+static size_t ucp_rndv_get_sched_reserved(ucp_request_t *rndv_req)
+{
+    return ucs_min(rndv_req->send.ep->worker->context->config.ext.rndv_frag_size,
+                   rndv_req->send.length - rndv_req->send.state.dt.offset +
+                   rndv_req->send.rndv_get.sched_bytes);
+}
+
+static int ucp_rndv_get_sched_acquire(ucp_request_t *rndv_req)
+{
+    ucp_worker_h worker   = rndv_req->send.ep->worker;
+    ucp_context_h context = worker->context;
+    size_t reserved;
+
+    ucs_assert(!(rndv_req->flags & UCP_REQUEST_FLAG_RNDV_GET_SCHED));
+
+    rndv_req->send.rndv_get.sched_bytes = 0;
+    reserved = ucp_rndv_get_sched_reserved(rndv_req);
+
+    /* always let one fragment through, so a budget smaller than a fragment
+     * does not stall all transfers */
+    if ((worker->rndv_get_sched.ops != 0) &&
+        ((worker->rndv_get_sched.ops >= context->config.ext.rndv_max_inflight_ops) ||
+         (worker->rndv_get_sched.bytes + reserved >
+          context->config.ext.rndv_max_inflight))) {
+        return 0;
+    }
+
+    worker->rndv_get_sched.bytes += reserved;
+    ++worker->rndv_get_sched.ops;
+    rndv_req->flags              |= UCP_REQUEST_FLAG_RNDV_GET_SCHED;
+    return 1;
+}
+
+static void ucp_rndv_get_sched_release(ucp_request_t *rndv_req)
+{
+    ucp_worker_h worker = rndv_req->send.ep->worker;
+    size_t reserved     = ucp_rndv_get_sched_reserved(rndv_req);
+
+    ucs_assert(rndv_req->flags & UCP_REQUEST_FLAG_RNDV_GET_SCHED);
+    ucs_assert(worker->rndv_get_sched.ops > 0);
+    ucs_assert(worker->rndv_get_sched.bytes >= reserved);
+
+    worker->rndv_get_sched.bytes -= reserved;
+    --worker->rndv_get_sched.ops;
+    rndv_req->flags              &= ~UCP_REQUEST_FLAG_RNDV_GET_SCHED;
+}
+
+/* The request is not on any pending queue while it waits for the budget, so
+ * the pending queue element is reused to link it */
+static void ucp_rndv_get_sched_wait(ucp_request_t *rndv_req)
+{
+    ucp_trace_req(rndv_req, "rndv_get waiting for budget at offset %zu",
+                  rndv_req->send.state.dt.offset);
+    ucs_queue_push(&rndv_req->send.ep->worker->rndv_get_sched.queue,
+                   (ucs_queue_elem_t*)&rndv_req->send.uct.priv);
+}
+
+/* Hand out the released budget to the waiting requests: first to the ones
+ * which can complete with a single fragment, then in round-robin order.
+ * Requests which are resumed from here and release their budget right away
+ * (because their data was fetched synchronously) are picked up again by the
+ * same loop, rather than by a nested dispatch. */
+static void ucp_rndv_get_sched_dispatch(ucp_worker_h worker)
+{
+    ucs_queue_head_t *queue = &worker->rndv_get_sched.queue;
+    size_t frag_size        = worker->context->config.ext.rndv_frag_size;
+    ucs_queue_iter_t iter;
+    ucp_request_t *rndv_req;
+
+    if (worker->rndv_get_sched.dispatching) {
+        return;
+    }
+
+    worker->rndv_get_sched.dispatching = 1;
+    while (!ucs_queue_is_empty(queue)) {
+        for (iter = ucs_queue_iter_begin(queue); !ucs_queue_iter_end(queue, iter);
+             iter = ucs_queue_iter_next(iter)) {
+            rndv_req = ucs_queue_iter_elem(rndv_req, iter, send.uct.priv);
+            if ((rndv_req->send.length - rndv_req->send.state.dt.offset) <=
+                frag_size) {
+                break;
+            }
+        }
+
+        if (ucs_queue_iter_end(queue, iter)) {
+            iter = ucs_queue_iter_begin(queue);
+        }
+
+        rndv_req = ucs_queue_iter_elem(rndv_req, iter, send.uct.priv);
+        if (!ucp_rndv_get_sched_acquire(rndv_req)) {
+            break;
+        }
+
+        ucs_queue_del_iter(queue, iter);
+        ucp_request_send(rndv_req, 0);
+    }
+    worker->rndv_get_sched.dispatching = 0;
+}
+
+void ucp_rndv_get_sched_purge(ucp_ep_h ep, ucs_status_t status)
+{
+    ucs_queue_head_t *queue = &ep->worker->rndv_get_sched.queue;
+    ucs_queue_iter_t iter;
+    ucp_request_t *rndv_req;
+
+    /* waiting requests have no fragments in flight, so they are completed
+     * right away */
+    iter = ucs_queue_iter_begin(queue);
+    while (!ucs_queue_iter_end(queue, iter)) {
+        rndv_req = ucs_queue_iter_elem(rndv_req, iter, send.uct.priv);
+        if (rndv_req->send.ep != ep) {
+            iter = ucs_queue_iter_next(iter);
+            continue;
+        }
+
+        ucs_queue_del_iter(queue, iter);
+        ucp_trace_req(rndv_req, "rndv_get purged: %s",
+                      ucs_status_string(status));
+        ucp_ep_rkey_cache_release(ep, rndv_req->send.rndv_get.rkey);
+        ucp_request_send_buffer_dereg(rndv_req);
+        ucp_rndv_zcopy_recv_req_complete(rndv_req->send.rndv_get.rreq, status);
+        ucp_request_put(rndv_req);
+    }
+}
+
+/* Called when the request has posted its whole fragment. If the fragment was
+ * completed already, its budget is passed on to the waiting requests, and the
+ * request either continues with a new fragment or waits for its turn. */
+static ucs_status_t ucp_rndv_get_sched_frag_posted(ucp_request_t *rndv_req)
+{
+    ucp_worker_h worker = rndv_req->send.ep->worker;
+
+    if (rndv_req->send.state.uct_comp.count > 0) {
+        /* ucp_rndv_get_completion() will continue the request */
+        return UCS_OK;
+    }
+
+    ucp_rndv_get_sched_release(rndv_req);
+    if (!worker->rndv_get_sched.dispatching) {
+        ucp_rndv_get_sched_dispatch(worker);
+        if (ucs_queue_is_empty(&worker->rndv_get_sched.queue) &&
+            ucp_rndv_get_sched_acquire(rndv_req)) {
+            return UCS_INPROGRESS;
+        }
+    }
+
+    ucp_rndv_get_sched_wait(rndv_req);
+    return UCS_OK;
+}
+
 static void ucp_rndv_recv_data_init(ucp_request_t *rreq, size_t size)
 {
     rreq->status             = UCS_OK;
@@ -260,8 +459,10 @@ static void ucp_rndv_req_send_rtr(ucp_request_t *rndv_req, ucp_request_t *rreq,
 
 static void ucp_rndv_get_lanes_count(ucp_request_t *req)
 {
-    ucp_ep_h ep        = req->send.ep;
-    ucp_lane_map_t map = 0;
+    ucp_ep_h ep             = req->send.ep;
+    ucp_ep_config_t *config = ucp_ep_config(ep);
+    unsigned max_lanes      = ep->worker->context->config.ext.max_rndv_lanes;
+    ucp_lane_map_t map      = 0;
     uct_rkey_t uct_rkey;
     ucp_lane_index_t lane;
 
@@ -269,14 +470,17 @@ static void ucp_rndv_get_lanes_count(ucp_request_t *req)
         return; /* already resolved */
     }
 
-    while ((lane = ucp_rkey_get_rma_bw_lane(req->send.rndv_get.rkey, ep, req->send.mem_type,
-                                            &uct_rkey, map)) != UCP_NULL_LANE) {
+    /* Lanes are selected in the same order by ucp_rndv_get_next_lane(), so
+     * only the first max_rndv_lanes of them take part in the transfer */
+    req->send.rndv_get.scale_sum = 0;
+    while ((req->send.rndv_get.lane_count < max_lanes) &&
+           ((lane = ucp_rkey_get_rma_bw_lane(req->send.rndv_get.rkey, ep,
+                                             req->send.mem_type, &uct_rkey,
+                                             map)) != UCP_NULL_LANE)) {
         req->send.rndv_get.lane_count++;
+        req->send.rndv_get.scale_sum += config->tag.rndv.scale[lane];
         map |= UCS_BIT(lane);
     }
-
-    req->send.rndv_get.lane_count = ucs_min(req->send.rndv_get.lane_count,
-                                            ep->worker->context->config.ext.max_rndv_lanes);
 }
 
 static ucp_lane_index_t ucp_rndv_get_next_lane(ucp_request_t *rndv_req, uct_rkey_t *uct_rkey)
@@ -336,6 +540,7 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_rma_get_zcopy, (self),
     size_t tail;
     int pending_add_res;
     ucp_lane_index_t lane;
+    int sched;
 
     ucp_rndv_get_lanes_count(rndv_req);
 
@@ -346,7 +551,7 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_rma_get_zcopy, (self),
         /* If can't perform get_zcopy - switch to active-message.
          * NOTE: we do not register memory and do not send our keys. */
         ucp_trace_req(rndv_req, "remote memory unreachable, switch to rtr");
-        ucp_rkey_destroy(rndv_req->send.rndv_get.rkey);
+        ucp_ep_rkey_cache_release(ep, rndv_req->send.rndv_get.rkey);
         ucp_rndv_recv_data_init(rndv_req->send.rndv_get.rreq,
                                 rndv_req->send.length);
         ucp_rndv_req_send_rtr(rndv_req, rndv_req->send.rndv_get.rreq,
@@ -354,6 +559,13 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_rma_get_zcopy, (self),
         return UCS_OK;
     }
 
+    sched = ucp_rndv_get_is_sched(rndv_req);
+    if (sched && !(rndv_req->flags & UCP_REQUEST_FLAG_RNDV_GET_SCHED) &&
+        !ucp_rndv_get_sched_acquire(rndv_req)) {
+        ucp_rndv_get_sched_wait(rndv_req);
+        return UCS_OK;
+    }
+
     if (!rndv_req->send.mdesc) {
         status = ucp_send_request_add_reg_lane(rndv_req, lane);
         ucs_assert_always(status == UCS_OK);
@@ -372,13 +584,26 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_rma_get_zcopy, (self),
     if ((offset == 0) && (remainder > 0) && (rndv_req->send.length > ucp_mtu)) {
         length = ucp_mtu - remainder;
     } else {
-        chunk = ucs_align_up((size_t)(ucs_min(rndv_req->send.length /
-                                              rndv_req->send.rndv_get.lane_count,
-                                              max_zcopy) * config->tag.rndv.scale[lane]),
-                             align);
+        /* Every lane gets a share of the message proportional to its
+         * bandwidth, so all lanes complete their part at the same time. The
+         * fastest lane is limited by max_zcopy, and the others are limited
+         * proportionally to keep the ratio. */
+        chunk  = ucs_align_up((size_t)(ucs_min(rndv_req->send.length /
+                                               rndv_req->send.rndv_get.scale_sum,
+                                               max_zcopy) *
+                                       config->tag.rndv.scale[lane]),
+                              align);
         length = ucs_min(chunk, rndv_req->send.length - offset);
     }
 
+    if (sched) {
+        /* do not post more than the fragment reserved from the worker budget */
+        length = ucs_min(length,
+                         ucs_max(ep->worker->context->config.ext.rndv_frag_size -
+                                 rndv_req->send.rndv_get.sched_bytes,
+                                 ucs_max(min_zcopy, align)));
+    }
+
     /* ensure that tail (rest of message) is over min_zcopy */
     tail = rndv_req->send.length - (offset + length);
     if (ucs_unlikely(tail && (tail < min_zcopy))) {
@@ -421,15 +646,30 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_progress_rma_get_zcopy, (self),
                                   rndv_req->send.rndv_get.remote_address + offset,
                                   uct_rkey,
                                   &rndv_req->send.state.uct_comp);
+        if (!UCS_STATUS_IS_ERR(status)) {
+            UCS_STATS_UPDATE_COUNTER(ep->stats,
+                                     UCP_EP_STAT_RNDV_GET_BYTES + lane, length);
+            if (sched) {
+                rndv_req->send.rndv_get.sched_bytes += length;
+            }
+        }
         ucp_request_send_state_advance(rndv_req, &state,
                                        UCP_REQUEST_SEND_PROTO_RNDV_GET,
                                        status);
         if (rndv_req->send.state.dt.offset == rndv_req->send.length) {
             if (rndv_req->send.state.uct_comp.count == 0) {
+                if (sched) {
+                    ucp_rndv_get_sched_release(rndv_req);
+                    ucp_rndv_get_sched_dispatch(ep->worker);
+                }
                 ucp_rndv_complete_rma_get_zcopy(rndv_req);
             }
             return UCS_OK;
         } else if (!UCS_STATUS_IS_ERR(status)) {
+            if (sched && (rndv_req->send.rndv_get.sched_bytes >=
+                          ep->worker->context->config.ext.rndv_frag_size)) {
+                return ucp_rndv_get_sched_frag_posted(rndv_req);
+            }
             /* in case if not all chunks are transmitted - return in_progress
              * status */
             return UCS_INPROGRESS;
@@ -456,10 +696,31 @@ UCS_PROFILE_FUNC_VOID(ucp_rndv_get_completion, (self, status),
 {
     ucp_request_t *rndv_req = ucs_container_of(self, ucp_request_t,
                                                send.state.uct_comp);
+    ucp_worker_h worker     = rndv_req->send.ep->worker;
+    size_t frag_size;
+
+    if (!(rndv_req->flags & UCP_REQUEST_FLAG_RNDV_GET_SCHED)) {
+        if (rndv_req->send.state.dt.offset == rndv_req->send.length) {
+            ucp_rndv_complete_rma_get_zcopy(rndv_req);
+        }
+        return;
+    }
 
+    frag_size = worker->context->config.ext.rndv_frag_size;
     if (rndv_req->send.state.dt.offset == rndv_req->send.length) {
+        ucp_rndv_get_sched_release(rndv_req);
         ucp_rndv_complete_rma_get_zcopy(rndv_req);
+    } else if (rndv_req->send.rndv_get.sched_bytes >= frag_size) {
+        /* the request stopped posting after its fragment, and now gives
+         * the others a chance before it continues */
+        ucp_rndv_get_sched_release(rndv_req);
+        ucp_rndv_get_sched_wait(rndv_req);
+    } else {
+        /* the rest of the fragment is still being posted */
+        return;
     }
+
+    ucp_rndv_get_sched_dispatch(worker);
 }
 
 static void ucp_rndv_put_completion(uct_completion_t *self, ucs_status_t status)
@@ -489,10 +750,12 @@ static void ucp_rndv_req_send_rma_get(ucp_request_t *rndv_req, ucp_request_t *rr
     rndv_req->send.rndv_get.rreq           = rreq;
     rndv_req->send.rndv_get.lanes_map      = 0;
     rndv_req->send.rndv_get.lane_count     = 0;
+    rndv_req->send.rndv_get.sched_bytes    = 0;
     rndv_req->send.datatype                = rreq->recv.datatype;
 
-    status = ucp_ep_rkey_unpack(rndv_req->send.ep, rndv_rts_hdr + 1,
-                                &rndv_req->send.rndv_get.rkey);
+    status = ucp_ep_rkey_cache_unpack(rndv_req->send.ep, rndv_rts_hdr->address,
+                                      rndv_rts_hdr->size, rndv_rts_hdr + 1,
+                                      &rndv_req->send.rndv_get.rkey);
     if (status != UCS_OK) {
         ucs_fatal("failed to unpack rendezvous remote key received from %s: %s",
                   ucp_ep_peer_name(rndv_req->send.ep), ucs_status_string(status));
@@ -797,6 +1060,205 @@ static ucs_status_t ucp_rndv_progress_am_zcopy_multi(uct_pending_req_t *self)
                                  ucp_rndv_am_zcopy_send_req_complete, 1);
 }
 
+/* Length of the next AM rndv fragment within the granted credit, and whether
+ * it should ask the receiver for more credit */
+static size_t ucp_rndv_am_window_frag_length(ucp_request_t *sreq,
+                                             size_t max_payload, int *credit_p)
+{
+    size_t offset = sreq->send.state.dt.offset;
+    size_t credit = sreq->send.tag.rndv_credit;
+    size_t length;
+
+    length = ucs_min(sreq->send.tag.rndv_end - offset,
+                     max_payload - sizeof(ucp_rndv_data_hdr_t));
+    if ((credit < offset) || (credit >= (offset + length))) {
+        *credit_p = 0;
+        return length;
+    } else if (credit > offset) {
+        /* stop before the fragment which asks for credit */
+        *credit_p = 0;
+        return credit - offset;
+    }
+
+    *credit_p = 1;
+    return ucs_min(sreq->send.tag.rndv_end - offset,
+                   max_payload - sizeof(ucp_rndv_data_credit_hdr_t));
+}
+
+static size_t ucp_rndv_am_window_pack_hdr(ucp_request_t *sreq, void *dest,
+                                          int credit)
+{
+    ucp_rndv_data_credit_hdr_t *hdr = dest;
+
+    hdr->super.rreq_ptr = sreq->send.tag.rreq_ptr;
+    hdr->super.offset   = sreq->send.state.dt.offset;
+    if (!credit) {
+        return sizeof(hdr->super);
+    }
+
+    hdr->sreq.reqptr = (uintptr_t)sreq;
+    hdr->sreq.ep_ptr = ucp_request_get_dest_ep_ptr(sreq);
+    return sizeof(*hdr);
+}
+
+static size_t ucp_rndv_am_window_pack_data(void *dest, void *arg)
+{
+    ucp_request_t *sreq = arg;
+    ucp_ep_h ep         = sreq->send.ep;
+    size_t length, hdr_size;
+    int credit;
+
+    length   = ucp_rndv_am_window_frag_length(sreq,
+                                              ucp_ep_get_max_bcopy(ep, sreq->send.lane),
+                                              &credit);
+    hdr_size = ucp_rndv_am_window_pack_hdr(sreq, dest, credit);
+    return hdr_size + ucp_dt_pack(ep->worker, sreq->send.datatype,
+                                  sreq->send.mem_type, dest + hdr_size,
+                                  sreq->send.buffer, &sreq->send.state.dt,
+                                  length);
+}
+
+/* Extend the data range the sender is allowed to send */
+static void ucp_rndv_am_window_update(ucp_request_t *sreq, size_t offset,
+                                      size_t window)
+{
+    size_t sent = sreq->send.state.dt.offset;
+    size_t end;
+
+    ucs_assert(offset <= sreq->send.length);
+    if (window >= (sreq->send.length - offset)) {
+        end = sreq->send.length;
+    } else {
+        end = offset + window;
+    }
+
+    if (end <= sreq->send.tag.rndv_end) {
+        return;
+    }
+
+    ucp_trace_req(sreq, "rndv am credit end %zu window %zu", end, window);
+
+    sreq->send.tag.rndv_end = end;
+    if (end == sreq->send.length) {
+        sreq->send.tag.rndv_credit = SIZE_MAX;
+    } else {
+        /* ask for more credit when half of the window is sent */
+        sreq->send.tag.rndv_credit = ucs_max(end - ucs_max(window / 2, 1), sent);
+    }
+}
+
+static ucs_status_t ucp_rndv_progress_am_window(uct_pending_req_t *self)
+{
+    ucp_request_t *sreq = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_ep_h ep         = sreq->send.ep;
+    int zcopy           = (sreq->send.state.uct_comp.func != NULL);
+    size_t iovcnt       = 0;
+    ucp_rndv_data_credit_hdr_t hdr;
+    ucp_dt_state_t state;
+    size_t length, hdr_size;
+    ucs_status_t status;
+    ssize_t packed_len;
+    size_t offset;
+    uct_iov_t iov;
+    int credit;
+
+    /* the credit may arrive during a send operation, so check the granted
+     * range on every iteration */
+    while ((offset = sreq->send.state.dt.offset) < sreq->send.tag.rndv_end) {
+        sreq->send.lane = ucp_send_request_get_next_am_bw_lane(sreq);
+
+        if (zcopy) {
+            status = ucp_send_request_add_reg_lane(sreq, sreq->send.lane);
+            ucs_assert_always(status == UCS_OK);
+
+            length   = ucp_rndv_am_window_frag_length(sreq,
+                                                      ucp_ep_get_max_zcopy(ep,
+                                                                           sreq->send.lane),
+                                                      &credit);
+            hdr_size = ucp_rndv_am_window_pack_hdr(sreq, &hdr, credit);
+            state    = sreq->send.state.dt;
+            ucp_dt_iov_copy_uct(ep->worker->context, &iov, &iovcnt, 1, &state,
+                                sreq->send.buffer, sreq->send.datatype, length,
+                                ucp_ep_md_index(ep, sreq->send.lane), NULL);
+            status = uct_ep_am_zcopy(ep->uct_eps[sreq->send.lane],
+                                     credit ? UCP_AM_ID_RNDV_DATA_CREDIT :
+                                              UCP_AM_ID_RNDV_DATA,
+                                     &hdr, hdr_size, &iov, iovcnt, 0,
+                                     &sreq->send.state.uct_comp);
+            ucp_request_send_state_advance(sreq, &state,
+                                           UCP_REQUEST_SEND_PROTO_ZCOPY_AM,
+                                           status);
+        } else {
+            /* the pack callback calculates the same length */
+            ucp_rndv_am_window_frag_length(sreq,
+                                           ucp_ep_get_max_bcopy(ep, sreq->send.lane),
+                                           &credit);
+            packed_len = uct_ep_am_bcopy(ep->uct_eps[sreq->send.lane],
+                                         credit ? UCP_AM_ID_RNDV_DATA_CREDIT :
+                                                  UCP_AM_ID_RNDV_DATA,
+                                         ucp_rndv_am_window_pack_data, sreq, 0);
+            status     = (packed_len < 0) ? (ucs_status_t)packed_len : UCS_OK;
+        }
+
+        if (status == UCS_ERR_NO_RESOURCE) {
+            if (sreq->send.lane == sreq->send.pending_lane) {
+                return UCS_ERR_NO_RESOURCE;
+            }
+
+            /* switch to the pending queue of the new lane */
+            if (ucp_request_pending_add(sreq, &status, 0)) {
+                return UCS_OK;
+            }
+        } else if (UCS_STATUS_IS_ERR(status)) {
+            ucs_fatal("error handling is unsupported with rendezvous protocol");
+        } else if (credit && (sreq->send.tag.rndv_credit == offset)) {
+            sreq->send.tag.rndv_credit = SIZE_MAX;
+        }
+    }
+
+    if (sreq->send.state.dt.offset < sreq->send.length) {
+        /* wait for more credit from the receiver */
+        sreq->flags |= UCP_REQUEST_FLAG_RNDV_WAIT_CREDIT;
+        return UCS_OK;
+    }
+
+    if (!zcopy) {
+        ucp_rndv_complete_send(sreq);
+    } else if (sreq->send.state.uct_comp.count == 0) {
+        ucp_rndv_am_zcopy_send_req_complete(sreq, UCS_OK);
+    }
+
+    return UCS_OK;
+}
+
+static void ucp_rndv_am_window_start(ucp_request_t *sreq, size_t window)
+{
+    ucp_ep_h ep = sreq->send.ep;
+    ucs_status_t status;
+
+    ucp_trace_req(sreq, "start rndv am with window %zu", window);
+
+    if (UCP_DT_IS_CONTIG(sreq->send.datatype) &&
+        (sreq->send.length >=
+         ucp_ep_config(ep)->am.mem_type_zcopy_thresh[sreq->send.mem_type])) {
+        status = ucp_request_send_buffer_reg_lane(sreq, ucp_ep_get_am_lane(ep));
+        ucs_assert_always(status == UCS_OK);
+
+        ucp_request_send_state_reset(sreq, ucp_rndv_am_zcopy_completion,
+                                     UCP_REQUEST_SEND_PROTO_ZCOPY_AM);
+    } else {
+        ucp_request_send_state_reset(sreq, NULL,
+                                     UCP_REQUEST_SEND_PROTO_BCOPY_AM);
+    }
+
+    sreq->send.uct.func         = ucp_rndv_progress_am_window;
+    sreq->send.pending_lane     = UCP_NULL_LANE;
+    sreq->send.tag.am_bw_index  = 0;
+    sreq->send.tag.rndv_end     = 0;
+    sreq->send.tag.rndv_credit  = SIZE_MAX;
+    ucp_rndv_am_window_update(sreq, 0, window);
+}
+
 UCS_PROFILE_FUNC_VOID(ucp_rndv_frag_put_completion, (self, status),
                       uct_completion_t *self, ucs_status_t status)
 {
@@ -915,13 +1377,11 @@ static ucs_status_t ucp_rndv_pipeline(ucp_request_t *sreq, ucp_rndv_rtr_hdr_t *r
     return status;;
 }
 
-UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_rtr_handler,
-                 (arg, data, length, flags),
-                 void *arg, void *data, size_t length, unsigned flags)
+static ucs_status_t ucp_rndv_rtr_process(ucp_rndv_rtr_hdr_t *rndv_rtr_hdr,
+                                         size_t window)
 {
-    ucp_rndv_rtr_hdr_t *rndv_rtr_hdr = data;
-    ucp_request_t *sreq              = (ucp_request_t*)rndv_rtr_hdr->sreq_ptr;
-    ucp_ep_h ep                      = sreq->send.ep;
+    ucp_request_t *sreq = (ucp_request_t*)rndv_rtr_hdr->sreq_ptr;
+    ucp_ep_h ep         = sreq->send.ep;
     ucp_context_h context;
     ucs_status_t status;
 
@@ -936,8 +1396,9 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_rtr_handler,
     }
 
     if (UCP_DT_IS_CONTIG(sreq->send.datatype) && rndv_rtr_hdr->address) {
-        status = ucp_ep_rkey_unpack(ep, rndv_rtr_hdr + 1,
-                                    &sreq->send.rndv_put.rkey);
+        status = ucp_ep_rkey_cache_unpack(ep, rndv_rtr_hdr->address,
+                                          sreq->send.length, rndv_rtr_hdr + 1,
+                                          &sreq->send.rndv_put.rkey);
         if (status != UCS_OK) {
             ucs_fatal("failed to unpack rendezvous remote key received from %s: %s",
                       ucp_ep_peer_name(ep), ucs_status_string(status));
@@ -969,14 +1430,17 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_rtr_handler,
             sreq->send.mdesc                   = NULL;
             goto out_send;
         } else {
-            ucp_rkey_destroy(sreq->send.rndv_put.rkey);
+            ucp_ep_rkey_cache_release(ep, sreq->send.rndv_put.rkey);
         }
     }
 
     /* switch to AM */
     sreq->send.tag.rreq_ptr = rndv_rtr_hdr->rreq_ptr;
 
-    if (UCP_DT_IS_CONTIG(sreq->send.datatype) &&
+    if (window < sreq->send.length) {
+        /* the receiver limits how much data can be sent ahead */
+        ucp_rndv_am_window_start(sreq, window);
+    } else if (UCP_DT_IS_CONTIG(sreq->send.datatype) &&
         (sreq->send.length >=
          ucp_ep_config(ep)->am.mem_type_zcopy_thresh[sreq->send.mem_type]))
     {
@@ -1004,6 +1468,31 @@ out_send:
     return UCS_OK;
 }
 
+/* Returns the window which follows the packed keys of the RTR, or SIZE_MAX if
+ * the receiver does not limit it */
+static size_t ucp_rndv_rtr_get_window(const ucp_rndv_rtr_hdr_t *rndv_rtr_hdr,
+                                      size_t length)
+{
+    size_t offset = sizeof(*rndv_rtr_hdr);
+
+    if (rndv_rtr_hdr->address != 0) {
+        offset += ucp_rkey_packed_buffer_size(rndv_rtr_hdr + 1);
+    }
+
+    if (length < (offset + sizeof(size_t))) {
+        return SIZE_MAX;
+    }
+
+    return *(const size_t*)UCS_PTR_BYTE_OFFSET(rndv_rtr_hdr, offset);
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_rtr_handler,
+                 (arg, data, length, flags),
+                 void *arg, void *data, size_t length, unsigned flags)
+{
+    return ucp_rndv_rtr_process(data, ucp_rndv_rtr_get_window(data, length));
+}
+
 UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_data_handler,
                  (arg, data, length, flags),
                  void *arg, void *data, size_t length, unsigned flags)
@@ -1020,6 +1509,88 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_data_handler,
     return UCS_OK;
 }
 
+static size_t ucp_rndv_pack_credit(void *dest, void *arg)
+{
+    ucp_request_t *req           = arg;
+    ucp_rndv_credit_hdr_t *hdr   = dest;
+
+    hdr->sreq_ptr = req->send.rndv_credit.remote_request;
+    hdr->offset   = req->send.rndv_credit.offset;
+    hdr->window   = req->send.ep->worker->context->config.ext.rndv_am_window;
+    return sizeof(*hdr);
+}
+
+static ucs_status_t ucp_rndv_progress_credit(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucs_status_t status;
+
+    status = ucp_do_am_single(self, UCP_AM_ID_RNDV_CREDIT, ucp_rndv_pack_credit,
+                              sizeof(ucp_rndv_credit_hdr_t));
+    if (status == UCS_OK) {
+        ucp_request_put(req);
+    }
+
+    return status;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_data_credit_handler,
+                 (arg, data, length, flags),
+                 void *arg, void *data, size_t length, unsigned flags)
+{
+    ucp_worker_h worker             = arg;
+    ucp_rndv_data_credit_hdr_t *hdr = data;
+    ucp_request_t *rreq             = (ucp_request_t*)hdr->super.rreq_ptr;
+    size_t recv_len                 = length - sizeof(*hdr);
+    ucp_request_t *req;
+    ucs_status_t status;
+
+    UCS_PROFILE_REQUEST_EVENT(rreq, "rndv_data_credit_recv", recv_len);
+
+    status = ucp_tag_request_process_recv_data(rreq, hdr + 1, recv_len,
+                                               hdr->super.offset, 1);
+    if (status != UCS_INPROGRESS) {
+        /* all data has arrived, the sender does not need more credit */
+        return UCS_OK;
+    }
+
+    req = ucp_request_get(worker);
+    if (req == NULL) {
+        ucs_fatal("failed to allocate rendezvous credit request");
+    }
+
+    req->flags                           = 0;
+    req->send.ep                         = ucp_worker_get_ep_by_ptr(worker,
+                                                                    hdr->sreq.ep_ptr);
+    req->send.mdesc                      = NULL;
+    req->send.pending_lane               = UCP_NULL_LANE;
+    req->send.lane                       = ucp_ep_get_am_lane(req->send.ep);
+    req->send.uct.func                   = ucp_rndv_progress_credit;
+    req->send.rndv_credit.remote_request = hdr->sreq.reqptr;
+    req->send.rndv_credit.offset         = hdr->super.offset + recv_len;
+
+    ucp_request_send(req, 0);
+    return UCS_OK;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_credit_handler,
+                 (arg, data, length, flags),
+                 void *arg, void *data, size_t length, unsigned flags)
+{
+    ucp_rndv_credit_hdr_t *hdr = data;
+    ucp_request_t *sreq        = (ucp_request_t*)hdr->sreq_ptr;
+
+    UCS_PROFILE_REQUEST_EVENT(sreq, "rndv_credit_recv", 0);
+
+    ucp_rndv_am_window_update(sreq, hdr->offset, hdr->window);
+    if (sreq->flags & UCP_REQUEST_FLAG_RNDV_WAIT_CREDIT) {
+        sreq->flags &= ~UCP_REQUEST_FLAG_RNDV_WAIT_CREDIT;
+        ucp_request_send(sreq, 0);
+    }
+
+    return UCS_OK;
+}
+
 static void ucp_rndv_dump_rkey(const void *packed_rkey, char *buffer, size_t max)
 {
     char *p    = buffer;
@@ -1039,6 +1610,8 @@ static void ucp_rndv_dump(ucp_worker_h worker, uct_am_trace_type_t type,
     const ucp_rndv_rts_hdr_t *rndv_rts_hdr = data;
     const ucp_rndv_rtr_hdr_t *rndv_rtr_hdr = data;
     const ucp_rndv_data_hdr_t *rndv_data = data;
+    const ucp_rndv_data_credit_hdr_t *rndv_data_credit = data;
+    const ucp_rndv_credit_hdr_t *rndv_credit = data;
     const ucp_reply_hdr_t *rep_hdr = data;
 
     switch (id) {
@@ -1065,11 +1638,26 @@ static void ucp_rndv_dump(ucp_worker_h worker, uct_am_trace_type_t type,
             ucp_rndv_dump_rkey(rndv_rtr_hdr + 1, buffer + strlen(buffer),
                                max - strlen(buffer));
         }
+        if (ucp_rndv_rtr_get_window(rndv_rtr_hdr, length) != SIZE_MAX) {
+            snprintf(buffer + strlen(buffer), max - strlen(buffer),
+                     " window %zu", ucp_rndv_rtr_get_window(rndv_rtr_hdr,
+                                                            length));
+        }
         break;
     case UCP_AM_ID_RNDV_DATA:
         snprintf(buffer, max, "RNDV_DATA rreq 0x%"PRIx64" offset %zu",
                  rndv_data->rreq_ptr, rndv_data->offset);
         break;
+    case UCP_AM_ID_RNDV_DATA_CREDIT:
+        snprintf(buffer, max, "RNDV_DATA_CREDIT rreq 0x%"PRIx64" offset %zu "
+                 "sreq 0x%lx", rndv_data_credit->super.rreq_ptr,
+                 rndv_data_credit->super.offset, rndv_data_credit->sreq.reqptr);
+        break;
+    case UCP_AM_ID_RNDV_CREDIT:
+        snprintf(buffer, max, "RNDV_CREDIT sreq 0x%lx offset %zu window %zu",
+                 rndv_credit->sreq_ptr, rndv_credit->offset,
+                 rndv_credit->window);
+        break;
     case UCP_AM_ID_RNDV_ATP:
         snprintf(buffer, max, "RNDV_ATP sreq 0x%lx status '%s'",
                  rep_hdr->reqptr, ucs_status_string(rep_hdr->status));
@@ -1081,17 +1669,30 @@ static void ucp_rndv_dump(ucp_worker_h worker, uct_am_trace_type_t type,
 
 UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_RTS, ucp_rndv_rts_handler,
               ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_ATS, ucp_rndv_ats_handler,
-              ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_ATP, ucp_rndv_atp_handler,
-              ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_RTR, ucp_rndv_rtr_handler,
-              ucp_rndv_dump, 0);
-UCP_DEFINE_AM(UCP_FEATURE_TAG, UCP_AM_ID_RNDV_DATA, ucp_rndv_data_handler,
-              ucp_rndv_dump, 0);
+/* Active messages and streams use the same rendezvous protocol after their RTS */
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_ATS,
+              ucp_rndv_ats_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_ATP,
+              ucp_rndv_atp_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_RTR,
+              ucp_rndv_rtr_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_DATA,
+              ucp_rndv_data_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_DATA_CREDIT,
+              ucp_rndv_data_credit_handler, ucp_rndv_dump, 0);
+UCP_DEFINE_AM(UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
+              UCP_AM_ID_RNDV_CREDIT,
+              ucp_rndv_credit_handler, ucp_rndv_dump, 0);
 
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_RNDV_RTS);
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_RNDV_ATS);
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_RNDV_ATP);
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_RNDV_RTR);
 UCP_DEFINE_AM_PROXY(UCP_AM_ID_RNDV_DATA);
+UCP_DEFINE_AM_PROXY(UCP_AM_ID_RNDV_DATA_CREDIT);
+UCP_DEFINE_AM_PROXY(UCP_AM_ID_RNDV_CREDIT);
@@ -33,7 +33,8 @@ typedef struct {
     uintptr_t                 sreq_ptr; /* request on the rndv initiator side - sender */
     uintptr_t                 rreq_ptr; /* request on the rndv receiver side */
     uint64_t                  address;  /* holds the address of the data buffer on the receiver's side */
-    /* packed rkeys follow */
+    /* packed rkeys follow, if address is not 0. If the receiver limits the
+     * data sent with active messages, the window (size_t) follows them */
 } UCS_S_PACKED ucp_rndv_rtr_hdr_t;
 
 /*
@@ -44,17 +45,44 @@ typedef struct {
     size_t                    offset;
 } UCS_S_PACKED ucp_rndv_data_hdr_t;
 
+/*
+ * RNDV_DATA_CREDIT
+ */
+typedef struct {
+    ucp_rndv_data_hdr_t       super;
+    ucp_request_hdr_t         sreq;     /* send request on the rndv initiator side */
+} UCS_S_PACKED ucp_rndv_data_credit_hdr_t;
+
+/*
+ * RNDV_CREDIT
+ */
+typedef struct {
+    uintptr_t                 sreq_ptr; /* request on the rndv initiator side - sender */
+    size_t                    offset;   /* offset of the received data */
+    size_t                    window;   /* how much data after offset can be sent */
+} UCS_S_PACKED ucp_rndv_credit_hdr_t;
+
 
 ucs_status_t ucp_tag_send_start_rndv(ucp_request_t *req);
 
+ucs_status_t ucp_rndv_send_buffer_reg(ucp_request_t *sreq);
+
 void ucp_rndv_matched(ucp_worker_h worker, ucp_request_t *req,
                       const ucp_rndv_rts_hdr_t *rndv_rts_hdr);
 
 ucs_status_t ucp_rndv_progress_rma_get_zcopy(uct_pending_req_t *self);
 
+/**
+ * Complete with @a status the rendezvous get requests of the endpoint which
+ * wait for the worker budget.
+ */
+void ucp_rndv_get_sched_purge(ucp_ep_h ep, ucs_status_t status);
+
 ucs_status_t ucp_rndv_process_rts(void *arg, void *data, size_t length,
                                   unsigned tl_flags);
 
+size_t ucp_rndv_rts_pack(ucp_request_t *sreq, ucp_rndv_rts_hdr_t *rndv_rts_hdr);
+
 size_t ucp_tag_rndv_rts_pack(void *dest, void *arg);
 
 #endif
@@ -28,7 +28,8 @@ ucp_tag_get_rndv_threshold(const ucp_request_t *req, size_t count,
     switch (req->send.datatype & UCP_DATATYPE_CLASS_MASK) {
     case UCP_DATATYPE_IOV:
         if ((count > max_iov) &&
-            ucp_ep_is_tag_offload_enabled(ucp_ep_config(req->send.ep))) {
+            ucp_ep_is_tag_offload_enabled(ucp_ep_config(req->send.ep)) &&
+            (ucp_dt_iov_count_coalesced(req->send.buffer, count) > max_iov)) {
             /* Make sure SW RNDV will be used, because tag offload does
              * not support multi-packet eager protocols. */
             return 1;
@@ -36,6 +37,7 @@ ucp_tag_get_rndv_threshold(const ucp_request_t *req, size_t count,
         /* Fall through */
     case UCP_DATATYPE_CONTIG:
         return ucs_min(rndv_rma_thresh, rndv_am_thresh);
+    case UCP_DATATYPE_STRIDED:
     case UCP_DATATYPE_GENERIC:
         return rndv_am_thresh;
     default:
@@ -52,13 +54,23 @@ ucp_tag_send_req(ucp_request_t *req, size_t dt_count,
                  ucp_send_callback_t cb, const ucp_proto_t *proto,
                  int enable_zcopy)
 {
-    size_t rndv_thresh  = ucp_tag_get_rndv_threshold(req, dt_count,
-                                                     msg_config->max_iov,
-                                                     rndv_rma_thresh,
-                                                     rndv_am_thresh);
-    ssize_t max_short   = ucp_proto_get_short_max(req, msg_config);
+    size_t rndv_thresh, zcopy_thresh;
     ucs_status_t status;
-    size_t zcopy_thresh;
+    ssize_t max_short;
+
+    if (ucs_unlikely(req->send.ep->worker->context->config.ext.tag_aggregate_thresh &&
+                     ucp_tag_eager_bundle_add(req, proto))) {
+        /* will be sent together with the pending send which leads the bundle */
+        UCP_EP_STAT_TAG_OP(req->send.ep, EAGER);
+        if (enable_zcopy) {
+            ucp_request_set_callback(req, send.cb, cb)
+        }
+        return req + 1;
+    }
+
+    rndv_thresh = ucp_tag_get_rndv_threshold(req, dt_count, msg_config->max_iov,
+                                             rndv_rma_thresh, rndv_am_thresh);
+    max_short   = ucp_proto_get_short_max(req, msg_config);
 
     if (enable_zcopy || ucs_unlikely(!UCP_MEM_IS_HOST(req->send.mem_type))) {
         zcopy_thresh = ucp_proto_get_zcopy_threshold(req, msg_config, dt_count,
@@ -67,6 +79,11 @@ ucp_tag_send_req(ucp_request_t *req, size_t dt_count,
         zcopy_thresh = rndv_thresh;
     }
 
+    if (ucs_unlikely(req->send.ep->worker->context->config.ext.thresh_tune) &&
+        enable_zcopy) {
+        ucp_ep_config_tune_start(req, max_short, &zcopy_thresh, &rndv_thresh);
+    }
+
     ucs_trace_req("select tag request(%p) progress algorithm datatype=%lx "
                   "buffer=%p length=%zu max_short=%zd rndv_thresh=%zu "
                   "zcopy_thresh=%zu zcopy_enabled=%d",
@@ -115,6 +132,11 @@ ucp_tag_send_req(ucp_request_t *req, size_t dt_count,
         return UCS_STATUS_PTR(status);
     }
 
+    if (ucs_unlikely(req->send.ep->worker->context->config.ext.tag_aggregate_thresh)) {
+        /* small sends which follow this one are aggregated with it */
+        ucp_tag_eager_bundle_start(req, proto);
+    }
+
     if (enable_zcopy) {
         ucp_request_set_callback(req, send.cb, cb)
     }
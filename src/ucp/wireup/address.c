@@ -15,13 +15,15 @@
 #include <ucp/core/ucp_ep.inl>
 #include <ucs/arch/bitops.h>
 #include <ucs/debug/log.h>
+#include <ucs/sys/string.h>
 #include <inttypes.h>
 
 
 /*
  * Packed address layout:
  *
- * [ uuid(64bit) | worker_name(string) ]
+ * [ header(8bit) ]
+ * [ uuid(64bit) | stream_window(64bit) | worker_name(string) ]
  * [ device1_md_index | device1_address(var) ]
  *    [ tl1_name_csum(string) | tl1_info | tl1_address(var) ]
  *    [ tl2_name_csum(string) | tl2_info | tl2_address(var) ]
@@ -29,7 +31,12 @@
  * [ device2_md_index | device2_address(var) ]
  *    ...
  *
+ *   * header contains UCP_ADDRESS_HEADER_FLAG_xx flags, which tell the format
+ *     of the rest of the address.
  *   * worker_name is packed if ENABLE_DEBUG is set.
+ *   * stream_window is packed together with uuid, only if it is not infinite.
+ *     It is UCX_STREAM_WINDOW of the worker's context, which must match on both
+ *     peers, and is marked by the STREAM_WINDOW flag in the header.
  *   * In unified mode tl_info contains just rsc_index and iface latency overhead.
  *     For last address in the tl address list, it will have LAST flag set.
  *   * In non unified mode tl_info contains iface attributes. LAST flag is set in
@@ -38,6 +45,14 @@
  *     EMPTY.
  *   * If the address list is empty, then it will contain only a single md_index
  *     which equals to UCP_NULL_RESOURCE.
+ *
+ * In compact mode (UCX_ADDRESS_COMPACT=y), which is marked by the COMPACT flag
+ * in the header:
+ *   * A device whose address is the same as the address of a previous device
+ *     (for example, shared memory devices on the same host) does not pack it,
+ *     and refers to the previous device index in the device address length.
+ *   * In non unified mode tl_info contains iface attributes quantized to
+ *     16-bit floats, and capability flags as a variable-length integer.
  */
 
 
@@ -46,6 +61,8 @@ typedef struct {
     uint64_t         tl_bitmap;
     ucp_rsc_index_t  rsc_index;
     ucp_rsc_index_t  tl_count;
+    ucp_rsc_index_t  dev_addr_ref; /* Previous device with the same address,
+                                      UCP_NULL_RESOURCE if none */
     size_t           tl_addrs_size;
 } ucp_address_packed_device_t;
 
@@ -58,6 +75,17 @@ typedef struct {
 } ucp_address_packed_iface_attr_t;
 
 
+/* In compact mode iface attributes are quantized to 16-bit floats (the upper
+ * half of a single precision float), followed by the priority and a
+ * variable-length integer of capability and atomic flags */
+typedef struct {
+    uint16_t         overhead;
+    uint16_t         bandwidth;
+    uint16_t         lat_ovh;
+    uint8_t          priority;
+} UCS_S_PACKED ucp_address_compact_iface_attr_t;
+
+
 /* In unified mode we pack resource index instead of iface attrs to the address,
  * so the peer can get all attrs from the local device with the same resource
  * index.
@@ -79,12 +107,25 @@ typedef struct {
 #define UCT_ADDRESS_FLAG_ATOMIC32     UCS_BIT(30) /* 32bit atomic operations */
 #define UCT_ADDRESS_FLAG_ATOMIC64     UCS_BIT(31) /* 64bit atomic operations */
 
+#define UCP_ADDRESS_COMPACT_ATOMIC32  UCS_BIT(0)  /* 32bit atomics, compact mode */
+#define UCP_ADDRESS_COMPACT_ATOMIC64  UCS_BIT(1)  /* 64bit atomics, compact mode */
+#define UCP_ADDRESS_COMPACT_FLAGS_SHIFT 2
+
+#define UCP_ADDRESS_HEADER_FLAG_STREAM_WINDOW 0x01 /* Stream window is packed */
+#define UCP_ADDRESS_HEADER_FLAG_COMPACT       0x02 /* Address is packed in compact
+                                                      mode */
+
 #define UCP_ADDRESS_FLAG_LAST         0x80   /* Last address in the list */
 #define UCP_ADDRESS_FLAG_HAVE_EP_ADDR 0x40   /* Indicates that ep addr is packed
                                                 right after iface addr */
 #define UCP_ADDRESS_FLAG_LEN_MASK     ~(UCP_ADDRESS_FLAG_HAVE_EP_ADDR | \
                                         UCP_ADDRESS_FLAG_LAST)
 
+#define UCP_ADDRESS_FLAG_DEV_ADDR_REF 0x40   /* Device address is the same as of
+                                                the device with index in the
+                                                lower bits, compact mode only */
+#define UCP_ADDRESS_DEV_ADDR_REF_MASK (UCP_ADDRESS_FLAG_DEV_ADDR_REF - 1)
+
 #define UCP_ADDRESS_FLAG_EMPTY        0x80   /* Device without TL addresses */
 #define UCP_ADDRESS_FLAG_MD_ALLOC     0x40   /* MD can register  */
 #define UCP_ADDRESS_FLAG_MD_REG       0x20   /* MD can allocate */
@@ -92,6 +133,11 @@ typedef struct {
                                         UCP_ADDRESS_FLAG_MD_ALLOC | \
                                         UCP_ADDRESS_FLAG_MD_REG)
 
+static int ucp_address_pack_stream_window(ucp_worker_h worker)
+{
+    return worker->context->config.ext.stream_window != UCS_MEMUNITS_INF;
+}
+
 static size_t ucp_address_worker_name_size(ucp_worker_h worker, uint64_t flags)
 {
 #if ENABLE_DEBUG_DATA
@@ -102,11 +148,172 @@ static size_t ucp_address_worker_name_size(ucp_worker_h worker, uint64_t flags)
 #endif
 }
 
-static size_t ucp_address_iface_attr_size(ucp_worker_t *worker)
+static int ucp_address_is_compact(ucp_worker_h worker)
+{
+    return worker->context->config.ext.address_compact;
+}
+
+static size_t ucp_address_varint_size(uint32_t value)
+{
+    size_t size = 1;
+
+    while (value >= UCS_BIT(7)) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+/* Pack an integer by 7 bits per byte, MSB set on all bytes except the last */
+static void* ucp_address_pack_varint(void *ptr, uint32_t value)
+{
+    uint8_t *p = ptr;
+
+    while (value >= UCS_BIT(7)) {
+        *(p++)  = (value & UCS_MASK(7)) | UCS_BIT(7);
+        value >>= 7;
+    }
+    *(p++) = value;
+    return p;
+}
+
+static const void* ucp_address_unpack_varint(const void *ptr, uint32_t *value_p)
+{
+    const uint8_t *p = ptr;
+    unsigned shift   = 0;
+    uint32_t value   = 0;
+
+    do {
+        value |= (uint32_t)(*p & UCS_MASK(7)) << shift;
+        shift += 7;
+    } while (*(p++) & UCS_BIT(7));
+
+    *value_p = value;
+    return p;
+}
+
+/* Round a float to its upper 16 bits: sign, exponent and 7 mantissa bits */
+static uint16_t ucp_address_pack_float16(float value)
+{
+    union {
+        float    f;
+        uint32_t u;
+    } v = { .f = value };
+
+    return (v.u + UCS_MASK(15) + ((v.u >> 16) & 1)) >> 16;
+}
+
+static float ucp_address_unpack_float16(uint16_t value)
+{
+    union {
+        float    f;
+        uint32_t u;
+    } v = { .u = (uint32_t)value << 16 };
+
+    return v.f;
+}
+
+/* Keep only the bits defined by UCP_ADDRESS_IFACE_FLAGS, to shrink address */
+static uint32_t ucp_address_pack_iface_flags(uint64_t cap_flags)
+{
+    uint32_t packed_flags = 0;
+    uint32_t packed_flag  = 1;
+    uint64_t bit          = 1;
+
+    while (UCP_ADDRESS_IFACE_FLAGS & ~(bit - 1)) {
+        if (UCP_ADDRESS_IFACE_FLAGS & bit) {
+            if (cap_flags & bit) {
+                packed_flags |= packed_flag;
+            }
+            packed_flag <<= 1;
+        }
+        bit <<= 1;
+    }
+
+    return packed_flags;
+}
+
+static uint64_t ucp_address_unpack_iface_flags(uint32_t packed_flags)
+{
+    uint32_t packed_flag = 1;
+    uint64_t cap_flags   = 0;
+    uint64_t bit         = 1;
+
+    while (UCP_ADDRESS_IFACE_FLAGS & ~(bit - 1)) {
+        if (UCP_ADDRESS_IFACE_FLAGS & bit) {
+            if (packed_flags & packed_flag) {
+                cap_flags |= bit;
+            }
+            packed_flag <<= 1;
+        }
+        bit <<= 1;
+    }
+
+    return cap_flags;
+}
+
+/* Return which of 32/64 bit atomics the iface supports, as compact mode flags */
+static uint32_t ucp_address_iface_atomics(const uct_iface_attr_t *iface_attr,
+                                          int enable_atomics)
+{
+    uint32_t atomics = 0;
+
+    if (!enable_atomics) {
+        return 0;
+    }
+
+    if (ucs_test_all_flags(iface_attr->cap.atomic32.op_flags, UCP_ATOMIC_OP_MASK) &&
+        ucs_test_all_flags(iface_attr->cap.atomic32.fop_flags, UCP_ATOMIC_FOP_MASK)) {
+        atomics |= UCP_ADDRESS_COMPACT_ATOMIC32;
+    }
+    if (ucs_test_all_flags(iface_attr->cap.atomic64.op_flags, UCP_ATOMIC_OP_MASK) &&
+        ucs_test_all_flags(iface_attr->cap.atomic64.fop_flags, UCP_ATOMIC_FOP_MASK)) {
+        atomics |= UCP_ADDRESS_COMPACT_ATOMIC64;
+    }
+
+    return atomics;
+}
+
+static uint32_t
+ucp_address_compact_iface_flags(const uct_iface_attr_t *iface_attr,
+                                int enable_atomics)
+{
+    return (ucp_address_pack_iface_flags(iface_attr->cap.flags) <<
+            UCP_ADDRESS_COMPACT_FLAGS_SHIFT) |
+           ucp_address_iface_atomics(iface_attr, enable_atomics);
+}
+
+static size_t ucp_address_iface_attr_size(ucp_worker_t *worker,
+                                          const uct_iface_attr_t *iface_attr,
+                                          int enable_atomics)
 {
-    return ucp_worker_unified_mode(worker) ?
-           sizeof(ucp_address_unified_iface_attr_t) :
-           sizeof(ucp_address_packed_iface_attr_t);
+    if (ucp_worker_unified_mode(worker)) {
+        return sizeof(ucp_address_unified_iface_attr_t);
+    } else if (ucp_address_is_compact(worker)) {
+        return sizeof(ucp_address_compact_iface_attr_t) +
+               ucp_address_varint_size(
+                   ucp_address_compact_iface_flags(iface_attr, enable_atomics));
+    } else {
+        return sizeof(ucp_address_packed_iface_attr_t);
+    }
+}
+
+/* Return the length of packed iface attributes, without unpacking them */
+static size_t ucp_address_packed_iface_attr_length(ucp_worker_t *worker,
+                                                   int is_compact,
+                                                   const void *ptr)
+{
+    const uint8_t *p;
+
+    if (ucp_worker_unified_mode(worker)) {
+        return sizeof(ucp_address_unified_iface_attr_t);
+    } else if (is_compact) {
+        p = UCS_PTR_TYPE_OFFSET(ptr, ucp_address_compact_iface_attr_t);
+        while (*(p++) & UCS_BIT(7));
+        return UCS_PTR_BYTE_DIFF(ptr, p);
+    } else {
+        return sizeof(ucp_address_packed_iface_attr_t);
+    }
 }
 
 static uint64_t ucp_worker_iface_can_connect(uct_iface_attr_t *attrs)
@@ -185,6 +392,51 @@ out:
     return dev;
 }
 
+/* In compact mode, find devices whose address is the same as the address of a
+ * previous device, so it would be packed only once */
+static ucs_status_t
+ucp_address_dedup_devices(ucp_worker_h worker,
+                          ucp_address_packed_device_t *devices,
+                          ucp_rsc_index_t num_devices)
+{
+    const size_t max_len = UCP_ADDRESS_DEV_ADDR_REF_MASK;
+    ucp_address_packed_device_t *dev, *prev;
+    ucp_worker_iface_t *wiface;
+    ucs_status_t status;
+    void *dev_addrs;
+
+    dev_addrs = ucs_alloca(num_devices * max_len);
+
+    for (dev = devices; dev < devices + num_devices; ++dev) {
+        if ((dev->dev_addr_len == 0) || (dev->dev_addr_len > max_len)) {
+            continue;
+        }
+
+        wiface = ucp_worker_iface(worker, dev->rsc_index);
+        status = uct_iface_get_device_address(wiface->iface,
+                                              UCS_PTR_BYTE_OFFSET(dev_addrs,
+                                                  (dev - devices) * max_len));
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        for (prev = devices;
+             (prev < dev) && ((prev - devices) <= UCP_ADDRESS_DEV_ADDR_REF_MASK);
+             ++prev) {
+            if ((prev->dev_addr_ref == UCP_NULL_RESOURCE) &&
+                (prev->dev_addr_len == dev->dev_addr_len) &&
+                !memcmp(UCS_PTR_BYTE_OFFSET(dev_addrs, (prev - devices) * max_len),
+                        UCS_PTR_BYTE_OFFSET(dev_addrs, (dev - devices) * max_len),
+                        dev->dev_addr_len)) {
+                dev->dev_addr_ref = prev - devices;
+                break;
+            }
+        }
+    }
+
+    return UCS_OK;
+}
+
 static ucs_status_t
 ucp_address_gather_devices(ucp_worker_h worker, uint64_t tl_bitmap,
                            uint64_t flags,
@@ -196,6 +448,7 @@ ucp_address_gather_devices(ucp_worker_h worker, uint64_t tl_bitmap,
     uct_iface_attr_t *iface_attr;
     ucp_rsc_index_t num_devices;
     ucp_rsc_index_t rsc_index;
+    ucs_status_t status;
 
     devices = ucs_calloc(context->num_tls, sizeof(*devices), "packed_devices");
     if (devices == NULL) {
@@ -225,7 +478,9 @@ ucp_address_gather_devices(ucp_worker_h worker, uint64_t tl_bitmap,
             /* iface address (its length will be packed in non-unified mode only) */
             dev->tl_addrs_size += iface_attr->iface_addr_len;
             dev->tl_addrs_size += !ucp_worker_unified_mode(worker); /* if addr length */
-            dev->tl_addrs_size += ucp_address_iface_attr_size(worker);
+            dev->tl_addrs_size += ucp_address_iface_attr_size(
+                                      worker, iface_attr,
+                                      worker->atomic_tls & UCS_BIT(rsc_index));
         } else {
             dev->tl_addrs_size += 1; /* 0-value for valid unpacking */
         }
@@ -236,8 +491,29 @@ ucp_address_gather_devices(ucp_worker_h worker, uint64_t tl_bitmap,
             dev->dev_addr_len = 0;
         }
 
-        dev->rsc_index  = rsc_index;
-        dev->tl_bitmap |= UCS_BIT(rsc_index);
+        dev->rsc_index    = rsc_index;
+        dev->dev_addr_ref = UCP_NULL_RESOURCE;
+        dev->tl_bitmap   |= UCS_BIT(rsc_index);
+    }
+
+    if (ucp_address_is_compact(worker) &&
+        (flags & UCP_ADDRESS_PACK_FLAG_DEVICE_ADDR)) {
+        for (dev = devices; dev < devices + num_devices; ++dev) {
+            if (dev->dev_addr_len >= UCP_ADDRESS_FLAG_DEV_ADDR_REF) {
+                ucs_error("device %s address length %zu is too long for"
+                          " compact address mode, set UCX_ADDRESS_COMPACT=n",
+                          context->tl_rscs[dev->rsc_index].tl_rsc.dev_name,
+                          dev->dev_addr_len);
+                ucs_free(devices);
+                return UCS_ERR_UNSUPPORTED;
+            }
+        }
+
+        status = ucp_address_dedup_devices(worker, devices, num_devices);
+        if (status != UCS_OK) {
+            ucs_free(devices);
+            return status;
+        }
     }
 
     *devices_p     = devices;
@@ -250,11 +526,14 @@ static size_t ucp_address_packed_size(ucp_worker_h worker,
                                       ucp_rsc_index_t num_devices,
                                       uint64_t flags)
 {
-    size_t size = 0;
+    size_t size = 1;                    /* header */
     const ucp_address_packed_device_t *dev;
 
     if (flags & UCP_ADDRESS_PACK_FLAG_WORKER_UUID) {
-        size += sizeof(uint64_t);
+        size += sizeof(uint64_t);       /* uuid */
+        if (ucp_address_pack_stream_window(worker)) {
+            size += sizeof(uint64_t);   /* stream window */
+        }
     }
 
     size += ucp_address_worker_name_size(worker, flags);
@@ -265,7 +544,8 @@ static size_t ucp_address_packed_size(ucp_worker_h worker,
         for (dev = devices; dev < devices + num_devices; ++dev) {
             size += 1;                  /* device md_index */
             size += 1;                  /* device address length */
-            if (flags & UCP_ADDRESS_PACK_FLAG_DEVICE_ADDR) {
+            if ((flags & UCP_ADDRESS_PACK_FLAG_DEVICE_ADDR) &&
+                (dev->dev_addr_ref == UCP_NULL_RESOURCE)) {
                 size += dev->dev_addr_len;  /* device address */
             }
             size += dev->tl_addrs_size; /* transport addresses */
@@ -315,11 +595,12 @@ static int ucp_address_pack_iface_attr(ucp_worker_h worker, void *ptr,
                                        const uct_iface_attr_t *iface_attr,
                                        int enable_atomics)
 {
+    ucp_address_compact_iface_attr_t *compact;
     ucp_address_packed_iface_attr_t  *packed;
     ucp_address_unified_iface_attr_t *unified;
-    uint32_t packed_flag;
-    uint64_t cap_flags;
-    uint64_t bit;
+    uint32_t atomics;
+    double bandwidth;
+    void *end;
 
     /* check if at least one of bandwidth values is 0 */
     if ((iface_attr->bandwidth.dedicated * iface_attr->bandwidth.shared) != 0) {
@@ -341,52 +622,49 @@ static int ucp_address_pack_iface_attr(ucp_worker_h worker, void *ptr,
         return sizeof(*unified);
     }
 
-    packed    = ptr;
-    cap_flags = iface_attr->cap.flags;
+    bandwidth = iface_attr->bandwidth.dedicated - iface_attr->bandwidth.shared;
+
+    if (ucp_address_is_compact(worker)) {
+        compact            = ptr;
+        compact->overhead  = ucp_address_pack_float16(iface_attr->overhead);
+        compact->bandwidth = ucp_address_pack_float16(bandwidth);
+        compact->lat_ovh   = ucp_address_pack_float16(iface_attr->latency.overhead);
+        compact->priority  = iface_attr->priority;
+        end                = ucp_address_pack_varint(compact + 1,
+                                 ucp_address_compact_iface_flags(iface_attr,
+                                                                 enable_atomics));
+        return UCS_PTR_BYTE_DIFF(ptr, end);
+    }
 
-    packed->prio_cap_flags = ((uint8_t)iface_attr->priority);
+    packed                 = ptr;
+    atomics                = ucp_address_iface_atomics(iface_attr, enable_atomics);
+    packed->prio_cap_flags = ((uint8_t)iface_attr->priority) |
+                             (ucp_address_pack_iface_flags(iface_attr->cap.flags) << 8) |
+                             ((atomics & UCP_ADDRESS_COMPACT_ATOMIC32) ?
+                              UCT_ADDRESS_FLAG_ATOMIC32 : 0) |
+                             ((atomics & UCP_ADDRESS_COMPACT_ATOMIC64) ?
+                              UCT_ADDRESS_FLAG_ATOMIC64 : 0);
     packed->overhead       = iface_attr->overhead;
-    packed->bandwidth      = iface_attr->bandwidth.dedicated - iface_attr->bandwidth.shared;
+    packed->bandwidth      = bandwidth;
     packed->lat_ovh        = iface_attr->latency.overhead;
 
-    /* Keep only the bits defined by UCP_ADDRESS_IFACE_FLAGS, to shrink address. */
-    packed_flag = UCS_BIT(8);
-    bit         = 1;
-    while (UCP_ADDRESS_IFACE_FLAGS & ~(bit - 1)) {
-        if (UCP_ADDRESS_IFACE_FLAGS & bit) {
-            if (cap_flags & bit) {
-                packed->prio_cap_flags |= packed_flag;
-            }
-            packed_flag <<= 1;
-        }
-        bit <<= 1;
-    }
-
-    if (enable_atomics) {
-        if (ucs_test_all_flags(iface_attr->cap.atomic32.op_flags, UCP_ATOMIC_OP_MASK) &&
-            ucs_test_all_flags(iface_attr->cap.atomic32.fop_flags, UCP_ATOMIC_FOP_MASK)) {
-            packed->prio_cap_flags |= UCT_ADDRESS_FLAG_ATOMIC32;
-        }
-        if (ucs_test_all_flags(iface_attr->cap.atomic64.op_flags, UCP_ATOMIC_OP_MASK) &&
-            ucs_test_all_flags(iface_attr->cap.atomic64.fop_flags, UCP_ATOMIC_FOP_MASK)) {
-            packed->prio_cap_flags |= UCT_ADDRESS_FLAG_ATOMIC64;
-        }
-    }
-
     return sizeof(*packed);
 }
 
 static int
-ucp_address_unpack_iface_attr(ucp_worker_t *worker,
+ucp_address_unpack_iface_attr(ucp_worker_t *worker, int is_compact,
                               ucp_address_iface_attr_t *iface_attr,
                               const void *ptr)
 {
+    const ucp_address_compact_iface_attr_t *compact;
     const ucp_address_packed_iface_attr_t *packed;
     const ucp_address_unified_iface_attr_t *unified;
     ucp_worker_iface_t *wiface;
-    uint32_t packed_flag;
     ucp_rsc_index_t rsc_idx;
-    uint64_t bit;
+    uint32_t flags, atomics;
+    float bandwidth;
+    const void *end;
+    int attr_len;
 
     if (ucp_worker_unified_mode(worker)) {
         /* Address contains resources index and iface latency overhead
@@ -411,36 +689,48 @@ ucp_address_unpack_iface_attr(ucp_worker_t *worker,
         return sizeof(*unified);
     }
 
-    packed                          = ptr;
-    iface_attr->cap_flags           = 0;
-    iface_attr->priority            = packed->prio_cap_flags & UCS_MASK(8);
-    iface_attr->overhead            = packed->overhead;
-    iface_attr->bandwidth.dedicated = ucs_max(0.0, packed->bandwidth);
-    iface_attr->bandwidth.shared    = ucs_max(0.0, -packed->bandwidth);
-    iface_attr->lat_ovh             = packed->lat_ovh;
-
-    packed_flag = UCS_BIT(8);
-    bit         = 1;
-    while (UCP_ADDRESS_IFACE_FLAGS & ~(bit - 1)) {
-        if (UCP_ADDRESS_IFACE_FLAGS & bit) {
-            if (packed->prio_cap_flags & packed_flag) {
-                iface_attr->cap_flags |= bit;
-            }
-            packed_flag <<= 1;
-        }
-        bit <<= 1;
+    if (is_compact) {
+        compact                 = ptr;
+        end                     = ucp_address_unpack_varint(compact + 1, &flags);
+        iface_attr->priority    = compact->priority;
+        iface_attr->overhead    = ucp_address_unpack_float16(compact->overhead);
+        iface_attr->lat_ovh     = ucp_address_unpack_float16(compact->lat_ovh);
+        bandwidth               = ucp_address_unpack_float16(compact->bandwidth);
+        iface_attr->cap_flags   = ucp_address_unpack_iface_flags(
+                                      flags >> UCP_ADDRESS_COMPACT_FLAGS_SHIFT);
+        atomics                 = flags & UCS_MASK(UCP_ADDRESS_COMPACT_FLAGS_SHIFT);
+        attr_len                = UCS_PTR_BYTE_DIFF(ptr, end);
+    } else {
+        packed                  = ptr;
+        iface_attr->priority    = packed->prio_cap_flags & UCS_MASK(8);
+        iface_attr->overhead    = packed->overhead;
+        iface_attr->lat_ovh     = packed->lat_ovh;
+        bandwidth               = packed->bandwidth;
+        iface_attr->cap_flags   = ucp_address_unpack_iface_flags(
+                                      (packed->prio_cap_flags >> 8) &
+                                      UCS_MASK(22));
+        atomics                 = ((packed->prio_cap_flags &
+                                    UCT_ADDRESS_FLAG_ATOMIC32) ?
+                                   UCP_ADDRESS_COMPACT_ATOMIC32 : 0) |
+                                  ((packed->prio_cap_flags &
+                                    UCT_ADDRESS_FLAG_ATOMIC64) ?
+                                   UCP_ADDRESS_COMPACT_ATOMIC64 : 0);
+        attr_len                = sizeof(*packed);
     }
 
-    if (packed->prio_cap_flags & UCT_ADDRESS_FLAG_ATOMIC32) {
+    iface_attr->bandwidth.dedicated = ucs_max(0.0, bandwidth);
+    iface_attr->bandwidth.shared    = ucs_max(0.0, -bandwidth);
+
+    if (atomics & UCP_ADDRESS_COMPACT_ATOMIC32) {
         iface_attr->atomic.atomic32.op_flags  |= UCP_ATOMIC_OP_MASK;
         iface_attr->atomic.atomic32.fop_flags |= UCP_ATOMIC_FOP_MASK;
     }
-    if (packed->prio_cap_flags & UCT_ADDRESS_FLAG_ATOMIC64) {
+    if (atomics & UCP_ADDRESS_COMPACT_ATOMIC64) {
         iface_attr->atomic.atomic64.op_flags  |= UCP_ATOMIC_OP_MASK;
         iface_attr->atomic.atomic64.fop_flags |= UCP_ATOMIC_FOP_MASK;
     }
 
-    return sizeof(*packed);
+    return attr_len;
 }
 
 static void*
@@ -526,15 +816,28 @@ static ucs_status_t ucp_address_do_pack(ucp_worker_h worker, ucp_ep_h ep,
     uint64_t md_flags;
     unsigned index;
     int attr_len;
+    int pack_window;
     void *ptr;
     void *flags_ptr;
 
     ptr   = buffer;
     index = 0;
 
+    pack_window = (flags & UCP_ADDRESS_PACK_FLAG_WORKER_UUID) &&
+                  ucp_address_pack_stream_window(worker);
+
+    *(uint8_t*)ptr = (pack_window ? UCP_ADDRESS_HEADER_FLAG_STREAM_WINDOW : 0) |
+                     (ucp_address_is_compact(worker) ?
+                      UCP_ADDRESS_HEADER_FLAG_COMPACT : 0);
+    ptr = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
+
     if (flags & UCP_ADDRESS_PACK_FLAG_WORKER_UUID) {
         *(uint64_t*)ptr = worker->uuid;
         ptr = UCS_PTR_TYPE_OFFSET(ptr, worker->uuid);
+        if (pack_window) {
+            *(uint64_t*)ptr = context->config.ext.stream_window;
+            ptr = UCS_PTR_BYTE_OFFSET(ptr, sizeof(uint64_t));
+        }
     }
 
     ptr = ucp_address_pack_worker_name(worker, ptr, flags);
@@ -561,14 +864,20 @@ static ucs_status_t ucp_address_do_pack(ucp_worker_h worker, ucp_ep_h ep,
         /* Device address length */
         *(uint8_t*)ptr = (dev == (devices + num_devices - 1)) ?
                          UCP_ADDRESS_FLAG_LAST : 0;
-        if (flags & UCP_ADDRESS_PACK_FLAG_DEVICE_ADDR) {
-            ucs_assert(dev->dev_addr_len < UCP_ADDRESS_FLAG_LAST);
+        if (dev->dev_addr_ref != UCP_NULL_RESOURCE) {
+            /* Same device address as of a previous device */
+            *(uint8_t*)ptr |= UCP_ADDRESS_FLAG_DEV_ADDR_REF | dev->dev_addr_ref;
+        } else if (flags & UCP_ADDRESS_PACK_FLAG_DEVICE_ADDR) {
+            ucs_assert(dev->dev_addr_len < (ucp_address_is_compact(worker) ?
+                                            UCP_ADDRESS_FLAG_DEV_ADDR_REF :
+                                            UCP_ADDRESS_FLAG_LAST));
             *(uint8_t*)ptr |= dev->dev_addr_len;
         }
         ptr = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
 
         /* Device address */
-        if (flags & UCP_ADDRESS_PACK_FLAG_DEVICE_ADDR) {
+        if ((flags & UCP_ADDRESS_PACK_FLAG_DEVICE_ADDR) &&
+            (dev->dev_addr_ref == UCP_NULL_RESOURCE)) {
             wiface = ucp_worker_iface(worker, dev->rsc_index);
             status = uct_iface_get_device_address(wiface->iface,
                                                   (uct_device_addr_t*)ptr);
@@ -738,9 +1047,12 @@ ucs_status_t ucp_address_unpack(ucp_worker_t *worker, const void *buffer,
                                 uint64_t flags,
                                 ucp_unpacked_address_t *unpacked_address)
 {
+    const uct_device_addr_t *dev_addrs[UCP_MAX_RESOURCES];
+    uint8_t dev_addr_lens[UCP_MAX_RESOURCES];
     ucp_address_entry_t *address_list, *address;
     int last_dev, last_tl, last_ep_addr;
     const uct_device_addr_t *dev_addr;
+    ucp_rsc_index_t ref_index;
     ucp_rsc_index_t dev_index;
     ucp_rsc_index_t md_index;
     unsigned address_count;
@@ -754,13 +1066,26 @@ ucs_status_t ucp_address_unpack(ucp_worker_t *worker, const void *buffer,
     const void *ptr;
     const void *aptr;
     const void *flags_ptr;
+    uint8_t header;
+    int compact;
+
+    ptr     = buffer;
+    header  = *(uint8_t*)ptr;
+    compact = header & UCP_ADDRESS_HEADER_FLAG_COMPACT;
+    ptr     = UCS_PTR_TYPE_OFFSET(ptr, header);
 
-    ptr = buffer;
     if (flags & UCP_ADDRESS_PACK_FLAG_WORKER_UUID) {
         unpacked_address->uuid = *(uint64_t*)ptr;
         ptr = UCS_PTR_TYPE_OFFSET(ptr, unpacked_address->uuid);
+        if (header & UCP_ADDRESS_HEADER_FLAG_STREAM_WINDOW) {
+            unpacked_address->stream_window = *(uint64_t*)ptr;
+            ptr = UCS_PTR_BYTE_OFFSET(ptr, sizeof(uint64_t));
+        } else {
+            unpacked_address->stream_window = UCS_MEMUNITS_INF;
+        }
     } else {
-        unpacked_address->uuid = 0;
+        unpacked_address->uuid          = 0;
+        unpacked_address->stream_window = UCS_MEMUNITS_AUTO;
     }
 
     aptr = ucp_address_unpack_worker_name(ptr, unpacked_address->name,
@@ -783,13 +1108,17 @@ ucs_status_t ucp_address_unpack(ucp_worker_t *worker, const void *buffer,
         /* device address length */
         dev_addr_len = (*(uint8_t*)ptr) & ~UCP_ADDRESS_FLAG_LAST;
         last_dev     = (*(uint8_t*)ptr) & UCP_ADDRESS_FLAG_LAST;
+        if (compact && (dev_addr_len & UCP_ADDRESS_FLAG_DEV_ADDR_REF)) {
+            dev_addr_len = 0; /* device address is not packed */
+        }
         ptr          = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
         ptr          = UCS_PTR_BYTE_OFFSET(ptr, dev_addr_len);
 
         last_tl = empty_dev;
         while (!last_tl) {
             ptr       = UCS_PTR_TYPE_OFFSET(ptr, uint16_t); /* tl_name_csum */
-            attr_len  = ucp_address_iface_attr_size(worker);
+            attr_len  = ucp_address_packed_iface_attr_length(worker, compact,
+                                                             ptr);
             flags_ptr = ucp_address_iface_flags_ptr(worker, (void*)ptr, attr_len);
             ptr       = UCS_PTR_BYTE_OFFSET(ptr, attr_len);
             ptr       = ucp_address_unpack_length(worker, flags_ptr, ptr,
@@ -844,8 +1173,20 @@ ucs_status_t ucp_address_unpack(ucp_worker_t *worker, const void *buffer,
         last_dev     = (*(uint8_t*)ptr) & UCP_ADDRESS_FLAG_LAST;
         ptr          = UCS_PTR_TYPE_OFFSET(ptr, uint8_t);
 
-        dev_addr = ptr;
-        ptr      = UCS_PTR_BYTE_OFFSET(ptr, dev_addr_len);
+        if (compact && (dev_addr_len & UCP_ADDRESS_FLAG_DEV_ADDR_REF)) {
+            /* Device address is the same as of a previous device */
+            ref_index    = dev_addr_len & UCP_ADDRESS_DEV_ADDR_REF_MASK;
+            ucs_assert(ref_index < dev_index);
+            dev_addr     = dev_addrs[ref_index];
+            dev_addr_len = dev_addr_lens[ref_index];
+        } else {
+            dev_addr     = ptr;
+            ptr          = UCS_PTR_BYTE_OFFSET(ptr, dev_addr_len);
+        }
+
+        ucs_assert(dev_index < UCP_MAX_RESOURCES);
+        dev_addrs[dev_index]     = dev_addr;
+        dev_addr_lens[dev_index] = dev_addr_len;
 
         last_tl = empty_dev;
         while (!last_tl) {
@@ -858,7 +1199,8 @@ ucs_status_t ucp_address_unpack(ucp_worker_t *worker, const void *buffer,
             address->dev_index  = dev_index;
             address->md_flags   = md_flags;
 
-            attr_len  = ucp_address_unpack_iface_attr(worker, &address->iface_attr, ptr);
+            attr_len  = ucp_address_unpack_iface_attr(worker, compact,
+                                                      &address->iface_attr, ptr);
             flags_ptr = ucp_address_iface_flags_ptr(worker, (void*)ptr, attr_len);
             ptr       = UCS_PTR_BYTE_OFFSET(ptr, attr_len);
             ptr       = ucp_address_unpack_length(worker, flags_ptr, ptr,
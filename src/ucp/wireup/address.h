@@ -77,6 +77,9 @@ struct ucp_address_entry {
  */
 struct ucp_unpacked_address {
     uint64_t                   uuid;            /* Remote worker UUID */
+    size_t                     stream_window;   /* Remote UCX_STREAM_WINDOW, or
+                                                   UCS_MEMUNITS_AUTO if the
+                                                   address has no UUID */
     char                       name[UCP_WORKER_NAME_MAX]; /* Remote worker name */
     unsigned                   address_count;   /* Length of address list */
     ucp_address_entry_t        *address_list;   /* Pointer to address list */
@@ -15,6 +15,7 @@
 #include <ucs/algorithm/qsort_r.h>
 #include <ucs/datastruct/queue.h>
 #include <ucs/sys/sock.h>
+#include <ucs/sys/string.h>
 #include <ucp/core/ucp_ep.inl>
 #include <string.h>
 #include <inttypes.h>
@@ -96,6 +97,34 @@ typedef struct {
 } ucp_wireup_select_ctx_t;
 
 
+/**
+ * Inputs of lanes selection which are used as a key to the selection cache.
+ * Followed by an entry for every remote address.
+ */
+typedef struct {
+    unsigned                  ep_init_flags;       /* Endpoint init flags */
+    ucp_err_handling_mode_t   err_mode;            /* Error handling mode */
+    int                       sockaddr;            /* Whether connecting to sockaddr */
+    unsigned                  address_count;       /* Number of remote addresses */
+} ucp_wireup_select_signature_t;
+
+
+typedef struct {
+    ucp_address_iface_attr_t  iface_attr;          /* Remote interface attributes */
+    uint64_t                  md_flags;            /* Remote MD flags */
+    uint64_t                  reachable_tl_bitmap; /* Local resources which can
+                                                      reach the remote address */
+    uint16_t                  tl_name_csum;        /* Checksum of transport name */
+    ucp_rsc_index_t           md_index;            /* Remote memory domain index */
+    ucp_rsc_index_t           dev_index;           /* Remote device index */
+} ucp_wireup_select_signature_entry_t;
+
+
+#define ucp_wireup_select_signature_length(_address_count) \
+    (sizeof(ucp_wireup_select_signature_t) + \
+     ((_address_count) * sizeof(ucp_wireup_select_signature_entry_t)))
+
+
 static const char *ucp_wireup_md_flags[] = {
     [ucs_ilog2(UCT_MD_FLAG_ALLOC)]               = "memory allocation",
     [ucs_ilog2(UCT_MD_FLAG_REG)]                 = "memory registration",
@@ -1077,15 +1106,25 @@ ucp_wireup_add_am_bw_lanes(ucp_wireup_select_ctx_t *select_ctx)
 static ucs_status_t
 ucp_wireup_add_rma_bw_lanes(ucp_wireup_select_ctx_t *select_ctx)
 {
-    ucp_ep_h ep           = select_ctx->ep;
-    ucp_context_h context = ep->worker->context;
+    ucp_ep_h ep            = select_ctx->ep;
+    ucp_context_h context  = ep->worker->context;
+    uint64_t rndv_features = UCP_FEATURE_TAG;
     ucp_wireup_select_bw_info_t bw_info;
     ucs_memory_type_t mem_type;
 
+    /* active messages and streams use rendezvous only if it is enabled for
+     * them */
+    if (context->config.ext.am_rndv_thresh != UCS_MEMUNITS_INF) {
+        rndv_features |= UCP_FEATURE_AM;
+    }
+    if (context->config.ext.stream_rndv_thresh != UCS_MEMUNITS_INF) {
+        rndv_features |= UCP_FEATURE_STREAM;
+    }
+
     if (select_ctx->ep_init_flags & UCP_EP_INIT_FLAG_MEM_TYPE) {
         bw_info.criteria.remote_md_flags = 0;
         bw_info.criteria.local_md_flags  = 0;
-    } else if (ucp_ep_get_context_features(ep) & UCP_FEATURE_TAG) {
+    } else if (ucp_ep_get_context_features(ep) & rndv_features) {
         /* if needed for RNDV, need only access for remote registered memory */
         bw_info.criteria.remote_md_flags = UCT_MD_FLAG_REG;
         bw_info.criteria.local_md_flags  = UCT_MD_FLAG_REG;
@@ -1377,10 +1416,55 @@ ucp_wireup_construct_lanes(ucp_wireup_select_ctx_t *select_ctx,
     key->am_bw_lanes[0] = key->am_lane;
 }
 
-ucs_status_t ucp_wireup_select_lanes(ucp_ep_h ep, const ucp_ep_params_t *params,
-                                     unsigned ep_init_flags, unsigned address_count,
-                                     const ucp_address_entry_t *address_list,
-                                     uint8_t *addr_indices, ucp_ep_config_key_t *key)
+/*
+ * Pack everything transport selection depends on, besides the local resources,
+ * into a signature buffer: endpoint parameters, and for every remote address
+ * its attributes and the set of local resources which can reach it.
+ */
+static size_t
+ucp_wireup_select_signature_pack(ucp_worker_h worker,
+                                 const ucp_ep_params_t *params,
+                                 unsigned ep_init_flags,
+                                 unsigned address_count,
+                                 const ucp_address_entry_t *address_list,
+                                 const ucp_ep_config_key_t *key, void *buffer)
+{
+    ucp_context_h context                   = worker->context;
+    ucp_wireup_select_signature_t *sig      = buffer;
+    ucp_wireup_select_signature_entry_t *se = (void*)(sig + 1);
+    const ucp_address_entry_t *ae;
+    ucp_rsc_index_t rsc_index;
+    size_t length;
+
+    length = ucp_wireup_select_signature_length(address_count);
+    memset(buffer, 0, length);
+
+    sig->ep_init_flags = ep_init_flags;
+    sig->err_mode      = key->err_mode;
+    sig->sockaddr      = !!(params->field_mask & UCP_EP_PARAM_FIELD_SOCK_ADDR);
+    sig->address_count = address_count;
+
+    for (ae = address_list; ae < address_list + address_count; ++ae, ++se) {
+        memcpy(&se->iface_attr, &ae->iface_attr, sizeof(se->iface_attr));
+        se->md_flags     = ae->md_flags;
+        se->tl_name_csum = ae->tl_name_csum;
+        se->md_index     = ae->md_index;
+        se->dev_index    = ae->dev_index;
+        ucs_for_each_bit(rsc_index, context->tl_bitmap) {
+            if (ucp_wireup_is_reachable(worker, rsc_index, ae)) {
+                se->reachable_tl_bitmap |= UCS_BIT(rsc_index);
+            }
+        }
+    }
+
+    return length;
+}
+
+static ucs_status_t
+ucp_wireup_select_lanes_uncached(ucp_ep_h ep, const ucp_ep_params_t *params,
+                                 unsigned ep_init_flags, unsigned address_count,
+                                 const ucp_address_entry_t *address_list,
+                                 uint8_t *addr_indices, ucp_ep_config_key_t *key)
 {
     ucp_worker_h worker = ep->worker;
     ucp_wireup_select_ctx_t select_ctx;
@@ -1413,6 +1497,48 @@ out:
     return UCS_OK;
 }
 
+ucs_status_t ucp_wireup_select_lanes(ucp_ep_h ep, const ucp_ep_params_t *params,
+                                     unsigned ep_init_flags, unsigned address_count,
+                                     const ucp_address_entry_t *address_list,
+                                     uint8_t *addr_indices, ucp_ep_config_key_t *key)
+{
+    ucp_wireup_select_cache_t *cache = &ep->worker->select_cache;
+    const ucp_wireup_select_cache_entry_t *entry;
+    size_t sig_length;
+    ucs_status_t status;
+    void *signature;
+
+    if (cache->max_count == 0) {
+        return ucp_wireup_select_lanes_uncached(ep, params, ep_init_flags,
+                                                address_count, address_list,
+                                                addr_indices, key);
+    }
+
+    signature  = ucs_alloca(ucp_wireup_select_signature_length(address_count));
+    sig_length = ucp_wireup_select_signature_pack(ep->worker, params,
+                                                  ep_init_flags, address_count,
+                                                  address_list, key, signature);
+
+    entry = ucp_wireup_select_cache_lookup(cache, signature, sig_length);
+    if (entry != NULL) {
+        ucs_trace("ep %p: using cached lanes selection", ep);
+        *key = entry->key;
+        memcpy(addr_indices, entry->addr_indices,
+               sizeof(*addr_indices) * key->num_lanes);
+        return UCS_OK;
+    }
+
+    status = ucp_wireup_select_lanes_uncached(ep, params, ep_init_flags,
+                                              address_count, address_list,
+                                              addr_indices, key);
+    if (status == UCS_OK) {
+        ucp_wireup_select_cache_add(cache, signature, sig_length, key,
+                                    addr_indices);
+    }
+
+    return status;
+}
+
 static double ucp_wireup_aux_score_func(ucp_context_h context,
                                         const uct_md_attr_t *md_attr,
                                         const uct_iface_attr_t *iface_attr,
@@ -0,0 +1,151 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2019.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "select_cache.h"
+
+#include <ucs/debug/memtrack.h>
+#include <string.h>
+
+
+__KHASH_IMPL(ucp_wireup_select_cache, static UCS_F_MAYBE_UNUSED inline,
+             uint32_t, ucp_wireup_select_cache_entry_t*, 1, kh_int_hash_func,
+             kh_int_hash_equal);
+
+/* Signatures take a few hundred bytes, so hash them by words (FNV-1a) rather
+ * than by bytes */
+static uint32_t
+ucp_wireup_select_cache_hash(const void *signature, size_t length)
+{
+    const uint64_t *word = signature;
+    const uint8_t *byte;
+    uint64_t hash;
+
+    hash = 0xcbf29ce484222325ull ^ length;
+    for (; length >= sizeof(*word); length -= sizeof(*word), ++word) {
+        hash = (hash ^ *word) * 0x100000001b3ull;
+    }
+
+    for (byte = (const uint8_t*)word; length > 0; --length, ++byte) {
+        hash = (hash ^ *byte) * 0x100000001b3ull;
+    }
+
+    return hash ^ (hash >> 32);
+}
+
+void ucp_wireup_select_cache_init(ucp_wireup_select_cache_t *cache,
+                                  unsigned max_count)
+{
+    kh_init_inplace(ucp_wireup_select_cache, &cache->hash);
+    ucs_list_head_init(&cache->lru);
+    cache->count     = 0;
+    cache->max_count = max_count;
+    cache->hits      = 0;
+    cache->misses    = 0;
+}
+
+void ucp_wireup_select_cache_cleanup(ucp_wireup_select_cache_t *cache)
+{
+    ucp_wireup_select_cache_entry_t *entry, *tmp;
+
+    ucs_list_for_each_safe(entry, tmp, &cache->lru, list) {
+        ucs_free(entry);
+    }
+    kh_destroy_inplace(ucp_wireup_select_cache, &cache->hash);
+}
+
+const ucp_wireup_select_cache_entry_t*
+ucp_wireup_select_cache_lookup(ucp_wireup_select_cache_t *cache,
+                               const void *signature, size_t length)
+{
+    uint32_t hash = ucp_wireup_select_cache_hash(signature, length);
+    ucp_wireup_select_cache_entry_t *entry;
+    khiter_t iter;
+
+    iter = kh_get(ucp_wireup_select_cache, &cache->hash, hash);
+    if (iter != kh_end(&cache->hash)) {
+        for (entry = kh_value(&cache->hash, iter); entry != NULL;
+             entry = entry->next) {
+            if ((entry->signature_length == length) &&
+                !memcmp(entry->signature, signature, length)) {
+                ucs_list_del(&entry->list);
+                ucs_list_add_head(&cache->lru, &entry->list);
+                ++cache->hits;
+                return entry;
+            }
+        }
+    }
+
+    ++cache->misses;
+    return NULL;
+}
+
+/* Remove the least recently used entry */
+static void ucp_wireup_select_cache_evict(ucp_wireup_select_cache_t *cache)
+{
+    ucp_wireup_select_cache_entry_t *entry, **entry_p;
+    khiter_t iter;
+
+    entry = ucs_list_tail(&cache->lru, ucp_wireup_select_cache_entry_t, list);
+    iter  = kh_get(ucp_wireup_select_cache, &cache->hash, entry->hash);
+    ucs_assert(iter != kh_end(&cache->hash));
+
+    entry_p = &kh_value(&cache->hash, iter);
+    while (*entry_p != entry) {
+        entry_p = &(*entry_p)->next;
+    }
+
+    *entry_p = entry->next;
+    if (kh_value(&cache->hash, iter) == NULL) {
+        kh_del(ucp_wireup_select_cache, &cache->hash, iter);
+    }
+
+    ucs_list_del(&entry->list);
+    ucs_free(entry);
+    --cache->count;
+}
+
+void ucp_wireup_select_cache_add(ucp_wireup_select_cache_t *cache,
+                                 const void *signature, size_t length,
+                                 const ucp_ep_config_key_t *key,
+                                 const uint8_t *addr_indices)
+{
+    uint32_t hash = ucp_wireup_select_cache_hash(signature, length);
+    ucp_wireup_select_cache_entry_t *entry;
+    khiter_t iter;
+    int ret;
+
+    if (cache->count >= cache->max_count) {
+        ucp_wireup_select_cache_evict(cache);
+    }
+
+    entry = ucs_malloc(sizeof(*entry) + length, "ucp_wireup_select_cache_entry");
+    if (entry == NULL) {
+        /* the cache is only an optimization */
+        return;
+    }
+
+    iter = kh_put(ucp_wireup_select_cache, &cache->hash, hash, &ret);
+    if (ret == -1) {
+        ucs_free(entry);
+        return;
+    }
+
+    entry->next             = (ret == 0) ? kh_value(&cache->hash, iter) : NULL;
+    entry->hash             = hash;
+    entry->key              = *key;
+    entry->key.dst_md_cmpts = NULL;
+    entry->signature_length = length;
+    memcpy(entry->addr_indices, addr_indices,
+           sizeof(*addr_indices) * key->num_lanes);
+    memcpy(entry->signature, signature, length);
+    kh_value(&cache->hash, iter) = entry;
+    ucs_list_add_head(&cache->lru, &entry->list);
+    ++cache->count;
+}
@@ -0,0 +1,67 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2019.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCP_WIREUP_SELECT_CACHE_H_
+#define UCP_WIREUP_SELECT_CACHE_H_
+
+#include <ucp/core/ucp_ep.h>
+#include <ucs/datastruct/khash.h>
+#include <ucs/datastruct/list.h>
+
+
+/**
+ * Result of transport selection for a given remote address and endpoint
+ * parameters. Entries with the same hash are chained.
+ */
+typedef struct ucp_wireup_select_cache_entry ucp_wireup_select_cache_entry_t;
+struct ucp_wireup_select_cache_entry {
+    ucp_wireup_select_cache_entry_t *next;         /* Next entry with same hash */
+    ucs_list_link_t                 list;          /* Member of the LRU list */
+    uint32_t                        hash;          /* Hash of the signature */
+    ucp_ep_config_key_t             key;           /* Selected lanes */
+    uint8_t                         addr_indices[UCP_MAX_LANES]; /* Remote address
+                                                                    index per lane */
+    size_t                          signature_length;
+    uint8_t                         signature[0];  /* Selection inputs */
+};
+
+
+__KHASH_TYPE(ucp_wireup_select_cache, uint32_t, ucp_wireup_select_cache_entry_t*)
+
+
+/**
+ * Worker-level cache of transport selection results, to skip the scoring of
+ * all resources when connecting to a peer which has the same set of resources
+ * as a peer we already connected to. When the cache is full, the least
+ * recently used entry is replaced.
+ */
+typedef struct {
+    khash_t(ucp_wireup_select_cache) hash;
+    ucs_list_link_t                  lru;          /* Entries, most recently
+                                                      used first */
+    unsigned                         count;        /* Number of entries */
+    unsigned                         max_count;    /* Maximal number of entries,
+                                                      0 - cache is disabled */
+    uint64_t                         hits;         /* Number of lookup hits */
+    uint64_t                         misses;       /* Number of lookup misses */
+} ucp_wireup_select_cache_t;
+
+
+void ucp_wireup_select_cache_init(ucp_wireup_select_cache_t *cache,
+                                  unsigned max_count);
+
+void ucp_wireup_select_cache_cleanup(ucp_wireup_select_cache_t *cache);
+
+const ucp_wireup_select_cache_entry_t*
+ucp_wireup_select_cache_lookup(ucp_wireup_select_cache_t *cache,
+                               const void *signature, size_t length);
+
+void ucp_wireup_select_cache_add(ucp_wireup_select_cache_t *cache,
+                                 const void *signature, size_t length,
+                                 const ucp_ep_config_key_t *key,
+                                 const uint8_t *addr_indices);
+
+#endif
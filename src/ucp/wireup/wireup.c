@@ -20,6 +20,7 @@
 #include <ucp/tag/eager.h>
 #include <ucs/async/async.h>
 #include <ucs/datastruct/queue.h>
+#include <ucs/sys/string.h>
 
 /*
  * Description of the protocol in UCX wiki:
@@ -270,15 +271,21 @@ static void ucp_wireup_remote_connected(ucp_ep_h ep)
 static ucs_status_t
 ucp_wireup_init_lanes_by_request(ucp_worker_h worker, ucp_ep_h ep,
                                  const ucp_ep_params_t *params,
-                                 unsigned ep_init_flags, unsigned address_count,
-                                 const ucp_address_entry_t *address_list,
+                                 unsigned ep_init_flags,
+                                 const ucp_unpacked_address_t *remote_address,
                                  uint8_t *addr_indices)
 {
-    ucs_status_t status = ucp_wireup_init_lanes(ep, params, ep_init_flags,
-                                                address_count, address_list,
-                                                addr_indices);
+    ucs_status_t status;
+
+    status = ucp_wireup_check_stream_window(worker, remote_address);
     if (status == UCS_OK) {
-        return UCS_OK;
+        status = ucp_wireup_init_lanes(ep, params, ep_init_flags,
+                                       remote_address->address_count,
+                                       remote_address->address_list,
+                                       addr_indices);
+        if (status == UCS_OK) {
+            return UCS_OK;
+        }
     }
 
     ucp_worker_set_ep_failed(worker, ep, NULL, UCP_NULL_LANE, status);
@@ -313,9 +320,7 @@ ucp_wireup_process_pre_request(ucp_worker_h worker, const ucp_wireup_msg_t *msg,
     /* initialize transport endpoints */
     status = ucp_wireup_init_lanes_by_request(worker, ep, &params,
                                               UCP_EP_CREATE_AM_LANE,
-                                              remote_address->address_count,
-                                              remote_address->address_list,
-                                              addr_indices);
+                                              remote_address, addr_indices);
     if (status != UCS_OK) {
         return;
     }
@@ -407,9 +412,7 @@ ucp_wireup_process_request(ucp_worker_h worker, const ucp_wireup_msg_t *msg,
 
     /* Initialize lanes (possible destroy existing lanes) */
     status = ucp_wireup_init_lanes_by_request(worker, ep, &params, ep_init_flags,
-                                              remote_address->address_count,
-                                              remote_address->address_list,
-                                              addr_indices);
+                                              remote_address, addr_indices);
     if (status != UCS_OK) {
         return;
     }
@@ -866,6 +869,27 @@ ucp_wireup_get_reachable_mds(ucp_worker_h worker, unsigned address_count,
     key->reachable_md_map = dst_md_map;
 }
 
+ucs_status_t
+ucp_wireup_check_stream_window(ucp_worker_h worker,
+                               const ucp_unpacked_address_t *remote_address)
+{
+    ucp_context_h context = worker->context;
+
+    /* stream flow control needs the same window on both sides, otherwise the
+     * sender could wait for credit which the receiver would never grant */
+    if (!(context->config.features & UCP_FEATURE_STREAM) ||
+        (remote_address->stream_window == UCS_MEMUNITS_AUTO) ||
+        (remote_address->stream_window == context->config.ext.stream_window)) {
+        return UCS_OK;
+    }
+
+    ucs_error("worker %s: STREAM_WINDOW %zu of remote worker %s is different"
+              " from the local %zu", ucp_worker_get_name(worker),
+              remote_address->stream_window, remote_address->name,
+              context->config.ext.stream_window);
+    return UCS_ERR_UNREACHABLE;
+}
+
 ucs_status_t ucp_wireup_init_lanes(ucp_ep_h ep, const ucp_ep_params_t *params,
                                    unsigned ep_init_flags, unsigned address_count,
                                    const ucp_address_entry_t *address_list,
@@ -597,6 +597,11 @@ ucs_status_t ucp_wireup_ep_connect_to_sockaddr(uct_ep_h uct_ep,
         goto out;
     }
 
+    status = ucp_worker_iface_open_lazy(worker, sockaddr_rsc);
+    if (status != UCS_OK) {
+        goto out;
+    }
+
     wiface = ucp_worker_iface(worker, sockaddr_rsc);
 
     wireup_ep->sockaddr_rsc_index = sockaddr_rsc;
@@ -77,6 +77,12 @@ static void ucs_callbackq_elem_reset(ucs_callbackq_t *cbq,
     elem->flags = 0;
 }
 
+static void ucs_callbackq_backoff_reset(ucs_callbackq_backoff_t *state)
+{
+    state->backoff = 0;
+    state->skip    = 0;
+}
+
 static void *ucs_callbackq_array_grow(ucs_callbackq_t *cbq, void *ptr,
                                       size_t elem_size, int count,
                                       int *new_count, const char *alloc_name)
@@ -218,6 +224,7 @@ static int ucs_callbackq_add_fast(ucs_callbackq_t *cbq, ucs_callback_t cb,
     cbq->fast_elems[idx].arg   = arg;
     cbq->fast_elems[idx].flags = flags;
     cbq->fast_elems[idx].id    = id;
+    ucs_callbackq_backoff_reset(&cbq->fast_backoff[idx]);
     return id;
 }
 
@@ -233,6 +240,10 @@ static void ucs_callbackq_remove_fast(ucs_callbackq_t *cbq, unsigned idx)
     last_idx = --priv->num_fast_elems;
     ucs_callbackq_remove_common(cbq, cbq->fast_elems, idx, last_idx, 0,
                                 &priv->fast_remove_mask);
+
+    /* the backoff state moves together with the element */
+    cbq->fast_backoff[idx] = cbq->fast_backoff[last_idx];
+    ucs_callbackq_backoff_reset(&cbq->fast_backoff[last_idx]);
 }
 
 /* should be called from dispatch thread only */
@@ -269,7 +280,9 @@ static void ucs_callbackq_enable_proxy(ucs_callbackq_t *cbq)
 
     ucs_assert(cbq->fast_elems[idx].arg == cbq);
     cbq->fast_elems[idx].cb    = ucs_callbackq_slow_proxy;
-    cbq->fast_elems[idx].flags = 0;
+    /* the proxy also purges removed callbacks, so do not starve it when
+     * dispatching with a budget */
+    cbq->fast_elems[idx].flags = UCS_CALLBACKQ_FLAG_PRIO;
     cbq->fast_elems[idx].id    = id;
     /* Avoid writing 'arg' because the dispatching thread may not see it in case
      * of weak memory ordering. Instead, 'arg' is reset to 'cbq' for all free and
@@ -383,6 +396,7 @@ static unsigned ucs_callbackq_slow_proxy(void *arg)
             if (priv->num_fast_elems < UCS_CALLBACKQ_FAST_MAX) {
                 fast_idx = ucs_callbackq_get_fast_idx(cbq);
                 cbq->fast_elems[fast_idx] = *elem;
+                ucs_callbackq_backoff_reset(&cbq->fast_backoff[fast_idx]);
                 priv->idxs[elem->id]      = fast_idx;
                 ucs_callbackq_remove_slow(cbq, slow_idx);
             }
@@ -420,7 +434,9 @@ ucs_status_t ucs_callbackq_init(ucs_callbackq_t *cbq)
 
     for (idx = 0; idx < UCS_CALLBACKQ_FAST_COUNT + 1; ++idx) {
         ucs_callbackq_elem_reset(cbq, &cbq->fast_elems[idx]);
+        ucs_callbackq_backoff_reset(&cbq->fast_backoff[idx]);
     }
+    cbq->budget_idx = 0;
 
     ucs_spinlock_init(&priv->lock);
     priv->slow_elems        = NULL;
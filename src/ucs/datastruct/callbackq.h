@@ -10,6 +10,7 @@
 
 #include <ucs/datastruct/list_types.h>
 #include <ucs/sys/compiler_def.h>
+#include <ucs/sys/math.h>
 #include <ucs/type/status.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -27,6 +28,8 @@ BEGIN_C_DECLS
 
 #define UCS_CALLBACKQ_FAST_COUNT   7     /* Max. number of fast-path callbacks */
 #define UCS_CALLBACKQ_ID_NULL      (-1)  /* Invalid callback identifier */
+#define UCS_CALLBACKQ_BACKOFF_MAX  32    /* Max. number of skipped dispatches
+                                            of an idle backoff callback */
 
 
 /*
@@ -66,8 +69,17 @@ typedef int (*ucs_callbackq_predicate_t)(const ucs_callbackq_elem_t *elem,
  */
 enum ucs_callbackq_flags {
     UCS_CALLBACKQ_FLAG_FAST        = UCS_BIT(0), /**< Fast-path (best effort) */
-    UCS_CALLBACKQ_FLAG_ONESHOT     = UCS_BIT(1)  /**< Call the callback only once
+    UCS_CALLBACKQ_FLAG_ONESHOT     = UCS_BIT(1), /**< Call the callback only once
                                                       (cannot be used with FAST) */
+    UCS_CALLBACKQ_FLAG_PRIO        = UCS_BIT(2), /**< Latency sensitive, dispatch
+                                                      it before the other callbacks
+                                                      when dispatching with a
+                                                      budget */
+    UCS_CALLBACKQ_FLAG_BACKOFF     = UCS_BIT(3)  /**< Dispatch less often while
+                                                      the callback does no work
+                                                      (only for FAST, and only
+                                                      when dispatching with a
+                                                      budget) */
 };
 
 
@@ -82,6 +94,17 @@ struct ucs_callbackq_elem {
 };
 
 
+/**
+ * Backoff state of a fast-path callback queue element, see
+ * @ref UCS_CALLBACKQ_FLAG_BACKOFF.
+ */
+typedef struct ucs_callbackq_backoff {
+    uint16_t                       backoff;  /**< Current number of dispatches
+                                                  to skip after an idle call */
+    uint16_t                       skip;     /**< Remaining dispatches to skip */
+} ucs_callbackq_backoff_t;
+
+
 /**
  * A queue of callback to execute
  */
@@ -92,6 +115,19 @@ struct ucs_callbackq {
      */
     ucs_callbackq_elem_t           fast_elems[UCS_CALLBACKQ_FAST_COUNT + 1];
 
+    /**
+     * Fast-path element to start the next dispatch with a budget from, so the
+     * elements in the end of the array would not be starved
+     */
+    unsigned                       budget_idx;
+
+    /**
+     * Backoff state of the fast-path elements, by the same index as
+     * @a fast_elems. Kept aside to not grow the elements, which are read by
+     * every dispatch.
+     */
+    ucs_callbackq_backoff_t        fast_backoff[UCS_CALLBACKQ_FAST_COUNT + 1];
+
     /**
      * Private data, which we don't want to expose in API to avoid pulling
      * more header files
@@ -192,6 +228,41 @@ void ucs_callbackq_remove_if(ucs_callbackq_t *cbq, ucs_callbackq_predicate_t pre
                              void *arg);
 
 
+/**
+ * Call a fast-path callback, unless it is in backoff state.
+ * A callback with @ref UCS_CALLBACKQ_FLAG_BACKOFF which did no work skips the
+ * next dispatches, twice as many as the previous time, up to
+ * @ref UCS_CALLBACKQ_BACKOFF_MAX. Any work resets it to be called every time.
+ */
+static UCS_F_ALWAYS_INLINE unsigned
+ucs_callbackq_elem_dispatch(ucs_callbackq_t *cbq, ucs_callbackq_elem_t *elem,
+                            ucs_callback_t cb)
+{
+    ucs_callbackq_backoff_t *state;
+    unsigned count;
+
+    if (ucs_likely(!(elem->flags & UCS_CALLBACKQ_FLAG_BACKOFF))) {
+        return cb(elem->arg);
+    }
+
+    state = &cbq->fast_backoff[elem - cbq->fast_elems];
+    if (state->skip > 0) {
+        --state->skip;
+        return 0;
+    }
+
+    count = cb(elem->arg);
+    if (count == 0) {
+        state->backoff = (state->backoff == 0) ? 1 :
+                         ucs_min(state->backoff * 2, UCS_CALLBACKQ_BACKOFF_MAX);
+        state->skip    = state->backoff;
+    } else {
+        state->backoff = 0;
+    }
+    return count;
+}
+
+
 /**
  * Dispatch callbacks from the callback queue.
  * Must be called from single thread only.
@@ -213,6 +284,56 @@ static inline unsigned ucs_callbackq_dispatch(ucs_callbackq_t *cbq)
     return count;
 }
 
+
+/**
+ * Dispatch callbacks from the callback queue, until they report at least
+ * @a max_events work. Callbacks with @ref UCS_CALLBACKQ_FLAG_PRIO, as well as
+ * the slow-path callbacks, are always dispatched first; the remaining ones are
+ * dispatched only while the budget is not exhausted, starting after the last
+ * one which was dispatched by the previous call.
+ * Must be called from single thread only.
+ *
+ * @param  [in] cbq         Callback queue to dispatch callbacks from.
+ * @param  [in] max_events  Stop dispatching once this much work is done.
+
+ * @return Sum of all return values from the dispatched callbacks.
+ */
+static inline unsigned ucs_callbackq_dispatch_budget(ucs_callbackq_t *cbq,
+                                                     unsigned max_events)
+{
+    ucs_callbackq_elem_t *elem;
+    unsigned num_elems, idx, i;
+    ucs_callback_t cb;
+    unsigned count;
+
+    count = 0;
+    for (elem = cbq->fast_elems; (cb = elem->cb) != NULL; ++elem) {
+        if (elem->flags & UCS_CALLBACKQ_FLAG_PRIO) {
+            count += ucs_callbackq_elem_dispatch(cbq, elem, cb);
+        }
+    }
+
+    num_elems = elem - cbq->fast_elems;
+    idx       = (cbq->budget_idx < num_elems) ? cbq->budget_idx : 0;
+    for (i = 0; (i < num_elems) && (count < max_events); ++i) {
+        elem = &cbq->fast_elems[idx];
+        cb   = elem->cb;
+        if (cb == NULL) {
+            /* removed by a dispatched callback */
+            break;
+        }
+
+        if (!(elem->flags & UCS_CALLBACKQ_FLAG_PRIO)) {
+            count += ucs_callbackq_elem_dispatch(cbq, elem, cb);
+        }
+
+        idx = (idx + 1 < num_elems) ? (idx + 1) : 0;
+    }
+
+    cbq->budget_idx = idx;
+    return count;
+}
+
 END_C_DECLS
 
 #endif
@@ -487,6 +487,13 @@ enum uct_flush_flags {
 enum uct_progress_types {
     UCT_PROGRESS_SEND        = UCS_BIT(0),  /**< Progress send operations */
     UCT_PROGRESS_RECV        = UCS_BIT(1),  /**< Progress receive operations */
+    UCT_PROGRESS_PRIO        = UCS_BIT(5),  /**< Hint for enable: the interface
+                                                 is latency sensitive, progress
+                                                 it ahead of other interfaces */
+    UCT_PROGRESS_BACKOFF     = UCS_BIT(6),  /**< Hint for enable: progress the
+                                                 interface less often while it
+                                                 has no events, when progressing
+                                                 the worker with a budget */
     UCT_PROGRESS_THREAD_SAFE = UCS_BIT(7)   /**< Enable/disable progress while
                                                  another thread may be calling
                                                  @ref ucp_worker_progress(). */
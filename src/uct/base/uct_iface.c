@@ -206,23 +206,30 @@ void uct_base_iface_progress_enable_cb(uct_base_iface_t *iface,
                                        ucs_callback_t cb, unsigned flags)
 {
     uct_priv_worker_t *worker = iface->worker;
-    unsigned thread_safe;
+    unsigned thread_safe, cbq_flags;
 
     UCS_ASYNC_BLOCK(worker->async);
 
     thread_safe = flags & UCT_PROGRESS_THREAD_SAFE;
-    flags      &= ~UCT_PROGRESS_THREAD_SAFE;
+    cbq_flags   = UCS_CALLBACKQ_FLAG_FAST;
+    if (flags & UCT_PROGRESS_PRIO) {
+        cbq_flags |= UCS_CALLBACKQ_FLAG_PRIO;
+    }
+    if (flags & UCT_PROGRESS_BACKOFF) {
+        cbq_flags |= UCS_CALLBACKQ_FLAG_BACKOFF;
+    }
+    flags      &= ~(UCT_PROGRESS_THREAD_SAFE | UCT_PROGRESS_PRIO |
+                    UCT_PROGRESS_BACKOFF);
 
     /* Add callback only if previous flags are 0 and new flags != 0 */
     if ((!iface->progress_flags && flags) &&
         (iface->prog.id == UCS_CALLBACKQ_ID_NULL)) {
         if (thread_safe) {
             iface->prog.id = ucs_callbackq_add_safe(&worker->super.progress_q,
-                                                    cb, iface,
-                                                    UCS_CALLBACKQ_FLAG_FAST);
+                                                    cb, iface, cbq_flags);
         } else {
             iface->prog.id = ucs_callbackq_add(&worker->super.progress_q, cb,
-                                               iface, UCS_CALLBACKQ_FLAG_FAST);
+                                               iface, cbq_flags);
         }
     }
     iface->progress_flags |= flags;
@@ -239,7 +246,8 @@ void uct_base_iface_progress_disable(uct_iface_h tl_iface, unsigned flags)
     UCS_ASYNC_BLOCK(worker->async);
 
     thread_safe = flags & UCT_PROGRESS_THREAD_SAFE;
-    flags      &= ~UCT_PROGRESS_THREAD_SAFE;
+    flags      &= ~(UCT_PROGRESS_THREAD_SAFE | UCT_PROGRESS_PRIO |
+                    UCT_PROGRESS_BACKOFF);
 
     /* Remove callback only if previous flags != 0, and removing the given
      * flags makes it become 0.
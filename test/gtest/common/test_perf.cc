@@ -212,6 +212,7 @@ test_perf::test_result test_perf::run_multi_threaded(const test_spec &test, unsi
     params.iov_stride      = test.msg_stride;
     params.ucp.send_datatype = (ucp_perf_datatype_t)test.data_layout;
     params.ucp.recv_datatype = (ucp_perf_datatype_t)test.data_layout;
+    params.ucp.am_batch_size = 16;
 
     thread_arg arg0;
     arg0.params   = params;
@@ -13,6 +13,10 @@
 #include "ucp_datatype.h"
 #include "ucp_test.h"
 
+extern "C" {
+#include <ucp/core/ucp_worker.h>
+}
+
 #define NUM_MESSAGES 17
 
 #define UCP_REALLOC_ID 1000
@@ -28,6 +32,7 @@ public:
     void *reply;
     void *for_release[NUM_MESSAGES];
     int release;
+    std::vector<size_t> recv_lengths;
 
     static ucp_params_t get_ctx_params() {
         ucp_params_t params = ucp_test::get_ctx_params();
@@ -97,6 +102,7 @@ ucs_status_t test_ucp_am_base::am_handler(test_ucp_am_base *me, void *data,
         status = UCS_OK;
     }
     
+    me->recv_lengths.push_back(length);
     me->recv_ams++;
     return status;
 }
@@ -121,7 +127,12 @@ protected:
     void do_send_process_data_test(int test_release, uint16_t am_id,
                                    int send_reply);
     void do_send_process_data_iov_test();
+    void do_send_batch_test(unsigned flags);
     void set_handlers(uint16_t am_id);
+
+    static ucs_status_t ucp_process_batch_cb(void *arg, void *data,
+                                             size_t length, ucp_ep_h reply_ep,
+                                             unsigned flags);
     void set_reply_handlers();
 };
 
@@ -257,6 +268,58 @@ void test_ucp_am::do_set_am_handler_realloc_test()
     do_send_process_data_test(0, UCP_SEND_ID + 1, 0);
 }
 
+ucs_status_t test_ucp_am::ucp_process_batch_cb(void *arg, void *data,
+                                               size_t length,
+                                               ucp_ep_h reply_ep,
+                                               unsigned flags)
+{
+    test_ucp_am *self = reinterpret_cast<test_ucp_am*>(arg);
+
+    /* batched data does not persist after the callback */
+    EXPECT_EQ(0u, flags);
+    if (reply_ep != NULL) {
+        self->replies++;
+    }
+
+    return self->am_handler(self, data, length, flags);
+}
+
+void test_ucp_am::do_send_batch_test(unsigned flags)
+{
+    const size_t count = 100;
+    std::vector<ucp_am_batch_item_t> items(count);
+    std::vector<std::vector<char> > bufs(count);
+    std::vector<size_t> lengths(count);
+    ucs_status_ptr_t sstatus;
+
+    for (size_t i = 0; i < count; ++i) {
+        lengths[i]      = (i * 13) % 300;
+        bufs[i].assign(lengths[i] + 1, (char)lengths[i]);
+        items[i].id     = UCP_SEND_ID;
+        items[i].buffer = &bufs[i][0];
+        items[i].length = lengths[i];
+    }
+
+    recv_ams = 0;
+    replies  = 0;
+    release  = 0;
+    recv_lengths.clear();
+
+    sstatus = ucp_am_send_batch(receiver().ep(), &items[0], count,
+                                (ucp_send_callback_t)ucs_empty_function,
+                                flags);
+    EXPECT_FALSE(UCS_PTR_IS_ERR(sstatus));
+    wait(sstatus);
+
+    while (recv_ams < (int)count) {
+        progress();
+    }
+
+    /* messages are delivered in the order of the batch */
+    EXPECT_EQ(lengths, recv_lengths);
+    EXPECT_EQ((flags & UCP_AM_SEND_REPLY) ? (int)count : 0, replies);
+}
+
 UCS_TEST_P(test_ucp_am, send_process_am) 
 {
     set_handlers(UCP_SEND_ID);
@@ -282,4 +345,246 @@ UCS_TEST_P(test_ucp_am, set_am_handler_realloc)
     do_set_am_handler_realloc_test();
 }
 
+UCS_TEST_P(test_ucp_am, send_batch)
+{
+    ucp_worker_set_am_handler(sender().worker(), UCP_SEND_ID,
+                              ucp_process_batch_cb, this,
+                              UCP_AM_FLAG_WHOLE_MSG);
+
+    do_send_batch_test(0);
+    do_send_batch_test(UCP_AM_SEND_REPLY);
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_am)
+
+
+class test_ucp_am_rndv : public test_ucp_am {
+public:
+    enum {
+        RECV_IN_CB,
+        RECV_DEFERRED,
+        DROP
+    };
+
+    virtual void init() {
+        modify_config("AM_RNDV_THRESH", "1k");
+        test_ucp_am::init();
+    }
+
+protected:
+    static ucs_status_t rndv_am_cb(void *arg, void *data, size_t length,
+                                   ucp_ep_h reply_ep, unsigned flags);
+
+    static void rndv_recv_cb(void *request, ucs_status_t status,
+                             size_t length) {
+    }
+
+    void *recv_data(void *data_desc) {
+        void *rreq = ucp_am_recv_data_nb(receiver().worker(), data_desc,
+                                         &m_rbuf[0], m_rbuf.size(),
+                                         ucp_dt_make_contig(1), rndv_recv_cb);
+        EXPECT_FALSE(UCS_PTR_IS_ERR(rreq));
+        return rreq;
+    }
+
+    void do_rndv_test(int mode, unsigned send_flags);
+
+    int               m_mode;
+    std::vector<char> m_rbuf;
+    void              *m_desc;
+    void              *m_rreq;
+    ucp_ep_h          m_reply_ep;
+};
+
+ucs_status_t test_ucp_am_rndv::rndv_am_cb(void *arg, void *data, size_t length,
+                                          ucp_ep_h reply_ep, unsigned flags)
+{
+    test_ucp_am_rndv *self = reinterpret_cast<test_ucp_am_rndv*>(arg);
+
+    EXPECT_TRUE(flags & UCP_CB_PARAM_FLAG_RNDV);
+    EXPECT_EQ(self->m_rbuf.size(), length);
+    self->m_reply_ep = reply_ep;
+    self->recv_ams++;
+
+    switch (self->m_mode) {
+    case RECV_IN_CB:
+        self->m_rreq = self->recv_data(data);
+        return UCS_OK;
+    case RECV_DEFERRED:
+        self->m_desc = data;
+        return UCS_INPROGRESS;
+    default:
+        return UCS_OK;
+    }
+}
+
+void test_ucp_am_rndv::do_rndv_test(int mode, unsigned send_flags)
+{
+    const size_t size = 64 * UCS_KBYTE;
+    std::vector<char> sbuf(size);
+    ucs_status_ptr_t sreq;
+
+    ucs::fill_random(sbuf);
+    m_rbuf.assign(size, 0);
+    m_mode     = mode;
+    m_desc     = NULL;
+    m_rreq     = NULL;
+    m_reply_ep = NULL;
+    recv_ams   = 0;
+
+    ucp_worker_set_am_handler(receiver().worker(), UCP_SEND_ID, rndv_am_cb,
+                              this, UCP_AM_FLAG_WHOLE_MSG | UCP_AM_FLAG_RNDV);
+
+    sreq = ucp_am_send_nb(sender().ep(), UCP_SEND_ID, &sbuf[0], size,
+                          ucp_dt_make_contig(1),
+                          (ucp_send_callback_t)ucs_empty_function, send_flags);
+    EXPECT_FALSE(UCS_PTR_IS_ERR(sreq));
+
+    while (recv_ams == 0) {
+        progress();
+    }
+
+    if (mode == RECV_DEFERRED) {
+        ASSERT_TRUE(m_desc != NULL);
+        m_rreq = recv_data(m_desc);
+    }
+
+    wait(m_rreq);
+    wait(sreq);
+
+    EXPECT_EQ((send_flags & UCP_AM_SEND_REPLY) != 0, m_reply_ep != NULL);
+    if (mode != DROP) {
+        EXPECT_EQ(sbuf, m_rbuf);
+    }
+}
+
+UCS_TEST_P(test_ucp_am_rndv, recv_data_in_cb)
+{
+    do_rndv_test(RECV_IN_CB, 0);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, recv_data_in_cb_reply)
+{
+    do_rndv_test(RECV_IN_CB, UCP_AM_SEND_REPLY);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, recv_data_deferred)
+{
+    do_rndv_test(RECV_DEFERRED, 0);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, drop)
+{
+    do_rndv_test(DROP, 0);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, send_process_whole_msg)
+{
+    set_handlers(UCP_SEND_ID);
+    do_send_process_data_test(0, UCP_SEND_ID, 0);
+
+    set_reply_handlers();
+    do_send_process_data_test(0, UCP_SEND_ID, UCP_AM_SEND_REPLY);
+}
+
+UCS_TEST_P(test_ucp_am_rndv, send_process_iov_am)
+{
+    do_send_process_data_iov_test();
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_am_rndv)
+
+
+class test_ucp_am_many2one : public test_ucp_am_base {
+public:
+    test_ucp_am_many2one() : m_receiver_idx(3), m_nsenders(3) {
+    }
+
+    virtual void init() {
+        if (is_self()) {
+            UCS_TEST_SKIP_R("self");
+        }
+
+        /* Skip entities creation */
+        test_base::init();
+
+        for (size_t i = 0; i < m_nsenders + 1; ++i) {
+            create_entity();
+        }
+
+        for (size_t i = 0; i < m_nsenders; ++i) {
+            e(i).connect(&e(m_receiver_idx), get_ep_params(), i);
+            e(m_receiver_idx).connect(&e(i), get_ep_params(), i);
+        }
+    }
+
+protected:
+    static ucs_status_t many2one_am_cb(void *arg, void *data, size_t length,
+                                       ucp_ep_h reply_ep, unsigned flags) {
+        test_ucp_am_many2one *self = reinterpret_cast<test_ucp_am_many2one*>(arg);
+        const char *buf            = (const char*)data;
+
+        /* every message is filled with its own value */
+        EXPECT_EQ(std::string(length, buf[0]), std::string(buf, length));
+        self->m_recv_values.insert(buf[0]);
+        self->recv_ams++;
+        return UCS_OK;
+    }
+
+    const size_t        m_receiver_idx;
+    const size_t        m_nsenders;
+    std::multiset<char> m_recv_values;
+};
+
+/* long messages from several senders with the same message ids are
+ * reassembled in parallel */
+UCS_TEST_P(test_ucp_am_many2one, send_long_interleaved)
+{
+    const size_t size   = 256 * UCS_KBYTE / ucs::test_time_multiplier();
+    const size_t nmsgs  = 4;
+    uint64_t message_id = e(0).worker()->am_message_id;
+    std::vector<std::vector<char> > bufs;
+    std::vector<ucs_status_ptr_t> sreqs;
+    std::multiset<char> sent_values;
+
+    bufs.reserve(m_nsenders * nmsgs);
+
+    ucp_worker_set_am_handler(e(m_receiver_idx).worker(), UCP_SEND_ID,
+                              many2one_am_cb, this, UCP_AM_FLAG_WHOLE_MSG);
+
+    recv_ams = 0;
+    for (size_t i = 0; i < m_nsenders; ++i) {
+        e(i).worker()->am_message_id = message_id;
+    }
+
+    /* post the messages of all senders before progressing any of them */
+    for (size_t j = 0; j < nmsgs; ++j) {
+        for (size_t i = 0; i < m_nsenders; ++i) {
+            char value = (char)((i * nmsgs) + j + 1);
+
+            bufs.push_back(std::vector<char>(size, value));
+            sent_values.insert(value);
+            sreqs.push_back(ucp_am_send_nb(e(i).ep(), UCP_SEND_ID,
+                                           &bufs.back()[0], size,
+                                           ucp_dt_make_contig(1),
+                                           (ucp_send_callback_t)
+                                           ucs_empty_function, 0));
+            ASSERT_FALSE(UCS_PTR_IS_ERR(sreqs.back()));
+        }
+    }
+
+    ucs_time_t deadline = ucs_get_time() + ucs_time_from_sec(10.0);
+    while ((recv_ams < (int)(m_nsenders * nmsgs)) &&
+           (ucs_get_time() < deadline)) {
+        progress();
+    }
+
+    ASSERT_EQ((int)(m_nsenders * nmsgs), recv_ams);
+    for (size_t i = 0; i < sreqs.size(); ++i) {
+        wait(sreqs[i]);
+    }
+
+    EXPECT_EQ(sent_values, m_recv_values);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_am_many2one)
@@ -6,6 +6,7 @@
 
 #include "ucp_test.h"
 extern "C" {
+#include <ucp/core/ucp_worker.h>
 #include <ucs/sys/sys.h>
 }
 
@@ -49,6 +50,25 @@ UCS_TEST_P(test_ucp_context, minimal_field_mask) {
     }
 }
 
+UCS_TEST_P(test_ucp_context, lazy_iface_open, "LAZY_IFACE_OPEN=y") {
+    /* the second worker uses the interface attributes cached by the first one */
+    entity *e = create_entity();
+
+    for (int i = 0; i < 2; ++i) {
+        ucp_worker_h worker = (i == 0) ? sender().worker() : e->worker();
+
+        for (unsigned iface_id = 0; iface_id < worker->num_ifaces; ++iface_id) {
+            ucp_worker_iface_t *wiface = worker->ifaces[iface_id];
+            bool can_connect = wiface->attr.cap.flags &
+                               (UCT_IFACE_FLAG_CONNECT_TO_IFACE |
+                                UCT_IFACE_FLAG_CONNECT_TO_EP);
+
+            EXPECT_EQ(can_connect, wiface->iface != NULL)
+                << worker->context->tl_rscs[wiface->rsc_index].tl_rsc.tl_name;
+        }
+    }
+}
+
 UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_context, all, "all")
 
 class test_ucp_aliases : public test_ucp_context {
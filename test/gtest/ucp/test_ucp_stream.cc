@@ -12,6 +12,11 @@
 #include "ucp_datatype.h"
 #include "ucp_test.h"
 
+extern "C" {
+#include <ucp/core/ucp_ep.h>
+#include <ucp/core/ucp_ep.inl>
+}
+
 
 class test_ucp_stream_base : public ucp_test {
 public:
@@ -132,6 +137,9 @@ protected:
     template <typename T, unsigned recv_flags>
     void do_send_exp_recv_test(ucp_datatype_t datatype);
     void do_send_recv_data_recv_test(ucp_datatype_t datatype);
+    void do_send_recv_rndv_test(bool recv_first);
+    bool poll_ep_event(ucp_worker_h worker, ucp_ep_h ep, unsigned event,
+                       ucp_stream_poll_ep_t *result);
 
     /* for self-validation of generic datatype
      * NOTE: it's tested only with byte array data since it's recv completion
@@ -139,6 +147,31 @@ protected:
     std::vector<uint8_t> context;
 };
 
+bool test_ucp_stream::poll_ep_event(ucp_worker_h worker, ucp_ep_h ep,
+                                    unsigned event,
+                                    ucp_stream_poll_ep_t *result)
+{
+    static const size_t  max_eps = 10;
+    ucp_stream_poll_ep_t poll_eps[max_eps];
+    ssize_t              count;
+
+    ucs_time_t deadline = ucs_get_time() +
+                          (ucs_time_from_sec(10.0) * ucs::test_time_multiplier());
+    do {
+        progress();
+        count = ucp_stream_worker_poll(worker, poll_eps, max_eps, 0);
+        EXPECT_GE(count, 0l);
+        for (ssize_t i = 0; i < count; ++i) {
+            if ((poll_eps[i].ep == ep) && (poll_eps[i].flags & event)) {
+                *result = poll_eps[i];
+                return true;
+            }
+        }
+    } while (ucs_get_time() < deadline);
+
+    return false;
+}
+
 void test_ucp_stream::do_send_recv_data_test(ucp_datatype_t datatype)
 {
     size_t            ssize = 0; /* total send size in bytes */
@@ -401,6 +434,71 @@ void test_ucp_stream::do_send_recv_data_recv_test(ucp_datatype_t datatype)
     EXPECT_EQ(check_pattern, rbuf);
 }
 
+void test_ucp_stream::do_send_recv_rndv_test(bool recv_first)
+{
+    /* eager and rendezvous sends, only some of the rendezvous ones fit in
+     * the receive buffer at the head of the stream */
+    const size_t ssizes[] = { 100, 64 * UCS_KBYTE, 10, 300 * UCS_KBYTE,
+                              2000, 7, 8 * UCS_KBYTE };
+    const size_t nsends   = sizeof(ssizes) / sizeof(ssizes[0]);
+    size_t       total    = std::accumulate(ssizes, ssizes + nsends, 0ul);
+    const size_t rsizes[] = { 50, 100 * UCS_KBYTE, total - 50 - 100 * UCS_KBYTE };
+    const size_t nrecvs   = sizeof(rsizes) / sizeof(rsizes[0]);
+    std::vector<char>   sbuf(total);
+    std::vector<char>   rbuf(total, 'r');
+    std::vector<void*>  sreqs, rreqs;
+    std::vector<size_t> rlengths(nrecvs);
+    size_t              offset;
+
+    ucs::fill_random(sbuf);
+
+    for (int post = 0; post < 2; ++post) {
+        if (post == !recv_first) {
+            offset = 0;
+            for (size_t i = 0; i < nrecvs; ++i) {
+                void *rreq = ucp_stream_recv_nb(receiver().ep(), &rbuf[offset],
+                                                rsizes[i], DATATYPE,
+                                                ucp_recv_cb, &rlengths[i],
+                                                UCP_STREAM_RECV_FLAG_WAITALL);
+                ASSERT_FALSE(UCS_PTR_IS_ERR(rreq));
+                rreqs.push_back(rreq);
+                offset += rsizes[i];
+            }
+        } else {
+            offset = 0;
+            for (size_t i = 0; i < nsends; ++i) {
+                ucp::data_type_desc_t dt_desc(DATATYPE, &sbuf[offset],
+                                              ssizes[i]);
+                void *sreq = stream_send_nb(dt_desc);
+                ASSERT_FALSE(UCS_PTR_IS_ERR(sreq));
+                sreqs.push_back(sreq);
+                offset += ssizes[i];
+            }
+
+            if (!recv_first) {
+                /* rendezvous data is fetched to a bounce buffer */
+                for (size_t i = 0; i < sreqs.size(); ++i) {
+                    wait(sreqs[i]);
+                }
+                sreqs.clear();
+            }
+        }
+    }
+
+    for (size_t i = 0; i < rreqs.size(); ++i) {
+        if (UCS_PTR_IS_PTR(rreqs[i])) {
+            rlengths[i] = wait_stream_recv(rreqs[i]);
+        }
+        EXPECT_EQ(rsizes[i], rlengths[i]);
+    }
+
+    for (size_t i = 0; i < sreqs.size(); ++i) {
+        wait(sreqs[i]);
+    }
+
+    EXPECT_EQ(sbuf, rbuf);
+}
+
 UCS_TEST_P(test_ucp_stream, send_recv_data) {
     do_send_recv_data_test(DATATYPE);
 }
@@ -516,6 +614,203 @@ UCS_TEST_P(test_ucp_stream, send_recv_data_recv_iov) {
     do_send_recv_data_recv_test(DATATYPE_IOV);
 }
 
+UCS_TEST_P(test_ucp_stream, send_exp_recv_rndv, "STREAM_RNDV_THRESH=1k") {
+    do_send_recv_rndv_test(true);
+}
+
+UCS_TEST_P(test_ucp_stream, send_recv_rndv, "STREAM_RNDV_THRESH=1k") {
+    do_send_recv_rndv_test(false);
+}
+
+UCS_TEST_P(test_ucp_stream, send_recv_window, "STREAM_WINDOW=64k") {
+    const size_t       msg_size = 4 * UCS_KBYTE;
+    const size_t       n_msgs   = 64;
+    std::vector<char>  sbuf(msg_size * n_msgs);
+    std::vector<char>  rbuf(sbuf.size(), 'r');
+    std::vector<void*> sreqs;
+    size_t             offset, length;
+
+    ucs::fill_random(sbuf);
+
+    for (size_t i = 0; i < n_msgs; ++i) {
+        ucp::data_type_desc_t dt_desc(DATATYPE, &sbuf[i * msg_size], msg_size);
+        void *sreq = stream_send_nb(dt_desc);
+        ASSERT_FALSE(UCS_PTR_IS_ERR(sreq));
+        sreqs.push_back(sreq);
+    }
+
+    /* the sends above the window wait for the receiver to consume data */
+    for (int i = 0; i < 100; ++i) {
+        progress();
+    }
+    ASSERT_TRUE(UCS_PTR_IS_PTR(sreqs.back()));
+    EXPECT_EQ(UCS_INPROGRESS, ucp_request_check_status(sreqs.back()));
+
+    offset = 0;
+    while (offset < rbuf.size()) {
+        void *rreq = ucp_stream_recv_nb(receiver().ep(), &rbuf[offset],
+                                        rbuf.size() - offset, DATATYPE,
+                                        ucp_recv_cb, &length, 0);
+        ASSERT_FALSE(UCS_PTR_IS_ERR(rreq));
+        if (UCS_PTR_IS_PTR(rreq)) {
+            length = wait_stream_recv(rreq);
+        }
+        offset += length;
+    }
+
+    for (size_t i = 0; i < sreqs.size(); ++i) {
+        wait(sreqs[i]);
+    }
+
+    EXPECT_EQ(sbuf, rbuf);
+
+    /* a send larger than the whole window would never get enough credit */
+    ucp::data_type_desc_t dt_desc(DATATYPE, &sbuf[0], 64 * UCS_KBYTE + 1);
+    void *sreq = stream_send_nb(dt_desc);
+    EXPECT_EQ(UCS_ERR_EXCEEDS_LIMIT, UCS_PTR_STATUS(sreq));
+}
+
+UCS_TEST_P(test_ucp_stream, window_mismatch, "STREAM_WINDOW=64k") {
+    ucp_ep_params_t params = get_ep_params();
+    ucp_address_t   *address;
+    size_t          address_length;
+    ucs_status_t    status;
+    ucp_ep_h        ep;
+
+    modify_config("STREAM_WINDOW", "32k");
+    entity *peer = create_entity();
+
+    ASSERT_UCS_OK(ucp_worker_get_address(peer->worker(), &address,
+                                         &address_length));
+
+    params.field_mask |= UCP_EP_PARAM_FIELD_REMOTE_ADDRESS;
+    params.address     = address;
+    {
+        scoped_log_handler slh(hide_errors_logger);
+        status = ucp_ep_create(sender().worker(), &params, &ep);
+    }
+    ucp_worker_release_address(peer->worker(), address);
+
+    EXPECT_EQ(UCS_ERR_UNREACHABLE, status);
+}
+
+UCS_TEST_P(test_ucp_stream, ep_ext_proto_on_demand) {
+    const size_t      msg_size = 1000;
+    std::vector<char> sbuf(msg_size, 's');
+    std::vector<char> rbuf(msg_size, 'r');
+    size_t            length;
+
+    /* the protocol extension is allocated by the first stream data */
+    EXPECT_TRUE(ucp_ep_ext_proto(sender().ep()) == NULL);
+    EXPECT_TRUE(ucp_ep_ext_proto(receiver().ep()) == NULL);
+
+    ucp::data_type_desc_t dt_desc(DATATYPE, &sbuf[0], msg_size);
+    wait(stream_send_nb(dt_desc));
+
+    void *rreq = ucp_stream_recv_nb(receiver().ep(), &rbuf[0], msg_size,
+                                    DATATYPE, ucp_recv_cb, &length,
+                                    UCP_STREAM_RECV_FLAG_WAITALL);
+    ASSERT_FALSE(UCS_PTR_IS_ERR(rreq));
+    if (UCS_PTR_IS_PTR(rreq)) {
+        length = wait_stream_recv(rreq);
+    }
+    EXPECT_EQ(msg_size, length);
+    EXPECT_EQ(sbuf, rbuf);
+
+    EXPECT_TRUE(ucp_ep_ext_proto(receiver().ep()) != NULL);
+    if (!is_loopback()) {
+        /* the sender did not receive, and has no error handler */
+        EXPECT_TRUE(ucp_ep_ext_proto(sender().ep()) == NULL);
+    }
+}
+
+UCS_TEST_P(test_ucp_stream, poll_events) {
+    const size_t         msg_size = 1000;
+    std::vector<char>    sbuf(msg_size, 's');
+    std::vector<char>    rbuf(msg_size, 'r');
+    ucp_stream_poll_ep_t poll_ep;
+    size_t               length;
+
+    ucp::data_type_desc_t dt_desc(DATATYPE, &sbuf[0], msg_size);
+    wait(stream_send_nb(dt_desc));
+
+    /* every new data arrival reports the ep again, with all ready data */
+    ASSERT_TRUE(poll_ep_event(receiver().worker(), receiver().ep(),
+                              UCP_STREAM_POLL_FLAG_IN, &poll_ep));
+    while (poll_ep.length < msg_size) {
+        ASSERT_TRUE(poll_ep_event(receiver().worker(), receiver().ep(),
+                                  UCP_STREAM_POLL_FLAG_IN, &poll_ep));
+    }
+    EXPECT_EQ(msg_size, poll_ep.length);
+
+    /* data is not reported when the ep is not polled for it */
+    ASSERT_UCS_OK(ucp_stream_ep_set_poll_events(receiver().ep(), 0));
+    wait(stream_send_nb(dt_desc));
+    for (int i = 0; i < 100; ++i) {
+        progress();
+    }
+    EXPECT_EQ(0l, ucp_stream_worker_poll(receiver().worker(), &poll_ep, 1, 0));
+
+    ASSERT_UCS_OK(ucp_stream_ep_set_poll_events(receiver().ep(),
+                                                UCP_STREAM_POLL_FLAG_IN));
+    EXPECT_TRUE(poll_ep_event(receiver().worker(), receiver().ep(),
+                              UCP_STREAM_POLL_FLAG_IN, &poll_ep));
+
+    for (int i = 0; i < 2; ++i) {
+        void *rreq = ucp_stream_recv_nb(receiver().ep(), &rbuf[0], msg_size,
+                                        DATATYPE, ucp_recv_cb, &length,
+                                        UCP_STREAM_RECV_FLAG_WAITALL);
+        ASSERT_FALSE(UCS_PTR_IS_ERR(rreq));
+        if (UCS_PTR_IS_PTR(rreq)) {
+            length = wait_stream_recv(rreq);
+        }
+        EXPECT_EQ(msg_size, length);
+        EXPECT_EQ(sbuf, rbuf);
+    }
+}
+
+UCS_TEST_P(test_ucp_stream, poll_events_out, "STREAM_WINDOW=64k") {
+    const size_t         msg_size = 4 * UCS_KBYTE;
+    const size_t         n_msgs   = 64;
+    std::vector<char>    sbuf(msg_size * n_msgs, 's');
+    std::vector<char>    rbuf(sbuf.size(), 'r');
+    std::vector<void*>   sreqs;
+    ucp_stream_poll_ep_t poll_ep;
+    size_t               length;
+
+    ASSERT_UCS_OK(ucp_stream_ep_set_poll_events(sender().ep(),
+                                                UCP_STREAM_POLL_FLAG_IN |
+                                                UCP_STREAM_POLL_FLAG_OUT));
+
+    for (size_t i = 0; i < n_msgs; ++i) {
+        ucp::data_type_desc_t dt_desc(DATATYPE, &sbuf[i * msg_size], msg_size);
+        void *sreq = stream_send_nb(dt_desc);
+        ASSERT_FALSE(UCS_PTR_IS_ERR(sreq));
+        sreqs.push_back(sreq);
+    }
+
+    void *rreq = ucp_stream_recv_nb(receiver().ep(), &rbuf[0], rbuf.size(),
+                                    DATATYPE, ucp_recv_cb, &length,
+                                    UCP_STREAM_RECV_FLAG_WAITALL);
+    ASSERT_FALSE(UCS_PTR_IS_ERR(rreq));
+
+    /* the sends which waited for the window are started after the receiver
+     * consumed the data */
+    EXPECT_TRUE(poll_ep_event(sender().worker(), sender().ep(),
+                              UCP_STREAM_POLL_FLAG_OUT, &poll_ep));
+
+    if (UCS_PTR_IS_PTR(rreq)) {
+        length = wait_stream_recv(rreq);
+    }
+    EXPECT_EQ(rbuf.size(), length);
+
+    for (size_t i = 0; i < sreqs.size(); ++i) {
+        wait(sreqs[i]);
+    }
+
+    EXPECT_EQ(sbuf, rbuf);
+}
+
 UCS_TEST_P(test_ucp_stream, send_zero_ending_iov_recv_data) {
     const size_t min_size         = UCS_KBYTE;
     const size_t max_size         = min_size * 64;
@@ -9,6 +9,12 @@
 
 #include <common/test_helpers.h>
 
+extern "C" {
+#include <ucp/core/ucp_context.h>
+#include <ucp/core/ucp_ep.inl>
+#include <ucp/core/ucp_request.h>
+}
+
 using namespace ucs; /* For vector<char> serialization */
 
 
@@ -413,6 +419,106 @@ UCS_TEST_P(test_ucp_tag_match, send_nb_multiple_recv_unexp) {
     }
 }
 
+UCS_TEST_P(test_ucp_tag_match, send_nb_multiple_recv_unexp_aggregate,
+           "TAG_AGGREGATE_THRESH=1k", "TCP_SNDBUF?=4k", "TCP_RCVBUF?=4k") {
+    const unsigned num_requests = 1000 / ucs::test_time_multiplier();
+    std::vector<request*> send_reqs(num_requests);
+    std::vector<std::vector<char> > send_data(num_requests);
+    unsigned num_bundled = 0;
+    ucp_tag_recv_info_t info;
+    ucs_status_t status;
+    ucp_request_t *leader;
+
+    skip_loopback();
+
+    /* the receiver is not progressed, so the sends which do not fit the send
+     * resources are aggregated; every 100th message is too large for that,
+     * and closes the current bundle */
+    for (unsigned i = 0; i < num_requests; ++i) {
+        send_data[i].resize(((i % 100) == 99) ? 4000 : (1 + (i % 200)));
+        ucs::fill_random(send_data[i]);
+        send_reqs[i] = send_nb(&send_data[i][0], send_data[i].size(), DATATYPE,
+                               0x1337 + i);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(send_reqs[i]));
+
+        /* a send which does not lead the open bundle was added to it */
+        leader = (ucp_ep_ext_proto(sender().ep()) != NULL) ?
+                 ucp_ep_ext_proto(sender().ep())->tag.bundle_req : NULL;
+        if ((send_reqs[i] != NULL) && (leader != NULL) &&
+            ((void*)(leader + 1) != send_reqs[i])) {
+            ++num_bundled;
+        }
+    }
+
+    UCS_TEST_MESSAGE << num_bundled << " of " << num_requests
+                     << " sends were aggregated";
+    EXPECT_GT(num_bundled, 0u);
+
+    /* the messages must arrive in order */
+    for (unsigned i = 0; i < num_requests; ++i) {
+        std::vector<char> recv_data(send_data[i].size(), 0);
+
+        status = recv_b(&recv_data[0], recv_data.size(), DATATYPE, 0, 0,
+                        &info);
+        ASSERT_UCS_OK(status);
+        EXPECT_EQ(send_data[i].size(), info.length);
+        EXPECT_EQ((ucp_tag_t)(0x1337 + i), info.sender_tag);
+        EXPECT_EQ(send_data[i], recv_data);
+    }
+
+    for (unsigned i = 0; i < num_requests; ++i) {
+        if (send_reqs[i] != NULL) {
+            wait(send_reqs[i]);
+            EXPECT_EQ(UCS_OK, send_reqs[i]->status);
+            request_release(send_reqs[i]);
+        }
+    }
+}
+
+UCS_TEST_P(test_ucp_tag_match, recv_malformed_bundle) {
+    /* same layout as ucp_eager_bundle_hdr_t */
+    typedef struct {
+        ucp_tag_t tag;
+        uint32_t  length;
+    } UCS_S_PACKED bundle_hdr_t;
+
+    const uint64_t send_value = 0xdeadbeef;
+    uint64_t bundle[5]        = {0};
+    uint64_t recv_value       = 0;
+    bundle_hdr_t *hdr;
+    ucp_tag_recv_info_t info;
+    ucp_tag_message_h message;
+    ucs_status_t status;
+
+    /* a valid message, followed by one which claims more data than the
+     * bundle has */
+    hdr         = (bundle_hdr_t*)bundle;
+    hdr->tag    = 0x1337;
+    hdr->length = sizeof(send_value);
+    memcpy(hdr + 1, &send_value, sizeof(send_value));
+    hdr         = (bundle_hdr_t*)&bundle[3];
+    hdr->tag    = 0x1338;
+    hdr->length = 1000;
+
+    {
+        scoped_log_handler slh(hide_warns_logger);
+        status = ucp_am_handlers[UCP_AM_ID_EAGER_BUNDLE].cb(receiver().worker(),
+                                                            bundle,
+                                                            sizeof(bundle), 0);
+    }
+    ASSERT_UCS_OK(status);
+
+    status = recv_b(&recv_value, sizeof(recv_value), DATATYPE, 0x1337,
+                    (ucp_tag_t)-1, &info);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(send_value, recv_value);
+
+    /* the malformed message was dropped */
+    message = ucp_tag_probe_nb(receiver().worker(), 0x1338, (ucp_tag_t)-1, 0,
+                               &info);
+    EXPECT_TRUE(message == NULL);
+}
+
 UCS_TEST_P(test_ucp_tag_match, sync_send_unexp) {
     ucp_tag_recv_info_t info;
     ucs_status_t        status;
@@ -607,6 +713,43 @@ UCS_TEST_P(test_ucp_tag_match, rndv_req_exp_auto_thresh, "RNDV_THRESH=auto") {
     request_release(my_recv_req);
 }
 
+UCS_TEST_P(test_ucp_tag_match, rndv_req_exp_same_buffer, "RNDV_THRESH=1048576",
+           "RNDV_RKEY_CACHE_SIZE=8") {
+    static const size_t size  = 1148576;
+    static const int    count = 8;
+    std::vector<char> sendbuf(size, 0);
+
+    skip_loopback();
+
+    /* repeated sends from the same buffer may reuse the cached remote key,
+     * and every other iteration the buffer is reallocated to make sure the
+     * receiver does not use a key which was received for previous memory */
+    for (int i = 0; i < count; ++i) {
+        request *my_send_req, *my_recv_req;
+        std::vector<char> recvbuf(size, 0);
+
+        if (i % 2) {
+            std::vector<char>(size, 0).swap(sendbuf);
+        }
+        ucs::fill_random(sendbuf);
+
+        my_recv_req = recv_nb(&recvbuf[0], recvbuf.size(), DATATYPE, 0x1337,
+                              0xffff);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(my_recv_req));
+
+        my_send_req = send_nb(&sendbuf[0], sendbuf.size(), DATATYPE, 0x111337);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(my_send_req));
+
+        wait(my_recv_req);
+
+        EXPECT_EQ(sendbuf.size(), my_recv_req->info.length);
+        EXPECT_EQ(sendbuf, recvbuf);
+
+        wait_and_validate(my_send_req);
+        request_release(my_recv_req);
+    }
+}
+
 UCS_TEST_P(test_ucp_tag_match, rndv_exp_huge_mix) {
     const size_t sizes[] = { 1000, 2000, 2500ul * UCS_MBYTE };
 
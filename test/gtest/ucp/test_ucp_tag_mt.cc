@@ -9,6 +9,10 @@
 
 #include <common/test_helpers.h>
 
+extern "C" {
+#include <ucp/core/ucp_worker.h>
+}
+
 #if _OPENMP
 #include "omp.h"
 #endif
@@ -88,4 +92,67 @@ UCS_TEST_P(test_ucp_tag_mt, send_recv) {
 #endif
 }
 
+#if ENABLE_MT
+typedef struct {
+    ucp_worker_h worker;
+    volatile int locked;
+    volatile int done;
+} test_ucp_tag_mt_hold_t;
+
+/* Hold the worker until the test is done with it, or for 10 seconds */
+static void *test_ucp_tag_mt_hold_worker(void *arg)
+{
+    test_ucp_tag_mt_hold_t *hold = (test_ucp_tag_mt_hold_t*)arg;
+    ucs_time_t deadline          = ucs_get_time() + ucs_time_from_sec(10.0);
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(hold->worker);
+    hold->locked = 1;
+    while (!hold->done && (ucs_get_time() < deadline)) {
+        sched_yield();
+    }
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(hold->worker);
+    return NULL;
+}
+
+UCS_TEST_P(test_ucp_tag_mt, try_progress, "MT_TRY_PROGRESS=y") {
+    uint64_t               send_data = 0xdeadbeefdeadbeef;
+    uint64_t               recv_data = 0;
+    test_ucp_tag_mt_hold_t hold;
+    ucp_tag_recv_info_t    info;
+    pthread_t              thread;
+    ucs_time_t             start_time;
+    unsigned               count;
+
+    if (GetParam().thread_type != MULTI_THREAD_WORKER) {
+        UCS_TEST_SKIP_R("the worker is not multi-threaded");
+    }
+
+    hold.worker = receiver().worker();
+    hold.locked = 0;
+    hold.done   = 0;
+    ASSERT_TRUE(hold.worker->flags & UCP_WORKER_FLAG_MT_TRY_PROGRESS);
+
+    ASSERT_EQ(0, pthread_create(&thread, NULL, test_ucp_tag_mt_hold_worker,
+                                &hold));
+    while (!hold.locked) {
+        sched_yield();
+    }
+
+    /* progress returns right away while another thread holds the worker */
+    start_time = ucs_get_time();
+    count      = ucp_worker_progress(hold.worker);
+    EXPECT_LT(ucs_time_to_sec(ucs_get_time() - start_time), 5.0);
+    EXPECT_EQ(0u, count);
+
+    hold.done = 1;
+    pthread_join(thread, NULL);
+
+    /* and progresses the worker as usual when it is free */
+    send_b(&send_data, sizeof(send_data), DATATYPE, 0x111337);
+    ASSERT_UCS_OK(recv_b(&recv_data, sizeof(recv_data), DATATYPE, 0x111337,
+                         0xffffff, &info));
+    EXPECT_EQ(send_data, recv_data);
+}
+#endif
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_mt)
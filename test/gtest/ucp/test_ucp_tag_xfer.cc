@@ -11,10 +11,12 @@
 
 extern "C" {
 #include <ucp/core/ucp_ep.inl>
+#include <ucp/wireup/wireup_ep.h>
 #include <ucs/datastruct/queue.h>
 }
 
 #include <iostream>
+#include <map>
 
 
 class test_ucp_tag_xfer : public test_ucp_tag {
@@ -99,6 +101,7 @@ public:
     void test_xfer_contig(size_t size, bool expected, bool sync, bool truncated);
     void test_xfer_generic(size_t size, bool expected, bool sync, bool truncated);
     void test_xfer_iov(size_t size, bool expected, bool sync, bool truncated);
+    void test_xfer_strided(size_t size, bool expected, bool sync, bool truncated);
     void test_xfer_generic_err(size_t size, bool expected, bool sync, bool truncated);
 
 protected:
@@ -121,6 +124,10 @@ protected:
 
     void test_xfer_len_offset();
 
+    void test_xfer_iov_sparse();
+
+    void test_xfer_concurrent(bool expected);
+
 private:
     request* do_send(const void *sendbuf, size_t count, ucp_datatype_t dt, bool sync);
 
@@ -199,8 +206,11 @@ void test_ucp_tag_xfer::test_xfer_prepare_bufs(uint8_t *sendbuf, uint8_t *recvbu
         }
         *send_dt = DATATYPE;
     } else {
-        /* the sender has a generic datatype */
-        status = ucp_dt_create_generic(&ucp::test_dt_uint8_ops, NULL, send_dt);
+        /* the sender has a generic datatype, which may be packed by helper
+         * threads */
+        status = ucp_dt_create_generic_ext(&ucp::test_dt_uint8_ops, NULL,
+                                           UCP_DT_GENERIC_FLAG_THREAD_SAFE,
+                                           send_dt);
         ASSERT_UCS_OK(status);
     }
 
@@ -401,6 +411,61 @@ void test_ucp_tag_xfer::test_xfer_iov(size_t size, bool expected, bool sync,
                                "IOV"));
 }
 
+void test_ucp_tag_xfer::test_xfer_strided(size_t size, bool expected,
+                                          bool sync, bool truncated)
+{
+    /* cover every specialized block size and a generic one */
+    static const size_t blocklens[] = {4, 8, 16, 32, 64, 24};
+    const size_t blocklen = blocklens[size % ucs_static_array_size(blocklens)];
+    ucp_dt_strided_dim_t dims[2];
+    ucp_datatype_t dt;
+    ucs_status_t status;
+
+    /* 3 blocks with gaps between them, repeated twice with a larger gap */
+    dims[0].count  = 3;
+    dims[0].stride = blocklen + 8;
+    dims[1].count  = 2;
+    dims[1].stride = dims[0].count * dims[0].stride + 16;
+    status = ucp_dt_create_strided(blocklen, dims, 2, &dt);
+    ASSERT_UCS_OK(status);
+
+    size_t elem_size = blocklen * dims[0].count * dims[1].count;
+    size_t extent    = dims[1].count * dims[1].stride;
+    size_t count     = size / elem_size;
+
+    /* if count is zero, truncation has no effect */
+    if (truncated && !count) {
+        truncated = false;
+    }
+
+    std::vector<char> sendbuf(count * extent, 0);
+    std::vector<char> recvbuf(count * extent, 0);
+    std::vector<char> expbuf(count * extent, 0);
+
+    ucs::fill_random(sendbuf);
+
+    size_t recvd = do_xfer(sendbuf.data(), recvbuf.data(), count, dt, dt,
+                           expected, sync, truncated);
+    if (!truncated) {
+        EXPECT_EQ(count * elem_size, recvd);
+
+        /* only the blocks are transferred, the gaps must stay untouched */
+        for (size_t elem = 0; elem < count; ++elem) {
+            for (size_t i1 = 0; i1 < dims[1].count; ++i1) {
+                for (size_t i0 = 0; i0 < dims[0].count; ++i0) {
+                    size_t offset = (elem * extent) + (i1 * dims[1].stride) +
+                                    (i0 * dims[0].stride);
+                    memcpy(&expbuf[offset], &sendbuf[offset], blocklen);
+                }
+            }
+        }
+        EXPECT_TRUE(expbuf == recvbuf) << "blocklen=" << blocklen
+                                       << " count=" << count;
+    }
+
+    ucp_dt_destroy(dt);
+}
+
 void test_ucp_tag_xfer::test_xfer_generic_err(size_t size, bool expected,
                                               bool sync, bool truncated)
 {
@@ -502,6 +567,63 @@ size_t test_ucp_tag_xfer::do_xfer(const void *sendbuf, void *recvbuf,
     return recvd;
 }
 
+void test_ucp_tag_xfer::test_xfer_iov_sparse()
+{
+    /* send items which are adjacent, overlap or have gaps between them, so
+     * some of them are registered and sent together */
+    const size_t iovcnt   = 64;
+    const size_t max_item = 1000;
+    const int    count    = 20 / ucs::test_time_multiplier() + 1;
+
+    std::vector<char> sendbuf(iovcnt * (max_item + 16), 0);
+    std::vector<ucp_dt_iov_t> iov(iovcnt);
+
+    ucs::fill_random(sendbuf);
+
+    for (int i = 0; i < count; ++i) {
+        std::vector<char> expbuf;
+        size_t offset = 0;
+
+        for (size_t iov_it = 0; iov_it < iovcnt; ++iov_it) {
+            size_t length = (iov_it % 7) ? (ucs::rand() % max_item + 1) : 0;
+
+            iov[iov_it].buffer = &sendbuf[offset];
+            iov[iov_it].length = length;
+            expbuf.insert(expbuf.end(), sendbuf.begin() + offset,
+                          sendbuf.begin() + offset + length);
+
+            switch (ucs::rand() % 3) {
+            case 0:
+                offset += length;
+                break;
+            case 1:
+                offset += length + 16;
+                break;
+            default:
+                offset += length / 2;
+                break;
+            }
+        }
+
+        std::vector<char> recvbuf(expbuf.size(), 0);
+        request *rreq = recv_nb(&recvbuf[0], recvbuf.size(), DATATYPE,
+                                RECV_TAG, RECV_MASK);
+        request *sreq = do_send(&iov[0], iovcnt, DATATYPE_IOV, false);
+
+        wait(rreq);
+        if (sreq != NULL) {
+            wait(sreq);
+            request_release(sreq);
+        }
+
+        EXPECT_UCS_OK(rreq->status);
+        EXPECT_EQ(expbuf.size(), rreq->info.length);
+        request_release(rreq);
+        EXPECT_TRUE(!check_buffers(expbuf, recvbuf, expbuf.size(), iovcnt, 1,
+                                   expbuf.size(), true, false, "IOV"));
+    }
+}
+
 void test_ucp_tag_xfer::test_xfer_len_offset()
 {
     const size_t max_offset  = 128;
@@ -553,6 +675,55 @@ void test_ucp_tag_xfer::test_xfer_len_offset()
     free(send_buf);
 }
 
+void test_ucp_tag_xfer::test_xfer_concurrent(bool expected)
+{
+    const size_t count = 16;
+    std::vector<std::vector<char> > sendbufs(count), recvbufs(count);
+    std::vector<request*> sreqs(count), rreqs(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t size = ((i % 4) * 100 + 1) * UCS_KBYTE + i;
+        sendbufs[i].resize(size);
+        recvbufs[i].resize(size, 0);
+        ucs::fill_random(sendbufs[i]);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (expected) {
+            rreqs[i] = recv_nb(&recvbufs[i][0], recvbufs[i].size(), DATATYPE,
+                               RECV_TAG, RECV_MASK);
+        } else {
+            sreqs[i] = do_send(&sendbufs[i][0], sendbufs[i].size(), DATATYPE,
+                               false);
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (expected) {
+            sreqs[i] = do_send(&sendbufs[i][0], sendbufs[i].size(), DATATYPE,
+                               false);
+        } else {
+            rreqs[i] = recv_nb(&recvbufs[i][0], recvbufs[i].size(), DATATYPE,
+                               RECV_TAG, RECV_MASK);
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        wait(rreqs[i]);
+        EXPECT_UCS_OK(rreqs[i]->status);
+        EXPECT_EQ(sendbufs[i].size(), rreqs[i]->info.length);
+        EXPECT_EQ(sendbufs[i], recvbufs[i]);
+        request_release(rreqs[i]);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (sreqs[i] != NULL) {
+            wait(sreqs[i]);
+            request_release(sreqs[i]);
+        }
+    }
+}
+
 UCS_TEST_P(test_ucp_tag_xfer, contig_exp) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_contig, true, false, false);
 }
@@ -566,6 +737,81 @@ UCS_TEST_P(test_ucp_tag_xfer, contig_unexp) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_contig, false, false, false);
 }
 
+UCS_TEST_P(test_ucp_tag_xfer, contig_exp_thresh_tune, "THRESH_TUNE=y") {
+    /* send messages around the tuned thresholds, until one of them is moved
+     * toward the faster protocol */
+    const int max_count = 10000 / ucs::test_time_multiplier();
+
+    /* error handling endpoints are not tuned */
+    skip_err_handling();
+
+    ucp_ep_config_t *config = ucp_ep_config(sender().ep());
+    std::vector<int> tuned;
+    size_t max_size = 0;
+    for (int index = 0; index < UCP_EP_TUNE_LAST; ++index) {
+        if (config->tune[index].max != 0) {
+            tuned.push_back(index);
+            max_size = std::max(max_size, config->tune[index].max * 2);
+        }
+    }
+    if (tuned.empty()) {
+        UCS_TEST_SKIP_R("no tuned thresholds");
+    }
+
+    /* the protocols may perform the same on this host, so make the lower
+     * protocol look much faster above the thresholds, and the next sample
+     * taken there has to move them up */
+    for (size_t j = 0; j < tuned.size(); ++j) {
+        ucp_ep_thresh_tune_t *tune = &config->tune[tuned[j]];
+        tune->stat[1][0].count     = 1000;
+        tune->stat[1][0].time      = 0;
+        tune->stat[1][1].count     = 1000;
+        tune->stat[1][1].time      = 1e12;
+    }
+
+    size_t init_zcopy_thresh = config->tag.eager.zcopy_thresh[0];
+    size_t init_rndv_thresh  = ucs_min(config->tag.rndv.rma_thresh,
+                                       config->tag.rndv.am_thresh);
+    std::vector<char> sendbuf(max_size, 0);
+    std::vector<char> recvbuf(max_size, 0);
+    unsigned num_updates;
+    int i;
+
+    ucs::fill_random(sendbuf);
+
+    num_updates = 0;
+    for (i = 0; (i < max_count) && (num_updates == 0); ++i) {
+        size_t thresh = (tuned[i % tuned.size()] == UCP_EP_TUNE_ZCOPY) ?
+                        config->tag.eager.zcopy_thresh[0] :
+                        ucs_min(config->tag.rndv.rma_thresh,
+                                config->tag.rndv.am_thresh);
+        size_t size   = (thresh / 2) + (ucs::rand() % (thresh + thresh / 2));
+        size_t recvd  = do_xfer(&sendbuf[0], &recvbuf[0], size, DATATYPE,
+                                DATATYPE, true, (i % 2), false);
+        ASSERT_EQ(size, recvd);
+        ASSERT_TRUE(!check_buffers(sendbuf, recvbuf, recvd, 1, 1, size,
+                                   true, (i % 2), "contig"));
+
+        num_updates = config->tune[UCP_EP_TUNE_ZCOPY].num_updates +
+                      config->tune[UCP_EP_TUNE_RNDV].num_updates;
+    }
+
+    UCS_TEST_MESSAGE << "zcopy threshold " << init_zcopy_thresh << " -> "
+                     << config->tag.eager.zcopy_thresh[0] << ", rndv threshold "
+                     << init_rndv_thresh << " -> "
+                     << ucs_min(config->tag.rndv.rma_thresh,
+                                config->tag.rndv.am_thresh)
+                     << " after " << i << " sends";
+    EXPECT_GT(num_updates, 0u);
+    if (config->tune[UCP_EP_TUNE_ZCOPY].num_updates > 0) {
+        EXPECT_GT(config->tag.eager.zcopy_thresh[0], init_zcopy_thresh);
+    }
+    if (config->tune[UCP_EP_TUNE_RNDV].num_updates > 0) {
+        EXPECT_GT(ucs_min(config->tag.rndv.rma_thresh,
+                          config->tag.rndv.am_thresh), init_rndv_thresh);
+    }
+}
+
 UCS_TEST_P(test_ucp_tag_xfer, generic_exp) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_generic, true, false, false);
 }
@@ -590,6 +836,22 @@ UCS_TEST_P(test_ucp_tag_xfer, iov_unexp) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_iov, false, false, false);
 }
 
+UCS_TEST_P(test_ucp_tag_xfer, iov_sparse_zcopy, "ZCOPY_THRESH=1") {
+    test_xfer_iov_sparse();
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp_truncated) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, true, false, true);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_unexp) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, false, false, false);
+}
+
 UCS_TEST_P(test_ucp_tag_xfer, generic_err_exp) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_generic_err, true, false, false);
 }
@@ -648,6 +910,17 @@ UCS_TEST_P(test_ucp_tag_xfer, iov_unexp_sync) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_iov, false, true, false);
 }
 
+UCS_TEST_P(test_ucp_tag_xfer, strided_exp_sync) {
+    /* because ucp_tag_send_req return status (instead request) if send operation
+     * completed immediately */
+    skip_loopback();
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, true, true, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, strided_unexp_sync) {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_strided, false, true, false);
+}
+
 /* send_contig_recv_contig */
 
 UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_contig_exp, "RNDV_THRESH=1248576") {
@@ -758,6 +1031,207 @@ UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_contig_exp_rndv_probe, "RNDV_THRE
     test_xfer_probe(true, true, true, false);
 }
 
+/* Counts the bcopy active messages which are sent on each transport endpoint
+ * of a worker, by replacing the am_bcopy operation of its interfaces */
+class am_bcopy_counter {
+public:
+    ~am_bcopy_counter() {
+        for (funcs_map_t::iterator it = m_funcs.begin(); it != m_funcs.end();
+             ++it) {
+            it->first->ops.ep_am_bcopy = it->second;
+        }
+        m_funcs.clear();
+        m_counts.clear();
+    }
+
+    void add(ucp_worker_h worker) {
+        uct_iface_h iface;
+
+        for (unsigned i = 0; i < worker->num_ifaces; ++i) {
+            iface = worker->ifaces[i]->iface;
+            if ((iface != NULL) && (m_funcs.find(iface) == m_funcs.end())) {
+                m_funcs[iface]         = iface->ops.ep_am_bcopy;
+                iface->ops.ep_am_bcopy = am_bcopy;
+            }
+        }
+    }
+
+    unsigned count(uct_ep_h uct_ep) const {
+        std::map<uct_ep_h, unsigned>::const_iterator it = m_counts.find(uct_ep);
+        return (it == m_counts.end()) ? 0 : it->second;
+    }
+
+private:
+    typedef ssize_t (*am_bcopy_func_t)(uct_ep_h, uint8_t, uct_pack_callback_t,
+                                       void*, unsigned);
+    typedef std::map<uct_iface_h, am_bcopy_func_t> funcs_map_t;
+
+    static ssize_t am_bcopy(uct_ep_h uct_ep, uint8_t id,
+                            uct_pack_callback_t pack_cb, void *arg,
+                            unsigned flags) {
+        ssize_t packed_len = m_funcs[uct_ep->iface](uct_ep, id, pack_cb, arg,
+                                                    flags);
+        if (packed_len >= 0) {
+            ++m_counts[uct_ep];
+        }
+        return packed_len;
+    }
+
+    static funcs_map_t                  m_funcs;
+    static std::map<uct_ep_h, unsigned> m_counts;
+};
+
+am_bcopy_counter::funcs_map_t          am_bcopy_counter::m_funcs;
+std::map<uct_ep_h, unsigned>           am_bcopy_counter::m_counts;
+
+/* many multi-fragment eager messages in flight, so the middle fragments are
+ * spread over the eager lanes and may arrive out of order */
+UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_contig_eager_multi_lane,
+           "RNDV_THRESH=inf", "ZCOPY_THRESH=inf", "MAX_EAGER_LANES=2") {
+    const unsigned count = 16;
+    const size_t size    = 256 * UCS_KBYTE / ucs::test_time_multiplier();
+    std::vector<std::vector<char> > sendbufs(count), recvbufs(count);
+    std::vector<request*> sreqs(count), rreqs(count);
+    am_bcopy_counter counter;
+    unsigned num_used_lanes;
+    ucp_lane_index_t lane;
+    uct_ep_h uct_ep;
+
+    skip_loopback();
+
+    if (ucp_ep_config(sender().ep())->key.am_bw_lanes[1] == UCP_NULL_LANE) {
+        UCS_TEST_SKIP_R("less than 2 bandwidth lanes");
+    }
+
+    counter.add(sender().worker());
+
+    /* the first half is expected, the second half is unexpected */
+    for (unsigned i = 0; i < count; ++i) {
+        sendbufs[i].resize(size);
+        recvbufs[i].resize(size, 0);
+        ucs::fill_random(sendbufs[i]);
+        if (i < (count / 2)) {
+            rreqs[i] = recv_nb(&recvbufs[i][0], size, DATATYPE, i, 0xffff);
+            ASSERT_TRUE(!UCS_PTR_IS_ERR(rreqs[i]));
+        }
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+        sreqs[i] = send_nb(&sendbufs[i][0], size, DATATYPE, i);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(sreqs[i]));
+    }
+
+    for (unsigned i = count / 2; i < count; ++i) {
+        rreqs[i] = recv_nb(&recvbufs[i][0], size, DATATYPE, i, 0xffff);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(rreqs[i]));
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+        wait(rreqs[i]);
+        EXPECT_EQ(UCS_OK, rreqs[i]->status);
+        EXPECT_EQ(size, rreqs[i]->info.length);
+        EXPECT_EQ(sendbufs[i], recvbufs[i]);
+        request_release(rreqs[i]);
+        wait_and_validate(sreqs[i]);
+    }
+
+    /* wireup is complete now, so the lanes hold their final endpoints */
+    num_used_lanes = 0;
+    for (int i = 0; i < UCP_MAX_LANES; ++i) {
+        lane = ucp_ep_config(sender().ep())->key.am_bw_lanes[i];
+        if (lane == UCP_NULL_LANE) {
+            break;
+        }
+
+        uct_ep = sender().ep()->uct_eps[lane];
+        if (ucp_wireup_ep_test(uct_ep)) {
+            uct_ep = ucs_derived_of(uct_ep, ucp_wireup_ep_t)->super.uct_ep;
+        }
+
+        UCS_TEST_MESSAGE << "bandwidth lane " << i << ": "
+                         << counter.count(uct_ep) << " bcopy messages";
+        if (counter.count(uct_ep) > 0) {
+            ++num_used_lanes;
+        }
+    }
+    EXPECT_GT(num_used_lanes, 1u);
+}
+
+/* rendezvous messages whose length does not split evenly between the
+ * rendezvous rails, so every lane gets a fragment with a tail */
+UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_contig_rndv_multi_rail,
+           "RNDV_THRESH=1000", "MAX_RNDV_RAILS=2") {
+    static const size_t sizes[] = { 1001, 65539, 1048583, 4194301 };
+
+    skip_loopback();
+
+    for (unsigned i = 0; i < ucs_array_size(sizes); ++i) {
+        std::vector<char> sendbuf(sizes[i]), recvbuf(sizes[i], 0);
+        request *sreq, *rreq;
+
+        ucs::fill_random(sendbuf);
+        rreq = recv_nb(&recvbuf[0], recvbuf.size(), DATATYPE, i, 0xffff);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(rreq));
+
+        sreq = send_nb(&sendbuf[0], sendbuf.size(), DATATYPE, i);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(sreq));
+
+        wait(rreq);
+        EXPECT_EQ(UCS_OK, rreq->status);
+        EXPECT_EQ(sendbuf.size(), rreq->info.length);
+        EXPECT_EQ(sendbuf, recvbuf);
+        request_release(rreq);
+        wait_and_validate(sreq);
+    }
+}
+
+#if ENABLE_MT
+
+/* rndv and sync send progressed by the worker progress thread */
+
+UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_contig_exp_rndv_progress_thread,
+           "RNDV_THRESH=1000", "PROGRESS_THREAD=y") {
+    test_run_xfer(true, true, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_contig_unexp_sync_progress_thread,
+           "RNDV_THRESH=1248576", "PROGRESS_THREAD=y") {
+    test_run_xfer(true, true, false, true, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, rndv_overlap_progress_thread, "RNDV_THRESH=1000",
+           "PROGRESS_THREAD=y") {
+    const size_t size = UCS_MBYTE;
+    std::vector<char> sendbuf(size, 0);
+    std::vector<char> recvbuf(size, 0);
+
+    ucs::fill_random(sendbuf);
+
+    request *rreq = recv_req_nb(&recvbuf[0], size, DATATYPE, 0x111337,
+                                0xffffff);
+    request *sreq = send_nbr(&sendbuf[0], size, DATATYPE, 0x111337);
+
+    /* none of the workers is progressed by the test, so only the progress
+     * thread can complete the transfer */
+    ucs_time_t deadline = ucs::get_deadline();
+    while (((ucp_request_check_status(rreq) == UCS_INPROGRESS) ||
+            ((sreq != UCS_STATUS_PTR(UCS_OK)) &&
+             (ucp_request_check_status(sreq) == UCS_INPROGRESS))) &&
+           (ucs_get_time() < deadline)) {
+        sched_yield();
+    }
+
+    ASSERT_UCS_OK(ucp_request_check_status(rreq));
+    request_release(rreq);
+    if (sreq != UCS_STATUS_PTR(UCS_OK)) {
+        ASSERT_UCS_OK(ucp_request_check_status(sreq));
+        request_release(sreq);
+    }
+    EXPECT_EQ(sendbuf, recvbuf);
+}
+
+#endif
+
 /* rndv send_generic_recv_generic am_rndv with bcopy on the sender side */
 
 UCS_TEST_P(test_ucp_tag_xfer, send_generic_recv_generic_exp_rndv, "RNDV_THRESH=1000") {
@@ -768,6 +1242,30 @@ UCS_TEST_P(test_ucp_tag_xfer, send_generic_recv_generic_exp_rndv_truncated, "RND
     test_run_xfer(false, false, true, false, true);
 }
 
+UCS_TEST_P(test_ucp_tag_xfer, send_generic_recv_generic_exp_pack_threads,
+           "RNDV_THRESH=1248576", "GENERIC_DT_PACK_THREADS=2",
+           "GENERIC_DT_PACK_THRESH=1") {
+    test_run_xfer(false, false, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, send_generic_recv_contig_unexp_pack_threads,
+           "RNDV_THRESH=1248576", "GENERIC_DT_PACK_THREADS=2",
+           "GENERIC_DT_PACK_THRESH=1") {
+    test_run_xfer(false, true, false, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, send_generic_recv_generic_exp_rndv_pack_threads,
+           "RNDV_THRESH=1000", "GENERIC_DT_PACK_THREADS=3",
+           "GENERIC_DT_PACK_THRESH=1") {
+    test_run_xfer(false, false, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, send_generic_recv_generic_exp_rndv_truncated_pack_threads,
+           "RNDV_THRESH=1000", "GENERIC_DT_PACK_THREADS=1",
+           "GENERIC_DT_PACK_THRESH=1") {
+    test_run_xfer(false, false, true, false, true);
+}
+
 UCS_TEST_P(test_ucp_tag_xfer, send_generic_recv_generic_exp_sync_rndv, "RNDV_THRESH=1000") {
     /* because ucp_tag_send_req return status (instead request) if send operation
      * completed immediately */
@@ -956,6 +1454,40 @@ UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_generic_exp_rndv_probe_zcopy, "RN
     test_xfer_probe(true, false, true, false);
 }
 
+/* am_rndv with a limited receiver window */
+
+UCS_TEST_P(test_ucp_tag_xfer, send_generic_recv_contig_exp_rndv_am_window,
+           "RNDV_THRESH=1000", "RNDV_AM_WINDOW=64k") {
+    test_run_xfer(false, true, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_generic_unexp_rndv_am_window,
+           "RNDV_THRESH=1000", "ZCOPY_THRESH=1248576", "RNDV_AM_WINDOW=64k") {
+    test_run_xfer(true, false, false, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_generic_exp_rndv_am_window_zcopy,
+           "RNDV_THRESH=1000", "ZCOPY_THRESH=1000", "RNDV_AM_WINDOW=64k") {
+    test_run_xfer(true, false, true, false, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, send_contig_recv_generic_unexp_sync_rndv_am_window_zcopy,
+           "RNDV_THRESH=1000", "ZCOPY_THRESH=1000", "RNDV_AM_WINDOW=5000") {
+    test_run_xfer(true, false, false, true, false);
+}
+
+/* many rendezvous receives served by a limited get budget */
+
+UCS_TEST_P(test_ucp_tag_xfer, contig_exp_rndv_max_inflight,
+           "RNDV_THRESH=1000", "RNDV_FRAG_SIZE=64k", "RNDV_MAX_INFLIGHT=128k") {
+    test_xfer_concurrent(true);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, contig_unexp_rndv_max_inflight_ops,
+           "RNDV_THRESH=1000", "RNDV_FRAG_SIZE=64k", "RNDV_MAX_INFLIGHT_OPS=1") {
+    test_xfer_concurrent(false);
+}
+
 UCS_TEST_SKIP_COND_P(test_ucp_tag_xfer, test_xfer_len_offset,
                      RUNNING_ON_VALGRIND, "RNDV_THRESH=1000") {
     test_xfer_len_offset();
@@ -1105,6 +1637,60 @@ UCS_TEST_P(test_ucp_tag_stats, rndv_unexpected, "RNDV_THRESH=1000") {
                       UCP_WORKER_STAT_TAG_RX_RNDV_UNEXP);
 }
 
+/* every rendezvous rail fetches a share of the message proportional to its
+ * bandwidth */
+UCS_TEST_P(test_ucp_tag_stats, rndv_get_lanes_share, "RNDV_THRESH=1000",
+           "RNDV_SCHEME=get_zcopy", "MAX_RNDV_RAILS=2") {
+    static const size_t size = 8 * UCS_MBYTE;
+    std::vector<char> sendbuf(size), recvbuf(size, 0);
+    uint64_t lane_bytes[UCP_MAX_LANES], total;
+    const ucp_ep_config_t *config;
+    request *sreq, *rreq;
+    double scale_sum;
+
+    check_offload_support(false);
+    skip_loopback();
+
+    ucs::fill_random(sendbuf);
+    rreq = recv_nb(&recvbuf[0], recvbuf.size(), DATATYPE, 0x1337, 0xffff);
+    ASSERT_TRUE(!UCS_PTR_IS_ERR(rreq));
+
+    sreq = send_nb(&sendbuf[0], sendbuf.size(), DATATYPE, 0x1337);
+    ASSERT_TRUE(!UCS_PTR_IS_ERR(sreq));
+
+    wait(rreq);
+    EXPECT_EQ(sendbuf, recvbuf);
+    request_release(rreq);
+    wait_and_validate(sreq);
+
+    /* the receiver fetches the data */
+    config    = ucp_ep_config(receiver().ep());
+    total     = 0;
+    scale_sum = 0;
+    for (ucp_lane_index_t lane = 0; lane < UCP_MAX_LANES; ++lane) {
+        lane_bytes[lane] = UCS_STATS_GET_COUNTER(ep_stats(receiver()),
+                                                 UCP_EP_STAT_RNDV_GET_BYTES +
+                                                 lane);
+        if (lane_bytes[lane] > 0) {
+            total     += lane_bytes[lane];
+            scale_sum += config->tag.rndv.scale[lane];
+        }
+    }
+
+    if (total == 0) {
+        UCS_TEST_SKIP_R("rendezvous get is not supported");
+    }
+
+    EXPECT_EQ(size, total);
+    for (ucp_lane_index_t lane = 0; lane < UCP_MAX_LANES; ++lane) {
+        if (lane_bytes[lane] > 0) {
+            EXPECT_NEAR(config->tag.rndv.scale[lane] / scale_sum,
+                        (double)lane_bytes[lane] / total, 0.1)
+                        << "lane " << (int)lane;
+        }
+    }
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_stats)
 
 #endif
@@ -148,6 +148,43 @@ UCS_TEST_SKIP_COND_P(test_ucp_wakeup, tx_wait,
     EXPECT_EQ(send_data, recv_data);
 }
 
+UCS_TEST_P(test_ucp_wakeup, rx_wait_spin, "WAIT_SPIN_TIME=1ms")
+{
+    const ucp_datatype_t DATATYPE = ucp_dt_make_contig(1);
+    const uint64_t TAG            = 0xdeadbeef;
+    const unsigned COUNT          = 100;
+    ucp_worker_h recv_worker;
+    void *sreq, *rreq;
+
+    sender().connect(&receiver(), get_ep_params());
+    recv_worker = receiver().worker();
+
+    for (unsigned i = 0; i < COUNT; ++i) {
+        uint64_t send_data = i, recv_data = 0;
+
+        rreq = ucp_tag_recv_nb(recv_worker, &recv_data, sizeof(recv_data),
+                               DATATYPE, TAG, (ucp_tag_t)-1, recv_completion);
+
+        sreq = ucp_tag_send_nb(sender().ep(), &send_data, sizeof(send_data),
+                               DATATYPE, TAG, send_completion);
+        if (UCS_PTR_IS_PTR(sreq)) {
+            wait(sreq);
+        } else {
+            ASSERT_UCS_OK(UCS_PTR_STATUS(sreq));
+        }
+
+        /* spins, or blocks until the message arrives */
+        while (!ucp_request_is_completed(rreq)) {
+            if (!ucp_worker_progress(recv_worker)) {
+                ASSERT_UCS_OK(ucp_worker_wait(recv_worker));
+            }
+        }
+        ucp_request_release(rreq);
+
+        EXPECT_EQ(send_data, recv_data);
+    }
+}
+
 UCS_TEST_P(test_ucp_wakeup, signal)
 {
     int efd;
@@ -15,6 +15,7 @@
 
 extern "C" {
 #include <ucp/wireup/address.h>
+#include <ucp/wireup/select_cache.h>
 #include <ucp/proto/proto.h>
 #include <ucp/core/ucp_ep.inl>
 }
@@ -448,6 +449,94 @@ UCS_TEST_P(test_ucp_wireup_1sided, empty_address) {
     ucs_free(buffer);
 }
 
+UCS_TEST_P(test_ucp_wireup_1sided, address_compact, "ADDRESS_COMPACT=y") {
+    ucp_worker_h worker = sender().worker();
+    ucp_context_h ctx   = sender().ucph();
+    std::vector<char> dev_addr;
+    ucp_worker_iface_t *wiface;
+    uct_iface_attr_t *attr;
+    ucs_status_t status;
+    size_t size, full_size;
+    void *buffer;
+    unsigned order[UCP_MAX_RESOURCES];
+    unsigned address_count;
+    ucp_rsc_index_t tl;
+
+    status = ucp_address_pack(worker, NULL, -1, -1, order, &size, &buffer);
+    ASSERT_UCS_OK(status);
+
+    ucp_unpacked_address unpacked_address;
+
+    status = ucp_address_unpack(worker, buffer, -1, &unpacked_address);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(worker->uuid, unpacked_address.uuid);
+
+    /* Compare the unpacked address to the local interface attributes */
+    ucs_for_each_bit(tl, ctx->tl_bitmap) {
+        attr = ucp_worker_iface_get_attr(worker, tl);
+        if (!(attr->cap.flags & (UCT_IFACE_FLAG_CONNECT_TO_IFACE |
+                                 UCT_IFACE_FLAG_CONNECT_TO_EP))) {
+            continue;
+        }
+
+        ASSERT_LT(order[tl], unpacked_address.address_count);
+        const ucp_address_entry_t *ae = &unpacked_address.address_list[order[tl]];
+
+        EXPECT_EQ(ctx->tl_rscs[tl].tl_name_csum, ae->tl_name_csum);
+        EXPECT_EQ(ctx->tl_rscs[tl].md_index, ae->md_index);
+        EXPECT_EQ(attr->priority, ae->iface_attr.priority);
+        EXPECT_EQ(attr->cap.flags & UCP_ADDRESS_IFACE_FLAGS,
+                  ae->iface_attr.cap_flags & UCP_ADDRESS_IFACE_FLAGS);
+        EXPECT_NEAR(attr->overhead, ae->iface_attr.overhead,
+                    attr->overhead * 0.01);
+        EXPECT_NEAR(attr->latency.overhead, ae->iface_attr.lat_ovh,
+                    attr->latency.overhead * 0.01);
+        EXPECT_NEAR(attr->bandwidth.dedicated + attr->bandwidth.shared,
+                    ae->iface_attr.bandwidth.dedicated +
+                    ae->iface_attr.bandwidth.shared,
+                    (attr->bandwidth.dedicated + attr->bandwidth.shared) * 0.01);
+
+        if (attr->device_addr_len > 0) {
+            dev_addr.resize(attr->device_addr_len);
+            wiface = ucp_worker_iface(worker, tl);
+            ASSERT_UCS_OK(uct_iface_get_device_address(wiface->iface,
+                              (uct_device_addr_t*)&dev_addr[0]));
+            ASSERT_TRUE(ae->dev_addr != NULL);
+            EXPECT_EQ(0, memcmp(&dev_addr[0], ae->dev_addr, dev_addr.size()));
+        }
+    }
+
+    address_count = unpacked_address.address_count;
+    ucs_free(unpacked_address.address_list);
+    ucs_free(buffer);
+
+    /* The compact address is not larger than the full one */
+    ctx->config.ext.address_compact = 0;
+    status = ucp_address_pack(worker, NULL, -1, -1, order, &full_size, &buffer);
+    ctx->config.ext.address_compact = 1;
+    ASSERT_UCS_OK(status);
+
+    /* The address format is taken from the address, not from the local
+     * configuration */
+    status = ucp_address_unpack(worker, buffer, -1, &unpacked_address);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(worker->uuid, unpacked_address.uuid);
+    EXPECT_EQ(address_count, unpacked_address.address_count);
+    ucs_free(unpacked_address.address_list);
+    ucs_free(buffer);
+
+    UCS_TEST_MESSAGE << "address size: " << size << " bytes, full: "
+                     << full_size << " bytes";
+    EXPECT_LE(size, full_size);
+}
+
+UCS_TEST_P(test_ucp_wireup_1sided, one_sided_wireup_compact,
+           "ADDRESS_COMPACT=y") {
+    sender().connect(&receiver(), get_ep_params());
+    send_recv(sender().ep(), receiver().worker(), receiver().ep(), 1, 1);
+    flush_worker(sender());
+}
+
 UCS_TEST_P(test_ucp_wireup_1sided, one_sided_wireup) {
     sender().connect(&receiver(), get_ep_params());
     send_recv(sender().ep(), receiver().worker(), receiver().ep(), 1, 1);
@@ -622,6 +711,38 @@ UCS_TEST_P(test_ucp_wireup_1sided, multi_ep_1sided) {
     }
 }
 
+UCS_TEST_P(test_ucp_wireup_1sided, lanes_cache) {
+    const ucp_wireup_select_cache_t *cache = &sender().worker()->select_cache;
+    const unsigned count                   = 10;
+    uint64_t hits;
+
+    sender().connect(&receiver(), get_ep_params(), 0);
+    hits = cache->hits;
+    EXPECT_GT(cache->count, 0u);
+
+    for (unsigned i = 1; i < count; ++i) {
+        sender().connect(&receiver(), get_ep_params(), i);
+        EXPECT_EQ(sender().ep(0, 0)->cfg_index, sender().ep(0, i)->cfg_index);
+    }
+
+    EXPECT_GE(cache->hits, hits + count - 1);
+
+    for (unsigned i = 0; i < count; ++i) {
+        send_recv(sender().ep(0, i), receiver().worker(), receiver().ep(), 8, 1);
+    }
+}
+
+UCS_TEST_P(test_ucp_wireup_1sided, lanes_cache_disabled, "LANES_CACHE_SIZE=0") {
+    const ucp_wireup_select_cache_t *cache = &sender().worker()->select_cache;
+
+    sender().connect(&receiver(), get_ep_params(), 0);
+    sender().connect(&receiver(), get_ep_params(), 1);
+    EXPECT_EQ(0u, cache->count);
+    EXPECT_EQ(0u, cache->hits);
+
+    send_recv(sender().ep(0, 1), receiver().worker(), receiver().ep(), 8, 1);
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_wireup_1sided)
 
 class test_ucp_wireup_2sided : public test_ucp_wireup {
@@ -1158,4 +1279,45 @@ UCS_TEST_P(test_ucp_wireup_fallback_amo, different_amo_types) {
 }
 
 UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_wireup_fallback_amo,
-                              shm_rc, "shm,rc_x,rc_v")
\ No newline at end of file
+                              shm_rc, "shm,rc_x,rc_v")
+class test_ucp_wireup_select_cache : public ucs::test {
+protected:
+    void add(ucp_wireup_select_cache_t *cache, uint64_t signature) {
+        ucp_ep_config_key_t key;
+        uint8_t             addr_indices[UCP_MAX_LANES] = {0};
+
+        ucp_ep_config_key_reset(&key);
+        ucp_wireup_select_cache_add(cache, &signature, sizeof(signature), &key,
+                                    addr_indices);
+    }
+
+    bool lookup(ucp_wireup_select_cache_t *cache, uint64_t signature) {
+        return ucp_wireup_select_cache_lookup(cache, &signature,
+                                              sizeof(signature)) != NULL;
+    }
+};
+
+UCS_TEST_F(test_ucp_wireup_select_cache, lru) {
+    const unsigned            max_count = 4;
+    ucp_wireup_select_cache_t cache;
+
+    ucp_wireup_select_cache_init(&cache, max_count);
+
+    for (uint64_t signature = 0; signature < max_count; ++signature) {
+        add(&cache, signature);
+    }
+    EXPECT_EQ(max_count, cache.count);
+
+    /* use the first entry, so the second one is the least recently used */
+    EXPECT_TRUE(lookup(&cache, 0));
+
+    add(&cache, max_count);
+    EXPECT_EQ(max_count, cache.count);
+    EXPECT_FALSE(lookup(&cache, 1));
+    EXPECT_TRUE(lookup(&cache, 0));
+    for (uint64_t signature = 2; signature <= max_count; ++signature) {
+        EXPECT_TRUE(lookup(&cache, signature));
+    }
+
+    ucp_wireup_select_cache_cleanup(&cache);
+}
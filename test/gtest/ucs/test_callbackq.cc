@@ -19,7 +19,8 @@ protected:
     enum {
         COMMAND_NONE,
         COMMAND_REMOVE_SELF,
-        COMMAND_ADD_ANOTHER
+        COMMAND_ADD_ANOTHER,
+        COMMAND_IDLE
     };
 
     struct callback_ctx {
@@ -64,6 +65,8 @@ protected:
         case COMMAND_ADD_ANOTHER:
             add(ctx->to_add);
             break;
+        case COMMAND_IDLE:
+            return 0;
         case COMMAND_NONE:
         default:
             break;
@@ -132,6 +135,15 @@ protected:
         return total;
     }
 
+    unsigned dispatch_budget(unsigned count, unsigned max_events = UINT_MAX)
+    {
+        unsigned total = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            total += ucs_callbackq_dispatch_budget(&m_cbq, max_events);
+        }
+        return total;
+    }
+
     ucs_callbackq_t     m_cbq;
 };
 
@@ -362,3 +374,95 @@ UCS_TEST_F(test_callbackq_noflags, remove_if) {
     }
 }
 
+UCS_TEST_F(test_callbackq_noflags, backoff) {
+    const unsigned num_dispatch = 1000;
+    callback_ctx ctx;
+
+    init_ctx(&ctx);
+    ctx.command = COMMAND_IDLE;
+    add(&ctx, UCS_CALLBACKQ_FLAG_FAST | UCS_CALLBACKQ_FLAG_BACKOFF);
+
+    /* an idle callback is dispatched less and less often */
+    dispatch_budget(num_dispatch);
+    EXPECT_GE(ctx.count, num_dispatch / (UCS_CALLBACKQ_BACKOFF_MAX + 1));
+    EXPECT_LE(ctx.count, 2 * num_dispatch / (UCS_CALLBACKQ_BACKOFF_MAX + 1));
+
+    /* doing work resets the backoff */
+    ctx.command = COMMAND_NONE;
+    dispatch_budget(UCS_CALLBACKQ_BACKOFF_MAX + 1);
+    ctx.count = 0;
+    dispatch_budget(10);
+    EXPECT_EQ(10u, ctx.count);
+
+    /* dispatching without a budget ignores the backoff */
+    ctx.command = COMMAND_IDLE;
+    dispatch_budget(UCS_CALLBACKQ_BACKOFF_MAX + 1);
+    ctx.count = 0;
+    dispatch(10);
+    EXPECT_EQ(10u, ctx.count);
+
+    remove(&ctx);
+}
+
+UCS_TEST_F(test_callbackq_noflags, budget) {
+    const unsigned num_others = 3;
+    callback_ctx prio, others[num_others];
+    unsigned i, count, others_count;
+
+    init_ctx(&prio);
+    add(&prio, UCS_CALLBACKQ_FLAG_FAST | UCS_CALLBACKQ_FLAG_PRIO);
+    for (i = 0; i < num_others; ++i) {
+        init_ctx(&others[i]);
+        add(&others[i], UCS_CALLBACKQ_FLAG_FAST);
+    }
+
+    /* the priority callback exhausts the budget */
+    count = ucs_callbackq_dispatch_budget(&m_cbq, 1);
+    EXPECT_EQ(1u, count);
+    EXPECT_EQ(1u, prio.count);
+
+    /* the rest of the budget goes to the other callbacks */
+    count = ucs_callbackq_dispatch_budget(&m_cbq, 2);
+    EXPECT_EQ(2u, count);
+    EXPECT_EQ(2u, prio.count);
+
+    /* idle priority callback does not consume the budget */
+    prio.command = COMMAND_IDLE;
+    count        = ucs_callbackq_dispatch_budget(&m_cbq, num_others);
+    EXPECT_EQ(num_others, count);
+    EXPECT_EQ(3u, prio.count);
+
+    others_count = 0;
+    for (i = 0; i < num_others; ++i) {
+        others_count += others[i].count;
+    }
+    EXPECT_EQ(num_others + 1, others_count);
+
+    remove(&prio);
+    for (i = 0; i < num_others; ++i) {
+        remove(&others[i]);
+    }
+}
+
+UCS_TEST_F(test_callbackq_noflags, budget_round_robin) {
+    const unsigned num_elems    = 4;
+    const unsigned num_dispatch = 100;
+    callback_ctx ctx[num_elems];
+    unsigned i;
+
+    for (i = 0; i < num_elems; ++i) {
+        init_ctx(&ctx[i]);
+        add(&ctx[i], UCS_CALLBACKQ_FLAG_FAST);
+    }
+
+    /* every callback does work, so a budget of 1 dispatches only one of them
+     * each time; the next dispatch starts with the next callback */
+    dispatch_budget(num_dispatch * num_elems, 1);
+    for (i = 0; i < num_elems; ++i) {
+        EXPECT_EQ(num_dispatch, ctx[i].count) << "callback " << i;
+    }
+
+    for (i = 0; i < num_elems; ++i) {
+        remove(&ctx[i]);
+    }
+}